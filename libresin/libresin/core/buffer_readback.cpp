@@ -0,0 +1,88 @@
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <libresin/core/buffer_readback.hpp>
+#include <libresin/utils/logger.hpp>
+
+namespace resin {
+
+BufferReadback::~BufferReadback() {
+  if (fence_ != nullptr) {
+    glDeleteSync(fence_);
+  }
+  if (staging_buffer_ != 0) {
+    glDeleteBuffers(1, &staging_buffer_);
+  }
+}
+
+void BufferReadback::request(GLuint source_buffer, size_t size) {
+  if (fence_ != nullptr) {
+    glDeleteSync(fence_);
+    fence_ = nullptr;
+  }
+  if (staging_buffer_ == 0) {
+    glGenBuffers(1, &staging_buffer_);
+  }
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, staging_buffer_);
+  if (size > capacity_) {
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+    capacity_ = size;
+  }
+  size_ = size;
+
+  if (size > 0) {
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_READ_BUFFER, source_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(size));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  // Flush so the fence is guaranteed to signal even if nobody waits on it with GL_SYNC_FLUSH_COMMANDS_BIT
+  fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+}
+
+bool BufferReadback::is_ready() const {
+  if (fence_ == nullptr) {
+    return false;
+  }
+  const GLenum status = glClientWaitSync(fence_, 0, 0);
+  return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void BufferReadback::read(void* output, size_t size) const {
+  if (fence_ == nullptr) {
+    Logger::warn("Attempted to read a buffer readback that was never requested");
+    return;
+  }
+
+  constexpr GLuint64 kWaitTimeout = 1'000'000'000;  // 1s
+  GLenum status                   = GL_TIMEOUT_EXPIRED;
+  while (status == GL_TIMEOUT_EXPIRED) {
+    status = glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitTimeout);
+  }
+  if (status == GL_WAIT_FAILED) {
+    Logger::err("Failed to wait for a buffer readback");
+    return;
+  }
+
+  size = std::min(size, size_);
+  if (size == 0) {
+    return;
+  }
+
+  glBindBuffer(GL_COPY_READ_BUFFER, staging_buffer_);
+  const void* data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+  if (data != nullptr) {
+    std::memcpy(output, data, size);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+  } else {
+    Logger::err("Failed to map a buffer readback");
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+}  // namespace resin
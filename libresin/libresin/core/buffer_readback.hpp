@@ -0,0 +1,44 @@
+#ifndef RESIN_BUFFER_READBACK_HPP
+#define RESIN_BUFFER_READBACK_HPP
+
+#include <glad/gl.h>
+
+#include <cstddef>
+
+namespace resin {
+
+// Asynchronous download of a GL buffer. The requested range is copied on the GPU into a staging buffer (the buffer
+// counterpart of a pixel pack buffer) and fenced, so the CPU can poll the fence every frame and map the staging buffer
+// only once the copy is done instead of stalling in glGetBufferSubData.
+class BufferReadback {
+ public:
+  BufferReadback() = default;
+  ~BufferReadback();
+
+  BufferReadback(const BufferReadback&)            = delete;
+  BufferReadback(BufferReadback&&)                 = delete;
+  BufferReadback& operator=(const BufferReadback&) = delete;
+  BufferReadback& operator=(BufferReadback&&)      = delete;
+
+  // Schedules a copy of the first size bytes of the source buffer. Writes of the shaders issued earlier are visible.
+  void request(GLuint source_buffer, size_t size);
+
+  // Never blocks.
+  bool is_ready() const;
+
+  // Blocks until the copy is done and copies min(size, requested size) bytes to the output.
+  void read(void* output, size_t size) const;
+
+  inline bool is_requested() const { return fence_ != nullptr; }
+  inline size_t size() const { return size_; }
+
+ private:
+  GLuint staging_buffer_ = 0;
+  size_t capacity_       = 0;
+  size_t size_           = 0;
+  GLsync fence_          = nullptr;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_BUFFER_READBACK_HPP
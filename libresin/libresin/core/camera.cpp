@@ -51,4 +51,16 @@ void Camera::recalculate_projection() {
   }
 }
 
+Ray Camera::ray(const glm::vec2& ndc) const {
+  // Same as v_Pos of main.vert, a point of the near plane (orthographic: of the camera plane) in the view space
+  const glm::vec2 pos             = ndc * glm::vec2(width_, height_);
+  const glm::mat4& local_to_world = transform.local_to_world_matrix();
+  if (is_orthographic_) {
+    return Ray{.origin    = glm::vec3(local_to_world * glm::vec4(pos, 0.0F, 1.0F)),
+               .direction = glm::normalize(glm::vec3(local_to_world * glm::vec4(0.0F, 0.0F, -1.0F, 0.0F)))};
+  }
+  return Ray{.origin    = glm::vec3(local_to_world * glm::vec4(0.0F, 0.0F, 0.0F, 1.0F)),
+             .direction = glm::normalize(glm::vec3(local_to_world * glm::vec4(pos, -near_plane_, 0.0F)))};
+}
+
 }  // namespace resin
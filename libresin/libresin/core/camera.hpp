@@ -1,9 +1,16 @@
 #ifndef RESIN_CAMERA_HPP
 #define RESIN_CAMERA_HPP
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <libresin/core/transform.hpp>
 
 namespace resin {
 
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;  // normalized
+};
+
 class Camera {
  public:
   Transform transform;
@@ -30,6 +37,9 @@ class Camera {
 
   void recalculate_projection();
 
+  // World space ray through the given normalized device coordinates, the same ray main.frag traces for the fragment.
+  Ray ray(const glm::vec2& ndc) const;
+
  private:
   bool is_orthographic_;
 
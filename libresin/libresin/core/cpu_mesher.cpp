@@ -0,0 +1,232 @@
+#include <array>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <libresin/core/cpu_mesher.hpp>
+#include <libresin/core/marching_cubes_tables.hpp>
+
+namespace resin {
+
+namespace {
+
+constexpr int kTileSide = static_cast<int>(CPUMesher::kTileSize) + 1;
+
+inline size_t local_corner_index(const glm::ivec3& local) {
+  return static_cast<size_t>((((local.z * kTileSide) + local.y) * kTileSide) + local.x);
+}
+
+template <typename T>
+void append(std::vector<T>& dst, const std::vector<T>& src) {
+  dst.insert(dst.end(), src.begin(), src.end());
+}
+
+}  // namespace
+
+CPUMesher::CPUMesher(const SDFEvaluator& evaluator, const glm::vec3& bb_start, const glm::vec3& bb_end,
+                     unsigned int resolution)
+    : evaluator_(evaluator),
+      bb_start_(bb_start),
+      bb_end_(bb_end),
+      voxel_size_((bb_end - bb_start) / static_cast<float>(resolution)),
+      resolution_(resolution),
+      tile_res_(resolution / kTileSize) {}
+
+TriangleSoup CPUMesher::march(ThreadPool& pool, const std::stop_token& stop_token) const {
+  std::vector<TriangleSoup> tiles(tile_count());
+  pool.parallel_for(tiles.size(), [this, &tiles, &stop_token](size_t index) {
+    if (stop_token.stop_requested()) {
+      return;
+    }
+    thread_local std::vector<float> values;
+    const glm::ivec3 tile = tile_coords(index);
+    if (sample_tile(tile, values)) {
+      march_tile(tile, values, tiles[index]);
+    }
+  });
+
+  TriangleSoup result;
+  size_t vertex_count = 0;
+  for (const auto& tile : tiles) {
+    vertex_count += tile.vertices.size();
+  }
+  result.vertices.reserve(vertex_count);
+  result.normals.reserve(vertex_count);
+  result.uvs.reserve(vertex_count);
+  result.edge_ids.reserve(vertex_count);
+  result.materials.reserve(vertex_count / 3);
+  for (const auto& tile : tiles) {
+    append(result.vertices, tile.vertices);
+    append(result.normals, tile.normals);
+    append(result.uvs, tile.uvs);
+    append(result.edge_ids, tile.edge_ids);
+    append(result.materials, tile.materials);
+  }
+  return result;
+}
+
+std::vector<HermiteSample> CPUMesher::hermite_samples(ThreadPool& pool, const std::stop_token& stop_token) const {
+  std::vector<std::vector<HermiteSample>> tiles(tile_count());
+  pool.parallel_for(tiles.size(), [this, &tiles, &stop_token](size_t index) {
+    if (stop_token.stop_requested()) {
+      return;
+    }
+    thread_local std::vector<float> values;
+    const glm::ivec3 tile = tile_coords(index);
+    if (sample_tile(tile, values)) {
+      hermite_tile(tile, values, tiles[index]);
+    }
+  });
+
+  std::vector<HermiteSample> result;
+  for (const auto& tile : tiles) {
+    append(result, tile);
+  }
+  return result;
+}
+
+bool CPUMesher::sample_tile(const glm::ivec3& tile, std::vector<float>& values) const {
+  // Same distance bound test as the classify pass
+  const glm::vec3 tile_size = voxel_size_ * static_cast<float>(kTileSize);
+  const glm::vec3 center    = bb_start_ + ((glm::vec3(tile) + 0.5F) * tile_size);
+  const float half_diagonal = (0.5F * glm::length(tile_size)) + glm::length(voxel_size_);
+  if (std::abs(evaluator_.distance(center)) > half_diagonal) {
+    return false;
+  }
+
+  // Corners on the tile faces are evaluated by both of the neighbouring tiles, the evaluation is deterministic so
+  // both of them see the same values.
+  values.resize(static_cast<size_t>(kTileSide) * kTileSide * kTileSide);
+  const glm::ivec3 origin = tile * static_cast<int>(kTileSize);
+  for (int z = 0; z < kTileSide; ++z) {
+    for (int y = 0; y < kTileSide; ++y) {
+      for (int x = 0; x < kTileSide; ++x) {
+        const glm::ivec3 local(x, y, z);
+        values[local_corner_index(local)] = evaluator_.distance(corner_position(origin + local));
+      }
+    }
+  }
+  return true;
+}
+
+void CPUMesher::march_tile(const glm::ivec3& tile, const std::vector<float>& values, TriangleSoup& soup) const {
+  const glm::ivec3 origin = tile * static_cast<int>(kTileSize);
+  const auto tile_size    = static_cast<int>(kTileSize);
+
+  std::array<float, 8> cube_values{};
+  std::array<glm::vec3, 8> cube_positions{};
+  std::array<glm::vec3, 12> edge_vertices{};
+  for (int z = 0; z < tile_size; ++z) {
+    for (int y = 0; y < tile_size; ++y) {
+      for (int x = 0; x < tile_size; ++x) {
+        const glm::ivec3 local(x, y, z);
+        const glm::ivec3 cell = origin + local;
+
+        int cube_index = 0;
+        for (size_t i = 0; i < 8; ++i) {
+          cube_values[i]    = values[local_corner_index(local + kMarchingCubesCornerOffsets[i])];
+          cube_positions[i] = corner_position(cell + kMarchingCubesCornerOffsets[i]);
+          if (cube_values[i] < 0) {
+            cube_index |= 1 << i;  // NOLINT(hicpp-signed-bitwise)
+          }
+        }
+
+        const int edge_flags = kMarchingCubesEdgeTable[static_cast<size_t>(cube_index)];
+        if (edge_flags == 0) {
+          continue;
+        }
+
+        for (size_t i = 0; i < 12; ++i) {
+          if ((edge_flags & (1 << i)) != 0) {  // NOLINT(hicpp-signed-bitwise)
+            const auto [v1, v2] = kMarchingCubesEdgeCorners[i];
+            const float val1    = cube_values[static_cast<size_t>(v1)];
+            const float val2    = cube_values[static_cast<size_t>(v2)];
+            edge_vertices[i]    = glm::mix(cube_positions[static_cast<size_t>(v1)],
+                                           cube_positions[static_cast<size_t>(v2)], -val1 / (val2 - val1));
+          }
+        }
+
+        const size_t tri_offset = static_cast<size_t>(cube_index) * 16;
+        for (size_t i = 0; kMarchingCubesTriTable[tri_offset + i] != -1; ++i) {
+          const int edge     = kMarchingCubesTriTable[tri_offset + i];
+          const glm::vec3& p = edge_vertices[static_cast<size_t>(edge)];
+
+          // Same as edgeId of the shader
+          const auto [c1, c2] = kMarchingCubesEdgeCorners[static_cast<size_t>(edge)];
+          const glm::ivec3 a  = cell + kMarchingCubesCornerOffsets[static_cast<size_t>(c1)];
+          const glm::ivec3 b  = cell + kMarchingCubesCornerOffsets[static_cast<size_t>(c2)];
+          const glm::ivec3 d  = glm::abs(b - a);
+          const uint32_t axis = d.x == 1 ? 0 : (d.y == 1 ? 1 : 2);
+
+          const glm::vec3 normalized = (p - bb_start_) / (bb_end_ - bb_start_);
+          soup.vertices.emplace_back(p, 1.0F);
+          soup.normals.emplace_back(evaluator_.normal(p), 1.0F);
+          soup.uvs.emplace_back(normalized.x, normalized.y);
+          soup.edge_ids.push_back((corner_index(glm::min(a, b)) * 3) + axis);
+
+          // Same as the march pass, the material is picked at the triangle centroid
+          if (i % 3 == 2) {
+            const size_t first       = soup.vertices.size() - 3;
+            const glm::vec3 centroid = (glm::vec3(soup.vertices[first]) + glm::vec3(soup.vertices[first + 1]) +
+                                        glm::vec3(soup.vertices[first + 2])) /
+                                       3.0F;
+            soup.materials.push_back(evaluator_.material(centroid));
+          }
+        }
+      }
+    }
+  }
+}
+
+void CPUMesher::hermite_tile(const glm::ivec3& tile, const std::vector<float>& values,
+                             std::vector<HermiteSample>& samples) const {
+  const glm::ivec3 origin = tile * static_cast<int>(kTileSize);
+  const auto tile_size    = static_cast<int>(kTileSize);
+
+  // Every cell handles the 3 grid edges starting at its lower corner, so each edge is visited once
+  for (int z = 0; z < tile_size; ++z) {
+    for (int y = 0; y < tile_size; ++y) {
+      for (int x = 0; x < tile_size; ++x) {
+        const glm::ivec3 local(x, y, z);
+        const glm::ivec3 cell = origin + local;
+        const float v0        = values[local_corner_index(local)];
+        for (int axis = 0; axis < 3; ++axis) {
+          glm::ivec3 end = local;
+          end[axis] += 1;
+          const float v1 = values[local_corner_index(end)];
+          if ((v0 < 0) == (v1 < 0)) {
+            continue;
+          }
+
+          const glm::vec3 p0 = corner_position(cell);
+          const glm::vec3 p1 = corner_position(origin + end);
+          const glm::vec3 p  = glm::mix(p0, p1, -v0 / (v1 - v0));
+
+          HermiteSample sample{};
+          sample.position      = glm::vec4(p, 1.0F);
+          sample.normal        = glm::vec4(evaluator_.normal(p), 0.0F);
+          sample.edge_id       = (corner_index(cell) * 3) + static_cast<uint32_t>(axis);
+          sample.starts_inside = v0 < 0 ? 1 : 0;
+          sample.material_id   = evaluator_.material(p);
+          samples.push_back(sample);
+        }
+      }
+    }
+  }
+}
+
+glm::ivec3 CPUMesher::tile_coords(size_t index) const {
+  const size_t res = tile_res_;
+  return {static_cast<int>(index % res), static_cast<int>((index / res) % res), static_cast<int>(index / (res * res))};
+}
+
+glm::vec3 CPUMesher::corner_position(const glm::ivec3& corner) const {
+  return bb_start_ + (glm::vec3(corner) * voxel_size_);
+}
+
+uint32_t CPUMesher::corner_index(const glm::ivec3& corner) const {
+  const uint32_t side = resolution_ + 1;
+  return (((static_cast<uint32_t>(corner.z) * side) + static_cast<uint32_t>(corner.y)) * side) +
+         static_cast<uint32_t>(corner.x);
+}
+
+}  // namespace resin
@@ -0,0 +1,65 @@
+#ifndef RESIN_CPU_MESHER_HPP
+#define RESIN_CPU_MESHER_HPP
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <libresin/core/dual_contouring.hpp>
+#include <libresin/core/sdf_tree/sdf_evaluator.hpp>
+#include <libresin/utils/thread_pool.hpp>
+#include <stop_token>
+#include <vector>
+
+namespace resin {
+
+// Marching cubes output in the same layout as the buffers of marching_cubes.comp.
+struct TriangleSoup {
+  std::vector<glm::vec4> vertices;
+  std::vector<glm::vec4> normals;
+  std::vector<glm::vec2> uvs;
+  std::vector<uint32_t> edge_ids;
+  std::vector<uint32_t> materials;  // one per triangle
+};
+
+// Native counterpart of the sparse passes of marching_cubes.comp. The grid is split into tiles of kTileSize^3 cells
+// (the blocks of the shader) which are classified, sampled and meshed independently, one tile per pool task. The
+// tiles are concatenated in their index order, so the result does not depend on the scheduling and, apart from the
+// order of the triangles, matches the GPU output.
+class CPUMesher {
+ public:
+  CPUMesher(const SDFEvaluator& evaluator, const glm::vec3& bb_start, const glm::vec3& bb_end,
+            unsigned int resolution);
+
+  // Once a stop is requested the remaining tiles are skipped and the result is incomplete.
+  TriangleSoup march(ThreadPool& pool, const std::stop_token& stop_token = {}) const;
+  std::vector<HermiteSample> hermite_samples(ThreadPool& pool, const std::stop_token& stop_token = {}) const;
+
+  inline size_t tile_count() const { return static_cast<size_t>(tile_res_) * tile_res_ * tile_res_; }
+
+  // Matches BLOCK_SIZE of marching_cubes.comp.
+  static constexpr unsigned int kTileSize = 8;
+
+ private:
+  // Returns false if the tile cannot be crossed by the surface, otherwise fills the (kTileSize + 1)^3 corner values.
+  bool sample_tile(const glm::ivec3& tile, std::vector<float>& values) const;
+
+  void march_tile(const glm::ivec3& tile, const std::vector<float>& values, TriangleSoup& soup) const;
+  void hermite_tile(const glm::ivec3& tile, const std::vector<float>& values,
+                    std::vector<HermiteSample>& samples) const;
+
+  glm::ivec3 tile_coords(size_t index) const;
+  glm::vec3 corner_position(const glm::ivec3& corner) const;
+  uint32_t corner_index(const glm::ivec3& corner) const;
+
+  const SDFEvaluator& evaluator_;
+  glm::vec3 bb_start_;
+  glm::vec3 bb_end_;
+  glm::vec3 voxel_size_;
+  unsigned int resolution_;
+  unsigned int tile_res_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_CPU_MESHER_HPP
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <libresin/core/dual_contouring.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+constexpr int kJacobiSweeps = 6;
+
+// Eigenvalues smaller than this fraction of the largest one are treated as zero when inverting the QEF matrix.
+constexpr float kSingularValueThreshold = 0.1F;
+
+// Cyclic Jacobi eigendecomposition of a symmetric matrix: a = eigenvectors * diag(eigenvalues) * eigenvectors^T.
+void symmetric_eigen(glm::mat3 a, glm::mat3& eigenvectors, glm::vec3& eigenvalues) {
+  eigenvectors = glm::mat3(1.0F);
+  for (int sweep = 0; sweep < kJacobiSweeps; ++sweep) {
+    for (int p = 0; p < 2; ++p) {
+      for (int q = p + 1; q < 3; ++q) {
+        const float apq = a[q][p];
+        if (std::abs(apq) < 1e-12F) {
+          continue;
+        }
+
+        const float theta = (a[q][q] - a[p][p]) / (2.0F * apq);
+        const float t     = std::copysign(1.0F, theta) / (std::abs(theta) + std::sqrt((theta * theta) + 1.0F));
+        const float c     = 1.0F / std::sqrt((t * t) + 1.0F);
+        const float s     = t * c;
+
+        glm::mat3 rot(1.0F);
+        rot[p][p] = c;
+        rot[q][q] = c;
+        rot[q][p] = s;
+        rot[p][q] = -s;
+
+        a            = glm::transpose(rot) * a * rot;
+        eigenvectors = eigenvectors * rot;
+      }
+    }
+  }
+  eigenvalues = glm::vec3(a[0][0], a[1][1], a[2][2]);
+}
+
+inline uint64_t cell_key(const glm::uvec3& cell) {
+  return static_cast<uint64_t>(cell.x) | (static_cast<uint64_t>(cell.y) << 21U) |
+         (static_cast<uint64_t>(cell.z) << 42U);
+}
+
+struct OctreeCell {
+  QEF qef;
+  glm::vec3 normal_sum = glm::vec3(0.0F);
+};
+
+using OctreeLevel = std::unordered_map<uint64_t, OctreeCell>;
+
+}  // namespace
+
+void QEF::add(const glm::vec3& point, const glm::vec3& normal) {
+  const glm::dvec3 n(normal);
+  const double d = glm::dot(n, glm::dvec3(point));
+  ata_ += glm::outerProduct(n, n);
+  atb_ += n * d;
+  btb_ += d * d;
+  mass_point_sum_ += glm::dvec3(point);
+  ++count_;
+}
+
+void QEF::add(const QEF& other) {
+  ata_ += other.ata_;
+  atb_ += other.atb_;
+  btb_ += other.btb_;
+  mass_point_sum_ += other.mass_point_sum_;
+  count_ += other.count_;
+}
+
+glm::vec3 QEF::solve() const {
+  const glm::vec3 mp = mass_point();
+
+  glm::mat3 eigenvectors;
+  glm::vec3 eigenvalues;
+  symmetric_eigen(glm::mat3(ata_), eigenvectors, eigenvalues);
+
+  // Truncated pseudo-inverse, solved relative to the mass point
+  const float max_eigenvalue = std::max({eigenvalues.x, eigenvalues.y, eigenvalues.z});
+  glm::mat3 inv_diagonal(0.0F);
+  for (int i = 0; i < 3; ++i) {
+    if (eigenvalues[i] > kSingularValueThreshold * max_eigenvalue) {
+      inv_diagonal[i][i] = 1.0F / eigenvalues[i];
+    }
+  }
+  const glm::mat3 pinv = eigenvectors * inv_diagonal * glm::transpose(eigenvectors);
+  return mp + pinv * glm::vec3(atb_ - ata_ * glm::dvec3(mp));
+}
+
+float QEF::error(const glm::vec3& point) const {
+  const glm::dvec3 p(point);
+  return static_cast<float>(glm::dot(p, ata_ * p) - (2.0 * glm::dot(p, atb_)) + btb_);
+}
+
+IndexedMesh dual_contour(std::span<const HermiteSample> samples, const DualContouringOptions& options) {
+  const unsigned int res       = options.resolution;
+  const unsigned int side      = res + 1;
+  const glm::vec3 voxel_size   = (options.bb_end - options.bb_start) / static_cast<float>(res);
+  const float voxel_length     = glm::length(voxel_size) / std::sqrt(3.0F);
+  const float error_threshold  = options.max_relative_error * voxel_length * voxel_length;
+  const unsigned int max_depth = std::min(options.max_depth, 20U);
+  const glm::ivec3 grid_size   = glm::ivec3(static_cast<int>(res));
+
+  // Decodes the edge into its lower corner and the axis, returns the 4 cells sharing it ordered counterclockwise when
+  // looking from the positive end of the axis.
+  auto edge_cells = [side](uint32_t edge_id, std::array<glm::ivec3, 4>& cells) {
+    const uint32_t corner = edge_id / 3;
+    const int axis        = static_cast<int>(edge_id % 3);
+    const glm::ivec3 origin(static_cast<int>(corner % side), static_cast<int>((corner / side) % side),
+                            static_cast<int>(corner / (side * side)));
+
+    glm::ivec3 b(0);
+    glm::ivec3 c(0);
+    b[(axis + 1) % 3] = 1;
+    c[(axis + 2) % 3] = 1;
+
+    cells = {origin, origin - b, origin - b - c, origin - c};
+  };
+
+  auto in_grid = [grid_size](const glm::ivec3& cell) {
+    return glm::all(glm::greaterThanEqual(cell, glm::ivec3(0))) && glm::all(glm::lessThan(cell, grid_size));
+  };
+
+  // Leaf cells
+  std::vector<OctreeLevel> levels(max_depth + 1);
+  std::array<glm::ivec3, 4> cells;
+  for (const auto& sample : samples) {
+    edge_cells(sample.edge_id, cells);
+    for (const auto& cell : cells) {
+      if (!in_grid(cell)) {
+        continue;
+      }
+      auto& leaf = levels[0][cell_key(glm::uvec3(cell))];
+      leaf.qef.add(glm::vec3(sample.position), glm::vec3(sample.normal));
+      leaf.normal_sum += glm::vec3(sample.normal);
+    }
+  }
+
+  // Bottom-up octree simplification. A cell is collapsed only if all of its children crossed by the surface were
+  // collapsed and the merged QEF error is small enough.
+  auto cell_vertex = [&](const OctreeCell& cell, const glm::uvec3& coords, unsigned int level) {
+    const glm::vec3 cell_size = voxel_size * static_cast<float>(1U << level);
+    const glm::vec3 cell_min  = options.bb_start + glm::vec3(coords) * cell_size;
+    return glm::clamp(cell.qef.solve(), cell_min, cell_min + cell_size);
+  };
+
+  std::unordered_set<uint64_t> blocked_children;
+  for (unsigned int level = 1; level <= max_depth; ++level) {
+    std::unordered_set<uint64_t> blocked;
+    std::unordered_map<uint64_t, glm::uvec3> parents;
+    for (const auto& [key, cell] : levels[level - 1]) {
+      const glm::uvec3 coords((key & 0x1FFFFFU), ((key >> 21U) & 0x1FFFFFU), (key >> 42U));
+      const glm::uvec3 parent_coords = coords >> 1U;
+      const uint64_t parent_key      = cell_key(parent_coords);
+      auto& parent                   = levels[level][parent_key];
+      parent.qef.add(cell.qef);
+      parent.normal_sum += cell.normal_sum;
+      parents.emplace(parent_key, parent_coords);
+    }
+    for (const uint64_t key : blocked_children) {
+      const glm::uvec3 coords((key & 0x1FFFFFU), ((key >> 21U) & 0x1FFFFFU), (key >> 42U));
+      blocked.insert(cell_key(coords >> 1U));
+    }
+
+    for (const auto& [key, coords] : parents) {
+      if (blocked.contains(key)) {
+        continue;
+      }
+      const auto& cell = levels[level][key];
+      if (cell.qef.error(cell_vertex(cell, coords, level)) > error_threshold) {
+        blocked.insert(key);
+      }
+    }
+
+    for (const uint64_t key : blocked) {
+      levels[level].erase(key);
+    }
+    blocked_children = std::move(blocked);
+  }
+
+  // Vertices are emitted for the topmost collapsed cells only.
+  IndexedMesh mesh;
+  std::vector<std::unordered_map<uint64_t, uint32_t>> vertex_indices(max_depth + 1);
+  auto vertex_index = [&](const glm::ivec3& leaf) {
+    for (unsigned int level = max_depth + 1; level-- > 0;) {
+      const glm::uvec3 coords = glm::uvec3(leaf) >> level;
+      const uint64_t key      = cell_key(coords);
+      auto cell_it            = levels[level].find(key);
+      if (cell_it == levels[level].end()) {
+        continue;
+      }
+
+      auto [it, inserted] = vertex_indices[level].try_emplace(key, static_cast<uint32_t>(mesh.vertices.size()));
+      if (inserted) {
+        const glm::vec3 pos  = cell_vertex(cell_it->second, coords, level);
+        const glm::vec3 uv3  = (pos - options.bb_start) / (options.bb_end - options.bb_start);
+        const glm::vec3 norm = cell_it->second.normal_sum;
+        mesh.vertices.push_back(pos);
+        mesh.normals.push_back(glm::length(norm) > 0.0F ? glm::normalize(norm) : glm::vec3(0.0F));
+        mesh.uvs.emplace_back(uv3.x, uv3.y);
+      }
+      return it->second;
+    }
+    return static_cast<uint32_t>(-1);  // unreachable, every leaf crossed by the surface is present at level 0
+  };
+
+  mesh.indices.reserve(samples.size() * 6);
+  mesh.materials.reserve(samples.size() * 2);
+  for (const auto& sample : samples) {
+    edge_cells(sample.edge_id, cells);
+    if (!std::ranges::all_of(cells, in_grid)) {
+      continue;
+    }
+
+    std::array<uint32_t, 4> quad{};
+    for (size_t i = 0; i < 4; ++i) {
+      quad[i] = vertex_index(cells[i]);
+    }
+    if (sample.starts_inside == 0) {
+      std::ranges::reverse(quad);
+    }
+
+    for (const auto& tri : {std::array{quad[0], quad[1], quad[2]}, std::array{quad[0], quad[2], quad[3]}}) {
+      if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+        continue;
+      }
+      mesh.indices.insert(mesh.indices.end(), tri.begin(), tri.end());
+      mesh.materials.push_back(sample.material_id);
+    }
+  }
+
+  return mesh;
+}
+
+}  // namespace resin
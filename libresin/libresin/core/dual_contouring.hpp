@@ -0,0 +1,72 @@
+#ifndef RESIN_DUAL_CONTOURING_HPP
+#define RESIN_DUAL_CONTOURING_HPP
+
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <libresin/core/indexed_mesh.hpp>
+#include <span>
+
+namespace resin {
+
+// Intersection of the surface with a grid edge together with the surface normal at that point. The layout matches the
+// std430 HermiteSample struct of marching_cubes.comp.
+struct HermiteSample {
+  glm::vec4 position;
+  glm::vec4 normal;
+  uint32_t edge_id;        // (corner_index * 3 + axis) on the (resolution + 1)^3 corner grid
+  uint32_t starts_inside;  // 1 if the SDF is negative at the lower corner of the edge
+  uint32_t material_id;    // material of the surface at the sample, shared by the quad of the edge
+  uint32_t padding_;
+};
+static_assert(sizeof(HermiteSample) == 48, "HermiteSample must match the std430 layout");
+
+// Quadratic error function of the tangent planes going through the hermite samples. It is accumulated in double, as
+// the error of a point far from the origin is a small difference of large terms.
+class QEF {
+ public:
+  void add(const glm::vec3& point, const glm::vec3& normal);
+  void add(const QEF& other);
+
+  // Returns the point minimizing the sum of squared distances to the planes. Directions in which the planes are
+  // (nearly) degenerate are resolved towards the mass point, so flat regions do not produce spikes.
+  glm::vec3 solve() const;
+  float error(const glm::vec3& point) const;
+
+  inline size_t count() const { return count_; }
+  inline glm::vec3 mass_point() const {
+    return count_ == 0 ? glm::vec3(0.0F) : glm::vec3(mass_point_sum_ / double(count_));
+  }
+
+ private:
+  glm::dmat3 ata_            = glm::dmat3(0.0);
+  glm::dvec3 atb_            = glm::dvec3(0.0);
+  double btb_                = 0.0;
+  glm::dvec3 mass_point_sum_ = glm::dvec3(0.0);
+  size_t count_              = 0;
+};
+
+struct DualContouringOptions {
+  glm::vec3 bb_start;
+  glm::vec3 bb_end;
+  unsigned int resolution;
+
+  // Maximum QEF error of a collapsed octree cell, relative to the squared voxel size.
+  float max_relative_error = 0.01F;
+
+  // Number of octree levels above the leaf cells that may be collapsed into a single vertex.
+  unsigned int max_depth = 3;
+};
+
+// Builds an adaptive mesh out of the hermite samples of a uniform grid. Leaf cells crossed by the surface get a vertex
+// placed by minimizing their QEF, which keeps the sharp edges of the CSG operations. Octree cells whose children all
+// collapsed are collapsed as well if the merged QEF error stays below the threshold, so flat regions end up with far
+// fewer vertices than curved ones. Every sign-changing grid edge emits a quad joining the vertices of the (possibly
+// collapsed) cells around it.
+// Cost: O(n * max_depth) expected, where n is the sample count
+IndexedMesh dual_contour(std::span<const HermiteSample> samples, const DualContouringOptions& options);
+
+}  // namespace resin
+
+#endif  // RESIN_DUAL_CONTOURING_HPP
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <fstream>
+#include <libresin/core/frame_profiler.hpp>
+#include <libresin/utils/logger.hpp>
+#include <nlohmann/json.hpp>
+#include <numeric>
+
+namespace resin {
+
+namespace {
+
+constexpr double kNanosecondsPerMicrosecond = 1e3;
+constexpr double kNanosecondsPerMillisecond = 1e6;
+constexpr int kTraceProcessId               = 1;
+
+int trace_thread_id(ProfileTrack track) { return static_cast<int>(track) + 1; }
+
+}  // namespace
+
+RollingStats::RollingStats(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)), next_(0), last_(0.0) {
+  samples_.reserve(capacity_);
+}
+
+void RollingStats::add(double sample) {
+  last_ = sample;
+  if (samples_.size() < capacity_) {
+    samples_.push_back(sample);
+    return;
+  }
+  samples_[next_] = sample;
+  next_           = (next_ + 1) % capacity_;
+}
+
+double RollingStats::average() const {
+  if (samples_.empty()) {
+    return 0.0;
+  }
+  return std::accumulate(samples_.begin(), samples_.end(), 0.0) / static_cast<double>(samples_.size());
+}
+
+double RollingStats::min() const { return samples_.empty() ? 0.0 : *std::ranges::min_element(samples_); }
+
+double RollingStats::max() const { return samples_.empty() ? 0.0 : *std::ranges::max_element(samples_); }
+
+void write_chrome_trace(std::ostream& output, std::span<const ProfileEvent> events) {
+  nlohmann::json trace_events = nlohmann::json::array();
+
+  // Metadata events naming the threads after the tracks
+  for (const auto [track, name] : kProfileTrackNames) {
+    trace_events.push_back({{"name", "thread_name"},
+                            {"ph", "M"},
+                            {"pid", kTraceProcessId},
+                            {"tid", trace_thread_id(track)},
+                            {"args", {{"name", name}}}});
+  }
+
+  for (const auto& event : events) {
+    trace_events.push_back({{"name", event.name},
+                            {"cat", kProfileTrackNames[event.track]},
+                            {"ph", "X"},
+                            {"ts", static_cast<double>(event.start_ns) / kNanosecondsPerMicrosecond},
+                            {"dur", static_cast<double>(event.duration_ns) / kNanosecondsPerMicrosecond},
+                            {"pid", kTraceProcessId},
+                            {"tid", trace_thread_id(event.track)}});
+  }
+
+  const nlohmann::json trace = {{"traceEvents", std::move(trace_events)}, {"displayTimeUnit", "ms"}};
+  output << trace.dump();
+}
+
+FrameProfiler::FrameProfiler()
+    : current_frame_(0),
+      is_recording_(false),
+      dropped_frames_(0),
+      cpu_origin_(std::chrono::steady_clock::now()),
+      gpu_origin_(0) {
+  // The current GPU time taken together with the CPU time aligns both tracks of the trace
+  glGetInteger64v(GL_TIMESTAMP, &gpu_origin_);
+}
+
+FrameProfiler::~FrameProfiler() {
+  for (auto& frame : frames_) {
+    if (!frame.queries.empty()) {
+      glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+  }
+}
+
+void FrameProfiler::begin_frame() {
+  if (!open_queries_.empty()) {
+    Logger::warn("Frame profiler: {} GPU sections were not ended", open_queries_.size());
+    open_queries_.clear();
+  }
+
+  current_frame_ = (current_frame_ + 1) % kQueryFrames;
+  resolve(frames_[current_frame_]);
+  is_recording_ = is_enabled;
+}
+
+void FrameProfiler::begin_gpu(std::string_view name) {
+  if (!is_recording_) {
+    return;
+  }
+
+  QueryFrame& frame    = frames_[current_frame_];
+  const GLuint query   = next_query(frame);
+  const size_t index   = frame.used - 1;
+  const size_t section = section_index(name, ProfileTrack::GPU);
+  glQueryCounter(query, GL_TIMESTAMP);
+  open_queries_.push_back({.section = section, .begin_query = index, .end_query = index});
+}
+
+void FrameProfiler::end_gpu() {
+  if (!is_recording_ || open_queries_.empty()) {
+    return;
+  }
+
+  QueryFrame& frame  = frames_[current_frame_];
+  const GLuint query = next_query(frame);
+  glQueryCounter(query, GL_TIMESTAMP);
+
+  PendingQuery pending = open_queries_.back();
+  open_queries_.pop_back();
+  pending.end_query = frame.used - 1;
+  frame.pending.push_back(pending);
+}
+
+void FrameProfiler::record_cpu(std::string_view name, std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end) {
+  if (!is_enabled) {
+    return;
+  }
+
+  const auto start_ns    = std::chrono::duration_cast<std::chrono::nanoseconds>(start - cpu_origin_).count();
+  const auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  add_event(section_index(name, ProfileTrack::CPU), static_cast<uint64_t>(std::max<int64_t>(start_ns, 0)),
+            static_cast<uint64_t>(std::max<int64_t>(duration_ns, 0)));
+}
+
+void FrameProfiler::clear() {
+  for (auto& section : sections_) {
+    section.milliseconds = RollingStats(section.milliseconds.capacity());
+  }
+  events_.clear();
+  dropped_frames_ = 0;
+}
+
+bool FrameProfiler::export_chrome_trace(const std::filesystem::path& path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    Logger::warn("Could not save the trace to path {}", path.string());
+    return false;
+  }
+
+  const std::vector<ProfileEvent> events(events_.begin(), events_.end());
+  write_chrome_trace(file, events);
+  if (!file) {
+    Logger::warn("Could not write the trace {}", path.string());
+    return false;
+  }
+
+  Logger::info("Saved {} profiled sections to {}", events.size(), path.string());
+  return true;
+}
+
+size_t FrameProfiler::section_index(std::string_view name, ProfileTrack track) {
+  // There are only a handful of sections, a linear search beats hashing the name
+  for (size_t i = 0; i < sections_.size(); ++i) {
+    if (sections_[i].track == track && sections_[i].name == name) {
+      return i;
+    }
+  }
+  sections_.push_back({.name = std::string(name), .track = track, .milliseconds = RollingStats()});
+  return sections_.size() - 1;
+}
+
+GLuint FrameProfiler::next_query(QueryFrame& frame) {
+  if (frame.used == frame.queries.size()) {
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    frame.queries.push_back(query);
+  }
+  return frame.queries[frame.used++];
+}
+
+void FrameProfiler::resolve(QueryFrame& frame) {
+  if (!frame.pending.empty()) {
+    // The queries complete in order, so the last one issued tells if the whole frame is available
+    GLint is_available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &is_available);
+
+    if (is_available == GL_TRUE) {
+      for (const auto& pending : frame.pending) {
+        GLuint64 begin = 0;
+        GLuint64 end   = 0;
+        glGetQueryObjectui64v(frame.queries[pending.begin_query], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[pending.end_query], GL_QUERY_RESULT, &end);
+
+        const auto origin = static_cast<GLuint64>(gpu_origin_);
+        add_event(pending.section, begin > origin ? begin - origin : 0, end > begin ? end - begin : 0);
+      }
+    } else {
+      ++dropped_frames_;
+    }
+  }
+
+  frame.used = 0;
+  frame.pending.clear();
+}
+
+void FrameProfiler::add_event(size_t section, uint64_t start_ns, uint64_t duration_ns) {
+  Section& entry = sections_[section];
+  entry.milliseconds.add(static_cast<double>(duration_ns) / kNanosecondsPerMillisecond);
+
+  if (events_.size() == kMaxEvents) {
+    events_.pop_front();
+  }
+  events_.push_back({.name = entry.name, .track = entry.track, .start_ns = start_ns, .duration_ns = duration_ns});
+}
+
+}  // namespace resin
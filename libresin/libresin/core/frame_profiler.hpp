@@ -0,0 +1,173 @@
+#ifndef RESIN_FRAME_PROFILER_HPP
+#define RESIN_FRAME_PROFILER_HPP
+
+#include <glad/gl.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <libresin/utils/enum_mapper.hpp>
+#include <libresin/utils/macros.hpp>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace resin {
+
+enum class ProfileTrack : uint8_t {
+  CPU    = 0,
+  GPU    = 1,
+  _Count = 2,  // NOLINT
+};
+
+constexpr StringEnumMapper<ProfileTrack> kProfileTrackNames({
+    {ProfileTrack::CPU, "CPU"},  //
+    {ProfileTrack::GPU, "GPU"}   //
+});
+
+// Single timed section. The times are in nanoseconds since the creation of the profiler, the GPU timestamps are
+// shifted to the same origin.
+struct ProfileEvent {
+  std::string name;
+  ProfileTrack track;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+};
+
+// Average, min and max of the last `capacity` samples.
+class RollingStats {
+ public:
+  explicit RollingStats(size_t capacity = kDefaultCapacity);
+
+  void add(double sample);
+
+  inline size_t count() const { return samples_.size(); }
+  inline size_t capacity() const { return capacity_; }
+  inline double last() const { return last_; }
+  double average() const;
+  double min() const;
+  double max() const;
+
+  static constexpr size_t kDefaultCapacity = 120;
+
+ private:
+  std::vector<double> samples_;
+  size_t capacity_;
+  size_t next_;
+  double last_;
+};
+
+// Writes the events in the Chrome trace event format, which chrome://tracing and Perfetto open. Every track is a
+// separate thread of a single process.
+void write_chrome_trace(std::ostream& output, std::span<const ProfileEvent> events);
+
+// Times the sections of a frame on the GPU with timestamp queries and on the CPU with a steady clock. The GPU queries
+// of a frame are read kQueryFrames - 1 frames later, when the GPU is normally done with them, so reading them never
+// stalls the pipeline. The queries still pending at that point are dropped instead of waited for.
+class FrameProfiler {
+ public:
+  struct Section {
+    std::string name;
+    ProfileTrack track;
+    RollingStats milliseconds;
+  };
+
+  // Must be called on the thread owning the GL context.
+  FrameProfiler();
+  ~FrameProfiler();
+
+  DISABLE_COPY_AND_MOVE(FrameProfiler)
+
+  // Collects the queries of the oldest frame in flight and starts recording a new frame. Changes of is_enabled take
+  // effect here, so a frame is always recorded whole.
+  void begin_frame();
+
+  // GPU sections may nest, every begin_gpu must be matched by end_gpu within the same frame.
+  void begin_gpu(std::string_view name);
+  void end_gpu();
+
+  void record_cpu(std::string_view name, std::chrono::steady_clock::time_point start,
+                  std::chrono::steady_clock::time_point end);
+
+  // Sections in the order they were first recorded.
+  inline std::span<const Section> sections() const { return sections_; }
+  inline const std::deque<ProfileEvent>& events() const { return events_; }
+  inline size_t dropped_frames() const { return dropped_frames_; }
+
+  void clear();
+
+  // Returns false if the file could not be written.
+  bool export_chrome_trace(const std::filesystem::path& path) const;
+
+  static constexpr size_t kQueryFrames = 3;
+  static constexpr size_t kMaxEvents   = 65536;  // ~1 minute of the instrumented sections at 60 FPS
+
+ public:
+  bool is_enabled = true;
+
+ private:
+  struct PendingQuery {
+    size_t section;
+    size_t begin_query;  // indices into QueryFrame::queries
+    size_t end_query;
+  };
+
+  struct QueryFrame {
+    std::vector<GLuint> queries;  // grows to the most queries a frame has used
+    size_t used = 0;
+    std::vector<PendingQuery> pending;
+  };
+
+  size_t section_index(std::string_view name, ProfileTrack track);
+  GLuint next_query(QueryFrame& frame);
+  void resolve(QueryFrame& frame);
+  void add_event(size_t section, uint64_t start_ns, uint64_t duration_ns);
+
+  std::array<QueryFrame, kQueryFrames> frames_;
+  size_t current_frame_;
+  std::vector<PendingQuery> open_queries_;
+  bool is_recording_;
+
+  std::vector<Section> sections_;
+  std::deque<ProfileEvent> events_;
+  size_t dropped_frames_;
+
+  std::chrono::steady_clock::time_point cpu_origin_;
+  GLint64 gpu_origin_;
+};
+
+// Times the enclosing scope on the GPU.
+class GPUProfileScope {
+ public:
+  GPUProfileScope(FrameProfiler& profiler, std::string_view name) : profiler_(profiler) { profiler_.begin_gpu(name); }
+  ~GPUProfileScope() { profiler_.end_gpu(); }
+
+  DISABLE_COPY_AND_MOVE(GPUProfileScope)
+
+ private:
+  FrameProfiler& profiler_;
+};
+
+// Times the enclosing scope on the CPU. The name is kept until the scope ends, so it must outlive the scope.
+class CPUProfileScope {
+ public:
+  CPUProfileScope(FrameProfiler& profiler, std::string_view name)
+      : profiler_(profiler), name_(name), start_(std::chrono::steady_clock::now()) {}
+  ~CPUProfileScope() { profiler_.record_cpu(name_, start_, std::chrono::steady_clock::now()); }
+
+  DISABLE_COPY_AND_MOVE(CPUProfileScope)
+
+ private:
+  FrameProfiler& profiler_;
+  std::string_view name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_FRAME_PROFILER_HPP
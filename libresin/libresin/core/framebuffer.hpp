@@ -4,6 +4,7 @@
 #include <glad/gl.h>
 
 #include <cstddef>
+#include <optional>
 
 namespace resin {
 
@@ -48,16 +49,28 @@ class ViewportFramebuffer : public Framebuffer {
   void begin_pick_render() const;
   void end_pick_render() const;
 
+  // Reads the pick attachment synchronously, which stalls until the GPU is done with the frame. The framebuffer must be
+  // bound.
   int sample_mouse_pick(size_t x, size_t y) const;
 
+  // Schedules a fenced copy of the pick attachment pixel into a pixel pack buffer, replacing the pending request. The
+  // framebuffer must be bound.
+  void request_mouse_pick(size_t x, size_t y);
+
+  // Result of the pending request once the copy is done (usually a frame or two later), never blocks.
+  std::optional<int> poll_mouse_pick();
+
   void clear() override;
   void resize(size_t width, size_t height) override;
 
   inline GLuint color_texture() const { return color_attachment_texture_; }
+  inline GLuint mouse_pick_texture() const { return mouse_pick_attachment_texture_; }
 
  private:
   GLuint color_attachment_texture_, mouse_pick_attachment_texture_;
   GLuint depth_renderbuffer_;
+  GLuint mouse_pick_pixel_buffer_;
+  GLsync mouse_pick_fence_;
 };
 
 class ImageFramebuffer : public Framebuffer {
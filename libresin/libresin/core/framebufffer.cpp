@@ -50,7 +50,9 @@ ViewportFramebuffer::ViewportFramebuffer(size_t width, size_t height)
     : Framebuffer(width, height),
       color_attachment_texture_(0),
       mouse_pick_attachment_texture_(0),
-      depth_renderbuffer_(0) {
+      depth_renderbuffer_(0),
+      mouse_pick_pixel_buffer_(0),
+      mouse_pick_fence_(nullptr) {
   start_init();
 
   // Setup color attachment
@@ -74,6 +76,12 @@ ViewportFramebuffer::ViewportFramebuffer(size_t width, size_t height)
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, mouse_pick_attachment_texture_, 0);
 
+  // Setup mouse pick readback
+  glGenBuffers(1, &mouse_pick_pixel_buffer_);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, mouse_pick_pixel_buffer_);
+  glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(int), nullptr, GL_STREAM_READ);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
   end_init();
 
   resin::Logger::info("Created new image framebuffer with id {}", color_attachment_texture_);
@@ -87,6 +95,10 @@ ViewportFramebuffer::~ViewportFramebuffer() {
   glDeleteRenderbuffers(1, &depth_renderbuffer_);
   glDeleteTextures(1, &color_attachment_texture_);
   glDeleteTextures(1, &mouse_pick_attachment_texture_);
+  glDeleteBuffers(1, &mouse_pick_pixel_buffer_);
+  if (mouse_pick_fence_ != nullptr) {
+    glDeleteSync(mouse_pick_fence_);
+  }
 
   resin::Logger::info("Deleted image framebuffer with id {}", framebuffer_id_);
 }
@@ -95,10 +107,14 @@ ViewportFramebuffer::ViewportFramebuffer(ViewportFramebuffer&& other) noexcept
     : Framebuffer(std::move(other)),
       color_attachment_texture_(other.color_attachment_texture_),
       mouse_pick_attachment_texture_(other.mouse_pick_attachment_texture_),
-      depth_renderbuffer_(other.depth_renderbuffer_) {
+      depth_renderbuffer_(other.depth_renderbuffer_),
+      mouse_pick_pixel_buffer_(other.mouse_pick_pixel_buffer_),
+      mouse_pick_fence_(other.mouse_pick_fence_) {
   other.color_attachment_texture_      = 0;
   other.mouse_pick_attachment_texture_ = 0;
   other.depth_renderbuffer_            = 0;
+  other.mouse_pick_pixel_buffer_       = 0;
+  other.mouse_pick_fence_              = nullptr;
 }
 
 void ViewportFramebuffer::begin_pick_render() const {
@@ -141,6 +157,44 @@ int ViewportFramebuffer::sample_mouse_pick(const size_t x, const size_t y) const
   return pixel;
 }
 
+void ViewportFramebuffer::request_mouse_pick(const size_t x, const size_t y) {
+  if (mouse_pick_fence_ != nullptr) {
+    glDeleteSync(mouse_pick_fence_);
+  }
+
+  // With a pack buffer bound glReadPixels only enqueues the copy and returns right away
+  glReadBuffer(GL_COLOR_ATTACHMENT1);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, mouse_pick_pixel_buffer_);
+  glReadPixels(static_cast<GLint>(x), static_cast<GLint>(height_ - y), 1, 1, GL_RED_INTEGER, GL_INT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  // Flush so the fence signals without anybody waiting on it with GL_SYNC_FLUSH_COMMANDS_BIT
+  mouse_pick_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+}
+
+std::optional<int> ViewportFramebuffer::poll_mouse_pick() {
+  if (mouse_pick_fence_ == nullptr) {
+    return std::nullopt;
+  }
+  const GLenum status = glClientWaitSync(mouse_pick_fence_, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    return std::nullopt;
+  }
+  glDeleteSync(mouse_pick_fence_);
+  mouse_pick_fence_ = nullptr;
+  if (status == GL_WAIT_FAILED) {
+    resin::Logger::err("Failed to wait for the mouse pick readback");
+    return std::nullopt;
+  }
+
+  int pixel = -1;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, mouse_pick_pixel_buffer_);
+  glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(int), &pixel);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return pixel;
+}
+
 ImageFramebuffer::ImageFramebuffer(size_t width, size_t height)
     : Framebuffer(width, height), color_attachment_texture_(0) {
   start_init();
@@ -7,10 +7,13 @@
 #include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/logger.hpp>
 #include <limits>
+#include <mutex>
 #include <stack>
 
 namespace resin {
 
+// The ids may be registered and unregistered from several threads, e.g. while the subtrees of a scene are built
+// concurrently.
 template <typename Obj>
 class IdRegistry {
  public:
@@ -29,6 +32,7 @@ class IdRegistry {
   }
 
   size_t register_id() {
+    const std::lock_guard lock(mutex_);
     if (freed_.empty()) {
       log_throw(ObjectsOverflowException());
     }
@@ -45,17 +49,24 @@ class IdRegistry {
       return false;
     }
 
+    const std::lock_guard lock(mutex_);
     return is_registered_[id];
   }
 
   size_t get_max_objs() const { return max_objs_; }
 
+  size_t get_free_objs() const {
+    const std::lock_guard lock(mutex_);
+    return freed_.size();
+  }
+
   void unregister_id(size_t id) {
     if (id >= max_objs_) {
       Logger::warn("Detected an attempt to unregister a non-existent id [{}].", id);
       return;
     }
 
+    const std::lock_guard lock(mutex_);
     is_registered_[id] = false;
     freed_.push(id);
   }
@@ -70,6 +81,7 @@ class IdRegistry {
   std::stack<size_t> freed_;
   std::vector<bool> is_registered_;
   size_t max_objs_;
+  mutable std::mutex mutex_;
 };
 
 // Strongly typed id, with similar behavior to unique_ptr -- it unregisters from the provided registry when destructor
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdint>
+#include <libresin/core/indexed_mesh.hpp>
+#include <libresin/utils/logger.hpp>
+#include <numeric>
+#include <unordered_map>
+
+namespace resin {
+
+IndexedMesh weld_triangle_soup(std::span<const glm::vec4> vertices, std::span<const glm::vec4> normals,
+                               std::span<const glm::vec2> uvs, std::span<const uint32_t> keys,
+                               std::span<const uint32_t> triangle_materials) {
+  IndexedMesh mesh;
+  if (vertices.size() != keys.size() || vertices.size() != normals.size() || vertices.size() != uvs.size() ||
+      (!triangle_materials.empty() && triangle_materials.size() != vertices.size() / 3)) {
+    Logger::err("Cannot weld triangle soup: buffer sizes do not match");
+    return mesh;
+  }
+
+  // Every grid edge is shared by up to 4 cells, so on a closed surface there is roughly 6x less unique vertices
+  // than soup vertices.
+  const size_t expected_unique = vertices.size() / 6 + 1;
+  mesh.vertices.reserve(expected_unique);
+  mesh.normals.reserve(expected_unique);
+  mesh.uvs.reserve(expected_unique);
+  mesh.indices.reserve(vertices.size());
+  mesh.materials.reserve(triangle_materials.size());
+
+  std::unordered_map<uint32_t, uint32_t> key_to_index;
+  key_to_index.reserve(expected_unique);
+
+  auto index_of = [&](size_t soup_idx) {
+    auto [it, inserted] = key_to_index.try_emplace(keys[soup_idx], static_cast<uint32_t>(mesh.vertices.size()));
+    if (inserted) {
+      mesh.vertices.emplace_back(vertices[soup_idx]);
+      mesh.normals.emplace_back(normals[soup_idx]);
+      mesh.uvs.emplace_back(uvs[soup_idx]);
+    }
+    return it->second;
+  };
+
+  for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+    const uint32_t a = index_of(i + 1);
+    const uint32_t b = index_of(i);
+    const uint32_t c = index_of(i + 2);
+    if (a == b || b == c || a == c) {
+      continue;
+    }
+    mesh.indices.insert(mesh.indices.end(), {a, b, c});
+    if (!triangle_materials.empty()) {
+      mesh.materials.push_back(triangle_materials[i / 3]);
+    }
+  }
+
+  return mesh;
+}
+
+std::vector<MaterialRange> sort_triangles_by_material(const IndexedMesh& mesh, std::vector<uint32_t>& sorted) {
+  sorted.resize(mesh.triangle_count());
+  if (mesh.materials.empty()) {
+    std::iota(sorted.begin(), sorted.end(), 0U);
+    return {MaterialRange{.material = 0, .first = 0, .count = sorted.size()}};
+  }
+
+  const uint32_t max_material = *std::ranges::max_element(mesh.materials);
+  std::vector<size_t> offsets(static_cast<size_t>(max_material) + 2, 0);
+  for (const uint32_t material : mesh.materials) {
+    ++offsets[material + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (size_t t = 0; t < mesh.triangle_count(); ++t) {
+    sorted[cursor[mesh.materials[t]]++] = static_cast<uint32_t>(t);
+  }
+
+  std::vector<MaterialRange> ranges;
+  for (uint32_t material = 0; material <= max_material; ++material) {
+    if (offsets[material] != offsets[material + 1]) {
+      ranges.push_back(MaterialRange{
+          .material = material, .first = offsets[material], .count = offsets[material + 1] - offsets[material]});
+    }
+  }
+  return ranges;
+}
+
+std::vector<MaterialSubmesh> split_by_material(const IndexedMesh& mesh) {
+  if (mesh.materials.empty()) {
+    return {MaterialSubmesh{.material = 0, .mesh = mesh}};
+  }
+
+  std::vector<uint32_t> sorted;
+  const std::vector<MaterialRange> ranges = sort_triangles_by_material(mesh, sorted);
+
+  // Every range compacts the vertices it references, the remap entries are reset after each range
+  std::vector<MaterialSubmesh> submeshes;
+  submeshes.reserve(ranges.size());
+  std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+  for (const auto& range : ranges) {
+    const auto triangles = std::span(sorted).subspan(range.first, range.count);
+
+    IndexedMesh& submesh = submeshes.emplace_back(MaterialSubmesh{.material = range.material}).mesh;
+    submesh.indices.reserve(range.count * 3);
+    for (const uint32_t t : triangles) {
+      for (size_t corner = 0; corner < 3; ++corner) {
+        const uint32_t v = mesh.indices[(3 * static_cast<size_t>(t)) + corner];
+        if (remap[v] == UINT32_MAX) {
+          remap[v] = static_cast<uint32_t>(submesh.vertices.size());
+          submesh.vertices.push_back(mesh.vertices[v]);
+          submesh.normals.push_back(mesh.normals[v]);
+          submesh.uvs.push_back(mesh.uvs[v]);
+        }
+        submesh.indices.push_back(remap[v]);
+      }
+    }
+    for (const uint32_t t : triangles) {
+      for (size_t corner = 0; corner < 3; ++corner) {
+        remap[mesh.indices[(3 * static_cast<size_t>(t)) + corner]] = UINT32_MAX;
+      }
+    }
+  }
+
+  return submeshes;
+}
+
+}  // namespace resin
@@ -0,0 +1,57 @@
+#ifndef RESIN_INDEXED_MESH_HPP
+#define RESIN_INDEXED_MESH_HPP
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+struct IndexedMesh {
+  std::vector<glm::vec3> vertices;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec2> uvs;
+  std::vector<uint32_t> indices;    // triangle list, counterclockwise winding
+  std::vector<uint32_t> materials;  // material id of every triangle, empty if the mesh has a single material
+
+  inline size_t triangle_count() const { return indices.size() / 3; }
+  inline bool empty() const { return indices.empty(); }
+  inline uint32_t triangle_material(size_t triangle) const { return materials.empty() ? 0 : materials[triangle]; }
+};
+
+struct MaterialSubmesh {
+  uint32_t material;
+  IndexedMesh mesh;
+};
+
+struct MaterialRange {
+  uint32_t material;
+  size_t first;  // position of the first triangle in the sorted order
+  size_t count;
+};
+
+// Builds an indexed mesh out of a marching cubes triangle soup. Soup vertices that share the same key (the id of the
+// grid edge they were interpolated on) are merged into a single vertex. Triangles that collapse after welding are
+// dropped. The soup is expected to be emitted in the clockwise order produced by the compute shader, the output uses
+// counterclockwise winding. The optional triangle materials hold one material id per soup triangle.
+// Cost: O(n) expected, where n is the soup vertex count
+IndexedMesh weld_triangle_soup(std::span<const glm::vec4> vertices, std::span<const glm::vec4> normals,
+                               std::span<const glm::vec2> uvs, std::span<const uint32_t> keys,
+                               std::span<const uint32_t> triangle_materials = {});
+
+// Stable counting sort of the triangles by their material. Fills the sorted triangle indices and returns the range of
+// every material that has triangles, ordered by the material id. A mesh without materials is a single range.
+// Cost: O(n + m), where n is the triangle count and m is the largest material id
+std::vector<MaterialRange> sort_triangles_by_material(const IndexedMesh& mesh, std::vector<uint32_t>& sorted);
+
+// Splits the mesh into one submesh per material using sort_triangles_by_material. Vertices shared by triangles of
+// different materials are duplicated.
+// Cost: O(n + m), where n is the triangle count and m is the largest material id
+std::vector<MaterialSubmesh> split_by_material(const IndexedMesh& mesh);
+
+}  // namespace resin
+
+#endif  // RESIN_INDEXED_MESH_HPP
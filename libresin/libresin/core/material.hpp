@@ -47,7 +47,11 @@ class MaterialSDFTreeComponent {
   inline bool operator!=(const MaterialSDFTreeComponent& other) const { return material_id() != other.material_id(); }
 
   inline IdView<MaterialId> material_id() const { return mat_id_; }
-  inline void rename(std::string&& new_name) { name_ = std::move(new_name); }
+  // Marks the material dirty, so that the editor notices the change, e.g. to commit it to the history
+  inline void rename(std::string&& new_name) {
+    name_ = std::move(new_name);
+    mark_dirty();
+  }
   inline std::string_view name() const { return name_; }
 
   void mark_dirty();
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <libresin/core/material_preview_cache.hpp>
+#include <libresin/utils/logger.hpp>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+constexpr std::string_view kPreviewExtension = ".rmpv";
+
+constexpr std::array<char, 4> kPreviewMagic = {'R', 'M', 'P', 'V'};
+constexpr size_t kPreviewHeaderSize         = kPreviewMagic.size() + sizeof(uint32_t);
+constexpr size_t kMaxPacketPixels           = 128;
+constexpr size_t kMaxRunPixels              = 129;
+constexpr uint8_t kRunControl               = 128;
+
+constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFNVPrime       = 1099511628211ULL;
+
+template <typename T>
+void hash_value(uint64_t& hash, const T& value) {
+  std::array<uint8_t, sizeof(T)> bytes{};
+  std::memcpy(bytes.data(), &value, sizeof(T));
+  for (const uint8_t byte : bytes) {
+    hash = (hash ^ byte) * kFNVPrime;
+  }
+}
+
+void append_pixel(std::vector<uint8_t>& data, uint32_t pixel) {
+  const size_t offset = data.size();
+  data.resize(offset + sizeof(uint32_t));
+  std::memcpy(data.data() + offset, &pixel, sizeof(uint32_t));
+}
+
+}  // namespace
+
+std::vector<uint8_t> encode_material_preview(std::span<const uint32_t> pixels) {
+  std::vector<uint8_t> data;
+  data.reserve(pixels.size());
+
+  size_t i = 0;
+  while (i < pixels.size()) {
+    size_t run = 1;
+    while (i + run < pixels.size() && run < kMaxRunPixels && pixels[i + run] == pixels[i]) {
+      ++run;
+    }
+
+    if (run > 1) {
+      data.push_back(static_cast<uint8_t>(kRunControl + run - 2));
+      append_pixel(data, pixels[i]);
+      i += run;
+      continue;
+    }
+
+    // Literals last until the next run of at least 2 pixels
+    const size_t control_offset = data.size();
+    data.push_back(0);
+    size_t count = 0;
+    while (i < pixels.size() && count < kMaxPacketPixels) {
+      if (count > 0 && i + 1 < pixels.size() && pixels[i] == pixels[i + 1]) {
+        break;
+      }
+      append_pixel(data, pixels[i]);
+      ++i;
+      ++count;
+    }
+    data[control_offset] = static_cast<uint8_t>(count - 1);
+  }
+
+  return data;
+}
+
+std::optional<MaterialPreviewPixels> decode_material_preview(std::span<const uint8_t> data, size_t pixel_count) {
+  MaterialPreviewPixels pixels;
+  pixels.reserve(pixel_count);
+
+  size_t offset = 0;
+  while (offset < data.size()) {
+    const uint8_t control = data[offset++];
+    const bool is_run     = control >= kRunControl;
+    const size_t count    = is_run ? size_t{control} - kRunControl + 2 : size_t{control} + 1;
+    const size_t stored   = is_run ? 1 : count;
+
+    if (offset + (stored * sizeof(uint32_t)) > data.size() || pixels.size() + count > pixel_count) {
+      return std::nullopt;
+    }
+
+    for (size_t i = 0; i < stored; ++i) {
+      uint32_t pixel = 0;
+      std::memcpy(&pixel, data.data() + offset, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+      pixels.insert(pixels.end(), is_run ? count : 1, pixel);
+    }
+  }
+
+  if (pixels.size() != pixel_count) {
+    return std::nullopt;
+  }
+  return pixels;
+}
+
+MaterialPreviewCache::MaterialPreviewCache(std::filesystem::path directory, size_t preview_size, size_t max_previews)
+    : directory_(std::move(directory)), preview_size_(preview_size), max_previews_(max_previews) {}
+
+MaterialPreviewCache::~MaterialPreviewCache() {
+  // Both futures come from std::async, so they would wait in their destructors anyway. Waiting explicitly keeps the
+  // writes from being lost when the editor closes.
+  if (pending_store_.valid()) {
+    pending_store_.wait();
+  }
+  if (pending_load_.valid()) {
+    pending_load_.wait();
+  }
+}
+
+uint64_t MaterialPreviewCache::key(const Material& material) const {
+  uint64_t hash = kFNVOffsetBasis;
+  hash_value(hash, kVersion);
+  hash_value(hash, static_cast<uint64_t>(preview_size_));
+  hash_value(hash, material.albedo.x);
+  hash_value(hash, material.albedo.y);
+  hash_value(hash, material.albedo.z);
+  hash_value(hash, material.ambientFactor);
+  hash_value(hash, material.diffuseFactor);
+  hash_value(hash, material.specularFactor);
+  hash_value(hash, material.specularExponent);
+  return hash;
+}
+
+std::filesystem::path MaterialPreviewCache::preview_path(uint64_t key) const {
+  return directory_ / std::format("{:016x}{}", key, kPreviewExtension);
+}
+
+std::optional<MaterialPreviewPixels> MaterialPreviewCache::load(uint64_t key) const {
+  std::ifstream file(preview_path(key), std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+
+  const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (data.size() < kPreviewHeaderSize || std::memcmp(data.data(), kPreviewMagic.data(), kPreviewMagic.size()) != 0) {
+    Logger::warn("Ignoring corrupted material preview {}", preview_path(key).string());
+    return std::nullopt;
+  }
+
+  uint32_t pixel_count = 0;
+  std::memcpy(&pixel_count, data.data() + kPreviewMagic.size(), sizeof(uint32_t));
+  if (pixel_count != preview_size_ * preview_size_) {
+    return std::nullopt;
+  }
+
+  auto pixels = decode_material_preview(std::span<const uint8_t>(data).subspan(kPreviewHeaderSize), pixel_count);
+  if (!pixels) {
+    Logger::warn("Ignoring corrupted material preview {}", preview_path(key).string());
+    return pixels;
+  }
+
+  // Marks the preview as recently used, so it is evicted last
+  std::error_code ec;
+  std::filesystem::last_write_time(preview_path(key), std::filesystem::file_time_type::clock::now(), ec);
+  return pixels;
+}
+
+void MaterialPreviewCache::evict() const {
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> previews;
+  std::error_code ec;
+  for (std::filesystem::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() != std::filesystem::path(kPreviewExtension)) {
+      continue;
+    }
+    std::error_code time_ec;
+    const auto time = it->last_write_time(time_ec);
+    if (!time_ec) {
+      previews.emplace_back(time, it->path());
+    }
+  }
+  if (previews.size() <= max_previews_) {
+    return;
+  }
+
+  const auto oldest_end = previews.begin() + static_cast<std::ptrdiff_t>(previews.size() - max_previews_);
+  std::ranges::nth_element(previews, oldest_end, {}, [](const auto& preview) { return preview.first; });
+  for (auto it = previews.begin(); it != oldest_end; ++it) {
+    std::filesystem::remove(it->second, ec);
+  }
+  Logger::debug("Evicted {} material previews from {}", oldest_end - previews.begin(), directory_.string());
+}
+
+void MaterialPreviewCache::store(uint64_t key, std::span<const uint32_t> pixels) const {
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    Logger::warn("Could not create the material preview cache directory {}: {}", directory_.string(), ec.message());
+    return;
+  }
+
+  const std::vector<uint8_t> data = encode_material_preview(pixels);
+  const auto pixel_count          = static_cast<uint32_t>(pixels.size());
+
+  // Written to a temporary file first, so a preview is never read half written
+  const std::filesystem::path path     = preview_path(key);
+  const std::filesystem::path tmp_path = std::filesystem::path(path).concat(".tmp");
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write(kPreviewMagic.data(), kPreviewMagic.size());
+    file.write(reinterpret_cast<const char*>(&pixel_count), sizeof(uint32_t));  // NOLINT
+    file.write(reinterpret_cast<const char*>(data.data()), std::ssize(data));   // NOLINT
+    if (!file) {
+      Logger::warn("Could not write the material preview {}", tmp_path.string());
+      return;
+    }
+  }
+
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    Logger::warn("Could not write the material preview {}: {}", path.string(), ec.message());
+    std::filesystem::remove(tmp_path, ec);
+  }
+}
+
+void MaterialPreviewCache::load_async(std::vector<uint64_t> keys) {
+  pending_load_ = std::async(std::launch::async, [this, keys = std::move(keys)]() {
+    std::unordered_map<uint64_t, MaterialPreviewPixels> previews;
+    for (const uint64_t key : keys) {
+      if (previews.contains(key)) {
+        continue;
+      }
+      if (auto pixels = load(key)) {
+        previews.emplace(key, std::move(*pixels));
+      }
+    }
+    return previews;
+  });
+}
+
+void MaterialPreviewCache::store_async(std::vector<std::pair<uint64_t, MaterialPreviewPixels>> previews) {
+  if (previews.empty()) {
+    return;
+  }
+
+  if (pending_store_.valid()) {
+    pending_store_.wait();
+  }
+  pending_store_ = std::async(std::launch::async, [this, previews = std::move(previews)]() {
+    for (const auto& [key, pixels] : previews) {
+      store(key, pixels);
+    }
+    evict();
+  });
+}
+
+std::optional<std::unordered_map<uint64_t, MaterialPreviewPixels>> MaterialPreviewCache::poll_loaded() {
+  if (!pending_load_.valid() || pending_load_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return std::nullopt;
+  }
+  return pending_load_.get();
+}
+
+}  // namespace resin
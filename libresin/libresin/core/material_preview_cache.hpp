@@ -0,0 +1,82 @@
+#ifndef RESIN_MATERIAL_PREVIEW_CACHE_HPP
+#define RESIN_MATERIAL_PREVIEW_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <libresin/core/material.hpp>
+#include <libresin/utils/macros.hpp>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+// Pixels of a square preview, RGBA8 packed into a single value each.
+using MaterialPreviewPixels = std::vector<uint32_t>;
+
+// Run-length encoding of the preview pixels. The previews are mostly the uniform background, so the runs shrink them
+// well while the sphere pixels are stored as literals. A packet starts with a control byte: c < 128 is followed by
+// c + 1 literal pixels, c >= 128 by a single pixel repeated c - 126 times.
+std::vector<uint8_t> encode_material_preview(std::span<const uint32_t> pixels);
+
+// Returns nothing if the data is corrupted or does not decode to exactly `pixel_count` pixels.
+std::optional<MaterialPreviewPixels> decode_material_preview(std::span<const uint8_t> data, size_t pixel_count);
+
+// Previews of the materials kept on disk between the sessions, so opening a scene does not raymarch the previews of the
+// materials that were already shown before. Every preview is a file named after its key, which hashes the material
+// and the preview parameters. The modification time of a file is bumped whenever it is read, so past `max_previews`
+// the least recently used previews are removed.
+class MaterialPreviewCache {
+ public:
+  MaterialPreviewCache(std::filesystem::path directory, size_t preview_size, size_t max_previews = kDefaultMaxPreviews);
+  ~MaterialPreviewCache();
+
+  DISABLE_COPY_AND_MOVE(MaterialPreviewCache)
+
+  uint64_t key(const Material& material) const;
+
+  std::optional<MaterialPreviewPixels> load(uint64_t key) const;
+  void store(uint64_t key, std::span<const uint32_t> pixels) const;
+
+  // Reads the previews of `keys` on a worker thread. Missing previews are skipped.
+  void load_async(std::vector<uint64_t> keys);
+
+  // Removes the least recently used previews past `max_previews`.
+  void evict() const;
+
+  // Writes the previews on a worker thread and evicts the old ones. Waits for the previous writes first.
+  void store_async(std::vector<std::pair<uint64_t, MaterialPreviewPixels>> previews);
+
+  inline bool is_loading() const { return pending_load_.valid(); }
+
+  // Previews read by the last load_async once it is done, never blocks.
+  std::optional<std::unordered_map<uint64_t, MaterialPreviewPixels>> poll_loaded();
+
+  inline size_t preview_size() const { return preview_size_; }
+  inline size_t max_previews() const { return max_previews_; }
+  inline const std::filesystem::path& directory() const { return directory_; }
+
+  // Bump when the preview shader changes, so the previews rendered by the old shader are not used.
+  static constexpr uint32_t kVersion = 1;
+
+  // A preview takes a few kilobytes, so the default cap keeps the cache within a few megabytes.
+  static constexpr size_t kDefaultMaxPreviews = 1024;
+
+ private:
+  std::filesystem::path preview_path(uint64_t key) const;
+
+  std::filesystem::path directory_;
+  size_t preview_size_;
+  size_t max_previews_;
+
+  std::future<std::unordered_map<uint64_t, MaterialPreviewPixels>> pending_load_;
+  std::future<void> pending_store_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_MATERIAL_PREVIEW_CACHE_HPP
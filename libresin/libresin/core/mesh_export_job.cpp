@@ -0,0 +1,208 @@
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <libresin/core/mesh_export_job.hpp>
+#include <libresin/utils/logger.hpp>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+// Share of the overall progress of every stage that reports progress. Sampling (GPU) and Meshing (CPU) are
+// alternatives, so they cover the same range.
+constexpr std::array<std::pair<float, float>, 4> kStageProgressRanges = {{
+    {0.0F, 0.4F},  // Sampling
+    {0.0F, 0.4F},  // Meshing
+    {0.4F, 0.9F},  // Building
+    {0.9F, 1.0F},  // Writing
+}};
+
+}  // namespace
+
+MeshExportJob::MeshExportJob(std::unique_ptr<MeshExporter> exporter, const glm::vec3& bb_start,
+                             const glm::vec3& bb_end, SDFTree& sdf_tree, IdView<SDFTreeNodeId> node_id,
+                             std::filesystem::path output_path, std::string format)
+    : exporter_(std::move(exporter)), output_path_(std::move(output_path)), format_(std::move(format)) {
+  exporter_->bb_start_ = bb_start;
+  exporter_->bb_end_   = bb_end;
+  exporter_->snapshot_materials(sdf_tree);
+
+  if (exporter_->backend_ == MeshExportBackend::CPU) {
+    exporter_->compile_evaluator(sdf_tree, node_id);
+    start_worker(true);
+    return;
+  }
+
+  exporter_->dispatch_classification(sdf_tree, node_id);
+  dispatch_readback_.request(exporter_->dispatch_buffer_->id(), sizeof(GLuint) * 3);
+  readback_step_ = ReadbackStep::DispatchSize;
+}
+
+MeshExportJob::~MeshExportJob() { cancel(); }
+
+void MeshExportJob::cancel() { stop_source_.request_stop(); }
+
+void MeshExportJob::update() {
+  if (readback_step_ == ReadbackStep::Finished) {
+    return;
+  }
+
+  if (stop_source_.stop_requested()) {
+    exporter_->release_gpu_buffers();
+    readback_step_ = ReadbackStep::Finished;
+    set_stage(MeshExportStage::Cancelled);
+    Logger::info("Cancelled mesh export '{}'", output_path_.string());
+    return;
+  }
+
+  switch (readback_step_) {
+    case ReadbackStep::DispatchSize:
+      if (dispatch_readback_.is_ready()) {
+        read_dispatch_size();
+      }
+      break;
+    case ReadbackStep::Count:
+      if (count_readback_.is_ready()) {
+        read_count();
+      }
+      break;
+    case ReadbackStep::Data:
+      if (std::ranges::all_of(data_readbacks_, [](const BufferReadback& readback) {
+            return !readback.is_requested() || readback.is_ready();
+          })) {
+        read_data();
+      }
+      break;
+    case ReadbackStep::Finished:
+      break;
+  }
+}
+
+void MeshExportJob::read_dispatch_size() {
+  std::array<GLuint, 3> dispatch_groups{};
+  dispatch_readback_.read(dispatch_groups.data(), sizeof(dispatch_groups));
+  if (dispatch_groups[0] == 0) {
+    // Nothing crosses the surface, the scene is built from the empty mesh
+    read_data();
+    return;
+  }
+
+  exporter_->dispatch_meshing(dispatch_groups[0]);
+  const auto& count_buffer = exporter_->mode_ == MeshingMode::DualContouring ? exporter_->hermite_count_buffer_
+                                                                             : exporter_->vertex_count_buffer_;
+  count_readback_.request(count_buffer->id(), sizeof(GLuint));
+  readback_step_ = ReadbackStep::Count;
+  set_stage_progress(1.0F / 3.0F);
+}
+
+void MeshExportJob::read_count() {
+  GLuint count = 0;
+  count_readback_.read(&count, sizeof(GLuint));
+
+  if (exporter_->mode_ == MeshingMode::DualContouring) {
+    exporter_->hermite_samples_.resize(count);
+    if (count > 0) {
+      data_readbacks_[0].request(exporter_->hermite_buffer_->id(), sizeof(HermiteSample) * count);
+    }
+  } else {
+    exporter_->vertices_.resize(count);
+    exporter_->normals_.resize(count);
+    exporter_->uvs_.resize(count);
+    exporter_->edge_ids_.resize(count);
+    exporter_->triangle_materials_.resize(count / 3);
+    if (count > 0) {
+      data_readbacks_[0].request(exporter_->vertex_buffer_->id(), sizeof(glm::vec4) * count);
+      data_readbacks_[1].request(exporter_->normal_buffer_->id(), sizeof(glm::vec4) * count);
+      data_readbacks_[2].request(exporter_->uv_buffer_->id(), sizeof(glm::vec2) * count);
+      data_readbacks_[3].request(exporter_->edge_id_buffer_->id(), sizeof(uint32_t) * count);
+      data_readbacks_[4].request(exporter_->triangle_material_buffer_->id(), sizeof(uint32_t) * (count / 3));
+    }
+  }
+  readback_step_ = ReadbackStep::Data;
+  set_stage_progress(2.0F / 3.0F);
+}
+
+void MeshExportJob::read_data() {
+  if (exporter_->mode_ == MeshingMode::DualContouring) {
+    if (data_readbacks_[0].is_requested()) {
+      data_readbacks_[0].read(exporter_->hermite_samples_.data(), data_readbacks_[0].size());
+    }
+  } else if (data_readbacks_[0].is_requested()) {
+    data_readbacks_[0].read(exporter_->vertices_.data(), data_readbacks_[0].size());
+    data_readbacks_[1].read(exporter_->normals_.data(), data_readbacks_[1].size());
+    data_readbacks_[2].read(exporter_->uvs_.data(), data_readbacks_[2].size());
+    data_readbacks_[3].read(exporter_->edge_ids_.data(), data_readbacks_[3].size());
+    data_readbacks_[4].read(exporter_->triangle_materials_.data(), data_readbacks_[4].size());
+  }
+
+  // The worker never touches GL, so everything GL owned is released here, on the context thread
+  exporter_->release_gpu_buffers();
+  readback_step_ = ReadbackStep::Finished;
+  start_worker(false);
+}
+
+void MeshExportJob::start_worker(bool run_cpu_mesher) {
+  worker_ = std::jthread([this, run_cpu_mesher, stop_token = stop_source_.get_token()]() {
+    try {
+      if (run_cpu_mesher) {
+        set_stage(MeshExportStage::Meshing);
+        if (!exporter_->execute_cpu(stop_token)) {
+          set_stage(MeshExportStage::Cancelled);
+          return;
+        }
+      }
+
+      set_stage(MeshExportStage::Building);
+      if (!exporter_->build_scene(stop_token, [this](float progress) { set_stage_progress(progress); })) {
+        set_stage(MeshExportStage::Cancelled);
+        return;
+      }
+
+      set_stage(MeshExportStage::Writing);
+      exporter_->export_mesh(output_path_, format_);
+      set_stage(MeshExportStage::Done);
+    } catch (const std::exception& e) {
+      Logger::err("Mesh export '{}' failed: {}", output_path_.string(), e.what());
+      set_stage(MeshExportStage::Failed);
+    }
+  });
+}
+
+void MeshExportJob::set_stage(MeshExportStage stage) {
+  stage_ = stage;
+  if (stage == MeshExportStage::Done) {
+    progress_ = 1.0F;
+  } else if (static_cast<size_t>(stage) < kStageProgressRanges.size()) {
+    progress_ = kStageProgressRanges[static_cast<size_t>(stage)].first;
+  }
+}
+
+void MeshExportJob::set_stage_progress(float stage_progress) {
+  const auto index = static_cast<size_t>(stage_.load());
+  if (index >= kStageProgressRanges.size()) {
+    return;
+  }
+  const auto [start, end] = kStageProgressRanges[index];
+  progress_               = start + ((end - start) * std::clamp(stage_progress, 0.0F, 1.0F));
+}
+
+void MeshExportQueue::start(std::unique_ptr<MeshExportJob> job) { jobs_.push_back(std::move(job)); }
+
+void MeshExportQueue::update() {
+  for (auto& job : jobs_) {
+    job->update();
+  }
+  // Destroying a job joins its worker, which is done by the time the job is finished. Failures are logged.
+  jobs_.remove_if([](const std::unique_ptr<MeshExportJob>& job) { return job->is_finished(); });
+}
+
+void MeshExportQueue::cancel_all() {
+  for (auto& job : jobs_) {
+    job->cancel();
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,123 @@
+#ifndef RESIN_MESH_EXPORT_JOB_HPP
+#define RESIN_MESH_EXPORT_JOB_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec3.hpp>
+#include <libresin/core/buffer_readback.hpp>
+#include <libresin/core/id_registry.hpp>
+#include <libresin/core/mesh_exporter.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/enum_mapper.hpp>
+#include <libresin/utils/macros.hpp>
+#include <list>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+namespace resin {
+
+enum class MeshExportStage : uint8_t {
+  Sampling  = 0,  // GPU passes and the fenced readbacks of their results
+  Meshing   = 1,  // CPU backend evaluation of the tree
+  Building  = 2,  // welding or contouring and LODs
+  Writing   = 3,  // native writer or Assimp scene and export
+  Done      = 4,
+  Cancelled = 5,
+  Failed    = 6,
+  _Count    = 7,  // NOLINT
+};
+
+constexpr StringEnumMapper<MeshExportStage> kMeshExportStageNames({
+    {MeshExportStage::Sampling, "Sampling"},    //
+    {MeshExportStage::Meshing, "Meshing"},      //
+    {MeshExportStage::Building, "Building"},    //
+    {MeshExportStage::Writing, "Writing"},      //
+    {MeshExportStage::Done, "Done"},            //
+    {MeshExportStage::Cancelled, "Cancelled"},  //
+    {MeshExportStage::Failed, "Failed"},        //
+});
+
+// Mesh export that does not stall the thread owning the GL context. The GPU passes are dispatched right away and
+// their results are downloaded with fenced readbacks polled by update(), so the editor keeps rendering while the
+// GPU works. Everything that does not need the GL context (CPU meshing, welding, LODs, Assimp) runs on a worker
+// thread. The tree is only accessed in the constructor: the GPU passes run on the shader code and the uniform buffer
+// snapshots taken there, and the CPU backend on its evaluator, so later edits do not affect the export.
+class MeshExportJob {
+ public:
+  // Must be called on the thread owning the GL context.
+  MeshExportJob(std::unique_ptr<MeshExporter> exporter, const glm::vec3& bb_start, const glm::vec3& bb_end,
+                SDFTree& sdf_tree, IdView<SDFTreeNodeId> node_id, std::filesystem::path output_path,
+                std::string format);
+  ~MeshExportJob();
+
+  DISABLE_COPY_AND_MOVE(MeshExportJob)
+
+  // Advances the GPU stages, must be called every frame on the thread owning the GL context. Never blocks.
+  void update();
+
+  // The GPU work that is already dispatched still runs, but its results are dropped.
+  void cancel();
+
+  inline MeshExportStage stage() const { return stage_.load(); }
+  inline bool is_finished() const { return stage() >= MeshExportStage::Done; }
+  inline const std::filesystem::path& output_path() const { return output_path_; }
+
+  // Overall progress in [0, 1].
+  inline float progress() const { return progress_.load(); }
+
+ private:
+  enum class ReadbackStep : uint8_t {
+    DispatchSize = 0,
+    Count        = 1,
+    Data         = 2,
+    Finished     = 3,
+  };
+
+  void read_dispatch_size();
+  void read_count();
+  void read_data();
+  void start_worker(bool run_cpu_mesher);
+  void set_stage(MeshExportStage stage);
+  void set_stage_progress(float stage_progress);
+
+  std::unique_ptr<MeshExporter> exporter_;
+  std::filesystem::path output_path_;
+  std::string format_;
+
+  std::atomic<MeshExportStage> stage_ = MeshExportStage::Sampling;
+  std::atomic<float> progress_        = 0.0F;
+  std::stop_source stop_source_;
+
+  ReadbackStep readback_step_ = ReadbackStep::Finished;
+  BufferReadback dispatch_readback_;
+  BufferReadback count_readback_;
+  std::array<BufferReadback, 5> data_readbacks_;
+
+  // Must be the last member, so the worker is joined before anything it uses is destroyed
+  std::jthread worker_;
+};
+
+// Export jobs started from the editor. Finished jobs are dropped by update().
+class MeshExportQueue {
+ public:
+  void start(std::unique_ptr<MeshExportJob> job);
+
+  // Must be called every frame on the thread owning the GL context.
+  void update();
+
+  void cancel_all();
+
+  inline const std::list<std::unique_ptr<MeshExportJob>>& jobs() const { return jobs_; }
+  inline bool empty() const { return jobs_.empty(); }
+
+ private:
+  std::list<std::unique_ptr<MeshExportJob>> jobs_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_MESH_EXPORT_JOB_HPP
@@ -1,62 +1,312 @@
+#include <assimp/material.h>
 #include <assimp/mesh.h>
 #include <assimp/scene.h>
 #include <assimp/vector3.h>
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <array>
 #include <assimp/Exporter.hpp>
+#include <chrono>
 #include <filesystem>
+#include <format>
+#include <fstream>
+#include <libresin/core/marching_cubes_tables.hpp>
 #include <libresin/core/mesh_exporter.hpp>
+#include <libresin/core/mesh_simplifier.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/shader.hpp>
 #include <libresin/core/uniform_buffer.hpp>
 #include <libresin/utils/path.hpp>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 namespace resin {
 
-MeshExporter::MeshExporter(ShaderResource& shader_resource, unsigned int resolution)
-    : shader_resource_(shader_resource), resolution_(resolution), scene_(new aiScene()) {
-  initialize_buffers();
+MeshExporter::MeshExporter(const ShaderResource& shader_resource, unsigned int resolution, MeshingMode mode,
+                           MeshExportBackend backend)
+    : shader_resource_(shader_resource),
+      resolution_(resolution),
+      mode_(mode),
+      backend_(backend),
+      bb_start_(0.0F),
+      bb_end_(0.0F),
+      scene_(new aiScene()) {
+  if (backend_ == MeshExportBackend::GPU) {
+    initialize_buffers();
+  }
 }
 
+MeshExporter::MeshExporter(unsigned int resolution, MeshingMode mode)
+    : shader_resource_(std::nullopt),
+      resolution_(resolution),
+      mode_(mode),
+      backend_(MeshExportBackend::CPU),
+      bb_start_(0.0F),
+      bb_end_(0.0F),
+      scene_(new aiScene()) {}
+
 void MeshExporter::setup_scene(const glm::vec3& bb_start, const glm::vec3& bb_end, SDFTree& sdf_tree,
                                IdView<SDFTreeNodeId> node_id) {
-  execute_shader(bb_start, bb_end, sdf_tree, node_id);
-  read_buffers();
-  create_scene();
+  bb_start_ = bb_start;
+  bb_end_   = bb_end;
+  snapshot_materials(sdf_tree);
+  if (backend_ == MeshExportBackend::CPU) {
+    compile_evaluator(sdf_tree, node_id);
+    execute_cpu();
+  } else {
+    execute_shader(sdf_tree, node_id);
+    read_buffers();
+  }
+  build_scene();
+}
+
+bool MeshExporter::build_scene(const std::stop_token& stop_token, const std::function<void(float)>& on_progress) {
+  auto report = [&on_progress](float progress) {
+    if (on_progress) {
+      on_progress(progress);
+    }
+  };
+
+  if (mode_ == MeshingMode::DualContouring) {
+    contour_vertices();
+  } else {
+    weld_vertices();
+  }
+  report(0.3F);
+
+  lods_.clear();
+  lods_.reserve(lod_options_.size());
+  for (const auto& options : lod_options_) {
+    if (stop_token.stop_requested()) {
+      return false;
+    }
+    const IndexedMesh& previous = lods_.empty() ? mesh_ : lods_.back();
+    lods_.push_back(simplify_mesh(previous, options));
+    Logger::info("Generated mesh LOD{}: {} -> {} triangles", lods_.size(), previous.triangle_count(),
+                 lods_.back().triangle_count());
+    report(0.3F + (0.6F * static_cast<float>(lods_.size()) / static_cast<float>(lod_options_.size())));
+  }
+
+  if (stop_token.stop_requested()) {
+    return false;
+  }
+  report(1.0F);
+  return true;
 }
 
 MeshExporter::~MeshExporter() { delete scene_; }
 
 void MeshExporter::export_mesh(const std::filesystem::path& output_path, std::string_view format) const {
-  Assimp::Exporter exporter;
-  if (exporter.Export(scene_, std::string(format), path_to_utf8str(output_path)) != AI_SUCCESS) {
-    Logger::err("Failed to export mesh asset '{}'", output_path.string());
+  const auto start = std::chrono::steady_clock::now();
+
+  size_t triangle_count = mesh_.triangle_count();
+  if (auto native_format = native_mesh_format(format)) {
+    std::ofstream output(output_path, std::ios::binary);
+    if (!output.is_open()) {
+      Logger::err("Failed to export mesh asset '{}': the file could not be opened", output_path.string());
+      return;
+    }
+    if (!lods_.empty() && *native_format != NativeMeshFormat::GLB) {
+      Logger::warn("The {} format cannot hold the LODs, only the full mesh is exported to '{}'", format,
+                   output_path.string());
+    }
+    switch (*native_format) {
+      case NativeMeshFormat::STL:
+        write_stl(output, mesh_);
+        break;
+      case NativeMeshFormat::PLY:
+        write_ply(output, mesh_);
+        break;
+      case NativeMeshFormat::GLB:
+        write_glb(output, mesh_, lods_, materials_);
+        triangle_count = total_triangle_count();
+        break;
+      case NativeMeshFormat::_Count:
+        break;
+    }
+    if (!output.good()) {
+      Logger::err("Failed to export mesh asset '{}'", output_path.string());
+      return;
+    }
   } else {
-    Logger::info("Successfully exported mesh asset '{}'", output_path.string());
+    // The Assimp scene is only needed by the formats without a native writer
+    if (scene_->mRootNode == nullptr) {
+      create_scene();
+    }
+    Assimp::Exporter exporter;
+    if (exporter.Export(scene_, std::string(format), path_to_utf8str(output_path)) != AI_SUCCESS) {
+      Logger::err("Failed to export mesh asset '{}'", output_path.string());
+      return;
+    }
+    triangle_count = total_triangle_count();
+  }
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  Logger::info("Successfully exported mesh asset '{}': {} triangles in {:.3f}s ({:.0f} triangles/s)",
+               output_path.string(), triangle_count, elapsed.count(),
+               static_cast<double>(triangle_count) / std::max(elapsed.count(), 1e-9));
+}
+
+size_t MeshExporter::total_triangle_count() const {
+  size_t count = mesh_.triangle_count();
+  for (const auto& lod : lods_) {
+    count += lod.triangle_count();
+  }
+  return count;
+}
+
+void MeshExporter::execute_shader(SDFTree& sdf_tree, IdView<SDFTreeNodeId> node_id) {
+  dispatch_classification(sdf_tree, node_id);
+
+  std::array<GLuint, 3> dispatch_groups{};
+  dispatch_buffer_->get_data(dispatch_groups.data(), sizeof(dispatch_groups));
+  if (dispatch_groups[0] != 0) {
+    dispatch_meshing(dispatch_groups[0]);
   }
 }
 
-void MeshExporter::execute_shader(const glm::vec3 bb_start, const glm::vec3 bb_end, SDFTree& sdf_tree,
-                                  IdView<SDFTreeNodeId> node_id) {
+void MeshExporter::dispatch_classification(SDFTree& sdf_tree, IdView<SDFTreeNodeId> node_id) {
   GroupNode& group_node = sdf_tree.group(node_id);
-  shader_resource_.set_ext_defi("SDF_CODE", group_node.gen_shader_code(GenShaderMode::SinglePrimitiveArray));
-  shader_resource_.set_ext_defi("MAX_UBO_NODE_COUNT", std::to_string(sdf_tree.max_node_count()));
-  shader_resource_.set_ext_defi("MAX_UBO_MATERIAL_COUNT", std::to_string(sdf_tree.max_material_count()));
+  shader_resource_->set_ext_defi("SDF_CODE", group_node.gen_shader_code(GenShaderMode::SinglePrimitiveArray));
+  shader_resource_->set_ext_defi("SDF_FUNCTIONS", sdf_tree.gen_shader_functions(GenShaderMode::SinglePrimitiveArray));
+  shader_resource_->set_ext_defi("MAX_UBO_NODE_COUNT", std::to_string(sdf_tree.max_node_count()));
+  shader_resource_->set_ext_defi("MAX_UBO_MATERIAL_COUNT", std::to_string(sdf_tree.max_material_count()));
 
-  // Set up compute shader
-  ComputeShaderProgram compute_shader_program("marching_cubes", shader_resource_);
+  primitive_ubo_ = std::make_unique<PrimitiveUniformBuffer>(sdf_tree.max_node_count(), kPrimitiveSnapshotBinding);
+  primitive_ubo_->bind();
+  primitive_ubo_->set(sdf_tree);
+  primitive_ubo_->unbind();
+
+  node_attributes_ubo_ =
+      std::make_unique<NodeAttributesUniformBuffer>(sdf_tree.max_node_count(), kNodeAttributesSnapshotBinding);
+  node_attributes_ubo_->bind();
+  node_attributes_ubo_->set(sdf_tree);
+  node_attributes_ubo_->unbind();
+
+  material_ubo_ = std::make_unique<MaterialUniformBuffer>(sdf_tree.max_material_count(), kMaterialSnapshotBinding);
+  material_ubo_->bind();
+  material_ubo_->set(sdf_tree);
+  material_ubo_->unbind();
+
+  const unsigned int block_res       = resolution_ / kBlockSize;
+  const unsigned int classify_groups = (block_res + kBlockSize - 1) / kBlockSize;
+
+  // Coarse pass: mark the blocks that may be crossed by the surface.
+  run_pass(MarchingCubesPass::Classify,
+           [classify_groups]() { glDispatchCompute(classify_groups, classify_groups, classify_groups); });
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  // Compaction: prefix sum over the block flags, writes the active block list and the indirect dispatch size.
+  run_pass(MarchingCubesPass::Compact, []() { glDispatchCompute(1, 1, 1); });
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void MeshExporter::dispatch_meshing(unsigned int active_blocks) {
+  const unsigned int block_res = resolution_ / kBlockSize;
+  Logger::info("Marching cubes active blocks: {} / {}", active_blocks, block_res * block_res * block_res);
+
+  // Full evaluation restricted to the active blocks.
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatch_buffer_->id());
+  run_pass(MarchingCubesPass::Sample, []() { glDispatchComputeIndirect(0); });
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  if (mode_ == MeshingMode::DualContouring) {
+    // At most 3 sign-changing edges per active cell
+    const size_t max_samples = static_cast<size_t>(active_blocks) * kBlockSize * kBlockSize * kBlockSize * 3;
+    hermite_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(HermiteSample) * max_samples, 12, GL_STREAM_READ);
+    run_pass(MarchingCubesPass::Hermite, []() { glDispatchComputeIndirect(0); });
+  } else {
+    run_pass(MarchingCubesPass::March, []() { glDispatchComputeIndirect(0); });
+  }
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);  // TODO(SDF-129) add GL_SHADER_IMAGE_ACCESS_BARRIER_BIT for textures
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+void MeshExporter::release_gpu_buffers() {
+  edges_lookup_buffer_      = nullptr;
+  triangles_lookup_buffer_  = nullptr;
+  vertex_buffer_            = nullptr;
+  vertex_count_buffer_      = nullptr;
+  normal_buffer_            = nullptr;
+  uv_buffer_                = nullptr;
+  edge_id_buffer_           = nullptr;
+  block_flags_buffer_       = nullptr;
+  active_blocks_buffer_     = nullptr;
+  dispatch_buffer_          = nullptr;
+  corner_values_buffer_     = nullptr;
+  hermite_count_buffer_     = nullptr;
+  hermite_buffer_           = nullptr;
+  triangle_material_buffer_ = nullptr;
+  primitive_ubo_            = nullptr;
+  node_attributes_ubo_      = nullptr;
+  material_ubo_             = nullptr;
+}
+
+void MeshExporter::snapshot_materials(SDFTree& sdf_tree) {
+  materials_.clear();
+  sdf_tree.visit_all_materials([this](MaterialSDFTreeComponent& material) {
+    materials_.push_back(MeshExportMaterial{.id       = static_cast<uint32_t>(material.material_id().raw()),
+                                            .name     = std::string(material.name()),
+                                            .material = material.material});
+  });
+}
+
+void MeshExporter::compile_evaluator(SDFTree& sdf_tree, IdView<SDFTreeNodeId> node_id) {
+  evaluator_ = std::make_unique<SDFEvaluator>(sdf_tree.group(node_id));
+}
+
+bool MeshExporter::execute_cpu(const std::stop_token& stop_token) {
+  if (thread_pool_ == nullptr) {
+    thread_pool_ = std::make_unique<ThreadPool>();
+  }
+
+  const CPUMesher mesher(*evaluator_, bb_start_, bb_end_, resolution_);
+  if (mode_ == MeshingMode::DualContouring) {
+    hermite_samples_ = mesher.hermite_samples(*thread_pool_, stop_token);
+    return !stop_token.stop_requested();
+  }
+
+  TriangleSoup soup   = mesher.march(*thread_pool_, stop_token);
+  vertices_           = std::move(soup.vertices);
+  normals_            = std::move(soup.normals);
+  uvs_                = std::move(soup.uvs);
+  edge_ids_           = std::move(soup.edge_ids);
+  triangle_materials_ = std::move(soup.materials);
+  return !stop_token.stop_requested();
+}
+
+void MeshExporter::run_pass(MarchingCubesPass pass, const std::function<void()>& dispatch) {
+  ShaderResource pass_resource(*shader_resource_);
+  pass_resource.set_ext_defi("MC_PASS", std::to_string(static_cast<int>(pass)));
+
+  ComputeShaderProgram compute_shader_program(std::format("marching_cubes_{}", static_cast<int>(pass)),
+                                              std::move(pass_resource));
   compute_shader_program.bind();
-  compute_shader_program.set_uniform("u_boundingBoxStart", bb_start);
-  compute_shader_program.set_uniform("u_boundingBoxEnd", bb_end);
+  compute_shader_program.set_uniform("u_boundingBoxStart", bb_start_);
+  compute_shader_program.set_uniform("u_boundingBoxEnd", bb_end_);
   compute_shader_program.set_uniform("u_marchRes", resolution_);
-  compute_shader_program.bind_uniform_buffer("PrimitiveNodeData", 0);
-  compute_shader_program.bind_uniform_buffer("NodeAttributesData", 1);
-  compute_shader_program.bind_uniform_buffer("MaterialData", 2);
 
-  // Dispatch compute shader.
-  glDispatchCompute(resolution_ / 8, resolution_ / 8, resolution_ / 8);
-  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);  // TODO(SDF-129) add GL_SHADER_IMAGE_ACCESS_BARRIER_BIT for textures
+  // Another export job may have taken the same bindings since the previous pass
+  for (const auto* buffer :
+       {edges_lookup_buffer_.get(), triangles_lookup_buffer_.get(), vertex_buffer_.get(), vertex_count_buffer_.get(),
+        normal_buffer_.get(), uv_buffer_.get(), edge_id_buffer_.get(), block_flags_buffer_.get(),
+        active_blocks_buffer_.get(), dispatch_buffer_.get(), corner_values_buffer_.get(), hermite_count_buffer_.get(),
+        hermite_buffer_.get(), triangle_material_buffer_.get()}) {
+    if (buffer != nullptr) {
+      buffer->bind_base();
+    }
+  }
+  if (pass != MarchingCubesPass::Compact) {
+    primitive_ubo_->bind_base();
+    node_attributes_ubo_->bind_base();
+    material_ubo_->bind_base();
+    compute_shader_program.bind_uniform_buffer("PrimitiveNodeData", *primitive_ubo_);
+    compute_shader_program.bind_uniform_buffer("NodeAttributesData", *node_attributes_ubo_);
+    compute_shader_program.bind_uniform_buffer("MaterialData", *material_ubo_);
+  }
+
+  dispatch();
   compute_shader_program.unbind();
 }
 
@@ -64,22 +314,49 @@ void MeshExporter::initialize_buffers() {
   const auto max_vertices =
       static_cast<unsigned int>(std::pow(resolution_, 3) * 3 * 5);  // max 5 triangles per each cuboid
 
-  edges_lookup_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(edge_table_), 0);
-  edges_lookup_buffer_->set_data(edge_table_, sizeof(edge_table_));
+  edges_lookup_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(kMarchingCubesEdgeTable), 0);
+  edges_lookup_buffer_->set_data(kMarchingCubesEdgeTable.data(), sizeof(kMarchingCubesEdgeTable));
 
-  triangles_lookup_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(tri_table_), 1);
-  triangles_lookup_buffer_->set_data(tri_table_, sizeof(tri_table_));
+  triangles_lookup_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(kMarchingCubesTriTable), 1);
+  triangles_lookup_buffer_->set_data(kMarchingCubesTriTable.data(), sizeof(kMarchingCubesTriTable));
 
-  vertex_buffer_       = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec4) * max_vertices, 2, GL_STREAM_READ);
-  vertex_count_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(unsigned int), 3, GL_STREAM_READ);
-  GLuint init          = 0;
+  vertex_count_buffer_  = std::make_unique<ShaderStorageBuffer>(sizeof(unsigned int), 3, GL_STREAM_READ);
+  hermite_count_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(unsigned int), 11, GL_STREAM_READ);
+  GLuint init           = 0;
   vertex_count_buffer_->set_data(&init, sizeof(unsigned int));
+  hermite_count_buffer_->set_data(&init, sizeof(unsigned int));
+
+  // Marching cubes triangle soup, dual contouring allocates its hermite buffer once the active blocks are known
+  if (mode_ == MeshingMode::MarchingCubes) {
+    vertex_buffer_  = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec4) * max_vertices, 2, GL_STREAM_READ);
+    normal_buffer_  = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec4) * max_vertices, 4, GL_STREAM_READ);
+    uv_buffer_      = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec2) * max_vertices, 5, GL_STREAM_READ);
+    edge_id_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(uint32_t) * max_vertices, 6, GL_STREAM_READ);
+    triangle_material_buffer_ =
+        std::make_unique<ShaderStorageBuffer>(sizeof(uint32_t) * (max_vertices / 3), 13, GL_STREAM_READ);
+  }
+
+  // Sparse marching cubes state
+  const auto block_count  = static_cast<size_t>(std::pow(resolution_ / kBlockSize, 3));
+  const auto corner_count = static_cast<size_t>(std::pow(resolution_ + 1, 3));
 
-  normal_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec4) * max_vertices, 4, GL_STREAM_READ);
-  uv_buffer_     = std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec2) * max_vertices, 5, GL_STREAM_READ);
+  block_flags_buffer_   = std::make_unique<ShaderStorageBuffer>(sizeof(GLuint) * block_count, 7, GL_STREAM_COPY);
+  active_blocks_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(GLuint) * block_count, 8, GL_STREAM_COPY);
+  dispatch_buffer_      = std::make_unique<ShaderStorageBuffer>(sizeof(GLuint) * 3, 9, GL_STREAM_COPY);
+  corner_values_buffer_ = std::make_unique<ShaderStorageBuffer>(sizeof(float) * corner_count, 10, GL_STREAM_COPY);
 }
 
 void MeshExporter::read_buffers() {
+  if (mode_ == MeshingMode::DualContouring) {
+    GLuint sample_count = 0;
+    hermite_count_buffer_->get_data(&sample_count, sizeof(unsigned int));
+    hermite_samples_.resize(sample_count);
+    if (sample_count > 0) {
+      hermite_buffer_->get_data(hermite_samples_.data(), sizeof(HermiteSample) * sample_count);
+    }
+    return;
+  }
+
   GLuint vertex_count = 0;
 
   vertex_count_buffer_->get_data(&vertex_count, sizeof(unsigned int));
@@ -87,49 +364,171 @@ void MeshExporter::read_buffers() {
   vertices_.resize(vertex_count);
   normals_.resize(vertex_count);
   uvs_.resize(vertex_count);
+  edge_ids_.resize(vertex_count);
+  triangle_materials_.resize(vertex_count / 3);
 
   vertex_buffer_->get_data(vertices_.data(), (sizeof(glm::vec4) * vertex_count));
   normal_buffer_->get_data(normals_.data(), (sizeof(glm::vec4) * vertex_count));
   uv_buffer_->get_data(uvs_.data(), (sizeof(glm::vec2) * vertex_count));
+  edge_id_buffer_->get_data(edge_ids_.data(), (sizeof(uint32_t) * vertex_count));
+  triangle_material_buffer_->get_data(triangle_materials_.data(), (sizeof(uint32_t) * (vertex_count / 3)));
 }
 
-void MeshExporter::create_scene() const {
+void MeshExporter::weld_vertices() {
+  mesh_ = weld_triangle_soup(vertices_, normals_, uvs_, edge_ids_, triangle_materials_);
+
+  const size_t soup_count   = vertices_.size();
+  const size_t welded_count = mesh_.vertices.size();
+  Logger::info("Welded mesh vertices: {} -> {} ({:.1f}% reduction)", soup_count, welded_count,
+               soup_count == 0 ? 0.0
+                               : 100.0 * static_cast<double>(soup_count - welded_count) /
+                                     static_cast<double>(soup_count));
+
+  // The soup is not needed anymore
+  vertices_           = {};
+  normals_            = {};
+  uvs_                = {};
+  edge_ids_           = {};
+  triangle_materials_ = {};
+}
+
+void MeshExporter::contour_vertices() {
+  DualContouringOptions options{.bb_start = bb_start_, .bb_end = bb_end_, .resolution = resolution_};
+  mesh_ = dual_contour(hermite_samples_, options);
+  Logger::info("Dual contoured mesh: {} hermite samples -> {} vertices, {} triangles", hermite_samples_.size(),
+               mesh_.vertices.size(), mesh_.triangle_count());
+
+  hermite_samples_ = {};
+}
+
+void MeshExporter::fill_mesh(aiMesh* mesh, const IndexedMesh& indexed_mesh, const glm::vec3& color) {
   // NOLINTBEGIN(cppcoreguidelines-owning-memory)
-  scene_->mRootNode             = new aiNode();
-  scene_->mMeshes               = new aiMesh*[1];
-  scene_->mMeshes[0]            = new aiMesh();
-  scene_->mNumMeshes            = 1;
-  scene_->mRootNode->mMeshes    = new unsigned int[1]{0};
-  scene_->mRootNode->mNumMeshes = 1;
-
-  scene_->mMaterials    = new aiMaterial*[1];
-  scene_->mMaterials[0] = nullptr;
-  scene_->mNumMaterials = 1;
-  scene_->mMaterials[0] = new aiMaterial();
-
-  aiMesh* mesh          = scene_->mMeshes[0];
   mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
 
-  // Fill vertices.
-  mesh->mVertices           = new aiVector3D[vertices_.size()];
-  mesh->mNumVertices        = static_cast<unsigned int>(vertices_.size());
-  mesh->mNormals            = new aiVector3D[normals_.size()];
-  mesh->mTextureCoords[0]   = new aiVector3D[uvs_.size()];
+  // Fill vertices. The vertex colors repeat the albedo, for the formats and tools that ignore materials.
+  const size_t vertex_count = indexed_mesh.vertices.size();
+  mesh->mVertices           = new aiVector3D[vertex_count];
+  mesh->mNumVertices        = static_cast<unsigned int>(vertex_count);
+  mesh->mNormals            = new aiVector3D[vertex_count];
+  mesh->mTextureCoords[0]   = new aiVector3D[vertex_count];
   mesh->mNumUVComponents[0] = 2;
-  for (size_t i = 0; i < vertices_.size(); ++i) {
-    mesh->mVertices[i]         = aiVector3D(vertices_[i].x, vertices_[i].y, vertices_[i].z);
-    mesh->mNormals[i]          = aiVector3D(normals_[i].x, normals_[i].y, normals_[i].z);
-    mesh->mTextureCoords[0][i] = aiVector3D(uvs_[i].x, uvs_[i].y, 0.0F);
+  mesh->mColors[0]          = new aiColor4D[vertex_count];
+  for (size_t i = 0; i < vertex_count; ++i) {
+    const glm::vec3& v         = indexed_mesh.vertices[i];
+    const glm::vec3& n         = indexed_mesh.normals[i];
+    mesh->mVertices[i]         = aiVector3D(v.x, v.y, v.z);
+    mesh->mNormals[i]          = aiVector3D(n.x, n.y, n.z);
+    mesh->mTextureCoords[0][i] = aiVector3D(indexed_mesh.uvs[i].x, indexed_mesh.uvs[i].y, 0.0F);
+    mesh->mColors[0][i]        = aiColor4D(color.r, color.g, color.b, 1.0F);
   }
 
-  mesh->mFaces    = new aiFace[vertices_.size() / 3];
-  mesh->mNumFaces = static_cast<unsigned int>(vertices_.size() / 3);
-  for (unsigned int i = 0; i < vertices_.size(); i += 3) {
-    aiFace& face     = mesh->mFaces[i / 3];
-    face.mIndices    = new unsigned int[3]{i + 1, i, i + 2};  // counterclockwise winding order
+  // Fill faces. The welded mesh already is in the counterclockwise winding order.
+  const size_t face_count = indexed_mesh.triangle_count();
+  const auto& indices     = indexed_mesh.indices;
+  mesh->mFaces            = new aiFace[face_count];
+  mesh->mNumFaces         = static_cast<unsigned int>(face_count);
+  for (size_t i = 0; i < face_count; ++i) {
+    aiFace& face     = mesh->mFaces[i];
+    face.mIndices    = new unsigned int[3]{indices[3 * i], indices[(3 * i) + 1], indices[(3 * i) + 2]};
     face.mNumIndices = 3;
   }
   // NOLINTEND(cppcoreguidelines-owning-memory)
 }
 
+aiMaterial* MeshExporter::create_material(const MeshExportMaterial& material) {
+  auto* ai_material = new aiMaterial();  // NOLINT(cppcoreguidelines-owning-memory)
+
+  const Material& mat = material.material;
+  const aiString name(material.name);
+  const aiColor3D albedo(mat.albedo.r, mat.albedo.g, mat.albedo.b);
+  const aiColor4D base_color(mat.albedo.r, mat.albedo.g, mat.albedo.b, 1.0F);
+  const aiColor3D ambient  = albedo * mat.ambientFactor;
+  const aiColor3D diffuse  = albedo * mat.diffuseFactor;
+  const aiColor3D specular(mat.specularFactor, mat.specularFactor, mat.specularFactor);
+  const int shading_model  = aiShadingMode_Blinn;
+
+  ai_material->AddProperty(&name, AI_MATKEY_NAME);
+  ai_material->AddProperty(&shading_model, 1, AI_MATKEY_SHADING_MODEL);
+  ai_material->AddProperty(&base_color, 1, AI_MATKEY_BASE_COLOR);
+  ai_material->AddProperty(&ambient, 1, AI_MATKEY_COLOR_AMBIENT);
+  ai_material->AddProperty(&diffuse, 1, AI_MATKEY_COLOR_DIFFUSE);
+  ai_material->AddProperty(&specular, 1, AI_MATKEY_COLOR_SPECULAR);
+  ai_material->AddProperty(&mat.specularExponent, 1, AI_MATKEY_SHININESS);
+  return ai_material;
+}
+
+void MeshExporter::create_scene() const {
+  // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+  std::vector<std::vector<MaterialSubmesh>> levels;
+  levels.reserve(1 + lods_.size());
+  levels.push_back(split_by_material(mesh_));
+  for (const auto& lod : lods_) {
+    levels.push_back(split_by_material(lod));
+  }
+
+  // Scene materials in the order of their first use, ids missing from the snapshot get the default material
+  std::unordered_map<uint32_t, unsigned int> scene_material_index;
+  std::vector<const MeshExportMaterial*> scene_materials;
+  for (const auto& level : levels) {
+    for (const auto& submesh : level) {
+      const auto next_index = static_cast<unsigned int>(scene_materials.size());
+      if (scene_material_index.try_emplace(submesh.material, next_index).second) {
+        auto it = std::ranges::find(materials_, submesh.material, &MeshExportMaterial::id);
+        scene_materials.push_back(it == materials_.end() ? nullptr : &*it);
+      }
+    }
+  }
+
+  const MeshExportMaterial fallback_material{.id = 0, .name = "default", .material = Material()};
+  const auto material_count = static_cast<unsigned int>(std::max<size_t>(scene_materials.size(), 1));
+  scene_->mMaterials        = new aiMaterial*[material_count];
+  scene_->mNumMaterials     = material_count;
+  for (unsigned int i = 0; i < material_count; ++i) {
+    const MeshExportMaterial* material = i < scene_materials.size() ? scene_materials[i] : nullptr;
+    scene_->mMaterials[i]              = create_material(material == nullptr ? fallback_material : *material);
+  }
+
+  size_t mesh_count = 0;
+  for (const auto& level : levels) {
+    mesh_count += level.size();
+  }
+  scene_->mRootNode  = new aiNode();
+  scene_->mMeshes    = new aiMesh*[mesh_count];
+  scene_->mNumMeshes = static_cast<unsigned int>(mesh_count);
+
+  // Every level gets its own node with one mesh per material, the _LOD<n> suffix is what the engines look for when
+  // grouping imported LODs. Without LODs the meshes are attached to the root.
+  const bool has_lods = levels.size() > 1;
+  if (has_lods) {
+    scene_->mRootNode->mChildren    = new aiNode*[levels.size()];
+    scene_->mRootNode->mNumChildren = static_cast<unsigned int>(levels.size());
+  }
+
+  unsigned int mesh_index = 0;
+  for (size_t l = 0; l < levels.size(); ++l) {
+    aiNode* node = scene_->mRootNode;
+    if (has_lods) {
+      node                            = new aiNode(std::format("mesh_LOD{}", l));
+      node->mParent                   = scene_->mRootNode;
+      scene_->mRootNode->mChildren[l] = node;
+    }
+    node->mMeshes    = new unsigned int[levels[l].size()];
+    node->mNumMeshes = static_cast<unsigned int>(levels[l].size());
+
+    for (size_t i = 0; i < levels[l].size(); ++i) {
+      const MaterialSubmesh& submesh    = levels[l][i];
+      const unsigned int material_index = scene_material_index.at(submesh.material);
+      const MeshExportMaterial* mat     = scene_materials[material_index];
+
+      auto* mesh           = new aiMesh();
+      mesh->mName          = aiString(mat == nullptr ? fallback_material.name : mat->name);
+      mesh->mMaterialIndex = material_index;
+      fill_mesh(mesh, submesh.mesh, (mat == nullptr ? fallback_material : *mat).material.albedo);
+      scene_->mMeshes[mesh_index] = mesh;
+      node->mMeshes[i]            = mesh_index++;
+    }
+  }
+  // NOLINTEND(cppcoreguidelines-owning-memory)
+}
+
 }  // namespace resin
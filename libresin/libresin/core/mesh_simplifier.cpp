@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <iterator>
+#include <libresin/core/mesh_simplifier.hpp>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+// Weight of the planes perpendicular to the open borders, relative to the surface planes.
+constexpr double kBoundaryWeight = 10.0;
+
+// Minimal cosine between a triangle normal before and after a collapse, smaller values are treated as a flip.
+constexpr double kMinFlipCos = 0.2;
+
+// Symmetric 4x4 matrix [A b; b^T c] measuring the sum of squared distances to a set of planes.
+class Quadric {
+ public:
+  static Quadric from_plane(const glm::dvec3& normal, double d, double weight) {
+    Quadric q;
+    q.a_ = weight * glm::outerProduct(normal, normal);
+    q.b_ = weight * d * normal;
+    q.c_ = weight * d * d;
+    return q;
+  }
+
+  Quadric& operator+=(const Quadric& other) {
+    a_ += other.a_;
+    b_ += other.b_;
+    c_ += other.c_;
+    return *this;
+  }
+
+  friend Quadric operator+(Quadric lhs, const Quadric& rhs) { return lhs += rhs; }
+
+  double error(const glm::dvec3& p) const { return glm::dot(p, a_ * p) + (2.0 * glm::dot(b_, p)) + c_; }
+
+  // Point with the smallest error, fails if the planes do not determine a single point.
+  bool minimizer(glm::dvec3& p) const {
+    if (std::abs(glm::determinant(a_)) < 1e-12) {
+      return false;
+    }
+    p = -(glm::inverse(a_) * b_);
+    return true;
+  }
+
+ private:
+  glm::dmat3 a_ = glm::dmat3(0.0);
+  glm::dvec3 b_ = glm::dvec3(0.0);
+  double c_     = 0.0;
+};
+
+struct Collapse {
+  double cost;
+  uint32_t v0, v1;
+  uint32_t stamp0, stamp1;
+  glm::dvec3 target;
+
+  bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+inline uint64_t edge_key(uint32_t a, uint32_t b) {
+  return (static_cast<uint64_t>(std::min(a, b)) << 32U) | static_cast<uint64_t>(std::max(a, b));
+}
+
+class EdgeCollapser {
+ public:
+  explicit EdgeCollapser(const IndexedMesh& mesh)
+      : normals_(mesh.normals),
+        uvs_(mesh.uvs),
+        quadrics_(mesh.vertices.size()),
+        vertex_faces_(mesh.vertices.size()),
+        vertex_alive_(mesh.vertices.size(), true),
+        stamps_(mesh.vertices.size(), 0) {
+    positions_.reserve(mesh.vertices.size());
+    for (const auto& v : mesh.vertices) {
+      positions_.emplace_back(v);
+    }
+
+    faces_.reserve(mesh.triangle_count());
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) {
+      const std::array<uint32_t, 3> face = {mesh.indices[3 * i], mesh.indices[(3 * i) + 1],
+                                            mesh.indices[(3 * i) + 2]};
+      if (face[0] == face[1] || face[1] == face[2] || face[0] == face[2]) {
+        continue;
+      }
+      const auto face_idx = static_cast<uint32_t>(faces_.size());
+      faces_.push_back(face);
+      if (!mesh.materials.empty()) {
+        face_materials_.push_back(mesh.materials[i]);
+      }
+      for (const uint32_t v : face) {
+        vertex_faces_[v].push_back(face_idx);
+      }
+    }
+    face_alive_.assign(faces_.size(), true);
+    live_faces_ = faces_.size();
+
+    init_quadrics();
+  }
+
+  void run(size_t target_faces, double max_cost) {
+    while (live_faces_ > target_faces && !heap_.empty()) {
+      const Collapse collapse = heap_.top();
+      heap_.pop();
+      if (!is_current(collapse)) {
+        continue;
+      }
+      if (collapse.cost > max_cost) {
+        break;
+      }
+      try_collapse(collapse);
+    }
+  }
+
+  IndexedMesh result() const {
+    IndexedMesh mesh;
+    std::vector<uint32_t> remap(positions_.size(), UINT32_MAX);
+    mesh.indices.reserve(live_faces_ * 3);
+    for (size_t f = 0; f < faces_.size(); ++f) {
+      if (!face_alive_[f]) {
+        continue;
+      }
+      for (const uint32_t v : faces_[f]) {
+        if (remap[v] == UINT32_MAX) {
+          remap[v] = static_cast<uint32_t>(mesh.vertices.size());
+          mesh.vertices.emplace_back(positions_[v]);
+          mesh.normals.push_back(normals_[v]);
+          mesh.uvs.push_back(uvs_[v]);
+        }
+        mesh.indices.push_back(remap[v]);
+      }
+      if (!face_materials_.empty()) {
+        mesh.materials.push_back(face_materials_[f]);
+      }
+    }
+    return mesh;
+  }
+
+ private:
+  glm::dvec3 face_normal(const std::array<uint32_t, 3>& face) const {
+    return glm::cross(positions_[face[1]] - positions_[face[0]], positions_[face[2]] - positions_[face[0]]);
+  }
+
+  void init_quadrics() {
+    struct EdgeFaces {
+      uint32_t count     = 0;
+      uint32_t last_face = 0;
+      bool material_seam = false;  // adjacent faces of different materials
+    };
+    std::unordered_map<uint64_t, EdgeFaces> edges;
+    edges.reserve(faces_.size() * 2);
+
+    for (size_t f = 0; f < faces_.size(); ++f) {
+      const auto& face   = faces_[f];
+      const glm::dvec3 n = face_normal(face);
+      const double len   = glm::length(n);
+      if (len > 0.0) {
+        const glm::dvec3 unit = n / len;
+        const Quadric q       = Quadric::from_plane(unit, -glm::dot(unit, positions_[face[0]]), 1.0);
+        for (const uint32_t v : face) {
+          quadrics_[v] += q;
+        }
+      }
+      for (size_t i = 0; i < 3; ++i) {
+        auto& edge = edges[edge_key(face[i], face[(i + 1) % 3])];
+        if (edge.count > 0 && !face_materials_.empty() && face_materials_[edge.last_face] != face_materials_[f]) {
+          edge.material_seam = true;
+        }
+        ++edge.count;
+        edge.last_face = static_cast<uint32_t>(f);
+      }
+    }
+
+    // Borders and material seams are pinned with planes going through the edge, perpendicular to its face, so the
+    // submeshes split by material keep their outlines
+    for (const auto& [key, edge] : edges) {
+      if (edge.count != 1 && !edge.material_seam) {
+        continue;
+      }
+      const auto a         = static_cast<uint32_t>(key >> 32U);
+      const auto b         = static_cast<uint32_t>(key & UINT32_MAX);
+      const glm::dvec3 dir = positions_[b] - positions_[a];
+      const glm::dvec3 n   = glm::cross(dir, face_normal(faces_[edge.last_face]));
+      const double len     = glm::length(n);
+      if (len <= std::numeric_limits<double>::min()) {
+        continue;
+      }
+      const glm::dvec3 unit = n / len;
+      const Quadric q       = Quadric::from_plane(unit, -glm::dot(unit, positions_[a]), kBoundaryWeight);
+      quadrics_[a] += q;
+      quadrics_[b] += q;
+    }
+
+    for (const auto& [key, edge] : edges) {
+      push_collapse(static_cast<uint32_t>(key >> 32U), static_cast<uint32_t>(key & UINT32_MAX));
+    }
+  }
+
+  void push_collapse(uint32_t v0, uint32_t v1) {
+    const Quadric q      = quadrics_[v0] + quadrics_[v1];
+    const glm::dvec3& p0 = positions_[v0];
+    const glm::dvec3& p1 = positions_[v1];
+
+    // The optimum is only trusted close to the edge, nearly parallel planes may place it arbitrarily far away
+    glm::dvec3 target;
+    const double edge_length = glm::length(p1 - p0);
+    if (!q.minimizer(target) || glm::length(target - (0.5 * (p0 + p1))) > 2.0 * edge_length) {
+      const std::array<glm::dvec3, 3> candidates = {p0, p1, 0.5 * (p0 + p1)};
+      target = *std::ranges::min_element(candidates, {}, [&q](const glm::dvec3& p) { return q.error(p); });
+    }
+
+    heap_.push(Collapse{.cost   = std::max(0.0, q.error(target)),
+                        .v0     = v0,
+                        .v1     = v1,
+                        .stamp0 = stamps_[v0],
+                        .stamp1 = stamps_[v1],
+                        .target = target});
+  }
+
+  bool is_current(const Collapse& collapse) const {
+    return vertex_alive_[collapse.v0] && vertex_alive_[collapse.v1] && stamps_[collapse.v0] == collapse.stamp0 &&
+           stamps_[collapse.v1] == collapse.stamp1;
+  }
+
+  void collect_neighbours(uint32_t v, std::vector<uint32_t>& neighbours) const {
+    neighbours.clear();
+    for (const uint32_t f : vertex_faces_[v]) {
+      if (!face_alive_[f]) {
+        continue;
+      }
+      for (const uint32_t u : faces_[f]) {
+        if (u != v) {
+          neighbours.push_back(u);
+        }
+      }
+    }
+    std::ranges::sort(neighbours);
+    const auto [first, last] = std::ranges::unique(neighbours);
+    neighbours.erase(first, last);
+  }
+
+  static bool contains(const std::array<uint32_t, 3>& face, uint32_t v) {
+    return face[0] == v || face[1] == v || face[2] == v;
+  }
+
+  // Link condition: the vertices adjacent to both ends must be exactly the opposite vertices of the shared triangles,
+  // otherwise the collapse would pinch the surface.
+  bool preserves_topology(uint32_t v0, uint32_t v1) {
+    size_t shared_faces = 0;
+    for (const uint32_t f : vertex_faces_[v0]) {
+      if (face_alive_[f] && contains(faces_[f], v1)) {
+        ++shared_faces;
+      }
+    }
+
+    collect_neighbours(v0, neighbours0_);
+    collect_neighbours(v1, neighbours1_);
+    common_.clear();
+    std::ranges::set_intersection(neighbours0_, neighbours1_, std::back_inserter(common_));
+    return shared_faces > 0 && common_.size() == shared_faces;
+  }
+
+  bool flips_faces(uint32_t v, uint32_t other, const glm::dvec3& target) const {
+    for (const uint32_t f : vertex_faces_[v]) {
+      if (!face_alive_[f] || contains(faces_[f], other)) {
+        continue;
+      }
+
+      const auto& face        = faces_[f];
+      const glm::dvec3 before = face_normal(face);
+      std::array<glm::dvec3, 3> p{};
+      for (size_t i = 0; i < 3; ++i) {
+        p[i] = face[i] == v ? target : positions_[face[i]];
+      }
+      const glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+      const double lengths = glm::length(before) * glm::length(after);
+      if (lengths <= std::numeric_limits<double>::min() || glm::dot(before, after) < kMinFlipCos * lengths) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void try_collapse(const Collapse& collapse) {
+    const uint32_t v0 = collapse.v0;
+    const uint32_t v1 = collapse.v1;
+    if (!preserves_topology(v0, v1) || flips_faces(v0, v1, collapse.target) || flips_faces(v1, v0, collapse.target)) {
+      return;
+    }
+
+    // Attributes are interpolated at the projection of the new position onto the collapsed edge
+    const glm::dvec3 edge = positions_[v1] - positions_[v0];
+    const double t = std::clamp(glm::dot(collapse.target - positions_[v0], edge) / glm::dot(edge, edge), 0.0, 1.0);
+    const auto tf  = static_cast<float>(t);
+    const glm::vec3 n = glm::mix(normals_[v0], normals_[v1], tf);
+    normals_[v0]      = glm::length(n) > 0.0F ? glm::normalize(n) : normals_[v0];
+    uvs_[v0]          = glm::mix(uvs_[v0], uvs_[v1], tf);
+    positions_[v0]    = collapse.target;
+    quadrics_[v0] += quadrics_[v1];
+
+    for (const uint32_t f : vertex_faces_[v1]) {
+      if (!face_alive_[f]) {
+        continue;
+      }
+      if (contains(faces_[f], v0)) {
+        face_alive_[f] = false;
+        --live_faces_;
+        continue;
+      }
+      std::ranges::replace(faces_[f], v1, v0);
+      vertex_faces_[v0].push_back(f);
+    }
+    std::erase_if(vertex_faces_[v0], [this](uint32_t f) { return !face_alive_[f]; });
+    vertex_faces_[v1].clear();
+    vertex_alive_[v1] = false;
+    ++stamps_[v0];
+
+    collect_neighbours(v0, neighbours0_);
+    for (const uint32_t u : neighbours0_) {
+      push_collapse(v0, u);
+    }
+  }
+
+  std::vector<glm::dvec3> positions_;
+  std::vector<glm::vec3> normals_;
+  std::vector<glm::vec2> uvs_;
+  std::vector<Quadric> quadrics_;
+
+  std::vector<std::array<uint32_t, 3>> faces_;
+  std::vector<uint32_t> face_materials_;  // empty if the mesh has a single material
+  std::vector<bool> face_alive_;
+  std::vector<std::vector<uint32_t>> vertex_faces_;
+  std::vector<bool> vertex_alive_;
+  std::vector<uint32_t> stamps_;
+  size_t live_faces_ = 0;
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap_;
+
+  // Scratch buffers of the link condition
+  std::vector<uint32_t> neighbours0_, neighbours1_, common_;
+};
+
+}  // namespace
+
+IndexedMesh simplify_mesh(const IndexedMesh& mesh, const SimplificationOptions& options) {
+  const size_t target_faces =
+      options.target_triangle_count != 0
+          ? options.target_triangle_count
+          : static_cast<size_t>(std::ceil(static_cast<double>(mesh.triangle_count()) * options.target_ratio));
+  if (mesh.empty() || target_faces >= mesh.triangle_count()) {
+    return mesh;
+  }
+
+  const auto max_error = static_cast<double>(options.max_error);
+  EdgeCollapser collapser(mesh);
+  collapser.run(target_faces, max_error * max_error);
+  return collapser.result();
+}
+
+}  // namespace resin
@@ -0,0 +1,32 @@
+#ifndef RESIN_MESH_SIMPLIFIER_HPP
+#define RESIN_MESH_SIMPLIFIER_HPP
+
+#include <cstddef>
+#include <libresin/core/indexed_mesh.hpp>
+#include <limits>
+
+namespace resin {
+
+struct SimplificationOptions {
+  // Fraction of the input triangles to keep, ignored if target_triangle_count is set.
+  float target_ratio = 0.5F;
+
+  // Absolute triangle budget, 0 means the budget is derived from target_ratio.
+  size_t target_triangle_count = 0;
+
+  // Collapses whose quadric error (roughly the distance from the original surface, in world units) exceeds this bound
+  // are never performed, even if the triangle budget is not reached yet.
+  float max_error = std::numeric_limits<float>::infinity();
+};
+
+// Quadric error metric edge collapse (Garland & Heckbert). Every vertex accumulates the planes of its adjacent
+// triangles, edges are collapsed in the order of the smallest error of the merged quadric and the surviving vertex is
+// moved to the point minimizing that error. Collapses that would flip a triangle or change the topology are skipped,
+// open borders (e.g. where the surface leaves the bounding box) and seams between materials are kept in place by
+// penalty planes. Triangles keep their materials.
+// Cost: O(n log n), where n is the triangle count
+IndexedMesh simplify_mesh(const IndexedMesh& mesh, const SimplificationOptions& options);
+
+}  // namespace resin
+
+#endif  // RESIN_MESH_SIMPLIFIER_HPP
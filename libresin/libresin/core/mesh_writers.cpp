@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <libresin/core/mesh_writers.hpp>
+#include <libresin/utils/macros.hpp>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace resin {
+
+namespace {
+
+// All the binary formats below are little endian, the buffers are written as they are in memory
+static_assert(std::endian::native == std::endian::little, "Native mesh writers require a little endian host");
+
+// Batches small writes (e.g. STL records) into large ones, spans that are larger than the buffer go straight through.
+class BufferedWriter {
+ public:
+  explicit BufferedWriter(std::ostream& output) : output_(output) { buffer_.reserve(kCapacity); }
+  ~BufferedWriter() { flush(); }
+
+  DISABLE_COPY_AND_MOVE(BufferedWriter)
+
+  template <typename T>
+  void write(const T& value) {
+    write_bytes(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void write_span(std::span<const T> values) {
+    write_bytes(values.data(), values.size_bytes());
+  }
+
+  void write_bytes(const void* data, size_t size) {
+    if (buffer_.size() + size > kCapacity) {
+      flush();
+    }
+    if (size >= kCapacity) {
+      output_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+      return;
+    }
+    const auto* bytes = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  void flush() {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+
+ private:
+  static constexpr size_t kCapacity = size_t{1} << 20U;
+
+  std::ostream& output_;
+  std::vector<char> buffer_;
+};
+
+// glTF constants
+constexpr int kGLTFFloat             = 5126;
+constexpr int kGLTFUnsignedInt       = 5125;
+constexpr int kGLTFArrayBuffer       = 34962;
+constexpr int kGLTFElementBuffer     = 34963;
+constexpr int kGLTFTriangles         = 4;
+constexpr uint32_t kGLBMagic         = 0x46546C67;  // "glTF"
+constexpr uint32_t kGLBVersion       = 2;
+constexpr uint32_t kGLBChunkJSON     = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kGLBChunkBIN      = 0x004E4942;  // "BIN\0"
+constexpr size_t kGLBHeaderSize      = 12;
+constexpr size_t kGLBChunkHeaderSize = 8;
+
+// Index buffer of a level with the triangles grouped by material. Meshes with a single material keep their own buffer.
+struct GLBLevel {
+  const IndexedMesh& mesh;
+  std::vector<MaterialRange> ranges;
+  std::vector<uint32_t> sorted_indices;
+
+  std::span<const uint32_t> indices() const {
+    return sorted_indices.empty() ? std::span<const uint32_t>(mesh.indices) : sorted_indices;
+  }
+};
+
+GLBLevel sort_level(const IndexedMesh& mesh) {
+  GLBLevel level{.mesh = mesh};
+  std::vector<uint32_t> sorted_triangles;
+  level.ranges = sort_triangles_by_material(mesh, sorted_triangles);
+  if (level.ranges.size() > 1) {
+    level.sorted_indices.reserve(mesh.indices.size());
+    for (const uint32_t t : sorted_triangles) {
+      const auto first = mesh.indices.begin() + (3 * static_cast<ptrdiff_t>(t));
+      level.sorted_indices.insert(level.sorted_indices.end(), first, first + 3);
+    }
+  }
+  return level;
+}
+
+// Blinn-Phong has no direct PBR counterpart, the exponent is mapped with the usual alpha = sqrt(2 / (n + 2)).
+nlohmann::json gltf_material(const MeshExportMaterial& material) {
+  const Material& mat = material.material;
+  return {
+      {"name", material.name},
+      {"pbrMetallicRoughness",
+       {
+           {"baseColorFactor", {mat.albedo.r, mat.albedo.g, mat.albedo.b, 1.0F}},
+           {"metallicFactor", 0.0F},
+           {"roughnessFactor", std::clamp(std::sqrt(2.0F / (mat.specularExponent + 2.0F)), 0.0F, 1.0F)},
+       }},
+      {"extras",
+       {
+           {"ambientFactor", mat.ambientFactor},
+           {"diffuseFactor", mat.diffuseFactor},
+           {"specularFactor", mat.specularFactor},
+           {"specularExponent", mat.specularExponent},
+       }},
+  };
+}
+
+}  // namespace
+
+void write_stl(std::ostream& output, const IndexedMesh& mesh) {
+  BufferedWriter writer(output);
+
+  // The header must not start with "solid", otherwise readers may take the file for an ASCII STL
+  std::array<char, 80> header{};
+  constexpr std::string_view kHeader = "resin binary STL";
+  std::ranges::copy(kHeader, header.begin());
+  writer.write(header);
+  writer.write(static_cast<uint32_t>(mesh.triangle_count()));
+
+  // normal, 3 vertices and the attribute byte count
+  constexpr size_t kRecordSize = (12 * sizeof(float)) + sizeof(uint16_t);
+  std::array<char, kRecordSize> record{};
+  for (size_t t = 0; t < mesh.triangle_count(); ++t) {
+    const glm::vec3& a = mesh.vertices[mesh.indices[3 * t]];
+    const glm::vec3& b = mesh.vertices[mesh.indices[(3 * t) + 1]];
+    const glm::vec3& c = mesh.vertices[mesh.indices[(3 * t) + 2]];
+    const glm::vec3 n  = glm::cross(b - a, c - a);
+    const float len    = glm::length(n);
+
+    const std::array<glm::vec3, 4> values = {len > 0.0F ? n / len : glm::vec3(0.0F), a, b, c};
+    std::memcpy(record.data(), values.data(), sizeof(values));
+    writer.write(record);
+  }
+}
+
+void write_ply(std::ostream& output, const IndexedMesh& mesh) {
+  BufferedWriter writer(output);
+
+  const std::string header = std::format(
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "comment resin\n"
+      "element vertex {}\n"
+      "property float x\nproperty float y\nproperty float z\n"
+      "property float nx\nproperty float ny\nproperty float nz\n"
+      "property float s\nproperty float t\n"
+      "element face {}\n"
+      "property list uchar uint vertex_indices\n"
+      "property uint material_index\n"
+      "end_header\n",
+      mesh.vertices.size(), mesh.triangle_count());
+  writer.write_bytes(header.data(), header.size());
+
+  std::array<float, 8> vertex{};
+  for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+    std::memcpy(vertex.data(), &mesh.vertices[v], sizeof(glm::vec3));
+    std::memcpy(vertex.data() + 3, &mesh.normals[v], sizeof(glm::vec3));
+    std::memcpy(vertex.data() + 6, &mesh.uvs[v], sizeof(glm::vec2));
+    writer.write(vertex);
+  }
+
+  // vertex count, 3 indices and the material
+  constexpr size_t kFaceSize = sizeof(uint8_t) + (4 * sizeof(uint32_t));
+  std::array<char, kFaceSize> face{};
+  face[0] = 3;
+  for (size_t t = 0; t < mesh.triangle_count(); ++t) {
+    const uint32_t material = mesh.triangle_material(t);
+    std::memcpy(face.data() + 1, &mesh.indices[3 * t], 3 * sizeof(uint32_t));
+    std::memcpy(face.data() + 1 + (3 * sizeof(uint32_t)), &material, sizeof(uint32_t));
+    writer.write(face);
+  }
+}
+
+void write_glb(std::ostream& output, const IndexedMesh& mesh, std::span<const IndexedMesh> lods,
+               std::span<const MeshExportMaterial> materials) {
+  std::vector<GLBLevel> levels;
+  levels.reserve(1 + lods.size());
+  levels.push_back(sort_level(mesh));
+  for (const auto& lod : lods) {
+    levels.push_back(sort_level(lod));
+  }
+
+  nlohmann::json buffer_views   = nlohmann::json::array();
+  nlohmann::json accessors      = nlohmann::json::array();
+  nlohmann::json meshes         = nlohmann::json::array();
+  nlohmann::json nodes          = nlohmann::json::array();
+  nlohmann::json gltf_materials = nlohmann::json::array();
+  std::unordered_map<uint32_t, size_t> material_index;
+  size_t bin_size = 0;
+
+  auto add_view = [&](size_t byte_length, int target) {
+    buffer_views.push_back({{"buffer", 0}, {"byteOffset", bin_size}, {"byteLength", byte_length}, {"target", target}});
+    bin_size += byte_length;
+    return buffer_views.size() - 1;
+  };
+  auto add_vertex_accessor = [&](size_t view, size_t count, std::string_view type) {
+    accessors.push_back({{"bufferView", view}, {"componentType", kGLTFFloat}, {"count", count}, {"type", type}});
+    return accessors.size() - 1;
+  };
+  auto scene_material = [&](uint32_t id) {
+    auto [it, inserted] = material_index.try_emplace(id, gltf_materials.size());
+    if (inserted) {
+      const auto found = std::ranges::find(materials, id, &MeshExportMaterial::id);
+      gltf_materials.push_back(found == materials.end()
+                                   ? gltf_material({.id = id, .name = "default", .material = Material()})
+                                   : gltf_material(*found));
+    }
+    return it->second;
+  };
+
+  for (size_t l = 0; l < levels.size(); ++l) {
+    const GLBLevel& level = levels[l];
+    nlohmann::json node   = {{"name", levels.size() == 1 ? std::string("mesh") : std::format("mesh_LOD{}", l)}};
+    if (level.mesh.empty()) {
+      nodes.push_back(std::move(node));
+      continue;
+    }
+
+    const size_t vertex_count   = level.mesh.vertices.size();
+    const size_t positions_view = add_view(vertex_count * sizeof(glm::vec3), kGLTFArrayBuffer);
+    const size_t normals_view   = add_view(vertex_count * sizeof(glm::vec3), kGLTFArrayBuffer);
+    const size_t uvs_view       = add_view(vertex_count * sizeof(glm::vec2), kGLTFArrayBuffer);
+    const size_t indices_view   = add_view(level.indices().size_bytes(), kGLTFElementBuffer);
+
+    const size_t positions = add_vertex_accessor(positions_view, vertex_count, "VEC3");
+    const size_t normals   = add_vertex_accessor(normals_view, vertex_count, "VEC3");
+    const size_t uvs       = add_vertex_accessor(uvs_view, vertex_count, "VEC2");
+
+    // POSITION accessors are required to have bounds
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for (const auto& v : level.mesh.vertices) {
+      min = glm::min(min, v);
+      max = glm::max(max, v);
+    }
+    accessors[positions]["min"] = {min.x, min.y, min.z};
+    accessors[positions]["max"] = {max.x, max.y, max.z};
+
+    nlohmann::json primitives = nlohmann::json::array();
+    for (const auto& range : level.ranges) {
+      accessors.push_back({{"bufferView", indices_view},
+                           {"byteOffset", range.first * 3 * sizeof(uint32_t)},
+                           {"componentType", kGLTFUnsignedInt},
+                           {"count", range.count * 3},
+                           {"type", "SCALAR"}});
+      primitives.push_back({{"attributes", {{"POSITION", positions}, {"NORMAL", normals}, {"TEXCOORD_0", uvs}}},
+                            {"indices", accessors.size() - 1},
+                            {"material", scene_material(range.material)},
+                            {"mode", kGLTFTriangles}});
+    }
+
+    node["mesh"] = meshes.size();
+    meshes.push_back({{"name", node["name"]}, {"primitives", std::move(primitives)}});
+    nodes.push_back(std::move(node));
+  }
+
+  nlohmann::json scene = {{"nodes", nlohmann::json::array()}};
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    scene["nodes"].push_back(i);
+  }
+
+  // glTF forbids empty top level arrays
+  nlohmann::json gltf = {{"asset", {{"version", "2.0"}, {"generator", "resin"}}}, {"scene", 0}};
+  gltf["scenes"]      = nlohmann::json::array();
+  gltf["scenes"].push_back(std::move(scene));
+  gltf["nodes"] = std::move(nodes);
+  if (bin_size > 0) {
+    gltf["meshes"]      = std::move(meshes);
+    gltf["materials"]   = std::move(gltf_materials);
+    gltf["accessors"]   = std::move(accessors);
+    gltf["bufferViews"] = std::move(buffer_views);
+    gltf["buffers"]     = nlohmann::json::array();
+    gltf["buffers"].push_back({{"byteLength", bin_size}});
+  }
+
+  // Chunks are 4 byte aligned, JSON is padded with spaces. All the binary views are multiples of 4 bytes already.
+  std::string json_chunk = gltf.dump();
+  json_chunk.resize((json_chunk.size() + 3) & ~size_t{3}, ' ');
+  const size_t total_size = kGLBHeaderSize + kGLBChunkHeaderSize + json_chunk.size() +
+                            (bin_size > 0 ? kGLBChunkHeaderSize + bin_size : 0);
+
+  BufferedWriter writer(output);
+  writer.write(kGLBMagic);
+  writer.write(kGLBVersion);
+  writer.write(static_cast<uint32_t>(total_size));
+  writer.write(static_cast<uint32_t>(json_chunk.size()));
+  writer.write(kGLBChunkJSON);
+  writer.write_bytes(json_chunk.data(), json_chunk.size());
+  if (bin_size == 0) {
+    return;
+  }
+
+  // Same order as the buffer views
+  writer.write(static_cast<uint32_t>(bin_size));
+  writer.write(kGLBChunkBIN);
+  for (const auto& level : levels) {
+    if (level.mesh.empty()) {
+      continue;
+    }
+    writer.write_span(std::span(level.mesh.vertices));
+    writer.write_span(std::span(level.mesh.normals));
+    writer.write_span(std::span(level.mesh.uvs));
+    writer.write_span(level.indices());
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,57 @@
+#ifndef RESIN_MESH_WRITERS_HPP
+#define RESIN_MESH_WRITERS_HPP
+
+#include <cstdint>
+#include <libresin/core/indexed_mesh.hpp>
+#include <libresin/core/material.hpp>
+#include <libresin/utils/enum_mapper.hpp>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace resin {
+
+// Material of the exported tree, copied when the export is set up so the tree may change while it runs.
+struct MeshExportMaterial {
+  uint32_t id;  // raw material id, matches the material ids of the meshes
+  std::string name;
+  Material material;
+};
+
+// Formats written without building an Assimp scene. The buffers of the meshes are streamed straight to the output,
+// the only intermediate data is the index buffer sorted by material.
+enum class NativeMeshFormat : uint8_t {
+  STL    = 0,
+  PLY    = 1,
+  GLB    = 2,
+  _Count = 3,  // NOLINT
+};
+
+// Same ids as the Assimp export formats they replace.
+constexpr StringEnumMapper<NativeMeshFormat> kNativeMeshFormatIds({
+    {NativeMeshFormat::STL, "stlb"},  //
+    {NativeMeshFormat::PLY, "plyb"},  //
+    {NativeMeshFormat::GLB, "glb2"},  //
+});
+
+inline std::optional<NativeMeshFormat> native_mesh_format(std::string_view format) {
+  return kNativeMeshFormatIds.from_value(format);
+}
+
+// Binary STL. The format has neither materials nor shared vertices, every triangle stores its face normal and its 3
+// positions.
+void write_stl(std::ostream& output, const IndexedMesh& mesh);
+
+// Binary little endian PLY with positions, normals and UVs. Faces carry their material id.
+void write_ply(std::ostream& output, const IndexedMesh& mesh);
+
+// glTF 2.0 binary container. The mesh and every LOD become nodes named mesh_LOD<n> (just "mesh" without LODs) with one
+// primitive per material, the primitives of a level share its vertex buffers.
+void write_glb(std::ostream& output, const IndexedMesh& mesh, std::span<const IndexedMesh> lods,
+               std::span<const MeshExportMaterial> materials);
+
+}  // namespace resin
+
+#endif  // RESIN_MESH_WRITERS_HPP
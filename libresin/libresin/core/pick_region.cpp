@@ -0,0 +1,127 @@
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <glm/common.hpp>
+#include <libresin/core/pick_region.hpp>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+constexpr size_t kInitialLassoCapacity = 256;
+
+// Viewport coordinates have the origin in the top left corner, the attachment in the bottom left one
+inline glm::vec2 to_attachment(const glm::vec2& point, size_t height) {
+  return {point.x, static_cast<float>(height) - point.y};
+}
+
+}  // namespace
+
+PickRegionBounds pick_region_bounds(std::span<const glm::vec2> points, size_t width, size_t height) {
+  if (points.empty()) {
+    return PickRegionBounds{.min = glm::ivec2(0), .max = glm::ivec2(0)};
+  }
+
+  glm::vec2 min = to_attachment(points.front(), height);
+  glm::vec2 max = min;
+  for (const auto& point : points) {
+    min = glm::min(min, to_attachment(point, height));
+    max = glm::max(max, to_attachment(point, height));
+  }
+
+  const glm::ivec2 size(static_cast<int>(width), static_cast<int>(height));
+  return PickRegionBounds{.min = glm::clamp(glm::ivec2(glm::floor(min)), glm::ivec2(0), size),
+                          .max = glm::clamp(glm::ivec2(glm::ceil(max)), glm::ivec2(0), size)};
+}
+
+std::vector<size_t> decode_node_mask(std::span<const uint32_t> mask) {
+  std::vector<size_t> ids;
+  for (size_t word = 0; word < mask.size(); ++word) {
+    for (uint32_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+      ids.push_back((word * 32) + static_cast<size_t>(std::countr_zero(bits)));
+    }
+  }
+  return ids;
+}
+
+PickRegionReducer::PickRegionReducer(ShaderResource shader_resource)
+    : program_("pick_region", std::move(shader_resource)),
+      lasso_buffer_(std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec2) * kInitialLassoCapacity, kLassoBinding,
+                                                          GL_DYNAMIC_DRAW)),
+      lasso_capacity_(kInitialLassoCapacity) {}
+
+void PickRegionReducer::request_box(const ViewportFramebuffer& framebuffer, const glm::vec2& from, const glm::vec2& to,
+                                    size_t max_node_count) {
+  const std::array<glm::vec2, 2> corners = {from, to};
+  dispatch(framebuffer, pick_region_bounds(corners, framebuffer.width(), framebuffer.height()), 0, max_node_count);
+}
+
+void PickRegionReducer::request_lasso(const ViewportFramebuffer& framebuffer, std::span<const glm::vec2> points,
+                                      size_t max_node_count) {
+  if (points.size() > lasso_capacity_) {
+    lasso_capacity_ = std::bit_ceil(points.size());
+    lasso_buffer_ =
+        std::make_unique<ShaderStorageBuffer>(sizeof(glm::vec2) * lasso_capacity_, kLassoBinding, GL_DYNAMIC_DRAW);
+  }
+
+  std::vector<glm::vec2> attachment_points;
+  attachment_points.reserve(points.size());
+  for (const auto& point : points) {
+    attachment_points.push_back(to_attachment(point, framebuffer.height()));
+  }
+  lasso_buffer_->set_data(attachment_points.data(), sizeof(glm::vec2) * attachment_points.size());
+
+  dispatch(framebuffer, pick_region_bounds(points, framebuffer.width(), framebuffer.height()),
+           static_cast<int>(points.size()), max_node_count);
+}
+
+std::optional<std::vector<size_t>> PickRegionReducer::poll() {
+  if (!is_pending_ || !readback_.is_ready()) {
+    return std::nullopt;
+  }
+  is_pending_ = false;
+
+  std::vector<uint32_t> mask(readback_.size() / sizeof(uint32_t));
+  readback_.read(mask.data(), readback_.size());
+  return decode_node_mask(mask);
+}
+
+void PickRegionReducer::dispatch(const ViewportFramebuffer& framebuffer, const PickRegionBounds& bounds,
+                                 int lasso_point_count, size_t max_node_count) {
+  const size_t word_count = std::max<size_t>((max_node_count + 31) / 32, 1);
+  if (word_count > mask_word_count_) {
+    node_mask_buffer_ =
+        std::make_unique<ShaderStorageBuffer>(sizeof(uint32_t) * word_count, kNodeMaskBinding, GL_STREAM_READ);
+    mask_word_count_ = word_count;
+  }
+
+  // The bindings are shared with the other compute passes, so they are restored before every dispatch
+  node_mask_buffer_->bind();
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+  node_mask_buffer_->unbind();
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kNodeMaskBinding, node_mask_buffer_->id());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kLassoBinding, lasso_buffer_->id());
+
+  if (!bounds.empty()) {
+    const glm::ivec2 size = bounds.max - bounds.min;
+    program_.bind();
+    program_.set_uniform("u_regionMin", bounds.min);
+    program_.set_uniform("u_regionMax", bounds.max);
+    program_.set_uniform("u_lassoPointCount", lasso_point_count);
+    program_.set_uniform("u_maskWordCount", static_cast<uint32_t>(word_count));
+    glBindImageTexture(0, framebuffer.mouse_pick_texture(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32I);
+    glDispatchCompute((static_cast<GLuint>(size.x) + kLocalSize - 1) / kLocalSize,
+                      (static_cast<GLuint>(size.y) + kLocalSize - 1) / kLocalSize, 1);
+    program_.unbind();
+  }
+
+  // An empty region still goes through the readback, so every request gets its (empty) result
+  readback_.request(node_mask_buffer_->id(), sizeof(uint32_t) * word_count);
+  is_pending_ = true;
+}
+
+}  // namespace resin
@@ -0,0 +1,73 @@
+#ifndef RESIN_PICK_REGION_HPP
+#define RESIN_PICK_REGION_HPP
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <libresin/core/buffer_readback.hpp>
+#include <libresin/core/framebuffer.hpp>
+#include <libresin/core/resources/shader_resource.hpp>
+#include <libresin/core/shader.hpp>
+#include <libresin/core/shader_storage_buffer.hpp>
+#include <libresin/utils/macros.hpp>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace resin {
+
+// Pixel box [min, max) of the attachment covered by the points given in viewport coordinates (origin in the top left
+// corner, like sample_mouse_pick), clamped to the attachment. Empty if min >= max on any axis.
+struct PickRegionBounds {
+  glm::ivec2 min;
+  glm::ivec2 max;
+
+  inline bool empty() const { return min.x >= max.x || min.y >= max.y; }
+};
+PickRegionBounds pick_region_bounds(std::span<const glm::vec2> points, size_t width, size_t height);
+
+// Raw ids of the set bits of the node mask, in increasing order.
+std::vector<size_t> decode_node_mask(std::span<const uint32_t> mask);
+
+// Box and lasso selection in the viewport. The pick attachment is reduced on the GPU (pick_region.comp) to a bitmask
+// of the node ids visible in the region, which is the only thing read back, with a fenced readback polled every frame.
+class PickRegionReducer {
+ public:
+  explicit PickRegionReducer(ShaderResource shader_resource);
+
+  DISABLE_COPY_AND_MOVE(PickRegionReducer)
+
+  // Both replace the pending request. The corners and the lasso points are in viewport coordinates, max_node_count
+  // is SDFTree::max_node_count.
+  void request_box(const ViewportFramebuffer& framebuffer, const glm::vec2& from, const glm::vec2& to,
+                   size_t max_node_count);
+  void request_lasso(const ViewportFramebuffer& framebuffer, std::span<const glm::vec2> points, size_t max_node_count);
+
+  // Raw ids of the nodes visible in the region once the GPU is done, never blocks.
+  std::optional<std::vector<size_t>> poll();
+
+  inline ComputeShaderProgram& program() { return program_; }
+
+ private:
+  void dispatch(const ViewportFramebuffer& framebuffer, const PickRegionBounds& bounds, int lasso_point_count,
+                size_t max_node_count);
+
+  // Bindings of pick_region.comp
+  static constexpr size_t kNodeMaskBinding = 14;
+  static constexpr size_t kLassoBinding    = 15;
+  static constexpr GLuint kLocalSize       = 16;
+
+  ComputeShaderProgram program_;
+  std::unique_ptr<ShaderStorageBuffer> node_mask_buffer_;
+  std::unique_ptr<ShaderStorageBuffer> lasso_buffer_;
+  size_t mask_word_count_ = 0;
+  size_t lasso_capacity_  = 0;
+  BufferReadback readback_;
+  bool is_pending_ = false;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_PICK_REGION_HPP
@@ -38,4 +38,8 @@ void Raycaster::draw_call() const {  // NOLINT
   glDrawElements(GL_TRIANGLES, kIndices.size(), GL_UNSIGNED_INT, nullptr);
 }
 
+void Raycaster::draw_call_instanced(GLsizei instance_count) const {  // NOLINT
+  glDrawElementsInstanced(GL_TRIANGLES, kIndices.size(), GL_UNSIGNED_INT, nullptr, instance_count);
+}
+
 }  // namespace resin
\ No newline at end of file
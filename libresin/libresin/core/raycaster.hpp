@@ -16,6 +16,7 @@ class Raycaster {
   void unbind() const;
 
   void draw_call() const;
+  void draw_call_instanced(GLsizei instance_count) const;
 
   Raycaster(const Raycaster&)            = delete;
   Raycaster(Raycaster&&)                 = delete;
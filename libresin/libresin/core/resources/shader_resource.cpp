@@ -1,5 +1,6 @@
 #include <cctype>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <libresin/core/resources/shader_resource.hpp>
 #include <libresin/utils/exceptions.hpp>
@@ -9,30 +10,45 @@
 #include <ranges>
 #include <string_view>
 #include <unordered_set>
+#include <vector>
 
 namespace resin {
-ShaderResource::ShaderResource(std::string&& content, ShaderType type, std::unordered_set<std::string>&& ext_defi_names,
-                               std::optional<std::string>&& version)
+ShaderResource::ShaderResource(std::filesystem::path path, std::string&& content, ShaderType type,
+                               ShaderExtDefiNames&& ext_defi_names, std::optional<std::string>&& version)
     : ext_defi_names_(std::move(ext_defi_names)),
+      path_(std::move(path)),
       version_(std::move(version)),
       raw_content_(std::move(content)),
       type_(type),
       is_dirty_(true) {}
 
-const std::unordered_set<std::string>& ShaderResource::get_ext_defi_names() const { return ext_defi_names_; }
+const ShaderExtDefiNames& ShaderResource::get_ext_defi_names() const { return ext_defi_names_; }
 
 void ShaderResource::set_ext_defi(std::string_view ext_defi_name, std::string&& defi_content) {
-  auto it = std::ranges::find(ext_defi_names_, ext_defi_name);
-  if (it == ext_defi_names_.end()) {
-    resin::Logger::warn("Shader resource could not find external definition named \"{}\"", ext_defi_name);
-    return;
+  auto it = ext_defis_.find(ext_defi_name);
+  if (it == ext_defis_.end()) {
+    auto name_it = ext_defi_names_.find(ext_defi_name);
+    if (name_it == ext_defi_names_.end()) {
+      resin::Logger::warn("Shader resource could not find external definition named \"{}\"", ext_defi_name);
+      return;
+    }
+    it = ext_defis_.emplace(*name_it, ExtDefi{.prefix = std::format("#define {} ", *name_it), .content = {}}).first;
   }
 
-  ext_defi_contents_[*it] = std::move(defi_content);
-  is_dirty_               = true;
+  it->second.content = std::move(defi_content);
+  is_dirty_          = true;
+}
+
+void ShaderResource::reload(const ShaderResource& source) {
+  ext_defi_names_ = source.ext_defi_names_;
+  std::erase_if(ext_defis_, [this](const auto& ext_defi) { return !ext_defi_names_.contains(ext_defi.first); });
+  version_     = source.version_;
+  raw_content_ = source.raw_content_;
+  type_        = source.type_;
+  is_dirty_    = true;
 }
 
-bool ShaderResource::is_glsl_ready() const { return ext_defi_contents_.size() == ext_defi_names_.size(); }
+bool ShaderResource::is_glsl_ready() const { return ext_defis_.size() == ext_defi_names_.size(); }
 
 const std::string& ShaderResource::get_raw() const { return raw_content_; }
 
@@ -42,19 +58,30 @@ const std::string& ShaderResource::get_glsl() const {
   }
 
   glsl_.clear();
-  if (version_ != std::nullopt) {
-    glsl_.append(version_.value());
-    glsl_.append("\n");
+  for (const std::string_view segment : get_glsl_segments()) {
+    glsl_.append(segment);
   }
-  for (const auto& ext_defi : ext_defi_contents_) {
-    glsl_.append(std::format("#define {} {}\n", ext_defi.first, ext_defi.second));
-  }
-  glsl_.append(raw_content_);
 
   is_dirty_ = false;
   return glsl_;
 }
 
+std::vector<std::string_view> ShaderResource::get_glsl_segments() const {
+  std::vector<std::string_view> segments;
+  segments.reserve((3 * ext_defis_.size()) + 3);
+  if (version_ != std::nullopt) {
+    segments.emplace_back(version_.value());
+    segments.emplace_back("\n");
+  }
+  for (const auto& ext_defi : ext_defis_) {
+    segments.emplace_back(ext_defi.second.prefix);
+    segments.emplace_back(ext_defi.second.content);
+    segments.emplace_back("\n");
+  }
+  segments.emplace_back(raw_content_);
+  return segments;
+}
+
 static ShaderType get_sh_type(const std::filesystem::path& path) {
   auto file_ext = path.extension().string();
   auto sh_type  = extension_to_shader_type(file_ext);
@@ -88,7 +115,7 @@ static std::string load_content(const std::filesystem::path& path) {
 
 void ShaderResourceManager::process_include_macro(const std::filesystem::path& sh_path, WordsStringViewIterator& it,
                                                   const WordsStringViewIterator& end, size_t curr_line,
-                                                  std::string& content, std::unordered_set<std::string>& defi_names) {
+                                                  std::string& content, ShaderExtDefiNames& defi_names) {
   if (it == end) {
     clear_log_throw(ShaderMacroInvalidArgumentsCountException(
         sh_path.string(), std::string(shader_macros::kExtDefiMacro), 0, 1, curr_line));
@@ -132,6 +159,7 @@ void ShaderResourceManager::process_include_macro(const std::filesystem::path& s
   visited_paths_.push_back(abs_path);
   auto res = get_res(abs_path);
   visited_paths_.pop_back();
+  files_[sh_path].includes.push_back(abs_path);
 
   content.append(res->get_raw());
   defi_names.insert(res->get_ext_defi_names().begin(), res->get_ext_defi_names().end());
@@ -139,7 +167,7 @@ void ShaderResourceManager::process_include_macro(const std::filesystem::path& s
 
 void ShaderResourceManager::process_ext_defi_macro(const std::filesystem::path& sh_path, WordsStringViewIterator& it,
                                                    const WordsStringViewIterator& end, size_t curr_line,
-                                                   std::unordered_set<std::string>& defi_names) {
+                                                   ShaderExtDefiNames& defi_names) {
   if (it == end) {
     clear_log_throw(ShaderMacroInvalidArgumentsCountException(
         sh_path.string(), std::string(shader_macros::kExtDefiMacro), 0, 1, curr_line));
@@ -191,19 +219,62 @@ std::optional<std::string> ShaderResourceManager::process_version_macro(const st
   return std::format("#version {}", arg1);
 }
 
+std::vector<std::filesystem::path> ShaderResourceManager::invalidate_modified() {
+  std::vector<std::filesystem::path> modified;
+  for (const auto& [path, file] : files_) {
+    std::error_code error;
+    const auto write_time = std::filesystem::last_write_time(path, error);
+    if (error || write_time != file.write_time) {
+      modified.push_back(path);
+    }
+  }
+
+  // The includes form a DAG, so the loop ends once no other file includes a dropped one
+  for (size_t i = 0; i < modified.size(); ++i) {
+    for (const auto& [path, file] : files_) {
+      if (std::ranges::find(file.includes, modified[i]) != file.includes.end() &&
+          std::ranges::find(modified, path) == modified.end()) {
+        modified.push_back(path);
+      }
+    }
+  }
+
+  for (const auto& path : modified) {
+    files_.erase(path);
+    cache_.erase(path);
+    Logger::info("Shader \"{}\" was modified and dropped from the cache.", path.string());
+  }
+  return modified;
+}
+
 ShaderResource ShaderResourceManager::load_res(const std::filesystem::path& path) {
   auto sh_type = get_sh_type(path);
-  auto content = load_content(path);
+
+  // Read before the content, so that a write made in the meantime is noticed by invalidate_modified
+  std::error_code error;
+  const auto write_time = std::filesystem::last_write_time(path, error);
+  auto content          = load_content(path);
+  files_[path]          = FileState{.write_time = write_time, .includes = {}};
 
   auto lines = make_lines_view(content) | std::views::enumerate;
 
-  std::unordered_set<std::string> defi_names;
+  ShaderExtDefiNames defi_names;
   std::string preprocessed_content;
   std::optional<std::string> version;
+  preprocessed_content.reserve(content.size());
 
   for (auto const [l, line_str] : lines) {
+    // Only the lines that may start with a macro are split into words
+    const size_t first = line_str.find_first_not_of(" \t");
+    if (first != std::string_view::npos && line_str[first] != '#') {
+      preprocessed_content.append(line_str);
+      preprocessed_content.append("\n");
+      continue;
+    }
+
+    // The words are split on spaces only, so the indentation is cut off first
     auto line  = static_cast<size_t>(l);
-    auto words = make_words_view(line_str);
+    auto words = make_words_view(first == std::string_view::npos ? line_str : line_str.substr(first));
 
     auto it  = words.begin();
     auto end = words.end();
@@ -240,7 +311,7 @@ ShaderResource ShaderResourceManager::load_res(const std::filesystem::path& path
     clear_log_throw(ShaderAbsentVersionException(path.string()));
   }
 
-  return ShaderResource(std::move(preprocessed_content), sh_type, std::move(defi_names), std::move(version));
+  return ShaderResource(path, std::move(preprocessed_content), sh_type, std::move(defi_names), std::move(version));
 }
 
 }  // namespace resin
@@ -4,9 +4,12 @@
 #include <array>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <libresin/core/resources/resource_manager.hpp>
 #include <libresin/utils/exceptions.hpp>
+#include <libresin/utils/string_hash.hpp>
 #include <libresin/utils/string_views.hpp>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
@@ -48,13 +51,20 @@ inline std::optional<ShaderType> extension_to_shader_type(std::string_view exten
   return std::nullopt;
 }
 
+using ShaderExtDefiNames = std::unordered_set<std::string, StringHash, std::equal_to<>>;
+
+// The GLSL code is kept as segments: the version macro, the external definitions and the content with the inserted
+// dependencies. Setting a definition replaces its segment only, and the segments are passed to the GL as they are, so
+// the content, which may be megabytes long, is not copied when e.g. the SDF code of the scene changes.
 class ShaderResource {
  public:
   ShaderResource() = delete;
-  explicit ShaderResource(std::string&& content, ShaderType type, std::unordered_set<std::string>&& ext_defi_names,
-                          std::optional<std::string>&& version);
+  explicit ShaderResource(std::filesystem::path path, std::string&& content, ShaderType type,
+                          ShaderExtDefiNames&& ext_defi_names, std::optional<std::string>&& version);
+
+  const ShaderExtDefiNames& get_ext_defi_names() const;
 
-  const std::unordered_set<std::string>& get_ext_defi_names() const;
+  // Cost: O(1) on average, the content is moved in
   void set_ext_defi(std::string_view ext_defi_name, std::string&& defi_content);
 
   // Checks if all external definitions has been defined.
@@ -64,16 +74,34 @@ class ShaderResource {
   const std::string& get_raw() const;
 
   // Returns glsl shader with inserted dependencies, external defintions and version macro.
+  // Cost: O(n) if any of the segments changed since the last call, where n is the length of the shader
   const std::string& get_glsl() const;
 
+  // Segments of get_glsl in order, valid until the resource is changed.
+  // Cost: O(d), where d is the number of the external definitions
+  std::vector<std::string_view> get_glsl_segments() const;
+
   inline ShaderType get_type() const { return type_; }
 
+  // Path of the file the shader was loaded from
+  inline const std::filesystem::path& get_path() const { return path_; }
+
+  // Takes the content of a newer load of the same file. The values of the external definitions that are still declared
+  // are kept.
+  void reload(const ShaderResource& source);
+
   inline std::string_view get_extension() const { return kShaderTypeToExtensionMap[static_cast<uint8_t>(type_)]; }
 
  private:
-  std::unordered_set<std::string> ext_defi_names_;
-  std::unordered_map<std::string, std::string> ext_defi_contents_;
+  struct ExtDefi {
+    std::string prefix;  // #define and the name
+    std::string content;
+  };
+
+  ShaderExtDefiNames ext_defi_names_;
+  std::unordered_map<std::string, ExtDefi, StringHash, std::equal_to<>> ext_defis_;
 
+  std::filesystem::path path_;
   std::optional<std::string> version_;
   std::string raw_content_;
   ShaderType type_;
@@ -86,6 +114,12 @@ class ShaderResourceManager : public ResourceManager<ShaderResource> {
  public:
   ~ShaderResourceManager() override {}
 
+  // Drops the cached shaders whose files were modified since they were loaded, along with the shaders including them
+  // directly or indirectly, and returns their paths. Loading a dropped shader again reads only the modified files, the
+  // unchanged includes are taken from the cache.
+  // Cost: O(f + i), where f is the number of the cached files and i the number of their includes
+  std::vector<std::filesystem::path> invalidate_modified();
+
  protected:
   ShaderResource load_res(const std::filesystem::path& path) override;
 
@@ -98,16 +132,22 @@ class ShaderResourceManager : public ResourceManager<ShaderResource> {
 
   void process_include_macro(const std::filesystem::path& sh_path, WordsStringViewIterator& it,
                              const WordsStringViewIterator& end, size_t curr_line, std::string& content,
-                             std::unordered_set<std::string>& defi_names);
+                             ShaderExtDefiNames& defi_names);
   void process_ext_defi_macro(const std::filesystem::path& sh_path, WordsStringViewIterator& it,
                               const WordsStringViewIterator& end, size_t curr_line,
-                              std::unordered_set<std::string>& defi_names);
+                              ShaderExtDefiNames& defi_names);
   std::optional<std::string> process_version_macro(const std::filesystem::path& sh_path, ShaderType sh_type,
                                                    WordsStringViewIterator& it, const WordsStringViewIterator& end,
                                                    size_t curr_line);
 
  private:
+  struct FileState {
+    std::filesystem::file_time_type write_time;
+    std::vector<std::filesystem::path> includes;  // direct includes only
+  };
+
   std::vector<std::filesystem::path> visited_paths_;
+  std::unordered_map<std::filesystem::path, FileState> files_;
 };
 
 }  // namespace resin
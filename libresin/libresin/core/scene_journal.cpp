@@ -0,0 +1,714 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <libresin/core/scene_journal.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/utils/logger.hpp>
+#include <limits>
+#include <span>
+#include <system_error>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+constexpr uint32_t kNoKey = std::numeric_limits<uint32_t>::max();
+
+constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFNVPrime       = 1099511628211ULL;
+
+enum class EntryType : uint32_t {
+  NodeSet        = 0,  // key, parent key, previous sibling key, NodeRecord, name
+  NodeRemove     = 1,  // key
+  MaterialSet    = 2,  // MaterialRecord, name
+  MaterialRemove = 3,  // key
+  LightSet       = 4,  // key, LightRecord, name
+  LightRemove    = 5,  // key
+};
+
+struct BatchHeader {
+  uint32_t size;
+  uint32_t padding;
+  uint64_t checksum;  // FNV-1a of the entries
+};
+
+uint64_t fnv1a(std::span<const uint8_t> data) {
+  uint64_t hash = kFNVOffsetBasis;
+  for (const uint8_t byte : data) {
+    hash = (hash ^ byte) * kFNVPrime;
+  }
+  return hash;
+}
+
+template <typename T>
+bool equal_records(const T& lhs, const T& rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+template <typename T>
+void append_value(std::vector<uint8_t>& data, const T& value) {
+  const size_t offset = data.size();
+  data.resize(offset + sizeof(T));
+  std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+void append_name(std::vector<uint8_t>& data, std::string_view name) {
+  append_value(data, static_cast<uint32_t>(name.size()));
+  data.insert(data.end(), name.begin(), name.end());
+}
+
+class JournalReader {
+ public:
+  explicit JournalReader(std::span<const uint8_t> data) : data_(data) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (data_.size() - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool read_name(std::string& name) {
+    uint32_t length = 0;
+    if (!read(length) || data_.size() - offset_ < length) {
+      return false;
+    }
+    name.assign(reinterpret_cast<const char*>(data_.data() + offset_), length);  // NOLINT
+    offset_ += length;
+    return true;
+  }
+
+  std::optional<std::span<const uint8_t>> read_bytes(size_t size) {
+    if (data_.size() - offset_ < size) {
+      return std::nullopt;
+    }
+    auto bytes = data_.subspan(offset_, size);
+    offset_ += size;
+    return bytes;
+  }
+
+  inline bool at_end() const { return offset_ == data_.size(); }
+
+ private:
+  std::span<const uint8_t> data_;
+  size_t offset_ = 0;
+};
+
+std::optional<std::vector<uint8_t>> read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Written to a temporary file first, so the file is never read half written
+bool write_file(const std::filesystem::path& path, std::span<const uint8_t> data) {
+  const std::filesystem::path tmp_path = std::filesystem::path(path).concat(".tmp");
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), std::ssize(data));  // NOLINT
+    if (!file) {
+      Logger::warn("Could not write the autosave file {}", tmp_path.string());
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    Logger::warn("Could not write the autosave file {}: {}", path.string(), ec.message());
+    std::filesystem::remove(tmp_path, ec);
+    return false;
+  }
+  return true;
+}
+
+class PrefabReferenceFinder : public ISDFTreeNodeVisitor {
+ public:
+  void visit_prefab_reference(PrefabReferenceNode& node) override { reference_ = &node; }
+
+  inline PrefabReferenceNode* reference() const { return reference_; }
+
+ private:
+  PrefabReferenceNode* reference_ = nullptr;
+};
+
+// Snapshot tables with the tree replaced by nodes that can be moved around by the keys of the journal
+class JournalReplay {
+ public:
+  JournalReplay(binary::SceneTables tables, std::span<const uint32_t> node_keys, std::span<const uint32_t> light_keys)
+      : tables_(std::move(tables)) {
+    tree_end_ = tables_.prefabs.empty() ? tables_.nodes.size() : tables_.prefabs.front().root;
+    if (tree_end_ == 0 || node_keys.size() != tree_end_ || light_keys.size() != tables_.lights.size()) {
+      valid_ = false;
+      return;
+    }
+
+    root_ = node_keys.front();
+    for (size_t i = 0; i < tree_end_; ++i) {
+      const binary::NodeRecord& record = tables_.nodes[i];
+      if ((record.parent == binary::kNoParent) != (i == 0) || (i > 0 && record.parent >= i) ||
+          nodes_.contains(node_keys[i])) {
+        valid_ = false;
+        return;
+      }
+
+      const uint32_t parent = i == 0 ? kNoKey : node_keys[record.parent];
+      nodes_.emplace(node_keys[i],
+                     Node{.record = record, .name = tables_.node_names[i], .parent = parent, .children = {}});
+      if (parent != kNoKey) {
+        nodes_.at(parent).children.push_back(node_keys[i]);
+      }
+    }
+
+    for (size_t i = 0; i < tables_.materials.size(); ++i) {
+      material_order_.push_back(tables_.materials[i].id);
+      materials_[tables_.materials[i].id] = {.record = tables_.materials[i], .name = tables_.material_names[i]};
+    }
+    for (size_t i = 0; i < tables_.lights.size(); ++i) {
+      light_order_.push_back(light_keys[i]);
+      lights_[light_keys[i]] = {.record = tables_.lights[i], .name = tables_.light_names[i]};
+    }
+  }
+
+  inline bool is_valid() const { return valid_; }
+
+  // Applies the entries up to the first one that does not fit the scene. Every entry leaves a valid tree behind.
+  bool apply(std::span<const uint8_t> entries) {
+    JournalReader reader(entries);
+    while (!reader.at_end()) {
+      EntryType type{};
+      if (!reader.read(type) || !apply_entry(type, reader)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  binary::SceneTables finish() && {
+    std::vector<binary::NodeRecord> nodes;
+    std::vector<std::string> node_names;
+    add_node(root_, binary::kNoParent, nodes, node_names);
+
+    // The prefab contents follow the tree, so only their position in the table changes
+    const auto new_tree_end = static_cast<uint32_t>(nodes.size());
+    for (size_t i = tree_end_; i < tables_.nodes.size(); ++i) {
+      binary::NodeRecord record = tables_.nodes[i];
+      if (record.parent != binary::kNoParent) {
+        record.parent = record.parent - static_cast<uint32_t>(tree_end_) + new_tree_end;
+      }
+      nodes.push_back(record);
+      node_names.push_back(std::move(tables_.node_names[i]));
+    }
+    for (binary::PrefabRecord& prefab : tables_.prefabs) {
+      prefab.root = prefab.root - static_cast<uint32_t>(tree_end_) + new_tree_end;
+    }
+    tables_.nodes      = std::move(nodes);
+    tables_.node_names = std::move(node_names);
+
+    copy_objects(material_order_, materials_, tables_.materials, tables_.material_names);
+    copy_objects(light_order_, lights_, tables_.lights, tables_.light_names);
+    return std::move(tables_);
+  }
+
+ private:
+  struct Node {
+    binary::NodeRecord record;
+    std::string name;
+    uint32_t parent;
+    std::vector<uint32_t> children;
+  };
+
+  template <typename Record>
+  struct Object {
+    Record record;
+    std::string name;
+  };
+
+  bool apply_entry(EntryType type, JournalReader& reader) {
+    uint32_t key = kNoKey;
+    switch (type) {
+      case EntryType::NodeSet: {
+        uint32_t parent = kNoKey;
+        uint32_t prev   = kNoKey;
+        Node node{};
+        if (!reader.read(key) || !reader.read(parent) || !reader.read(prev) || !reader.read(node.record) ||
+            !reader.read_name(node.name)) {
+          return false;
+        }
+        node.parent = parent;
+        return set_node(key, prev, std::move(node));
+      }
+      case EntryType::NodeRemove:
+        return reader.read(key) && remove_node(key);
+      case EntryType::MaterialSet: {
+        Object<binary::MaterialRecord> material{};
+        if (!reader.read(material.record) || !reader.read_name(material.name)) {
+          return false;
+        }
+        set_object(material.record.id, std::move(material), material_order_, materials_);
+        return true;
+      }
+      case EntryType::MaterialRemove:
+        return reader.read(key) && remove_object(key, material_order_, materials_);
+      case EntryType::LightSet: {
+        Object<binary::LightRecord> light{};
+        if (!reader.read(key) || !reader.read(light.record) || !reader.read_name(light.name)) {
+          return false;
+        }
+        set_object(key, std::move(light), light_order_, lights_);
+        return true;
+      }
+      case EntryType::LightRemove:
+        return reader.read(key) && remove_object(key, light_order_, lights_);
+    }
+
+    return false;
+  }
+
+  bool set_node(uint32_t key, uint32_t prev, Node node) {
+    if (node.parent == kNoKey) {
+      if (key != root_ || prev != kNoKey) {
+        return false;
+      }
+    } else {
+      auto parent_it = nodes_.find(node.parent);
+      if (key == root_ || parent_it == nodes_.end() || parent_it->second.record.type != binary::kGroupNodeType ||
+          is_ancestor(key, node.parent)) {
+        return false;
+      }
+      const auto& siblings = parent_it->second.children;
+      if (prev != kNoKey && (prev == key || std::ranges::find(siblings, prev) == siblings.end())) {
+        return false;
+      }
+    }
+
+    auto node_it = nodes_.find(key);
+    if (node_it != nodes_.end()) {
+      detach(key, node_it->second.parent);
+      node.children = std::move(node_it->second.children);
+    }
+    if (node.parent != kNoKey) {
+      auto& siblings = nodes_.at(node.parent).children;
+      auto position  = prev == kNoKey ? siblings.begin() : std::next(std::ranges::find(siblings, prev));
+      siblings.insert(position, key);
+    }
+    nodes_[key] = std::move(node);
+    return true;
+  }
+
+  bool remove_node(uint32_t key) {
+    auto node_it = nodes_.find(key);
+    if (node_it == nodes_.end() || key == root_) {
+      return false;
+    }
+    detach(key, node_it->second.parent);
+    nodes_.erase(node_it);
+    return true;
+  }
+
+  void detach(uint32_t key, uint32_t parent) {
+    auto parent_it = nodes_.find(parent);
+    if (parent_it != nodes_.end()) {
+      std::erase(parent_it->second.children, key);
+    }
+  }
+
+  bool is_ancestor(uint32_t key, uint32_t node) const {
+    for (uint32_t current = node; current != kNoKey;) {
+      if (current == key) {
+        return true;
+      }
+      auto node_it = nodes_.find(current);
+      current      = node_it == nodes_.end() ? kNoKey : node_it->second.parent;
+    }
+    return false;
+  }
+
+  // Children of a removed group that were not moved out of it are removed by their own entries, the ones left behind
+  // by a corrupted journal are dropped here, as only the nodes reachable from the root are added.
+  void add_node(uint32_t key, uint32_t parent, std::vector<binary::NodeRecord>& nodes,
+                std::vector<std::string>& node_names) const {
+    const Node& node          = nodes_.at(key);
+    const auto index          = static_cast<uint32_t>(nodes.size());
+    binary::NodeRecord record = node.record;
+    record.parent             = parent;
+    nodes.push_back(record);
+    node_names.push_back(node.name);
+
+    if (node.record.type == binary::kGroupNodeType) {
+      for (const uint32_t child : node.children) {
+        add_node(child, index, nodes, node_names);
+      }
+    }
+  }
+
+  template <typename Record>
+  static void set_object(uint32_t key, Object<Record> object, std::vector<uint32_t>& order,
+                         std::unordered_map<uint32_t, Object<Record>>& objects) {
+    if (!objects.contains(key)) {
+      order.push_back(key);
+    }
+    objects[key] = std::move(object);
+  }
+
+  template <typename Record>
+  static bool remove_object(uint32_t key, std::vector<uint32_t>& order,
+                            std::unordered_map<uint32_t, Object<Record>>& objects) {
+    if (objects.erase(key) == 0) {
+      return false;
+    }
+    std::erase(order, key);
+    return true;
+  }
+
+  template <typename Record>
+  static void copy_objects(const std::vector<uint32_t>& order,
+                           const std::unordered_map<uint32_t, Object<Record>>& objects, std::vector<Record>& records,
+                           std::vector<std::string>& names) {
+    records.clear();
+    names.clear();
+    for (const uint32_t key : order) {
+      records.push_back(objects.at(key).record);
+      names.push_back(objects.at(key).name);
+    }
+  }
+
+  binary::SceneTables tables_;
+  size_t tree_end_ = 0;
+  bool valid_      = true;
+
+  uint32_t root_ = kNoKey;
+  std::unordered_map<uint32_t, Node> nodes_;
+  std::vector<uint32_t> material_order_;
+  std::unordered_map<uint32_t, Object<binary::MaterialRecord>> materials_;
+  std::vector<uint32_t> light_order_;
+  std::unordered_map<uint32_t, Object<binary::LightRecord>> lights_;
+};
+
+}  // namespace
+
+SceneJournal::SceneJournal(std::filesystem::path directory) : directory_(std::move(directory)) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    Logger::warn("Could not create the autosave directory {}, the scene will not be recovered after a crash: {}",
+                 directory_.string(), ec.message());
+  }
+}
+
+SceneJournal::~SceneJournal() { flush(); }
+
+void SceneJournal::flush() {
+  if (pending_write_.valid()) {
+    pending_write_.wait();
+  }
+}
+
+bool SceneJournal::capture_node(SDFTree& tree, SDFTreeNode& node, uint32_t parent, uint32_t prev,
+                                State& state) const {
+  const auto key = static_cast<uint32_t>(node.node_id().raw());
+  NodeState node_state{
+      .parent = parent,
+      .prev   = prev,
+      .record = binary::make_node_record(node),
+      .name   = std::string(node.name()),
+  };
+
+  PrefabReferenceFinder finder;
+  node.accept_visitor(finder);
+  if (finder.reference() != nullptr) {
+    auto prefab_it = prefab_indices_.find(finder.reference()->prefab().prefab_id().raw());
+    if (prefab_it == prefab_indices_.end()) {
+      return false;
+    }
+    node_state.record.prefab = prefab_it->second;
+  }
+
+  state.node_order.push_back(key);
+  state.nodes.emplace(key, std::move(node_state));
+  if (!tree.is_group(node.node_id())) {
+    return true;
+  }
+
+  uint32_t child_prev = kNoKey;
+  GroupNode& group    = tree.group(node.node_id());
+  for (const auto child_id : group) {
+    if (!capture_node(tree, group.get_child(child_id), key, child_prev, state)) {
+      return false;
+    }
+    child_prev = static_cast<uint32_t>(child_id.raw());
+  }
+  return true;
+}
+
+bool SceneJournal::capture(Scene& scene, State& state) const {
+  SDFTree& tree = scene.tree();
+  if (!capture_node(tree, tree.root(), kNoKey, kNoKey, state)) {
+    return false;
+  }
+
+  for (const auto mat_id : tree.materials()) {
+    const MaterialSDFTreeComponent& material = tree.material(mat_id);
+    const auto key                           = static_cast<uint32_t>(mat_id.raw());
+    state.material_order.push_back(key);
+    state.materials.emplace(key, ObjectState<binary::MaterialRecord>{.record = binary::make_material_record(material),
+                                                                     .name   = std::string(material.name())});
+  }
+  for (const auto& [light_id, light] : scene.lights()) {
+    const auto key = static_cast<uint32_t>(light_id.raw());
+    state.light_order.push_back(key);
+    state.lights.emplace(
+        key, ObjectState<binary::LightRecord>{.record = binary::make_light_record(*light),
+                                              .name   = std::string(light->name())});
+  }
+  return true;
+}
+
+void SceneJournal::record(Scene& scene) {
+  State state;
+  if (!has_snapshot_ || scene.tree().generation() != generation_ || !capture(scene, state)) {
+    compact(scene);
+    return;
+  }
+
+  std::vector<uint8_t> entries;
+  for (const uint32_t key : state.node_order) {
+    const NodeState& node = state.nodes.at(key);
+    auto old_it           = state_.nodes.find(key);
+    if (old_it != state_.nodes.end() && old_it->second.parent == node.parent && old_it->second.prev == node.prev &&
+        old_it->second.name == node.name && equal_records(old_it->second.record, node.record)) {
+      continue;
+    }
+    append_value(entries, EntryType::NodeSet);
+    append_value(entries, key);
+    append_value(entries, node.parent);
+    append_value(entries, node.prev);
+    append_value(entries, node.record);
+    append_name(entries, node.name);
+  }
+  for (const uint32_t key : state_.node_order) {
+    if (!state.nodes.contains(key)) {
+      append_value(entries, EntryType::NodeRemove);
+      append_value(entries, key);
+    }
+  }
+
+  for (const uint32_t key : state.material_order) {
+    const auto& material = state.materials.at(key);
+    auto old_it          = state_.materials.find(key);
+    if (old_it != state_.materials.end() && old_it->second.name == material.name &&
+        equal_records(old_it->second.record, material.record)) {
+      continue;
+    }
+    append_value(entries, EntryType::MaterialSet);
+    append_value(entries, material.record);
+    append_name(entries, material.name);
+  }
+  for (const uint32_t key : state_.material_order) {
+    if (!state.materials.contains(key)) {
+      append_value(entries, EntryType::MaterialRemove);
+      append_value(entries, key);
+    }
+  }
+
+  for (const uint32_t key : state.light_order) {
+    const auto& light = state.lights.at(key);
+    auto old_it       = state_.lights.find(key);
+    if (old_it != state_.lights.end() && old_it->second.name == light.name &&
+        equal_records(old_it->second.record, light.record)) {
+      continue;
+    }
+    append_value(entries, EntryType::LightSet);
+    append_value(entries, key);
+    append_value(entries, light.record);
+    append_name(entries, light.name);
+  }
+  for (const uint32_t key : state_.light_order) {
+    if (!state.lights.contains(key)) {
+      append_value(entries, EntryType::LightRemove);
+      append_value(entries, key);
+    }
+  }
+
+  state_ = std::move(state);
+  if (entries.empty()) {
+    return;
+  }
+
+  const BatchHeader header{
+      .size     = static_cast<uint32_t>(entries.size()),
+      .padding  = 0,
+      .checksum = fnv1a(entries),
+  };
+  std::vector<uint8_t> batch;
+  batch.reserve(sizeof(BatchHeader) + entries.size());
+  append_value(batch, header);
+  batch.insert(batch.end(), entries.begin(), entries.end());
+
+  journal_size_ += batch.size();
+  if (journal_size_ > kCompactionThreshold) {
+    compact(scene);
+    return;
+  }
+  append_async(std::move(batch));
+}
+
+void SceneJournal::index_prefabs(SDFTree& tree, SDFTreeNode& node) {
+  PrefabReferenceFinder finder;
+  node.accept_visitor(finder);
+  if (finder.reference() != nullptr) {
+    prefab_indices_.try_emplace(finder.reference()->prefab().prefab_id().raw(),
+                                static_cast<uint16_t>(prefab_indices_.size()));
+  }
+  if (tree.is_group(node.node_id())) {
+    GroupNode& group = tree.group(node.node_id());
+    for (const auto child_id : group) {
+      index_prefabs(tree, group.get_child(child_id));
+    }
+  }
+}
+
+void SceneJournal::compact(Scene& scene) {
+  std::vector<uint8_t> snapshot = binary::serialize_scene(scene);
+
+  prefab_indices_.clear();
+  index_prefabs(scene.tree(), scene.tree().root());
+  state_ = State{};
+  capture(scene, state_);
+
+  const JournalHeader header{
+      .magic           = kJournalMagic,
+      .version         = kJournalVersion,
+      .snapshot_hash   = fnv1a(snapshot),
+      .node_key_count  = static_cast<uint32_t>(state_.node_order.size()),
+      .light_key_count = static_cast<uint32_t>(state_.light_order.size()),
+  };
+  std::vector<uint8_t> journal;
+  append_value(journal, header);
+  for (const uint32_t key : state_.node_order) {
+    append_value(journal, key);
+  }
+  for (const uint32_t key : state_.light_order) {
+    append_value(journal, key);
+  }
+
+  has_snapshot_ = true;
+  generation_   = scene.tree().generation();
+  journal_size_ = journal.size();
+  write_async(std::move(snapshot), std::move(journal));
+}
+
+void SceneJournal::write_async(std::vector<uint8_t> snapshot, std::vector<uint8_t> journal) {
+  flush();
+  pending_write_ =
+      std::async(std::launch::async, [this, snapshot = std::move(snapshot), journal = std::move(journal)]() {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        if (ec) {
+          Logger::warn("Could not create the autosave directory {}: {}", directory_.string(), ec.message());
+          return;
+        }
+
+        // A crash between the writes leaves the old journal behind, which is ignored as it was started for another
+        // snapshot
+        if (write_file(directory_ / kSnapshotFileName, snapshot)) {
+          write_file(directory_ / kJournalFileName, journal);
+        }
+      });
+}
+
+void SceneJournal::append_async(std::vector<uint8_t> batch) {
+  flush();
+  pending_write_ = std::async(std::launch::async, [this, batch = std::move(batch)]() {
+    std::ofstream file(directory_ / kJournalFileName, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+      // Warned once, as every recorded change would warn again
+      if (!has_warned_) {
+        Logger::warn("Could not open the autosave journal {}, the edits will not be recovered after a crash",
+                     (directory_ / kJournalFileName).string());
+        has_warned_ = true;
+      }
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(batch.data()), std::ssize(batch));  // NOLINT
+    file.flush();
+    if (!file) {
+      Logger::warn("Could not append to the autosave journal {}", (directory_ / kJournalFileName).string());
+    }
+  });
+}
+
+bool SceneJournal::has_autosave(const std::filesystem::path& directory) {
+  std::error_code ec;
+  return std::filesystem::exists(directory / kSnapshotFileName, ec);
+}
+
+std::optional<std::vector<uint8_t>> SceneJournal::restore(const std::filesystem::path& directory) {
+  std::optional<std::vector<uint8_t>> snapshot = read_file(directory / kSnapshotFileName);
+  if (!snapshot) {
+    return std::nullopt;
+  }
+  binary::SceneTables tables = binary::decode_scene_tables(*snapshot);
+
+  const std::optional<std::vector<uint8_t>> journal = read_file(directory / kJournalFileName);
+  if (!journal) {
+    return snapshot;
+  }
+
+  JournalReader reader(*journal);
+  JournalHeader header{};
+  if (!reader.read(header) || header.magic != kJournalMagic || header.version != kJournalVersion ||
+      header.snapshot_hash != fnv1a(*snapshot)) {
+    Logger::warn("Ignoring the autosave journal, it was not written for the autosave snapshot");
+    return snapshot;
+  }
+
+  std::vector<uint32_t> node_keys(header.node_key_count);
+  std::vector<uint32_t> light_keys(header.light_key_count);
+  bool has_keys = true;
+  for (uint32_t& key : node_keys) {
+    has_keys = has_keys && reader.read(key);
+  }
+  for (uint32_t& key : light_keys) {
+    has_keys = has_keys && reader.read(key);
+  }
+
+  JournalReplay replay(std::move(tables), node_keys, light_keys);
+  if (!has_keys || !replay.is_valid()) {
+    Logger::warn("Ignoring the autosave journal, its keys do not match the autosave snapshot");
+    return snapshot;
+  }
+
+  size_t batch_count = 0;
+  while (!reader.at_end()) {
+    BatchHeader batch{};
+    std::optional<std::span<const uint8_t>> entries;
+    if (!reader.read(batch) || !(entries = reader.read_bytes(batch.size)) || fnv1a(*entries) != batch.checksum) {
+      Logger::warn("The autosave journal is torn after {} batches, the rest is ignored", batch_count);
+      break;
+    }
+    if (!replay.apply(*entries)) {
+      Logger::warn("The batch {} of the autosave journal does not fit the scene, the rest is ignored", batch_count);
+      break;
+    }
+    ++batch_count;
+  }
+
+  Logger::info("Replayed {} batches of the autosave journal", batch_count);
+  return binary::encode_scene_tables(std::move(replay).finish());
+}
+
+void SceneJournal::discard(const std::filesystem::path& directory) {
+  std::error_code ec;
+  std::filesystem::remove(directory / kJournalFileName, ec);
+  std::filesystem::remove(directory / kSnapshotFileName, ec);
+}
+
+}  // namespace resin
@@ -0,0 +1,133 @@
+#ifndef RESIN_SCENE_JOURNAL_HPP
+#define RESIN_SCENE_JOURNAL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <libresin/core/scene.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/macros.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace resin {
+
+// Autosave of the edited scene made of a binary snapshot and an append-only journal of the changes made since the
+// snapshot was written:
+//
+//   autosave.resinb: binary scene, see binary::serialize_scene
+//   autosave.resinj: JournalHeader | node keys | light keys | batches
+//
+// The keys are the raw ids of the tree nodes in the pre-order of the snapshot and of the lights in the order of the
+// snapshot light table, as the journal refers to the objects by their raw ids. The materials are referred to by the
+// raw ids stored in the material records. Every batch is the size and the checksum of its entries followed by the
+// entries, so a batch torn by a crash is detected and the replay stops at the last complete one.
+//
+// The edits are not reported to the journal, as the editor changes the nodes in place. Instead, record compares the
+// records of the scene with the ones of the previous call and appends the ones that changed, which is cheap as the
+// registries hold at most a hundred objects each. The files are written on a worker thread.
+class SceneJournal {
+ public:
+  explicit SceneJournal(std::filesystem::path directory);
+  ~SceneJournal();
+
+  DISABLE_COPY_AND_MOVE(SceneJournal)
+
+  // Appends the changes made since the last call to the journal. Compacts the journal instead if there is no snapshot
+  // yet, the tree was replaced, a prefab that is not in the snapshot is referenced, or the journal outgrew
+  // kCompactionThreshold.
+  // Cost: O(n + m + l), where n, m and l are the numbers of the nodes, materials and lights
+  void record(Scene& scene);
+
+  // Replaces the snapshot with the scene and starts an empty journal.
+  // Cost: O(n + m + l + p), where p is the number of the prefab nodes
+  void compact(Scene& scene);
+
+  // Waits for the pending writes.
+  void flush();
+
+  inline const std::filesystem::path& directory() const { return directory_; }
+  inline size_t journal_size() const { return journal_size_; }
+
+  static bool has_autosave(const std::filesystem::path& directory);
+
+  // Binary scene of the snapshot with the journal replayed on top of it, nothing if there is no snapshot. The journal
+  // is ignored if it was not written for the snapshot, and the replay stops at the first corrupted batch.
+  // Throws BinarySceneDeserializationException if the snapshot is corrupted.
+  static std::optional<std::vector<uint8_t>> restore(const std::filesystem::path& directory);
+
+  static void discard(const std::filesystem::path& directory);
+
+  static constexpr size_t kCompactionThreshold = size_t{1} << 20;
+
+  static constexpr std::string_view kSnapshotFileName = "autosave.resinb";
+  static constexpr std::string_view kJournalFileName  = "autosave.resinj";
+
+  static constexpr std::array<char, 4> kJournalMagic = {'R', 'S', 'N', 'J'};
+  static constexpr uint32_t kJournalVersion          = 1;
+
+  struct JournalHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint64_t snapshot_hash;  // FNV-1a of the snapshot file the journal was started for
+    uint32_t node_key_count;
+    uint32_t light_key_count;
+  };
+
+ private:
+  struct NodeState {
+    uint32_t parent;
+    uint32_t prev;
+    binary::NodeRecord record;
+    std::string name;
+  };
+
+  template <typename Record>
+  struct ObjectState {
+    Record record;
+    std::string name;
+  };
+
+  // Records of the scene in the order of the snapshot tables. Holds the keys of the tree nodes in pre-order.
+  struct State {
+    std::vector<uint32_t> node_order;
+    std::unordered_map<uint32_t, NodeState> nodes;
+    std::vector<uint32_t> material_order;
+    std::unordered_map<uint32_t, ObjectState<binary::MaterialRecord>> materials;
+    std::vector<uint32_t> light_order;
+    std::unordered_map<uint32_t, ObjectState<binary::LightRecord>> lights;
+  };
+
+  // Fails if the scene references a prefab that is not in the snapshot. The nodes are captured in the order of the
+  // node records written by binary::serialize_scene.
+  bool capture(Scene& scene, State& state) const;
+  bool capture_node(SDFTree& tree, SDFTreeNode& node, uint32_t parent, uint32_t prev, State& state) const;
+
+  // Assigns the prefabs the indices of their records in the order written by binary::serialize_scene, which is the
+  // order the references are first met in the pre-order of the tree.
+  void index_prefabs(SDFTree& tree, SDFTreeNode& node);
+
+  void write_async(std::vector<uint8_t> snapshot, std::vector<uint8_t> journal);
+  void append_async(std::vector<uint8_t> batch);
+
+  std::filesystem::path directory_;
+
+  bool has_snapshot_ = false;
+  size_t generation_ = 0;
+  State state_;
+  // Raw prefab id to the index of the prefab record of the snapshot
+  std::unordered_map<size_t, uint16_t> prefab_indices_;
+  size_t journal_size_ = 0;
+
+  // Only touched by the writes, which never overlap
+  bool has_warned_ = false;
+  std::future<void> pending_write_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_SCENE_JOURNAL_HPP
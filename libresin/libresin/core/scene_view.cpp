@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/vec2.hpp>
+#include <libresin/core/scene_view.hpp>
+#include <utility>
+
+namespace resin {
+
+void set_camera_uniforms(const ShaderProgram& program, const Camera& camera, const Framebuffer& framebuffer) {
+  program.set_uniform("u_iV", camera.inverse_view_matrix());
+  program.set_uniform("u_resolution", glm::vec2(framebuffer.width(), framebuffer.height()));
+  program.set_uniform("u_nearPlane", camera.near_plane());
+  program.set_uniform("u_farPlane", camera.far_plane());
+  program.set_uniform("u_ortho", camera.is_orthographic());
+  program.set_uniform("u_camSize", camera.height());
+}
+
+SceneView::SceneView(std::string name, std::unique_ptr<Camera> camera, float resolution_scale)
+    : name_(std::move(name)),
+      camera_(std::move(camera)),
+      framebuffer_(1, 1),
+      display_width_(1),
+      display_height_(1),
+      resolution_scale_(resolution_scale),
+      is_dirty_(true) {}
+
+bool SceneView::resize(size_t display_width, size_t display_height) {
+  if (display_width == 0 || display_height == 0) {
+    return false;
+  }
+
+  const auto width =
+      std::max<size_t>(1, static_cast<size_t>(std::lround(static_cast<float>(display_width) * resolution_scale_)));
+  const auto height =
+      std::max<size_t>(1, static_cast<size_t>(std::lround(static_cast<float>(display_height) * resolution_scale_)));
+  if (display_width == display_width_ && display_height == display_height_ && width == framebuffer_.width() &&
+      height == framebuffer_.height()) {
+    return false;
+  }
+
+  display_width_  = display_width;
+  display_height_ = display_height;
+  if (width != framebuffer_.width() || height != framebuffer_.height()) {
+    framebuffer_.resize(width, height);
+  }
+  camera_->set_aspect_ratio(static_cast<float>(display_width) / static_cast<float>(display_height));
+  is_dirty_ = true;
+  return true;
+}
+
+void SceneView::set_resolution_scale(float resolution_scale) {
+  resolution_scale_ = resolution_scale;
+  resize(display_width_, display_height_);
+}
+
+}  // namespace resin
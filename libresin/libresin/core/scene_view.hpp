@@ -0,0 +1,57 @@
+#ifndef RESIN_SCENE_VIEW_HPP
+#define RESIN_SCENE_VIEW_HPP
+
+#include <cstddef>
+#include <libresin/core/camera.hpp>
+#include <libresin/core/framebuffer.hpp>
+#include <libresin/core/shader.hpp>
+#include <libresin/utils/macros.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace resin {
+
+// Sets the camera uniforms main.vert and the fragment shaders using it expect.
+void set_camera_uniforms(const ShaderProgram& program, const Camera& camera, const Framebuffer& framebuffer);
+
+// Additional view of the scene with its own camera and framebuffer. The views share the compiled SDF program and the
+// uniform buffers with the main viewport, only the camera uniforms are set before a view is rendered. The content is
+// kept until the view gets invalidated, so a view costs nothing while the scene and its camera do not change.
+class SceneView {
+ public:
+  // Must be called on the thread owning the GL context.
+  SceneView(std::string name, std::unique_ptr<Camera> camera, float resolution_scale = 1.0F);
+
+  DISABLE_COPY_AND_MOVE(SceneView)
+
+  // Resizes the framebuffer to the displayed size times the resolution scale. Returns true if the view got invalidated.
+  bool resize(size_t display_width, size_t display_height);
+  void set_resolution_scale(float resolution_scale);
+
+  inline void mark_dirty() { is_dirty_ = true; }
+  inline void mark_clean() { is_dirty_ = false; }
+  inline bool is_dirty() const { return is_dirty_; }
+
+  inline std::string_view name() const { return name_; }
+  inline float resolution_scale() const { return resolution_scale_; }
+  inline Camera& camera() { return *camera_; }
+  inline const Camera& camera() const { return *camera_; }
+  inline ViewportFramebuffer& framebuffer() { return framebuffer_; }
+  inline const ViewportFramebuffer& framebuffer() const { return framebuffer_; }
+
+ public:
+  bool is_open = false;
+
+ private:
+  std::string name_;
+  std::unique_ptr<Camera> camera_;
+  ViewportFramebuffer framebuffer_;
+  size_t display_width_, display_height_;
+  float resolution_scale_;
+  bool is_dirty_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_SCENE_VIEW_HPP
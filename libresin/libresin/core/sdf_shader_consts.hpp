@@ -68,6 +68,16 @@ constexpr StringEnumMapper<SDFShaderPrim> kSDFShaderPrimComponentArrayNames({
 
 constexpr std::string_view kSDFScaleFunctionName = "opScale";
 
+// Prefab content is evaluated by a shared function per prefab, e.g. sdPrefab0, called by every reference with the
+// position transformed into the space of the reference
+constexpr std::string_view kSDFPrefabFunctionPrefix         = "sdPrefab";
+constexpr std::string_view kSDFInstanceFunctionName         = "opInstance";
+constexpr std::string_view kSDFInstancePositionFunctionName = "instancePos";
+
+// Domain repetition of the prefab references, see Repetition
+constexpr std::string_view kSDFRepeatGridFunctionName  = "opRepeatGrid";
+constexpr std::string_view kSDFRepeatPolarFunctionName = "opRepeatPolar";
+
 enum class SDFShaderCoreComponents : uint8_t {
   Transforms = 0,
   Materials  = 1,
@@ -2,10 +2,12 @@
 #include <libresin/core/sdf_tree/group_node.hpp>
 #include <libresin/core/sdf_tree/primitive_base_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/logger.hpp>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
@@ -20,25 +22,33 @@ GroupNode::GroupNode(SDFTreeRegistry& tree) : SDFTreeNode(tree, "Group") {
 GroupNode::~GroupNode() { tree_registry_.all_group_nodes[node_id_.raw()] = std::nullopt; }
 
 SDFTreeNode& GroupNode::push_back_primitive(SDFTreePrimitiveType type, SDFBinaryOperation bin_op) {
+  auto node_ptr = create_primitive(type);
+  node_ptr->set_bin_op(bin_op);
+  SDFTreeNode& result = *node_ptr;
+  push_back_child(std::move(node_ptr));
+  return result;
+}
+
+std::unique_ptr<SDFTreeNode> GroupNode::create_primitive(SDFTreePrimitiveType type) {
   switch (type) {
     case SDFTreePrimitiveType::Sphere:
-      return push_back_child<SphereNode>(bin_op);
+      return std::make_unique<SphereNode>(tree_registry_);
     case SDFTreePrimitiveType::Cube:
-      return push_back_child<CubeNode>(bin_op);
+      return std::make_unique<CubeNode>(tree_registry_);
     case SDFTreePrimitiveType::Torus:
-      return push_back_child<TorusNode>(bin_op);
+      return std::make_unique<TorusNode>(tree_registry_);
     case SDFTreePrimitiveType::Capsule:
-      return push_back_child<CapsuleNode>(bin_op);
+      return std::make_unique<CapsuleNode>(tree_registry_);
     case SDFTreePrimitiveType::Link:
-      return push_back_child<LinkNode>(bin_op);
+      return std::make_unique<LinkNode>(tree_registry_);
     case SDFTreePrimitiveType::Ellipsoid:
-      return push_back_child<EllipsoidNode>(bin_op);
+      return std::make_unique<EllipsoidNode>(tree_registry_);
     case SDFTreePrimitiveType::Pyramid:
-      return push_back_child<PyramidNode>(bin_op);
+      return std::make_unique<PyramidNode>(tree_registry_);
     case SDFTreePrimitiveType::Cylinder:
-      return push_back_child<CylinderNode>(bin_op);
+      return std::make_unique<CylinderNode>(tree_registry_);
     case SDFTreePrimitiveType::TriangularPrism:
-      return push_back_child<TriangularPrismNode>(bin_op);
+      return std::make_unique<TriangularPrismNode>(tree_registry_);
     case resin::SDFTreePrimitiveType::_Count:
       throw NonExhaustiveEnumException();
   }
@@ -360,6 +370,7 @@ void GroupNode::insert_after_child(std::optional<IdView<SDFTreeNodeId>> after_ch
 }
 
 void GroupNode::push_dirty_primitives() {
+  const std::lock_guard lock(tree_registry_.dirty_nodes_mutex);
   for (auto prim : leaves_) {
     tree_registry_.dirty_primitives.emplace(std::move(prim));
   }
@@ -368,11 +379,58 @@ void GroupNode::push_dirty_primitives() {
 std::unique_ptr<SDFTreeNode> GroupNode::copy() {
   auto result = std::make_unique<GroupNode>(tree_registry_);
   copy_common(*result, *this);
-  for (auto& list_it : nodes_order_) {
-    result->push_back_child(nodes_.find(list_it)->second.second->copy());
+
+  SDFSubtreeBuilder builder(std::move(result));
+  copy_children_to(builder, builder.root());
+  return builder.build();
+}
+
+void GroupNode::copy_children_to(SDFSubtreeBuilder& builder, GroupNode& target) const {
+  for (const auto& list_it : nodes_order_) {
+    const auto& child = nodes_.find(list_it)->second.second;
+    if (!tree_registry_.all_group_nodes[list_it.raw()].has_value()) {
+      builder.push_back_child(target, child->copy());
+      continue;
+    }
+
+    auto& child_group = builder.push_back_child<GroupNode>(target, child->bin_op());
+    copy_common(child_group, *child);
+    tree_registry_.all_group_nodes[list_it.raw()]->get().copy_children_to(builder, child_group);
   }
+}
 
-  return result;
+void GroupNode::append_unlinked_child(std::unique_ptr<SDFTreeNode> node_ptr) {
+  node_ptr->set_parent(*this);
+  node_ptr->transform().set_parent(transform_);
+  auto node_id = node_ptr->node_id();
+
+  nodes_order_.push_back(node_id);
+  nodes_.emplace(node_id, std::make_pair(std::prev(nodes_order_.end()), std::move(node_ptr)));
+}
+
+void GroupNode::link_subtree(
+    const std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>>& built_subtrees) {
+  leaves_.clear();
+  const auto mat_id = active_material_id();
+  for (const auto& child_id : nodes_order_) {
+    auto& child = get_child(child_id);
+    if (built_subtrees.contains(child_id)) {
+      if (mat_id.has_value()) {
+        child.set_ancestor_mat_id(*mat_id);
+      }
+      child.insert_leaves_to(leaves_);
+      continue;
+    }
+
+    child.ancestor_mat_id_ = mat_id;
+    child.mark_dirty();
+    if (tree_registry_.all_group_nodes[child_id.raw()].has_value()) {
+      tree_registry_.all_group_nodes[child_id.raw()]->get().link_subtree(built_subtrees);
+    } else {
+      child.mark_primitives_dirty();
+    }
+    child.insert_leaves_to(leaves_);
+  }
 }
 
 void GroupNode::insert_leaves_up(const std::unique_ptr<SDFTreeNode>& source) {
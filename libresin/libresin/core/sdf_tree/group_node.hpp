@@ -22,6 +22,8 @@
 namespace resin {
 using SDFTreePrimitiveType = sdf_shader_consts::SDFShaderPrim;
 
+class SDFSubtreeBuilder;
+
 class GroupNode final : public SDFTreeNode {
  public:
   GroupNode() = delete;
@@ -137,6 +139,22 @@ class GroupNode final : public SDFTreeNode {
   void fix_material_ancestors() override;
 
  private:
+  friend SDFSubtreeBuilder;
+
+  std::unique_ptr<SDFTreeNode> create_primitive(SDFTreePrimitiveType type);
+
+  // Appends the child without updating its material ancestors and the leaves of this group and its ancestors.
+  // Cost: O(1)
+  void append_unlinked_child(std::unique_ptr<SDFTreeNode> node_ptr);
+
+  // Recomputes the material ancestors and the leaves of the whole subtree and marks its nodes dirty. The subtrees in
+  // built_subtrees are already linked, so the material is only propagated into them.
+  // Cost: O(n + l), where l is the total size of the leaf sets of the groups
+  void link_subtree(
+      const std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>>& built_subtrees);
+
+  void copy_children_to(SDFSubtreeBuilder& builder, GroupNode& target) const;
+
   void insert_leaves_up(const std::unique_ptr<SDFTreeNode>& source);
   void remove_leaves_up(const std::unique_ptr<SDFTreeNode>& source);
 
@@ -0,0 +1,28 @@
+#include <format>
+#include <libresin/core/sdf_shader_consts.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_registry.hpp>
+#include <utility>
+
+namespace resin {
+
+Prefab::Prefab(SDFTreeRegistry& tree, std::unique_ptr<GroupNode> root, std::string path)
+    : prefab_id_(tree.prefabs_registry), root_(std::move(root)), path_(std::move(path)) {}
+
+Prefab::~Prefab() { Logger::debug("Destructed prefab with id={}.", prefab_id_.raw()); }
+
+std::string_view Prefab::name() const { return root_->name(); }
+
+std::string Prefab::shader_function_name() const {
+  return std::format("{}{}", sdf_shader_consts::kSDFPrefabFunctionPrefix, prefab_id_.raw());
+}
+
+std::string Prefab::gen_shader_function(GenShaderMode mode) const {
+  std::string content_code = root_->gen_shader_code(mode);
+  return std::format("sdf_result {}(vec3 {}){{return {};}}", shader_function_name(),
+                     sdf_shader_consts::kSDFShaderVariableNames[sdf_shader_consts::SDFShaderVariable::Position],
+                     content_code.empty() ? "sdEmpty()" : content_code);
+}
+
+}  // namespace resin
@@ -0,0 +1,78 @@
+#ifndef RESIN_PREFAB_HPP
+#define RESIN_PREFAB_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <libresin/core/id_registry.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace resin {
+
+class GroupNode;
+class PrefabReferenceNode;
+struct SDFTreeRegistry;
+
+class Prefab;
+using PrefabId = Id<Prefab>;
+
+// Content of a prefab shared by all of its references in the tree. The content lives outside of the tree root, so its
+// nodes take the registry and the uniform buffer slots once, no matter how many times the prefab is referenced. The
+// shader code of the content is generated once as well, as a function called by every reference with its own
+// transform.
+class Prefab {
+ public:
+  Prefab() = delete;
+
+  // It is the programmer's responsibility to assert that Prefab class will not outlive the provided registry!
+  Prefab(SDFTreeRegistry& tree, std::unique_ptr<GroupNode> root, std::string path);
+  ~Prefab();
+
+  Prefab(const Prefab&)            = delete;
+  Prefab(Prefab&&)                 = delete;
+  Prefab& operator=(const Prefab&) = delete;
+  Prefab& operator=(Prefab&&)      = delete;
+
+  inline IdView<PrefabId> prefab_id() const { return prefab_id_; }
+
+  inline GroupNode& root() { return *root_; }
+  inline const GroupNode& root() const { return *root_; }
+
+  std::string_view name() const;
+
+  // Path of the file the prefab was loaded from, empty if it is not known
+  inline std::string_view path() const { return path_; }
+
+  inline size_t reference_count() const { return reference_count_; }
+
+  // Keeps the prefab from being deleted by SDFTree::delete_unused_prefabs while it has no references, e.g. while an
+  // undo step may bring a deleted reference back. Every retain must be paired with a release, unless the whole tree
+  // is cleared.
+  inline void retain() { ++retain_count_; }
+  inline void release() { --retain_count_; }
+  inline bool is_retained() const { return retain_count_ > 0; }
+
+  // Name of the shader function evaluating the content, e.g. sdPrefab0
+  std::string shader_function_name() const;
+
+  // Single line definition of the shader function evaluating the content.
+  // Cost: O(n), where n is the number of the prefab nodes
+  std::string gen_shader_function(GenShaderMode mode) const;
+
+ private:
+  friend PrefabReferenceNode;
+
+  PrefabId prefab_id_;
+  std::unique_ptr<GroupNode> root_;
+  std::string path_;
+
+  // The references may be created concurrently while a scene is loaded
+  std::atomic<size_t> reference_count_{0};
+  size_t retain_count_ = 0;
+};
+
+}  // namespace resin
+
+#endif
@@ -0,0 +1,111 @@
+#include <format>
+#include <glm/common.hpp>
+#include <libresin/core/sdf_shader_consts.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_registry.hpp>
+#include <libresin/utils/exceptions.hpp>
+#include <mutex>
+#include <utility>
+
+namespace resin {
+
+PrefabReferenceNode::PrefabReferenceNode(SDFTreeRegistry& tree, Prefab& prefab)
+    : SDFTreeNode(tree, prefab.name()), prefab_(prefab), instance_id_(tree.primitives_registry) {
+  ++prefab_.reference_count_;
+  mark_primitives_dirty();
+  mark_dirty();
+}
+
+PrefabReferenceNode::~PrefabReferenceNode() { --prefab_.reference_count_; }
+
+std::string PrefabReferenceNode::gen_shader_code(GenShaderMode mode) const {
+  switch (mode) {
+    case resin::GenShaderMode::SinglePrimitiveArray: {
+      const std::string pos_code =
+          std::format("{}({},{})", sdf_shader_consts::kSDFInstancePositionFunctionName,
+                      sdf_shader_consts::kSDFShaderVariableNames[sdf_shader_consts::SDFShaderVariable::Position],
+                      instance_id_.raw());
+      return std::format("{}({}({}),{})", sdf_shader_consts::kSDFInstanceFunctionName, prefab_.shader_function_name(),
+                         repetition_.gen_shader_code(pos_code, instance_id_.raw()), node_id_.raw());
+    }
+    case resin::GenShaderMode::ArrayPerPrimitiveType:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+std::unique_ptr<SDFTreeNode> PrefabReferenceNode::copy() {
+  auto result = std::make_unique<PrefabReferenceNode>(tree_registry_, prefab_);
+  copy_common(*result, *this);
+  result->repetition_ = repetition_;
+  return result;
+}
+
+void PrefabReferenceNode::set_material(IdView<MaterialId> mat_id) {
+  mark_primitives_dirty();
+  mat_id_ = mat_id;
+}
+
+void PrefabReferenceNode::remove_material() {
+  mark_primitives_dirty();
+  mat_id_ = std::nullopt;
+}
+
+void PrefabReferenceNode::set_repetition(const Repetition& repetition) {
+  if (repetition.type != repetition_.type || repetition.count != repetition_.count) {
+    tree_registry_.is_tree_dirty = true;
+  }
+  repetition_         = repetition;
+  repetition_.spacing = glm::max(repetition_.spacing, 0.0F);
+  repetition_.count   = glm::clamp(repetition_.count, 1U, Repetition::kMaxCount);
+  mark_primitives_dirty();
+}
+
+std::unique_ptr<GroupNode> PrefabReferenceNode::expand() {
+  auto group = std::make_unique<GroupNode>(tree_registry_);
+  copy_common(*group, *this);
+
+  SDFSubtreeBuilder builder(std::move(group));
+  if (repetition_.type == RepetitionType::None) {
+    builder.push_back_child(builder.root(), prefab_.root().copy());
+    return builder.build();
+  }
+
+  for (size_t i = 0; i < repetition_.instance_count(); ++i) {
+    auto& instance = builder.push_back_child<GroupNode>(builder.root(), SDFBinaryOperation::Union);
+    instance.rename(instance_group_name(i));
+    instance.transform().set_local_from_matrix(repetition_.instance_matrix(i));
+    builder.push_back_child(instance, prefab_.root().copy());
+  }
+  return builder.build();
+}
+
+std::string PrefabReferenceNode::instance_group_name(size_t index) { return std::format("Instance {}", index); }
+
+void PrefabReferenceNode::push_dirty_primitives() {
+  const std::lock_guard lock(tree_registry_.dirty_nodes_mutex);
+  tree_registry_.dirty_primitives.emplace(node_id());
+}
+
+void PrefabReferenceNode::delete_material_from_subtree(IdView<MaterialId> mat_id) {
+  tree_registry_.is_tree_dirty = true;
+  if (mat_id == mat_id_) {
+    mat_id_ = std::nullopt;
+  }
+}
+
+void PrefabReferenceNode::fix_material_ancestors() {
+  tree_registry_.is_tree_dirty = true;
+  if (!parent_.has_value()) {
+    ancestor_mat_id_ = std::nullopt;
+  } else {
+    ancestor_mat_id_ = parent_->get().active_material_id();
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,91 @@
+#ifndef RESIN_PREFAB_REFERENCE_NODE_HPP
+#define RESIN_PREFAB_REFERENCE_NODE_HPP
+
+#include <libresin/core/id_registry.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/primitive_base_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_registry.hpp>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+namespace resin {
+
+class GroupNode;
+
+// Leaf placing an instance of a prefab in the tree. The content of the prefab is not copied, the reference only holds
+// its own transform, which is stored in the primitives uniform buffer like the transform of a primitive. The node must
+// be expanded into a group with SDFTree::expand_prefab_reference before the content can be edited. The content may be
+// repeated in the space of the reference, which costs a single evaluation of the content regardless of the copies
+// count.
+class PrefabReferenceNode final : public SDFTreeNode {
+ public:
+  PrefabReferenceNode() = delete;
+  explicit PrefabReferenceNode(SDFTreeRegistry& tree, Prefab& prefab);
+  ~PrefabReferenceNode() override;
+
+  inline void accept_visitor(ISDFTreeNodeVisitor& visitor) override {
+    SDFTreeNode::accept_visitor(visitor);
+    visitor.visit_prefab_reference(*this);
+  }
+
+  std::string gen_shader_code(GenShaderMode mode) const override;
+  [[nodiscard]] std::unique_ptr<SDFTreeNode> copy() override;
+  inline bool is_leaf() override { return true; }
+
+  // The content is rendered with the materials of the prefab. The material of the reference is kept and applied to
+  // the content once the reference is expanded.
+  void set_material(IdView<MaterialId> mat_id) override;
+  void remove_material() override;
+  IdView<MaterialId> active_material_id_or_default() const {
+    auto mat = active_material_id();
+    return mat ? *mat : tree_registry_.default_material.material_id();
+  }
+
+  inline Prefab& prefab() { return prefab_; }
+  inline const Prefab& prefab() const { return prefab_; }
+
+  // Slot of the instance transform in the primitives uniform buffer
+  inline IdView<PrimitiveNodeId> instance_id() const { return instance_id_; }
+
+  inline const Repetition& repetition() const { return repetition_; }
+
+  // The counts are compiled into the shader, so changing them marks the tree dirty.
+  // Cost: O(1)
+  void set_repetition(const Repetition& repetition);
+
+  // Detached group with the properties of the reference and a copy of the prefab content as its only child. If the
+  // content is repeated, every copy is placed in a group of its own, named with instance_group_name.
+  // Cost: O(kn), where n is the number of the prefab nodes and k is the number of the copies
+  [[nodiscard]] std::unique_ptr<GroupNode> expand();
+
+  static std::string instance_group_name(size_t index);
+
+ protected:
+  inline void insert_leaves_to(
+      std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>>& leaves) override {
+    leaves.emplace(node_id());
+  }
+
+  inline void remove_leaves_from(
+      std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>>& leaves) override {
+    leaves.erase(leaves.find(node_id()));
+  }
+
+  void push_dirty_primitives() override;
+  inline void set_ancestor_mat_id(IdView<MaterialId> mat_id) override { ancestor_mat_id_ = mat_id; }
+  inline void remove_ancestor_mat_id() override { ancestor_mat_id_ = std::nullopt; }
+  void delete_material_from_subtree(IdView<MaterialId> mat_id) override;
+  void fix_material_ancestors() override;
+
+ private:
+  Prefab& prefab_;  // NOLINT
+  PrimitiveNodeId instance_id_;
+  Repetition repetition_;
+};
+
+}  // namespace resin
+
+#endif
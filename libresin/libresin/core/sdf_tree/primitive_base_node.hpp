@@ -4,6 +4,7 @@
 #include <libresin/core/sdf_shader_consts.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <mutex>
 #include <optional>
 
 namespace resin {
@@ -92,7 +93,10 @@ class BasePrimitiveNode : public SDFTreeNode {
     leaves.erase(leaves.find(node_id()));
   }
 
-  inline void push_dirty_primitives() final { tree_registry_.dirty_primitives.emplace(node_id()); }
+  inline void push_dirty_primitives() final {
+    const std::lock_guard lock(tree_registry_.dirty_nodes_mutex);
+    tree_registry_.dirty_primitives.emplace(node_id());
+  }
   inline void set_ancestor_mat_id(IdView<MaterialId> mat_id) final { ancestor_mat_id_ = mat_id; }
   inline void remove_ancestor_mat_id() final { ancestor_mat_id_ = std::nullopt; }
   inline void delete_material_from_subtree(IdView<MaterialId> mat_id) final {
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <format>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/vec2.hpp>
+#include <libresin/core/sdf_shader_consts.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/utils/exceptions.hpp>
+
+namespace resin {
+
+namespace {
+
+// Same as in sdf.glsl
+constexpr float kMinSpacing = 1e-6F;
+
+inline glm::vec3 grid_offset(const glm::uvec3& count) { return 0.5F * (glm::vec3(count) - 1.0F); }
+
+inline float polar_sector(const glm::uvec3& count) { return glm::two_pi<float>() / static_cast<float>(count.x); }
+
+}  // namespace
+
+size_t Repetition::instance_count() const {
+  switch (type) {
+    case RepetitionType::None:
+      return 1;
+    case RepetitionType::Grid:
+      return static_cast<size_t>(count.x) * count.y * count.z;
+    case RepetitionType::Polar:
+      return count.x;
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+glm::vec3 Repetition::fold(const glm::vec3& pos) const {
+  switch (type) {
+    case RepetitionType::None:
+      return pos;
+    case RepetitionType::Grid: {
+      const glm::vec3 offset = grid_offset(count);
+      const glm::vec3 cell =
+          glm::clamp(glm::round((pos / glm::max(spacing, kMinSpacing)) + offset), glm::vec3(0.0F),
+                     glm::vec3(count) - 1.0F) -
+          offset;
+      return pos - (spacing * cell);
+    }
+    case RepetitionType::Polar: {
+      const float sector = polar_sector(count);
+      const float angle  = sector * std::round(std::atan2(pos.z, pos.x) / sector);
+      const float c      = std::cos(angle);
+      const float s      = std::sin(angle);
+      return {(c * pos.x) + (s * pos.z), pos.y, (c * pos.z) - (s * pos.x)};
+    }
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+glm::mat4 Repetition::instance_matrix(size_t index) const {
+  switch (type) {
+    case RepetitionType::None:
+      return glm::mat4(1.0F);
+    case RepetitionType::Grid: {
+      const glm::vec3 cell(index % count.x, (index / count.x) % count.y, index / (count.x * count.y));
+      return glm::translate(spacing * (cell - grid_offset(count)));
+    }
+    case RepetitionType::Polar:
+      // Inverse of the rotation applied by fold
+      return glm::rotate(-polar_sector(count) * static_cast<float>(index), glm::vec3(0.0F, 1.0F, 0.0F));
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+void Repetition::expand_bounds(glm::vec3& min, glm::vec3& max) const {
+  switch (type) {
+    case RepetitionType::None:
+      return;
+    case RepetitionType::Grid: {
+      const glm::vec3 extent = spacing * grid_offset(count);
+      min -= extent;
+      max += extent;
+      return;
+    }
+    case RepetitionType::Polar: {
+      // Every copy fits in the cylinder around the Y axis reaching the farthest corner of the content box
+      const glm::vec3 reach = glm::max(glm::abs(min), glm::abs(max));
+      const float radius    = glm::length(glm::vec2(reach.x, reach.z));
+      min.x                 = -radius;
+      min.z                 = -radius;
+      max.x                 = radius;
+      max.z                 = radius;
+      return;
+    }
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+std::string Repetition::gen_shader_code(std::string_view pos_code, size_t instance_id) const {
+  switch (type) {
+    case RepetitionType::None:
+      return std::string(pos_code);
+    case RepetitionType::Grid:
+      return std::format("{}({},{},vec3({},{},{}))", sdf_shader_consts::kSDFRepeatGridFunctionName, pos_code,
+                         instance_id, count.x, count.y, count.z);
+    case RepetitionType::Polar:
+      return std::format("{}({},{}.0)", sdf_shader_consts::kSDFRepeatPolarFunctionName, pos_code, count.x);
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
+}  // namespace resin
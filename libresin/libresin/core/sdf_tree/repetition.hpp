@@ -0,0 +1,64 @@
+#ifndef RESIN_REPETITION_HPP
+#define RESIN_REPETITION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <libresin/utils/enum_mapper.hpp>
+#include <string>
+#include <string_view>
+
+namespace resin {
+
+enum class RepetitionType : uint8_t {
+  None   = 0,
+  Grid   = 1,
+  Polar  = 2,
+  _Count = 3,  // NOLINT
+};
+
+constexpr StringEnumMapper<RepetitionType> kRepetitionTypeNames({
+    {RepetitionType::None, "None"},    //
+    {RepetitionType::Grid, "Grid"},    //
+    {RepetitionType::Polar, "Polar"},  //
+});
+
+// Domain repetition of the content of a prefab reference. The position is folded into the nearest copy before the
+// content is evaluated, so the content is evaluated once no matter how many copies there are. The distance is exact
+// only if the content of a copy does not reach into the space of the neighbouring copies.
+//
+// Grid: count copies along each of the local axes, spacing apart and centered at the origin of the reference.
+// Polar: count.x copies rotated around the local Y axis.
+struct Repetition {
+  // Fits in 10 bits, as the counts are packed into a single value by the binary format
+  static constexpr uint32_t kMaxCount = 1023;
+
+  RepetitionType type = RepetitionType::None;
+  glm::vec3 spacing   = glm::vec3(1.0F);
+  glm::uvec3 count    = glm::uvec3(1);
+
+  // Cost: O(1)
+  size_t instance_count() const;
+
+  // Same as opRepeatGrid and opRepeatPolar of sdf.glsl.
+  // Cost: O(1)
+  glm::vec3 fold(const glm::vec3& pos) const;
+
+  // Local to reference matrix of the copy with the given index in [0, instance_count()). Folding a point of the copy
+  // gives the point of the content it was copied from.
+  glm::mat4 instance_matrix(size_t index) const;
+
+  // Grows the box of the content to the box of all of the copies.
+  void expand_bounds(glm::vec3& min, glm::vec3& max) const;
+
+  // Shader expression folding the position expression. The grid spacing is read from the u_sdf_primitives slot of the
+  // reference, the counts are compiled into the shader.
+  std::string gen_shader_code(std::string_view pos_code, size_t instance_id) const;
+
+  bool operator==(const Repetition&) const = default;
+};
+
+}  // namespace resin
+
+#endif
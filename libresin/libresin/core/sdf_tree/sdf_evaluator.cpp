@@ -0,0 +1,615 @@
+#include <algorithm>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_evaluator.hpp>
+#include <limits>
+#include <ranges>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+// Same as in sdf.glsl
+constexpr float kThinRegionOffset = 0.001F;
+constexpr float kMinSmoothFactor  = 0.01F;
+constexpr float kNormalEpsilon    = 0.0005F;
+constexpr float kHitEpsilon       = 0.0001F;
+constexpr int kMaxRaySteps        = 256;
+
+// Slack of the primitive bounds, covers the gradient estimate and the thin region offset
+constexpr float kBoundsMargin = 0.01F;
+
+// Nodes scaled below it are compiled as empty, their world_to_local matrices are not invertible
+constexpr float kMinScale = 1e-6F;
+
+inline bool is_degenerate_scale(const SDFTreeNode& node) {
+  return std::abs(node.transform().local_scale()) <= kMinScale;
+}
+
+inline float smooth_min(float a, float b, float k) {
+  const float h = std::max(k - std::abs(a - b), 0.0F) / k;
+  return std::min(a, b) - (0.1666F * h * h * h * k);
+}
+
+inline float smooth_max(float a, float b, float k) {
+  const float h = std::max(k - std::abs(a - b), 0.0F) / k;
+  return std::max(a, b) + (0.1666F * h * h * h * k);
+}
+
+inline float op_diff(float d1, float d2) { return std::max(d1, -(d2 - kThinRegionOffset)); }
+
+// Parametric interval of the ray inside the box, clipped to [t_begin, t_end]. Returns false if it is empty.
+inline bool clip_ray_to_box(const glm::vec3& origin, const glm::vec3& inv_dir, const glm::vec3& min,
+                            const glm::vec3& max, float& t_begin, float& t_end) {
+  const glm::vec3 t0     = (min - origin) * inv_dir;
+  const glm::vec3 t1     = (max - origin) * inv_dir;
+  const glm::vec3 t_near = glm::min(t0, t1);
+  const glm::vec3 t_far  = glm::max(t0, t1);
+  t_begin                = std::max({t_near.x, t_near.y, t_near.z, t_begin});
+  t_end                  = std::min({t_far.x, t_far.y, t_far.z, t_end});
+  return t_begin <= t_end;
+}
+
+class ShallowGroupVisitor : public ISDFTreeNodeVisitor {
+ public:
+  void visit_group(GroupNode& node) override { is_shallow = node.primitives().empty(); }
+
+  bool is_shallow = false;
+};
+
+}  // namespace
+
+class SDFEvaluator::CompilerVisitor : public ISDFTreeNodeVisitor {
+ public:
+  explicit CompilerVisitor(SDFEvaluator& evaluator) : evaluator_(evaluator) {}
+
+  void visit_group(GroupNode& node) override {
+    std::vector<std::reference_wrapper<SDFTreeNode>> children;
+    for (const auto& child_id : node) {
+      auto& child = node.get_child(child_id);
+      ShallowGroupVisitor shallow_visitor;
+      child.accept_visitor(shallow_visitor);
+      if (!shallow_visitor.is_shallow) {
+        children.emplace_back(child);
+      }
+    }
+
+    if (children.empty()) {
+      // The current node must be a root
+      return;
+    }
+
+    if (is_degenerate_scale(node)) {
+      emit(Instruction{.type = InstructionType::Empty});
+      return;
+    }
+
+    // Left fold of the children, the operation of a child combines it with everything before it
+    children.front().get().accept_visitor(*this);
+    for (auto& child : children | std::views::drop(1)) {
+      child.get().accept_visitor(*this);
+      emit(Instruction{
+          .type = InstructionType::Combine, .bin_op = child.get().bin_op(), .factor = child.get().factor()});
+    }
+    emit(Instruction{.type = InstructionType::Scale, .scale = node.transform().local_scale()});
+  }
+
+  void visit_primitive(BasePrimitiveNode& node) override {
+    if (is_degenerate_scale(node)) {
+      emit(Instruction{.type = InstructionType::Empty});
+      return;
+    }
+
+    emit(Instruction{.type           = InstructionType::Primitive,
+                     .primitive_type = node.primitive_type(),
+                     .world_to_local = node.transform().world_to_local_matrix(),
+                     .scale          = node.transform().local_scale(),
+                     .material_id    = static_cast<uint32_t>(node.active_material_id_or_default().raw()),
+                     .node_id        = node_id_override_.value_or(static_cast<uint32_t>(node.node_id().raw()))});
+  }
+
+  // The content of the prefab is inlined between the instructions moving the position into the space of the reference,
+  // like the sdPrefab function called by opInstance. The world_to_local matrices of the content are relative to the
+  // prefab root.
+  void visit_prefab_reference(PrefabReferenceNode& node) override {
+    if (is_degenerate_scale(node)) {
+      emit(Instruction{.type = InstructionType::Empty});
+      return;
+    }
+
+    GroupNode& content = node.prefab().root();
+    if (content.primitives().empty()) {
+      emit(Instruction{.type = InstructionType::Empty});
+    } else {
+      emit(Instruction{.type           = InstructionType::BeginInstance,
+                       .world_to_local = node.transform().world_to_local_matrix(),
+                       .repetition     = node.repetition()});
+      node_id_override_ = static_cast<uint32_t>(node.node_id().raw());
+      content.accept_visitor(*this);
+      node_id_override_ = std::nullopt;
+      emit(Instruction{.type = InstructionType::EndInstance});
+    }
+    emit(Instruction{.type = InstructionType::Scale, .scale = node.transform().local_scale()});
+  }
+
+  // Sizes are packed the same way as in PrimitiveUniformBuffer
+  void visit_sphere(SphereNode& node) override { evaluator_.program_.back().size = glm::vec3(node.radius); }
+  void visit_cube(CubeNode& node) override { evaluator_.program_.back().size = node.size; }
+  void visit_torus(TorusNode& node) override {
+    evaluator_.program_.back().size = glm::vec3(node.major_radius, node.minor_radius, 0);
+  }
+  void visit_capsule(CapsuleNode& node) override {
+    evaluator_.program_.back().size = glm::vec3(node.height, node.radius, 0);
+  }
+  void visit_link(LinkNode& node) override {
+    evaluator_.program_.back().size = glm::vec3(node.length, node.major_radius, node.minor_radius);
+  }
+  void visit_ellipsoid(EllipsoidNode& node) override { evaluator_.program_.back().size = node.radii; }
+  void visit_pyramid(PyramidNode& node) override { evaluator_.program_.back().size = glm::vec3(node.height, 0, 0); }
+  void visit_cylinder(CylinderNode& node) override {
+    evaluator_.program_.back().size = glm::vec3(node.height, node.radius, 0);
+  }
+  void visit_prism(TriangularPrismNode& node) override {
+    evaluator_.program_.back().size = glm::vec3(node.prismHeight, node.baseHeight, 0);
+  }
+
+ private:
+  void emit(const Instruction& instr) {
+    if (instr.type == InstructionType::Primitive || instr.type == InstructionType::Empty) {
+      ++stack_size_;
+      evaluator_.max_stack_size_ = std::max(evaluator_.max_stack_size_, stack_size_);
+    } else if (instr.type == InstructionType::Combine) {
+      --stack_size_;
+    }
+    evaluator_.program_.push_back(instr);
+  }
+
+  SDFEvaluator& evaluator_;
+  size_t stack_size_ = 0;
+
+  // Set while the content of a prefab reference is compiled
+  std::optional<uint32_t> node_id_override_;
+};
+
+SDFEvaluator::SDFEvaluator(GroupNode& root) {
+  CompilerVisitor visitor(*this);
+  root.accept_visitor(visitor);
+  compute_bounds();
+}
+
+float SDFEvaluator::distance(const glm::vec3& world_pos) const { return eval_distance(world_pos, nullptr); }
+
+float SDFEvaluator::eval_distance(const glm::vec3& world_pos, const std::vector<uint8_t>* skipped) const {
+  if (program_.empty()) {
+    return kFarPlane;
+  }
+
+  thread_local std::vector<float> stack;
+  stack.resize(std::max(stack.size(), max_stack_size_));
+
+  // The prefab references are not nested, so there is at most one instance space at a time
+  glm::vec3 pos = world_pos;
+  size_t top    = 0;
+  for (size_t i = 0; i < program_.size(); ++i) {
+    const auto& instr = program_[i];
+    if (skipped != nullptr && (*skipped)[i] != 0) {
+      stack[top++] = kFarPlane;
+      if (instr.type == InstructionType::BeginInstance) {
+        i = instr.instance_end;
+      }
+      continue;
+    }
+
+    switch (instr.type) {
+      case InstructionType::Primitive:
+        stack[top++] = eval_primitive(instr, pos);
+        break;
+      case InstructionType::BeginInstance:
+        pos = instance_pos(instr, world_pos);
+        break;
+      case InstructionType::EndInstance:
+        pos = world_pos;
+        break;
+      case InstructionType::Combine:
+        --top;
+        stack[top - 1] = eval_combine(instr, stack[top - 1], stack[top]);
+        break;
+      case InstructionType::Scale:
+        stack[top - 1] = instr.scale * stack[top - 1];
+        break;
+      case InstructionType::Empty:
+        stack[top++] = kFarPlane;
+        break;
+    }
+  }
+
+  return stack[0];
+}
+
+uint32_t SDFEvaluator::material(const glm::vec3& pos) const { return closest_tag(pos, &Instruction::material_id); }
+
+uint32_t SDFEvaluator::node_id(const glm::vec3& pos) const { return closest_tag(pos, &Instruction::node_id); }
+
+uint32_t SDFEvaluator::closest_tag(const glm::vec3& world_pos, uint32_t Instruction::* tag) const {
+  if (program_.empty()) {
+    return 0;
+  }
+
+  thread_local std::vector<std::pair<float, uint32_t>> stack;
+  stack.resize(std::max(stack.size(), max_stack_size_));
+
+  glm::vec3 pos = world_pos;
+  size_t top    = 0;
+  for (const auto& instr : program_) {
+    switch (instr.type) {
+      case InstructionType::Primitive:
+        stack[top++] = {eval_primitive(instr, pos), instr.*tag};
+        break;
+      case InstructionType::BeginInstance:
+        pos = instance_pos(instr, world_pos);
+        break;
+      case InstructionType::EndInstance:
+        pos = world_pos;
+        break;
+      case InstructionType::Combine: {
+        --top;
+        const auto [d1, t1] = stack[top - 1];
+        const auto [d2, t2] = stack[top];
+        stack[top - 1]      = {eval_combine(instr, d1, d2), combine_tag(instr, d1, t1, d2, t2)};
+        break;
+      }
+      case InstructionType::Scale:
+        stack[top - 1].first = instr.scale * stack[top - 1].first;
+        break;
+      case InstructionType::Empty:
+        stack[top++] = {kFarPlane, 0};
+        break;
+    }
+  }
+
+  return stack[0].second;
+}
+
+std::optional<SDFRayHit> SDFEvaluator::raycast(const glm::vec3& origin, const glm::vec3& direction,
+                                               float max_distance) const {
+  if (program_.empty()) {
+    return std::nullopt;
+  }
+
+  // Slab test against the bounds, the surface cannot be hit outside of them
+  const glm::vec3 dir     = glm::normalize(direction);
+  const glm::vec3 inv_dir = 1.0F / dir;
+  float t                 = 0.0F;
+  float t_end             = max_distance;
+  if (!clip_ray_to_box(origin, inv_dir, bounds_min_, bounds_max_, t, t_end)) {
+    return std::nullopt;
+  }
+
+  thread_local std::vector<uint8_t> skipped;
+  if (!skip_missed_leaves(origin, inv_dir, t, t_end, skipped)) {
+    return std::nullopt;
+  }
+
+  for (int i = 0; i < kMaxRaySteps && t <= t_end; ++i) {
+    const glm::vec3 pos = origin + (t * dir);
+    const float dist    = eval_distance(pos, &skipped);
+    if (dist < kHitEpsilon) {
+      return SDFRayHit{.node_id = node_id(pos), .distance = t, .position = pos, .normal = normal(pos)};
+    }
+    t += dist;
+  }
+
+  return std::nullopt;
+}
+
+bool SDFEvaluator::skip_missed_leaves(const glm::vec3& origin, const glm::vec3& inv_dir, float t_begin, float t_end,
+                                      std::vector<uint8_t>& skipped) const {
+  skipped.assign(program_.size(), 0);
+
+  // A leaf the ray never gets close to does not change the surface along the ray under any of the operators, e.g. the
+  // union and the difference with it leave the other operand and the intersection with it is empty. So it may be
+  // evaluated as an empty node. The leaf boxes are grown by the reach of the smooth operators.
+  bool is_any_hit = false;
+  for (size_t i = 0; i < program_.size(); ++i) {
+    const auto& instr = program_[i];
+    if (instr.type != InstructionType::Primitive && instr.type != InstructionType::BeginInstance) {
+      continue;
+    }
+
+    float leaf_begin = t_begin;
+    float leaf_end   = t_end;
+    if (clip_ray_to_box(origin, inv_dir, instr.bounds_min, instr.bounds_max, leaf_begin, leaf_end)) {
+      is_any_hit = true;
+    } else {
+      skipped[i] = 1;
+    }
+    if (instr.type == InstructionType::BeginInstance) {
+      i = instr.instance_end;
+    }
+  }
+
+  return is_any_hit;
+}
+
+void SDFEvaluator::compute_bounds() {
+  const glm::vec3 empty_min(std::numeric_limits<float>::max());
+  const glm::vec3 empty_max(std::numeric_limits<float>::lowest());
+  bounds_min_ = empty_min;
+  bounds_max_ = empty_max;
+
+  // Box of the content of the prefab reference being read, in the space of the content
+  Instruction* instance  = nullptr;
+  glm::vec3 instance_min = empty_min;
+  glm::vec3 instance_max = empty_max;
+
+  // Smooth operators move the surface outwards by at most a sixth of their factor, and blend the operands closer than
+  // their factor
+  float max_factor = 0.0F;
+  for (size_t i = 0; i < program_.size(); ++i) {
+    auto& instr = program_[i];
+    switch (instr.type) {
+      case InstructionType::Combine:
+        max_factor = std::max(max_factor, std::max(kMinSmoothFactor, instr.factor));
+        break;
+      case InstructionType::BeginInstance:
+        instance     = &instr;
+        instance_min = empty_min;
+        instance_max = empty_max;
+        break;
+      case InstructionType::EndInstance:
+        instance->bounds_min   = empty_min;
+        instance->bounds_max   = empty_max;
+        instance->instance_end = i;
+        if (instance_min.x <= instance_max.x) {
+          instance->repetition.expand_bounds(instance_min, instance_max);
+          grow_bounds(instance_min, instance_max, glm::inverse(instance->world_to_local), instance->bounds_min,
+                      instance->bounds_max);
+          bounds_min_ = glm::min(bounds_min_, instance->bounds_min);
+          bounds_max_ = glm::max(bounds_max_, instance->bounds_max);
+        }
+        instance = nullptr;
+        break;
+      case InstructionType::Primitive: {
+        glm::vec3 local_min;
+        glm::vec3 local_max;
+        local_bounds(instr, local_min, local_max);
+        const glm::mat4 local_to_parent = glm::inverse(instr.world_to_local);
+        if (instance != nullptr) {
+          grow_bounds(local_min, local_max, local_to_parent, instance_min, instance_max);
+        } else {
+          instr.bounds_min = empty_min;
+          instr.bounds_max = empty_max;
+          grow_bounds(local_min, local_max, local_to_parent, instr.bounds_min, instr.bounds_max);
+          bounds_min_ = glm::min(bounds_min_, instr.bounds_min);
+          bounds_max_ = glm::max(bounds_max_, instr.bounds_max);
+        }
+        break;
+      }
+      case InstructionType::Scale:
+      case InstructionType::Empty:
+        break;
+    }
+  }
+
+  if (bounds_min_.x <= bounds_max_.x) {
+    bounds_min_ -= (max_factor / 6.0F) + kBoundsMargin;
+    bounds_max_ += (max_factor / 6.0F) + kBoundsMargin;
+  }
+
+  // A leaf changes the surface of a smooth operator up to the factor away from its own surface
+  const float leaf_margin = max_factor + kBoundsMargin;
+  for (auto& instr : program_) {
+    if (instr.type == InstructionType::BeginInstance ||
+        (instr.type == InstructionType::Primitive && instr.bounds_min.x <= instr.bounds_max.x)) {
+      instr.bounds_min -= leaf_margin;
+      instr.bounds_max += leaf_margin;
+    }
+  }
+}
+
+void SDFEvaluator::grow_bounds(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform,
+                               glm::vec3& target_min, glm::vec3& target_max) {
+  for (int corner = 0; corner < 8; ++corner) {
+    const glm::vec3 local(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y,  // NOLINT
+                          corner & 4 ? max.z : min.z);                               // NOLINT
+    const glm::vec3 target = glm::vec3(transform * glm::vec4(local, 1.0F));
+    target_min             = glm::min(target_min, target);
+    target_max             = glm::max(target_max, target);
+  }
+}
+
+void SDFEvaluator::local_bounds(const Instruction& instr, glm::vec3& min, glm::vec3& max) {
+  // Half extents of the zero sets of eval_primitive
+  const glm::vec3 size = instr.size;
+  glm::vec3 extent(0.0F);
+  switch (instr.primitive_type) {
+    case SDFTreePrimitiveType::Sphere:
+      extent = glm::vec3(size.x);
+      break;
+    case SDFTreePrimitiveType::Cube:
+      extent = 0.5F * size;
+      break;
+    case SDFTreePrimitiveType::Torus:
+      extent = glm::vec3(size.x + size.y, size.y, size.x + size.y);
+      break;
+    case SDFTreePrimitiveType::Capsule:
+      extent = glm::vec3(size.y, (0.5F * size.x) + size.y, size.y);
+      break;
+    case SDFTreePrimitiveType::Link:
+      extent = glm::vec3(size.y + size.z, (0.5F * size.x) + size.y + size.z, size.z);
+      break;
+    case SDFTreePrimitiveType::Ellipsoid:
+      extent = size;
+      break;
+    case SDFTreePrimitiveType::Pyramid:
+      min = glm::vec3(-0.5F, 0.0F, -0.5F);
+      max = glm::vec3(0.5F, size.x, 0.5F);
+      return;
+    case SDFTreePrimitiveType::Cylinder:
+      extent = glm::vec3(size.y, 0.5F * size.x, size.y);
+      break;
+    case SDFTreePrimitiveType::TriangularPrism:
+      extent = glm::vec3(size.y, 0.5F * size.x, size.y);
+      break;
+    case SDFTreePrimitiveType::_Count:
+      break;
+  }
+  min = -extent;
+  max = extent;
+}
+
+glm::vec3 SDFEvaluator::normal(const glm::vec3& pos) const {
+  glm::vec3 n(0.0F);
+  for (int i = 0; i < 4; ++i) {
+    const glm::vec3 e =
+        0.5773F * ((2.0F * glm::vec3(((i + 3) >> 1) & 1, (i >> 1) & 1, i & 1)) - 1.0F);  // NOLINT(hicpp-signed-bitwise)
+    n += e * distance(pos + (kNormalEpsilon * e));
+  }
+  return glm::normalize(n);
+}
+
+glm::vec3 SDFEvaluator::instance_pos(const Instruction& instr, const glm::vec3& world_pos) {
+  return instr.repetition.fold(glm::vec3(instr.world_to_local * glm::vec4(world_pos, 1.0F)));
+}
+
+float SDFEvaluator::eval_primitive(const Instruction& instr, const glm::vec3& parent_pos) {
+  glm::vec3 pos        = glm::vec3(instr.world_to_local * glm::vec4(parent_pos, 1.0F));
+  const glm::vec3 size = instr.size;
+
+  float dist = kFarPlane;
+  switch (instr.primitive_type) {
+    case SDFTreePrimitiveType::Sphere:
+      dist = glm::length(pos) - size.x;
+      break;
+    case SDFTreePrimitiveType::Cube: {
+      const glm::vec3 d = glm::abs(pos) - (0.5F * size);
+      dist              = std::min(std::max(d.x, std::max(d.y, d.z)), 0.0F) + glm::length(glm::max(d, 0.0F));
+      break;
+    }
+    case SDFTreePrimitiveType::Torus: {
+      const glm::vec2 d(glm::length(glm::vec2(pos.x, pos.z)) - size.x, pos.y);
+      dist = glm::length(d) - size.y;
+      break;
+    }
+    case SDFTreePrimitiveType::Capsule: {
+      const glm::vec3 d(pos.x, pos.y - glm::clamp(pos.y, -0.5F * size.x, 0.5F * size.x), pos.z);
+      dist = glm::length(d) - size.y;
+      break;
+    }
+    case SDFTreePrimitiveType::Link: {
+      const glm::vec3 d(pos.x, std::max(std::abs(pos.y) - (0.5F * size.x), 0.0F), pos.z);
+      dist = glm::length(glm::vec2(glm::length(glm::vec2(d.x, d.y)) - size.y, d.z)) - size.z;
+      break;
+    }
+    case SDFTreePrimitiveType::Ellipsoid: {
+      const glm::vec2 d(glm::length(pos / size), glm::length(pos / (size * size)));
+      dist = d.x * (d.x - 1.0F) / d.y;
+      break;
+    }
+    case SDFTreePrimitiveType::Pyramid: {
+      if (pos.y <= 0.0F) {
+        dist = glm::length(glm::max(glm::abs(pos) - glm::vec3(0.5F, 0.0F, 0.5F), 0.0F));
+        break;
+      }
+
+      const float h  = size.x;
+      const float m2 = (h * h) + 0.25F;
+      pos.x          = std::abs(pos.x);
+      pos.z          = std::abs(pos.z);
+      if (pos.z > pos.x) {
+        std::swap(pos.x, pos.z);
+      }
+      pos.x -= 0.5F;
+      pos.z -= 0.5F;
+
+      const glm::vec3 q(pos.z, (h * pos.y) - (0.5F * pos.x), (h * pos.x) + (0.5F * pos.y));
+      const float s  = std::max(-q.x, 0.0F);
+      const float t  = glm::clamp((q.y - (0.5F * pos.z)) / (m2 + 0.25F), 0.0F, 1.0F);
+      const float a  = (m2 * (q.x + s) * (q.x + s)) + (q.y * q.y);
+      const float b  = (m2 * (q.x + (0.5F * t)) * (q.x + (0.5F * t))) + ((q.y - (m2 * t)) * (q.y - (m2 * t)));
+      const float d2 = std::min(q.y, (-q.x * m2) - (q.y * 0.5F)) > 0.0F ? 0.0F : std::min(a, b);
+      dist           = std::sqrt((d2 + (q.z * q.z)) / m2) * glm::sign(std::max(q.z, -pos.y));
+      break;
+    }
+    case SDFTreePrimitiveType::Cylinder: {
+      const glm::vec2 d =
+          glm::abs(glm::vec2(pos.y, glm::length(glm::vec2(pos.x, pos.z)))) - glm::vec2(size.x / 2, size.y);
+      dist = std::min(std::max(d.y, d.x), 0.0F) + glm::length(glm::max(d, 0.0F));
+      break;
+    }
+    case SDFTreePrimitiveType::TriangularPrism: {
+      const glm::vec3 d = glm::abs(pos);
+      dist = std::max(d.y - (size.x * 0.5F), std::max((d.x * 0.866025F) + (pos.z * 0.5F), -pos.z) - (size.y * 0.5F));
+      break;
+    }
+    case SDFTreePrimitiveType::_Count:
+      break;
+  }
+
+  return instr.scale * dist;
+}
+
+float SDFEvaluator::eval_combine(const Instruction& instr, float d1, float d2) {
+  const float k = std::max(kMinSmoothFactor, instr.factor);
+  switch (instr.bin_op) {
+    case SDFBinaryOperation::Union:
+      return std::min(d1, d2);
+    case SDFBinaryOperation::SmoothUnion:
+      return smooth_min(d1, d2, k);
+    case SDFBinaryOperation::Diff:
+      return op_diff(d1, d2);
+    case SDFBinaryOperation::SmoothDiff:
+      return smooth_max(d1, -d2, k);
+    case SDFBinaryOperation::Inter:
+      return std::max(d1, d2);
+    case SDFBinaryOperation::SmoothInter:
+      return smooth_max(d1, d2, k);
+    case SDFBinaryOperation::Xor:
+      return std::max(std::min(d1, d2), kThinRegionOffset - std::max(d1, d2));
+    case SDFBinaryOperation::SmoothXor:
+      return op_diff(smooth_min(d1, d2, k), smooth_max(d1, d2, k));
+    case SDFBinaryOperation::_Count:
+      break;
+  }
+
+  return d1;
+}
+
+uint32_t SDFEvaluator::combine_tag(const Instruction& instr, float d1, uint32_t t1, float d2, uint32_t t2) {
+  // Same selection as the id of sdf_result in the operators of sdf.glsl
+  const float k = std::max(kMinSmoothFactor, instr.factor);
+  switch (instr.bin_op) {
+    case SDFBinaryOperation::Union:
+    case SDFBinaryOperation::SmoothUnion:
+      return d1 < d2 ? t1 : t2;
+    case SDFBinaryOperation::Diff:
+      return d1 > -(d2 - kThinRegionOffset) ? t1 : t2;
+    case SDFBinaryOperation::SmoothDiff:
+      return d1 > -d2 ? t1 : t2;
+    case SDFBinaryOperation::Inter:
+    case SDFBinaryOperation::SmoothInter:
+      return d1 > d2 ? t1 : t2;
+    case SDFBinaryOperation::Xor: {
+      const uint32_t near = d1 < d2 ? t1 : t2;
+      const uint32_t far  = d1 < d2 ? t2 : t1;
+      return std::min(d1, d2) > kThinRegionOffset - std::max(d1, d2) ? near : far;
+    }
+    case SDFBinaryOperation::SmoothXor: {
+      const uint32_t near = d1 < d2 ? t1 : t2;
+      const uint32_t far  = d1 > d2 ? t1 : t2;
+      return smooth_min(d1, d2, k) > -(smooth_max(d1, d2, k) - kThinRegionOffset) ? near : far;
+    }
+    case SDFBinaryOperation::_Count:
+      break;
+  }
+
+  return t1;
+}
+
+}  // namespace resin
@@ -0,0 +1,125 @@
+#ifndef RESIN_SDF_EVALUATOR_HPP
+#define RESIN_SDF_EVALUATOR_HPP
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/primitive_base_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <optional>
+#include <vector>
+
+namespace resin {
+
+struct SDFRayHit {
+  uint32_t node_id;  // raw id of the hit primitive node, matches the id output of main.frag
+  float distance;    // along the normalized ray direction
+  glm::vec3 position;
+  glm::vec3 normal;
+};
+
+// Native counterpart of the SDF code generated by GroupNode::gen_shader_code, the distance functions and operators
+// mirror sdf.glsl. The subtree is flattened into a postfix program when the evaluator is created, so the evaluation
+// neither touches the tree nor the GL state and may run on many threads at once.
+class SDFEvaluator {
+ public:
+  explicit SDFEvaluator(GroupNode& root);
+
+  float distance(const glm::vec3& pos) const;
+
+  // Tetrahedral gradient estimate, matches calcNormal of the shaders.
+  glm::vec3 normal(const glm::vec3& pos) const;
+
+  // Raw id of the material of the primitive that wins the operators at the position, matches sdf_result.mat_id of the
+  // shaders. Smooth operators blend the materials for rendering, here the closer operand wins.
+  uint32_t material(const glm::vec3& pos) const;
+
+  // Raw id of the primitive node that wins the operators at the position, same selection as material.
+  uint32_t node_id(const glm::vec3& pos) const;
+
+  // Sphere traces the ray like raycast of main.frag, but only inside the bounds of the primitives. The primitives and
+  // the prefab references whose own bounds the ray misses are not evaluated while marching. A ray starting inside the
+  // surface hits right away.
+  std::optional<SDFRayHit> raycast(const glm::vec3& origin, const glm::vec3& direction,
+                                   float max_distance = kFarPlane) const;
+
+  inline bool empty() const { return program_.empty(); }
+  inline size_t instruction_count() const { return program_.size(); }
+
+  // World space box containing the surface, empty (min > max) if there are no primitives.
+  inline const glm::vec3& bounds_min() const { return bounds_min_; }
+  inline const glm::vec3& bounds_max() const { return bounds_max_; }
+
+  // Distance returned where nothing is evaluated, matches u_farPlane of the shaders.
+  static constexpr float kFarPlane = 100.0F;
+
+ private:
+  enum class InstructionType : uint8_t {
+    Primitive = 0,
+    Combine   = 1,
+    Scale     = 2,
+    Empty     = 3,
+
+    // Move the position into the space of a prefab reference and back, see PrefabReferenceNode
+    BeginInstance = 4,
+    EndInstance   = 5,
+  };
+
+  struct Instruction {
+    InstructionType type;
+    SDFTreePrimitiveType primitive_type = SDFTreePrimitiveType::Sphere;
+    SDFBinaryOperation bin_op           = SDFBinaryOperation::Union;
+    glm::mat4 world_to_local            = glm::mat4(1.0F);
+    glm::vec3 size                      = glm::vec3(0.0F);
+    float scale                         = 1.0F;
+    float factor                        = 0.0F;
+    uint32_t material_id                = 0;
+    uint32_t node_id                    = 0;
+    Repetition repetition;
+
+    // World space box of a primitive outside of the prefab references or of a whole reference, used to skip it when a
+    // ray misses it. The box of a reference is kept in its BeginInstance instruction, together with the index of the
+    // matching EndInstance.
+    glm::vec3 bounds_min = glm::vec3(0.0F);
+    glm::vec3 bounds_max = glm::vec3(0.0F);
+    size_t instance_end  = 0;
+  };
+
+  class CompilerVisitor;
+
+  // Position in the space of the prefab content, folded by the repetition of the reference
+  static glm::vec3 instance_pos(const Instruction& instr, const glm::vec3& world_pos);
+
+  // The position is in the world space or in the space of the prefab content
+  static float eval_primitive(const Instruction& instr, const glm::vec3& parent_pos);
+  static float eval_combine(const Instruction& instr, float d1, float d2);
+  static uint32_t combine_tag(const Instruction& instr, float d1, uint32_t t1, float d2, uint32_t t2);
+  static void local_bounds(const Instruction& instr, glm::vec3& min, glm::vec3& max);
+
+  // Grows the target box to contain the transformed box
+  static void grow_bounds(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform, glm::vec3& target_min,
+                          glm::vec3& target_max);
+
+  // The instructions flagged in skipped evaluate to kFarPlane, a skipped BeginInstance skips the whole reference
+  float eval_distance(const glm::vec3& world_pos, const std::vector<uint8_t>* skipped) const;
+
+  // Flags the primitives and the references whose bounds the ray misses between t_begin and t_end. Returns false if
+  // every one of them is missed.
+  bool skip_missed_leaves(const glm::vec3& origin, const glm::vec3& inv_dir, float t_begin, float t_end,
+                          std::vector<uint8_t>& skipped) const;
+
+  // Tag (material or node id) of the primitive selected by the operators at the position
+  uint32_t closest_tag(const glm::vec3& world_pos, uint32_t Instruction::* tag) const;
+  void compute_bounds();
+
+  std::vector<Instruction> program_;
+  size_t max_stack_size_ = 0;
+  glm::vec3 bounds_min_;
+  glm::vec3 bounds_max_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_SDF_EVALUATOR_HPP
@@ -0,0 +1,41 @@
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/utils/logger.hpp>
+#include <memory>
+#include <utility>
+
+namespace resin {
+
+SDFSubtreeBuilder::SDFSubtreeBuilder(std::unique_ptr<GroupNode> root) : root_(std::move(root)) {}
+
+SDFTreeNode& SDFSubtreeBuilder::push_back_primitive(GroupNode& parent, SDFTreePrimitiveType type,
+                                                    SDFBinaryOperation op) {
+  auto node_ptr = parent.create_primitive(type);
+  node_ptr->set_bin_op(op);
+  SDFTreeNode& result = *node_ptr;
+  push_back_child(parent, std::move(node_ptr));
+  return result;
+}
+
+void SDFSubtreeBuilder::push_back_child(GroupNode& parent, std::unique_ptr<SDFTreeNode> node_ptr) {
+  parent.append_unlinked_child(std::move(node_ptr));
+}
+
+void SDFSubtreeBuilder::push_back_built_subtree(GroupNode& parent, std::unique_ptr<GroupNode> subtree) {
+  built_subtrees_.emplace(subtree->node_id());
+  parent.append_unlinked_child(std::move(subtree));
+}
+
+void SDFSubtreeBuilder::set_material(SDFTreeNode& node, IdView<MaterialId> mat_id) { node.mat_id_ = mat_id; }
+
+std::unique_ptr<GroupNode> SDFSubtreeBuilder::build() {
+  Logger::debug("Linking a subtree built in bulk with root id {}", root_->node_id().raw());
+  root_->link_subtree(built_subtrees_);
+  root_->mark_dirty();
+  root_->tree_registry_.is_tree_dirty = true;
+  return std::move(root_);
+}
+
+}  // namespace resin
@@ -0,0 +1,66 @@
+#ifndef RESIN_SDF_SUBTREE_BUILDER_HPP
+#define RESIN_SDF_SUBTREE_BUILDER_HPP
+
+#include <concepts>
+#include <functional>
+#include <libresin/core/id_registry.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+namespace resin {
+
+// Assembles a detached subtree in bulk. The children are only appended to their parents while the subtree is built,
+// and the material ancestors, the leaves of the groups and the dirty state are computed once by build(), in a single
+// traversal. Pushing the children directly costs O(h) each, which makes building a whole tree O(nh).
+//
+// The parents passed to the builder must be the root or the groups created by the same builder. The nodes must not be
+// used as a part of a tree until build() is called. The builders of different subtrees may be used concurrently, so
+// the sibling subtrees may be built on separate threads and then attached with push_back_built_subtree.
+class SDFSubtreeBuilder {
+ public:
+  explicit SDFSubtreeBuilder(std::unique_ptr<GroupNode> root);
+
+  inline GroupNode& root() { return *root_; }
+
+  // Cost: O(1)
+  template <SDFTreeNodeConcept Node, typename... Args>
+    requires std::constructible_from<Node, SDFTreeRegistry&, Args...>
+  inline Node& push_back_child(GroupNode& parent, SDFBinaryOperation op, Args&&... args) {
+    auto node_ptr = std::make_unique<Node>(root_->tree_registry_, std::forward<Args>(args)...);
+    node_ptr->set_bin_op(op);
+    Node& result = *node_ptr;
+    push_back_child(parent, std::move(node_ptr));
+    return result;
+  }
+
+  // Cost: O(1)
+  SDFTreeNode& push_back_primitive(GroupNode& parent, SDFTreePrimitiveType type, SDFBinaryOperation op);
+
+  // The node_ptr may be a whole subtree, which is relinked by build() as well.
+  // Cost: O(1)
+  void push_back_child(GroupNode& parent, std::unique_ptr<SDFTreeNode> node_ptr);
+
+  // Appends a subtree returned by build() of another builder. Its nodes are not traversed again, build() only
+  // propagates the material of the parent into it.
+  // Cost: O(1)
+  void push_back_built_subtree(GroupNode& parent, std::unique_ptr<GroupNode> subtree);
+
+  // Unlike SDFTreeNode::set_material, the material is not propagated to the descendants until build() is called.
+  // Cost: O(1)
+  void set_material(SDFTreeNode& node, IdView<MaterialId> mat_id);
+
+  // Cost: O(n + l), where l is the total size of the leaf sets of the groups
+  // Note: The builder must not be used afterwards.
+  [[nodiscard]] std::unique_ptr<GroupNode> build();
+
+ private:
+  std::unique_ptr<GroupNode> root_;
+  std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>> built_subtrees_;
+};
+
+}  // namespace resin
+
+#endif
@@ -2,7 +2,10 @@
 #include <libresin/core/material.hpp>
 #include <libresin/core/sdf_shader_consts.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
 #include <libresin/core/sdf_tree/primitive_base_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/utils/exceptions.hpp>
@@ -11,10 +14,31 @@
 #include <utility>
 
 namespace resin {
+
+namespace {
+
+class PrefabReferenceVisitor : public ISDFTreeNodeVisitor {
+ public:
+  void visit_prefab_reference(PrefabReferenceNode& node) override { reference = &node; }
+
+  PrefabReferenceNode* reference = nullptr;
+};
+
+size_t subtree_node_count(const SDFTree& tree, const GroupNode& group) {
+  size_t count = 1;
+  for (auto child_id : group) {
+    count += tree.is_group(child_id) ? subtree_node_count(tree, tree.group(child_id)) : 1;
+  }
+  return count;
+}
+
+}  // namespace
+
 size_t SDFTree::curr_id_ = 0;
 
 SDFTree::SDFTree() : root_(std::make_unique<GroupNode>(sdf_tree_registry_)), tree_id_((curr_id_++)) {
   materials_.resize(sdf_tree_registry_.materials_registry.get_max_objs());
+  prefabs_.resize(sdf_tree_registry_.prefabs_registry.get_max_objs());
 }
 
 std::optional<IdView<SDFTreeNodeId>> SDFTree::get_view_from_raw_id(size_t raw_id) {
@@ -83,6 +107,12 @@ void SDFTree::visit_all_primitives(ISDFTreeNodeVisitor& visitor) {
   for (auto prim : root_->primitives()) {
     sdf_tree_registry_.all_nodes[prim.raw()]->get().accept_visitor(visitor);
   }
+
+  for (const auto& prefab_id : prefab_active_ids_) {
+    for (auto prim : (*prefabs_[prefab_id.raw()])->root().primitives()) {
+      sdf_tree_registry_.all_nodes[prim.raw()]->get().accept_visitor(visitor);
+    }
+  }
 }
 
 void SDFTree::delete_node(IdView<SDFTreeNodeId> node_id) {
@@ -102,6 +132,17 @@ std::string SDFTree::gen_shader_code(GenShaderMode mode) const {
   return root_code.empty() ? "sdEmpty()" : root_code;
 }
 
+std::string SDFTree::gen_shader_functions(GenShaderMode mode) const {
+  std::string functions;
+  for (const auto& prefab_id : prefab_active_ids_) {
+    const Prefab& prefab = **prefabs_[prefab_id.raw()];
+    if (prefab.reference_count() > 0) {
+      functions += prefab.gen_shader_function(mode);
+    }
+  }
+  return functions;
+}
+
 const MaterialSDFTreeComponent& SDFTree::material(IdView<MaterialId> mat_id) const {
   if (mat_id == sdf_tree_registry_.default_material.material_id()) {
     return sdf_tree_registry_.default_material;
@@ -131,6 +172,9 @@ void SDFTree::delete_material(IdView<MaterialId> mat_id) {
   }
 
   root_->remove_material_from_subtree(mat_id);
+  for (const auto& prefab_id : prefab_active_ids_) {
+    (*prefabs_[prefab_id.raw()])->root().remove_material_from_subtree(mat_id);
+  }
 
   std::erase(material_active_ids_, mat_id);
 
@@ -155,12 +199,138 @@ void SDFTree::visit_dirty_materials(const std::function<void(MaterialSDFTreeComp
   }
 }
 
-void SDFTree::set_root(std::unique_ptr<GroupNode> root) { root_ = std::move(root); }
+const Prefab& SDFTree::prefab(IdView<PrefabId> prefab_id) const {
+  if (!prefabs_[prefab_id.raw()].has_value()) {
+    log_throw(PrefabDoesNotExist(prefab_id.raw()));
+  }
+  return **prefabs_[prefab_id.raw()];
+}
+
+Prefab& SDFTree::prefab(IdView<PrefabId> prefab_id) {
+  return const_cast<Prefab&>(std::as_const(*this).prefab(prefab_id));  // NOLINT
+}
+
+Prefab& SDFTree::add_prefab(std::unique_ptr<GroupNode> root, std::string path) {
+  for (auto leaf : root->primitives()) {
+    PrefabReferenceVisitor visitor;
+    visit_node(leaf, visitor);
+    if (visitor.reference != nullptr) {
+      log_throw(NestedPrefabReferenceException());
+    }
+  }
+
+  auto new_prefab = std::make_unique<Prefab>(sdf_tree_registry_, std::move(root), std::move(path));
+  auto id         = new_prefab->prefab_id();
+  Logger::info("Created new prefab with id {}", id.raw());
+  prefab_active_ids_.push_back(id);
+  prefabs_[id.raw()] = std::move(new_prefab);
+  return **prefabs_[id.raw()];
+}
+
+std::optional<std::reference_wrapper<Prefab>> SDFTree::find_prefab(std::string_view path) {
+  if (path.empty()) {
+    return std::nullopt;
+  }
+
+  for (const auto& prefab_id : prefab_active_ids_) {
+    if ((*prefabs_[prefab_id.raw()])->path() == path) {
+      return **prefabs_[prefab_id.raw()];
+    }
+  }
+  return std::nullopt;
+}
+
+void SDFTree::delete_unused_prefabs() {
+  std::erase_if(prefab_active_ids_, [this](const auto& prefab_id) {
+    if ((*prefabs_[prefab_id.raw()])->reference_count() > 0 || (*prefabs_[prefab_id.raw()])->is_retained()) {
+      return false;
+    }
+    Logger::info("Deleted unused prefab with id {}", prefab_id.raw());
+    prefabs_[prefab_id.raw()] = std::nullopt;
+    return true;
+  });
+}
+
+GroupNode& SDFTree::expand_prefab_reference(IdView<SDFTreeNodeId> node_id) {
+  PrefabReferenceVisitor visitor;
+  visit_node(node_id, visitor);
+  if (visitor.reference == nullptr) {
+    log_throw(SDFTreeNodeIsNotAPrefabReference(node_id.raw()));
+  }
+
+  // The copies are checked against the free ids up front, so that a large repetition cannot leave the registries
+  // exhausted halfway through the expansion
+  Prefab& prefab                   = visitor.reference->prefab();
+  const size_t copies              = visitor.reference->repetition().instance_count();
+  const size_t instance_group_size = visitor.reference->repetition().type == RepetitionType::None ? 0 : 1;
+  const size_t nodes_needed        = 1 + copies * (subtree_node_count(*this, prefab.root()) + instance_group_size);
+  const size_t primitives_needed   = copies * prefab.root().primitives().size();
+  if (nodes_needed > sdf_tree_registry_.nodes_registry.get_free_objs() ||
+      nodes_needed > sdf_tree_registry_.transform_component_registry.get_free_objs() ||
+      primitives_needed > sdf_tree_registry_.primitives_registry.get_free_objs()) {
+    log_throw(ObjectsOverflowException());
+  }
+
+  std::unique_ptr<GroupNode> group = visitor.reference->expand();
+  GroupNode& result                = *group;
+  GroupNode& parent                = visitor.reference->parent();
+  parent.insert_before_child(node_id, std::move(group));
+  parent.delete_child(node_id);
+  return result;
+}
+
+PrefabReferenceNode& SDFTree::instance_group(IdView<SDFTreeNodeId> node_id) {
+  GroupNode& group = this->group(node_id);
+  if (!group.has_parent()) {
+    log_throw(SDFTreeRootDeletionError());
+  }
+  for (auto leaf : group.primitives()) {
+    PrefabReferenceVisitor visitor;
+    visit_node(leaf, visitor);
+    if (visitor.reference != nullptr) {
+      log_throw(NestedPrefabReferenceException());
+    }
+  }
+
+  // The content is rendered with its own materials only, so the inherited material must be kept
+  if (!group.material_id().has_value() && group.active_material_id().has_value()) {
+    group.set_material(*group.active_material_id());
+  }
+
+  GroupNode& parent = group.parent();
+  std::optional<IdView<SDFTreeNodeId>> next_id;
+  if (parent.child_has_neighbor_next(node_id)) {
+    next_id = parent.child_neighbor_next(node_id).node_id();
+  }
+  auto content = std::unique_ptr<GroupNode>(static_cast<GroupNode*>(parent.detach_child(node_id).release()));
+
+  Prefab& prefab = add_prefab(std::move(content));
+  auto reference = std::make_unique<PrefabReferenceNode>(sdf_tree_registry_, prefab);
+  SDFTreeNode::copy_common(*reference, prefab.root());
+  prefab.root().transform().set_local_from_matrix(glm::mat4(1.0F));
+  prefab.root().set_bin_op(SDFBinaryOperation::Union);
+  prefab.root().mark_dirty();
+  prefab.root().mark_primitives_dirty();
+
+  PrefabReferenceNode& result = *reference;
+  parent.insert_before_child(next_id, std::move(reference));
+  return result;
+}
+
+void SDFTree::set_root(std::unique_ptr<GroupNode> root) {
+  root_ = std::move(root);
+  ++generation_;
+}
 
 void SDFTree::clear() {
   material_active_ids_.clear();
   std::ranges::fill(materials_.begin(), materials_.end(), std::nullopt);
   root_ = create_detached_node<GroupNode>();
+  ++generation_;
+
+  // The references are gone with the old root
+  prefab_active_ids_.clear();
+  std::ranges::fill(prefabs_.begin(), prefabs_.end(), std::nullopt);
 }
 
 }  // namespace resin
@@ -4,12 +4,16 @@
 #include <functional>
 #include <libresin/core/id_registry.hpp>
 #include <libresin/core/material.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node_visitor.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_registry.hpp>
 #include <libresin/core/transform.hpp>
 #include <libresin/utils/exceptions.hpp>
+#include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
 
 namespace resin {
 class GroupNode;
@@ -34,6 +38,7 @@ class SDFTree {
   inline const SDFTreeRegistry::NodesSet& dirty_node_attributes() const {
     return sdf_tree_registry_.dirty_node_attributes;
   }
+  inline const SDFTreeRegistry::MaterialsSet& dirty_materials() const { return sdf_tree_registry_.dirty_materials; }
 
   // Cost O(1)
   SDFTreeNode& node(IdView<SDFTreeNodeId> node_id);
@@ -53,6 +58,9 @@ class SDFTree {
 
   std::string gen_shader_code(GenShaderMode mode = GenShaderMode::SinglePrimitiveArray) const;
 
+  // Definitions of the shader functions of the referenced prefabs called by the code of gen_shader_code, in one line.
+  std::string gen_shader_functions(GenShaderMode mode = GenShaderMode::SinglePrimitiveArray) const;
+
   inline GroupNode& root() { return *root_; }
   inline const GroupNode& root() const { return *root_; }
 
@@ -64,6 +72,10 @@ class SDFTree {
 
   inline size_t tree_id() const { return tree_id_; }
 
+  // Incremented whenever the root is replaced, e.g. when a scene is loaded, so that the ids held outside of the tree
+  // can be told apart from the ids of the previous root.
+  inline size_t generation() const { return generation_; }
+
   inline bool is_dirty() const { return sdf_tree_registry_.is_tree_dirty; }
   inline void mark_clean() { sdf_tree_registry_.is_tree_dirty = false; }
 
@@ -87,8 +99,39 @@ class SDFTree {
   void visit_dirty_materials(const std::function<void(MaterialSDFTreeComponent&)>& mat_visitor);
   inline void mark_materials_clean() { sdf_tree_registry_.dirty_materials.clear(); }
 
+  Prefab& prefab(IdView<PrefabId> prefab_id);
+  const Prefab& prefab(IdView<PrefabId> prefab_id) const;
+
+  // Takes over the content of a prefab, so that it can be referenced by PrefabReferenceNode. The content must not
+  // contain prefab references itself.
+  // Cost: O(l), where l is the number of the leaves of the content
+  Prefab& add_prefab(std::unique_ptr<GroupNode> root, std::string path = "");
+
+  // Prefab loaded from the path, used to share the content of a file referenced more than once.
+  // Cost: O(p), where p is the number of the prefabs
+  std::optional<std::reference_wrapper<Prefab>> find_prefab(std::string_view path);
+
+  // The retained prefabs are kept, see Prefab::retain.
+  // Cost: O(p), where p is the number of the prefabs
+  void delete_unused_prefabs();
+
+  // Replaces the reference with a group holding a copy of the prefab content, so that the content can be edited. The
+  // prefab is kept even if it is no longer referenced. Throws ObjectsOverflowException and leaves the tree unchanged if
+  // the registries cannot hold every repeated copy.
+  // Cost: O(kn + h), where n is the number of the prefab nodes and k is the number of the copies
+  GroupNode& expand_prefab_reference(IdView<SDFTreeNodeId> node_id);
+
+  // Replaces the group with a reference to a new prefab holding the group, the inverse of expand_prefab_reference. The
+  // reference takes over the transform and the operation of the group, so that its content can be repeated. The group
+  // must not contain prefab references.
+  // Cost: O(l + h), where l is the number of the leaves of the group
+  PrefabReferenceNode& instance_group(IdView<SDFTreeNodeId> node_id);
+
+  inline const std::vector<IdView<PrefabId>>& prefabs() const { return prefab_active_ids_; }
+
   inline size_t max_node_count() const { return sdf_tree_registry_.nodes_registry.get_max_objs(); }
   inline size_t max_material_count() const { return sdf_tree_registry_.materials_registry.get_max_objs(); }
+  inline size_t max_prefab_count() const { return sdf_tree_registry_.prefabs_registry.get_max_objs(); }
 
   void set_root(std::unique_ptr<GroupNode> root);
   void clear();
@@ -97,8 +140,14 @@ class SDFTree {
   static size_t curr_id_;
 
   SDFTreeRegistry sdf_tree_registry_;
+
+  // The prefabs must outlive the references in the tree
+  std::vector<IdView<PrefabId>> prefab_active_ids_;
+  std::vector<std::optional<std::unique_ptr<Prefab>>> prefabs_;
+
   std::unique_ptr<GroupNode> root_;
   size_t tree_id_;
+  size_t generation_ = 0;
 
   std::vector<IdView<MaterialId>> material_active_ids_;
   std::vector<std::optional<std::unique_ptr<MaterialSDFTreeComponent>>> materials_;
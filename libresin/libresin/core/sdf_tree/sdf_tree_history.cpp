@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <cstring>
+#include <libresin/core/material.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_history.hpp>
+#include <limits>
+#include <utility>
+
+namespace resin {
+
+namespace {
+
+constexpr uint32_t kNoKey = std::numeric_limits<uint32_t>::max();
+
+template <typename T>
+bool equal_records(const T& lhs, const T& rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+class PrefabReferenceFinder : public ISDFTreeNodeVisitor {
+ public:
+  void visit_prefab_reference(PrefabReferenceNode& node) override { reference_ = &node; }
+
+  inline PrefabReferenceNode* reference() const { return reference_; }
+
+ private:
+  PrefabReferenceNode* reference_ = nullptr;
+};
+
+void retain(const std::vector<Prefab*>& prefabs) {
+  for (Prefab* prefab : prefabs) {
+    prefab->retain();
+  }
+}
+
+void add_prefab(std::vector<Prefab*>& prefabs, Prefab* prefab) {
+  if (std::ranges::find(prefabs, prefab) == prefabs.end()) {
+    prefabs.push_back(prefab);
+  }
+}
+
+}  // namespace
+
+bool SDFTreeHistory::NodeState::operator==(const NodeState& other) const {
+  return parent == other.parent && prev == other.prev && name == other.name && equal_records(record, other.record);
+}
+
+bool SDFTreeHistory::MaterialState::operator==(const MaterialState& other) const {
+  return name == other.name && equal_records(record, other.record);
+}
+
+SDFTreeHistory::SDFTreeHistory(SDFTree& tree) : tree_(tree), generation_(tree.generation()) {
+  set_current(capture());
+}
+
+SDFTreeHistory::~SDFTreeHistory() {
+  // The prefabs were destroyed with the replaced tree
+  if (tree_.generation() != generation_) {
+    return;
+  }
+  release(state_.prefabs);
+  for (Step& step : steps_) {
+    release(step.prefabs);
+  }
+}
+
+bool SDFTreeHistory::commit() {
+  check_generation();
+  State state = capture();
+
+  Step step;
+  std::unordered_map<uint32_t, size_t> before_orders;
+  for (size_t i = 0; i < state_.node_order.size(); ++i) {
+    before_orders.emplace(state_.node_order[i], i);
+  }
+  for (size_t i = 0; i < state.node_order.size(); ++i) {
+    const uint32_t key = state.node_order[i];
+    const auto& node   = state.nodes.at(key);
+    auto old_it        = state_.nodes.find(key);
+    if (old_it != state_.nodes.end() && old_it->second == node) {
+      continue;
+    }
+    step.nodes.push_back(NodeChange{
+        .key          = key,
+        .before       = old_it == state_.nodes.end() ? std::nullopt : std::optional(old_it->second),
+        .after        = node,
+        .before_order = old_it == state_.nodes.end() ? 0 : before_orders.at(key),
+        .after_order  = i,
+    });
+  }
+  for (const uint32_t key : state_.node_order) {
+    if (!state.nodes.contains(key)) {
+      step.nodes.push_back(NodeChange{
+          .key          = key,
+          .before       = state_.nodes.at(key),
+          .after        = std::nullopt,
+          .before_order = before_orders.at(key),
+          .after_order  = 0,
+      });
+    }
+  }
+
+  for (const auto& [key, material] : state.materials) {
+    auto old_it = state_.materials.find(key);
+    if (old_it == state_.materials.end() || !(old_it->second == material)) {
+      step.materials.push_back(MaterialChange{
+          .key    = key,
+          .before = old_it == state_.materials.end() ? std::nullopt : std::optional(old_it->second),
+          .after  = material,
+      });
+    }
+  }
+  for (const auto& [key, material] : state_.materials) {
+    if (!state.materials.contains(key)) {
+      step.materials.push_back(MaterialChange{.key = key, .before = material, .after = std::nullopt});
+    }
+  }
+
+  if (step.nodes.empty() && step.materials.empty()) {
+    set_current(std::move(state));
+    return false;
+  }
+
+  for (const NodeChange& change : step.nodes) {
+    for (const auto* node : {&change.before, &change.after}) {
+      if (node->has_value() && (*node)->record.type == binary::kPrefabReferenceNodeType) {
+        add_prefab(step.prefabs, prefabs_.at((*node)->record.prefab));
+      }
+    }
+  }
+  retain(step.prefabs);
+
+  while (steps_.size() > current_) {
+    release(steps_.back().prefabs);
+    steps_.pop_back();
+  }
+  steps_.push_back(std::move(step));
+  if (steps_.size() > kMaxSteps) {
+    release(steps_.front().prefabs);
+    steps_.pop_front();
+  }
+  current_ = steps_.size();
+
+  set_current(std::move(state));
+  return true;
+}
+
+bool SDFTreeHistory::undo() {
+  commit();
+  if (!can_undo()) {
+    return false;
+  }
+
+  --current_;
+  apply(steps_[current_], false);
+  return true;
+}
+
+bool SDFTreeHistory::redo() {
+  commit();
+  if (!can_redo()) {
+    return false;
+  }
+
+  apply(steps_[current_], true);
+  ++current_;
+  return true;
+}
+
+void SDFTreeHistory::clear() {
+  for (Step& step : steps_) {
+    release(step.prefabs);
+  }
+  steps_.clear();
+  current_ = 0;
+}
+
+SDFTreeHistory::State SDFTreeHistory::capture() {
+  State state;
+  Keys material_keys;
+  for (const auto mat_id : tree_.materials()) {
+    const MaterialSDFTreeComponent& material = tree_.material(mat_id);
+
+    // The key of a material is kept as long as the material is alive
+    auto key_it  = material_keys_.key_of_raw.find(mat_id.raw());
+    uint32_t key = material_keys_.next_key;
+    if (key_it != material_keys_.key_of_raw.end() && material_keys_.raw_of_key.at(key_it->second) == mat_id.raw() &&
+        state_.materials.contains(key_it->second)) {
+      key = key_it->second;
+    } else {
+      ++material_keys_.next_key;
+    }
+    material_keys.assign(key, mat_id.raw());
+
+    MaterialState material_state{
+        .record = binary::make_material_record(material),
+        .name   = std::string(material.name()),
+    };
+    material_state.record.id = key;
+    state.materials.emplace(key, std::move(material_state));
+  }
+  material_keys.next_key = material_keys_.next_key;
+  material_keys_         = std::move(material_keys);
+
+  Keys node_keys;
+  node_keys.next_key = node_keys_.next_key;
+  std::swap(node_keys, node_keys_);
+  capture_node(tree_.root(), kNoKey, kNoKey, state, node_keys);
+  return state;
+}
+
+void SDFTreeHistory::capture_node(SDFTreeNode& node, uint32_t parent, uint32_t prev, State& state,
+                                  const Keys& old_keys) {
+  const size_t raw          = node.node_id().raw();
+  binary::NodeRecord record = binary::make_node_record(node);
+  if (record.material_id != binary::kNoMaterial) {
+    auto mat_it        = material_keys_.key_of_raw.find(record.material_id);
+    record.material_id = mat_it == material_keys_.key_of_raw.end() ? binary::kNoMaterial : mat_it->second;
+  }
+  PrefabReferenceFinder finder;
+  node.accept_visitor(finder);
+  if (finder.reference() != nullptr) {
+    Prefab& prefab          = finder.reference()->prefab();
+    record.prefab           = static_cast<uint16_t>(prefab.prefab_id().raw());
+    prefabs_[record.prefab] = &prefab;
+    add_prefab(state.prefabs, &prefab);
+  }
+
+  // The key of a node is kept as long as the node is alive. A node that changed its type took the raw id of a deleted
+  // node, so it gets a new key.
+  auto key_it  = old_keys.key_of_raw.find(raw);
+  uint32_t key = node_keys_.next_key;
+  if (key_it != old_keys.key_of_raw.end() && old_keys.raw_of_key.at(key_it->second) == raw) {
+    auto old_it = state_.nodes.find(key_it->second);
+    if (old_it != state_.nodes.end() && old_it->second.record.type == record.type &&
+        old_it->second.record.prefab == record.prefab) {
+      key = key_it->second;
+    }
+  }
+  if (key == node_keys_.next_key) {
+    ++node_keys_.next_key;
+  }
+  node_keys_.assign(key, raw);
+
+  NodeState node_state{
+      .parent = parent,
+      .prev   = prev,
+      .record = record,
+      .name   = std::string(node.name()),
+  };
+  state.node_order.push_back(key);
+  state.nodes.emplace(key, std::move(node_state));
+  if (!tree_.is_group(node.node_id())) {
+    return;
+  }
+
+  uint32_t child_prev = kNoKey;
+  GroupNode& group    = tree_.group(node.node_id());
+  for (const auto child_id : group) {
+    capture_node(group.get_child(child_id), key, child_prev, state, old_keys);
+    child_prev = node_keys_.key_of_raw.at(child_id.raw());
+  }
+}
+
+void SDFTreeHistory::set_current(State state) {
+  retain(state.prefabs);
+  release(state_.prefabs);
+  state_ = std::move(state);
+}
+
+void SDFTreeHistory::check_generation() {
+  if (tree_.generation() == generation_) {
+    return;
+  }
+
+  // The prefabs were destroyed with the replaced tree, so they are dropped without being released
+  generation_ = tree_.generation();
+  steps_.clear();
+  current_ = 0;
+  state_   = State{};
+  node_keys_.clear();
+  material_keys_.clear();
+  prefabs_.clear();
+  set_current(capture());
+}
+
+void SDFTreeHistory::apply(const Step& step, bool forward) {
+  for (const MaterialChange& change : step.materials) {
+    const auto& target = forward ? change.after : change.before;
+    if (!target) {
+      continue;
+    }
+
+    const auto& record = target->record;
+    Material material(glm::vec3(record.albedo[0], record.albedo[1], record.albedo[2]), record.ambient,
+                      record.diffuse, record.specular, record.specular_exponent);
+    if (auto mat_id = material_of_key(change.key)) {
+      auto& mat    = tree_.material(*mat_id);
+      mat.material = material;
+      mat.rename(std::string(target->name));
+      mat.mark_dirty();
+    } else {
+      auto& mat = tree_.add_material(material);
+      mat.rename(std::string(target->name));
+      material_keys_.assign(change.key, mat.material_id().raw());
+    }
+  }
+
+  // The parents and the previous siblings come first in the pre-order, so they are in place when a node is placed
+  std::vector<const NodeChange*> placed;
+  std::vector<const NodeChange*> removed;
+  for (const NodeChange& change : step.nodes) {
+    ((forward ? change.after : change.before) ? placed : removed).push_back(&change);
+  }
+  std::ranges::sort(placed, {}, [forward](const NodeChange* change) {
+    return forward ? change->after_order : change->before_order;
+  });
+
+  for (const NodeChange* change : placed) {
+    const auto& source = forward ? change->before : change->after;
+    const auto& target = forward ? change->after : change->before;
+    if (!source) {
+      SDFTreeNode& node = create_node(*target);
+      node_keys_.assign(change->key, node.node_id().raw());
+      place_node(node, *target);
+      apply_node(node, nullptr, *target);
+      continue;
+    }
+
+    SDFTreeNode& node = node_of_key(change->key);
+    if (source->parent != target->parent || source->prev != target->prev) {
+      place_node(node, *target);
+    }
+    apply_node(node, &*source, *target);
+  }
+
+  // The removed children of a removed group are deleted with it
+  for (const NodeChange* change : removed) {
+    const auto& source = forward ? change->before : change->after;
+    const bool is_parent_removed = std::ranges::any_of(removed, [&source](const NodeChange* other) {
+      return other->key == source->parent;
+    });
+    if (!is_parent_removed) {
+      tree_.delete_node(node_of_key(change->key).node_id());
+    }
+  }
+
+  for (const MaterialChange& change : step.materials) {
+    if (!(forward ? change.after : change.before)) {
+      tree_.delete_material(*material_of_key(change.key));
+    }
+  }
+
+  // The objects recreated by the step keep their keys, as the state they are captured against holds the target states
+  for (const NodeChange& change : step.nodes) {
+    const auto& target = forward ? change.after : change.before;
+    if (target) {
+      state_.nodes[change.key] = *target;
+    } else {
+      state_.nodes.erase(change.key);
+    }
+  }
+  for (const MaterialChange& change : step.materials) {
+    const auto& target = forward ? change.after : change.before;
+    if (target) {
+      state_.materials[change.key] = *target;
+    } else {
+      state_.materials.erase(change.key);
+    }
+  }
+  set_current(capture());
+}
+
+void SDFTreeHistory::apply_node(SDFTreeNode& node, const NodeState* from, const NodeState& to) {
+  if (from == nullptr || !equal_records(from->record, to.record)) {
+    binary::apply_node_record(node, to.record);
+  }
+
+  const uint32_t from_material = from == nullptr ? binary::kNoMaterial : from->record.material_id;
+  if (from_material != to.record.material_id) {
+    auto mat_id = to.record.material_id == binary::kNoMaterial ? std::nullopt : material_of_key(to.record.material_id);
+    if (mat_id) {
+      node.set_material(*mat_id);
+    } else {
+      node.remove_material();
+    }
+  }
+
+  if (from == nullptr || from->name != to.name) {
+    node.rename(std::string(to.name));
+  }
+}
+
+SDFTreeNode& SDFTreeHistory::create_node(const NodeState& state) {
+  GroupNode& parent = tree_.group(node_of_key(state.parent).node_id());
+  const auto bin_op = static_cast<SDFBinaryOperation>(state.record.bin_op);
+  if (state.record.type == binary::kGroupNodeType) {
+    return parent.push_back_child<GroupNode>(bin_op);
+  }
+  if (state.record.type == binary::kPrefabReferenceNodeType) {
+    return parent.push_back_child<PrefabReferenceNode>(bin_op, *prefabs_.at(state.record.prefab));
+  }
+  return parent.push_back_primitive(static_cast<SDFTreePrimitiveType>(state.record.type), bin_op);
+}
+
+void SDFTreeHistory::place_node(SDFTreeNode& node, const NodeState& state) {
+  auto node_ptr     = node.parent().detach_child(node.node_id());
+  GroupNode& parent = tree_.group(node_of_key(state.parent).node_id());
+  if (state.prev == kNoKey) {
+    parent.insert_after_child(std::nullopt, std::move(node_ptr));
+  } else {
+    parent.insert_after_child(node_of_key(state.prev).node_id(), std::move(node_ptr));
+  }
+}
+
+SDFTreeNode& SDFTreeHistory::node_of_key(uint32_t key) {
+  return tree_.node(*tree_.get_view_from_raw_id(node_keys_.raw_of_key.at(key)));
+}
+
+std::optional<IdView<MaterialId>> SDFTreeHistory::material_of_key(uint32_t key) const {
+  auto raw_it = material_keys_.raw_of_key.find(key);
+  if (raw_it == material_keys_.raw_of_key.end()) {
+    return std::nullopt;
+  }
+  auto mat_it =
+      std::ranges::find_if(tree_.materials(), [&raw_it](auto mat_id) { return mat_id.raw() == raw_it->second; });
+  return mat_it == tree_.materials().end() ? std::nullopt : std::optional(*mat_it);
+}
+
+void SDFTreeHistory::release(std::vector<Prefab*>& prefabs) {
+  for (Prefab* prefab : prefabs) {
+    prefab->release();
+  }
+  prefabs.clear();
+}
+
+}  // namespace resin
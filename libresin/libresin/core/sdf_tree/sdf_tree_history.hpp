@@ -0,0 +1,153 @@
+#ifndef RESIN_SDF_TREE_HISTORY_HPP
+#define RESIN_SDF_TREE_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/macros.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace resin {
+
+// Undo and redo of the edits of the nodes and the materials of a tree. The editor changes the nodes in place, so the
+// edits are not reported one by one. Instead, commit compares the records of the tree with the ones of the last commit
+// and stores the ones that changed as a step, holding the state of every changed node before and after the step. The
+// unchanged nodes are shared by all of the steps, so a step costs the size of its changes only, no matter how large
+// the tree is. Committing only once an interaction ends, e.g. when a gizmo drag is released, coalesces it into a
+// single step.
+//
+// A step that only changes the properties of the nodes and the materials is applied to the existing objects, so the
+// tree is not rebuilt and the shader is not recompiled, unless a binary operation or a repetition changed. The nodes
+// added, removed or moved by a step are created, deleted or moved in the tree.
+//
+// The nodes and the materials are identified by keys of the history, as the ids of the objects recreated by undo
+// differ from the ids of the deleted ones. The prefabs referenced by the history are retained, so that a deleted
+// reference can be brought back. Replacing the root of the tree, e.g. by loading a scene, clears the history.
+class SDFTreeHistory {
+ public:
+  explicit SDFTreeHistory(SDFTree& tree);
+  ~SDFTreeHistory();
+
+  DISABLE_COPY_AND_MOVE(SDFTreeHistory)
+
+  // Stores the changes made since the last commit as a step, dropping the undone steps. Returns false if nothing
+  // changed.
+  // Cost: O(n + m + c), where n and m are the numbers of the nodes and the materials, and c the number of the changes
+  bool commit();
+
+  // Both commit the pending changes first. Return false if there is no step to apply.
+  // Cost: O(n + m + ch), where c is the number of the changes of the step and h the height of the tree
+  bool undo();
+  bool redo();
+
+  inline bool can_undo() const { return current_ > 0; }
+  inline bool can_redo() const { return current_ < steps_.size(); }
+  inline size_t step_count() const { return steps_.size(); }
+
+  // Drops all of the steps and takes the current tree as the initial state.
+  void clear();
+
+  static constexpr size_t kMaxSteps = 128;
+
+ private:
+  // The parent and the previous sibling are keys, the material of the record is a key and the prefab of the record is
+  // the raw id of the prefab.
+  struct NodeState {
+    uint32_t parent;
+    uint32_t prev;
+    binary::NodeRecord record;
+    std::string name;
+
+    bool operator==(const NodeState& other) const;
+  };
+
+  struct MaterialState {
+    binary::MaterialRecord record;
+    std::string name;
+
+    bool operator==(const MaterialState& other) const;
+  };
+
+  // The order is the index of the node in the pre-order of the tree the state belongs to, so that the parents and the
+  // previous siblings are restored before the nodes referring to them.
+  struct NodeChange {
+    uint32_t key;
+    std::optional<NodeState> before;
+    std::optional<NodeState> after;
+    size_t before_order;
+    size_t after_order;
+  };
+
+  struct MaterialChange {
+    uint32_t key;
+    std::optional<MaterialState> before;
+    std::optional<MaterialState> after;
+  };
+
+  struct Step {
+    std::vector<NodeChange> nodes;
+    std::vector<MaterialChange> materials;
+    std::vector<Prefab*> prefabs;  // retained while the step is kept
+  };
+
+  struct State {
+    std::vector<uint32_t> node_order;
+    std::unordered_map<uint32_t, NodeState> nodes;
+    std::unordered_map<uint32_t, MaterialState> materials;
+    std::vector<Prefab*> prefabs;  // referenced by the nodes, retained while the state is the current one
+  };
+
+  // Keys of the objects, stable across their deletion and recreation
+  struct Keys {
+    std::unordered_map<size_t, uint32_t> key_of_raw;
+    std::unordered_map<uint32_t, size_t> raw_of_key;
+    uint32_t next_key = 0;
+
+    void assign(uint32_t key, size_t raw) {
+      key_of_raw[raw] = key;
+      raw_of_key[key] = raw;
+    }
+    void clear() {
+      key_of_raw.clear();
+      raw_of_key.clear();
+    }
+  };
+
+  // Assigns the keys of the objects captured, keeping the ones of the objects of the current state.
+  State capture();
+  void capture_node(SDFTreeNode& node, uint32_t parent, uint32_t prev, State& state, const Keys& old_keys);
+  void set_current(State state);
+
+  // Clears the history if the root was replaced
+  void check_generation();
+  void apply(const Step& step, bool forward);
+  void apply_node(SDFTreeNode& node, const NodeState* from, const NodeState& to);
+  SDFTreeNode& create_node(const NodeState& state);
+  void place_node(SDFTreeNode& node, const NodeState& state);
+
+  SDFTreeNode& node_of_key(uint32_t key);
+  std::optional<IdView<MaterialId>> material_of_key(uint32_t key) const;
+
+  static void release(std::vector<Prefab*>& prefabs);
+
+  SDFTree& tree_;  // NOLINT
+  size_t generation_;
+
+  State state_;
+  std::deque<Step> steps_;
+  size_t current_ = 0;  // number of the applied steps
+
+  Keys node_keys_;
+  Keys material_keys_;
+  std::unordered_map<uint16_t, Prefab*> prefabs_;  // raw prefab id to the prefab, for the retained prefabs
+};
+
+}  // namespace resin
+
+#endif  // RESIN_SDF_TREE_HISTORY_HPP
@@ -1,5 +1,6 @@
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <mutex>
 
 namespace resin {
 
@@ -7,7 +8,7 @@ SDFTreeNode::SDFTreeNode(SDFTreeRegistry& tree, std::string_view name)
     : node_id_(tree.nodes_registry),
       transform_id_(tree.transform_component_registry),
       bin_op_(SDFBinaryOperation::Union),
-      factor_(0.5F),
+      factor_(kDefaultFactor),
       tree_registry_(tree),
       name_(std::format("{} {}", name, tree.node_index++)) {
   tree_registry_.all_nodes[node_id_.raw()] = *this;
@@ -37,7 +38,10 @@ void SDFTreeNode::set_factor(float factor) {
   mark_dirty();
 }
 
-void SDFTreeNode::mark_dirty() { tree_registry_.dirty_node_attributes.emplace(node_id()); }
+void SDFTreeNode::mark_dirty() {
+  const std::lock_guard lock(tree_registry_.dirty_nodes_mutex);
+  tree_registry_.dirty_node_attributes.emplace(node_id());
+}
 
 void SDFTreeNode::mark_primitives_dirty() { push_dirty_primitives(); }
 
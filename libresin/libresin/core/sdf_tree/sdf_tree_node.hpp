@@ -17,6 +17,7 @@ using SDFBinaryOperation = sdf_shader_consts::SDFShaderBinOp;
 
 struct SDFTreeRegistry;
 class SDFTree;
+class SDFSubtreeBuilder;
 
 struct Material;
 using MaterialId = Id<Material>;
@@ -31,6 +32,8 @@ enum class GenShaderMode : uint8_t {
 
 class SDFTreeNode {
  public:
+  static constexpr float kDefaultFactor = 0.5F;
+
   SDFTreeNode() = delete;
 
   // It is the programmer's responsibility to assert that SDFTreeNode class will not outlive the provided registry!
@@ -81,7 +84,11 @@ class SDFTreeNode {
   inline const GroupNode& parent() const { return parent_.value(); }
 
   std::string_view name() const { return name_; }
-  void rename(std::string&& name) { name_ = std::move(name); }
+  // Marks the node dirty, so that the editor notices the change, e.g. to commit it to the history
+  void rename(std::string&& name) {
+    name_ = std::move(name);
+    mark_dirty();
+  }
 
   void mark_dirty();
   void mark_primitives_dirty();
@@ -89,6 +96,7 @@ class SDFTreeNode {
  protected:
   friend SDFTree;
   friend GroupNode;
+  friend SDFSubtreeBuilder;
 
   inline void set_parent(GroupNode& parent) { parent_ = parent; }
   inline void remove_parent() { parent_.reset(); }
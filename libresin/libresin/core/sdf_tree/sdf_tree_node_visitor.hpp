@@ -14,6 +14,7 @@ class EllipsoidNode;
 class PyramidNode;
 class CylinderNode;
 class TriangularPrismNode;
+class PrefabReferenceNode;
 
 class ISDFTreeNodeVisitor {
  public:
@@ -29,6 +30,7 @@ class ISDFTreeNodeVisitor {
   void virtual visit_pyramid(PyramidNode&) {}
   void virtual visit_cylinder(CylinderNode&) {}
   void virtual visit_prism(TriangularPrismNode&) {}
+  void virtual visit_prefab_reference(PrefabReferenceNode&) {}
 
   virtual ~ISDFTreeNodeVisitor() = default;
 };
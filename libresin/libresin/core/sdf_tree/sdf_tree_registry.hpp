@@ -1,17 +1,21 @@
 #ifndef RESIN_SDF_TREE_REGISTRY_HPP
 #define RESIN_SDF_TREE_REGISTRY_HPP
 
+#include <atomic>
 #include <libresin/core/id_registry.hpp>
 #include <libresin/core/material.hpp>
 #include <libresin/core/sdf_shader_consts.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/transform.hpp>
+#include <mutex>
 #include <optional>
 
 namespace resin {
 template <sdf_shader_consts::SDFShaderPrim PrimType>
 class PrimitiveNode;
 
+class Prefab;
+
 struct SDFTreeRegistry {
   using NodesSet     = std::unordered_set<IdView<SDFTreeNodeId>, IdViewHash<SDFTreeNodeId>, std::equal_to<>>;
   using MaterialsSet = std::unordered_set<IdView<MaterialId>, IdViewHash<MaterialId>, std::equal_to<>>;
@@ -31,6 +35,7 @@ struct SDFTreeRegistry {
         primitives_registry(IdRegistry<BasePrimitiveNode>(100)),
         nodes_registry(IdRegistry<SDFTreeNode>(100)),
         materials_registry(IdRegistry<Material>(100)),
+        prefabs_registry(IdRegistry<Prefab>(100)),
         default_material(*this) {
     all_nodes.resize(nodes_registry.get_max_objs());
     all_group_nodes.resize(nodes_registry.get_max_objs());
@@ -79,19 +84,23 @@ struct SDFTreeRegistry {
   std::vector<std::optional<std::reference_wrapper<SDFTreeNode>>> all_nodes;
   std::vector<std::optional<std::reference_wrapper<GroupNode>>> all_group_nodes;
 
+  // The nodes of detached subtrees may be created concurrently, so the insertions into these sets are guarded
+  std::mutex dirty_nodes_mutex;
   NodesSet dirty_primitives;
   NodesSet dirty_node_attributes;
 
   IdRegistry<Material> materials_registry;
   MaterialsSet dirty_materials;
 
+  IdRegistry<Prefab> prefabs_registry;
+
   // Required for shader generation
   MaterialSDFTreeComponent default_material;
 
-  size_t node_index{};
+  std::atomic<size_t> node_index{};
   size_t material_index{};
 
-  bool is_tree_dirty{true};
+  std::atomic<bool> is_tree_dirty{true};
 };
 
 }  // namespace resin
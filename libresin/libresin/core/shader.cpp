@@ -1,5 +1,7 @@
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <format>
 #include <libresin/core/resources/shader_resource.hpp>
@@ -8,6 +10,8 @@
 #include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/logger.hpp>
 #include <stdexcept>
+#include <string_view>
+#include <vector>
 
 namespace resin {
 ShaderProgram::ShaderProgram(std::string_view name) : shader_name_(name), program_id_(glCreateProgram()) {
@@ -40,6 +44,39 @@ void ShaderProgram::recompile() {
   }
 }
 
+bool ShaderProgram::reload_shaders(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths,
+                                   std::span<ShaderResource* const> shaders) {
+  if (std::ranges::none_of(shaders, [&paths](const ShaderResource* shader) {
+        return std::ranges::find(paths, shader->get_path()) != paths.end();
+      })) {
+    return false;
+  }
+
+  std::vector<ShaderResource> previous_shaders;
+  for (const ShaderResource* shader : shaders) {
+    previous_shaders.push_back(*shader);
+  }
+
+  try {
+    for (ShaderResource* shader : shaders) {
+      if (std::ranges::find(paths, shader->get_path()) != paths.end()) {
+        shader->reload(*manager.get_res(shader->get_path()));
+      }
+    }
+    recompile();
+    Logger::info("Reloaded shader {}", shader_name_);
+    return true;
+  } catch (const std::runtime_error&) {
+    Logger::warn("Could not reload shader {}, keeping the previous one", shader_name_);
+  }
+
+  for (size_t i = 0; i < shaders.size(); ++i) {
+    *shaders[i] = std::move(previous_shaders[i]);
+  }
+  recompile();
+  return false;
+}
+
 std::optional<std::string> ShaderProgram::get_shader_status(GLuint shader, GLenum type) {
   GLint status = 0;
   glGetShaderiv(shader, type, &status);
@@ -111,8 +148,17 @@ GLuint ShaderProgram::create_shader(const ShaderResource& resource, GLenum type)
     log_throw(ShaderCreationException(get_shader_type_name(type), shader_name_, "unable to create shader."));
   }
 
-  const GLchar* source = resource.get_glsl().c_str();
-  glShaderSource(shader, 1, &source, nullptr);
+  // The segments are passed as they are, so that the shader is not concatenated on every recompilation
+  const std::vector<std::string_view> segments = resource.get_glsl_segments();
+  std::vector<const GLchar*> sources;
+  std::vector<GLint> lengths;
+  sources.reserve(segments.size());
+  lengths.reserve(segments.size());
+  for (const std::string_view segment : segments) {
+    sources.push_back(segment.data());
+    lengths.push_back(static_cast<GLint>(segment.size()));
+  }
+  glShaderSource(shader, static_cast<GLsizei>(sources.size()), sources.data(), lengths.data());
   glCompileShader(shader);
   auto compile_status = get_shader_status(shader, GL_COMPILE_STATUS);
   if (compile_status.has_value()) {
@@ -181,6 +227,11 @@ RenderingShaderProgram::RenderingShaderProgram(std::string_view name, ShaderReso
   Logger::info("Shader {} creation took {}", name, duration);
 }
 
+bool RenderingShaderProgram::reload(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths) {
+  const std::array<ShaderResource*, 2> shaders = {&vertex_shader_, &fragment_shader_};
+  return reload_shaders(manager, paths, shaders);
+}
+
 void RenderingShaderProgram::create_program() {
   GLuint vertex_shader   = create_shader(vertex_shader_, GL_VERTEX_SHADER);
   GLuint fragment_shader = create_shader(fragment_shader_, GL_FRAGMENT_SHADER);
@@ -214,6 +265,11 @@ ComputeShaderProgram::ComputeShaderProgram(std::string_view name, ShaderResource
   Logger::info("Shader {} creation took {}", name, duration);
 }
 
+bool ComputeShaderProgram::reload(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths) {
+  const std::array<ShaderResource*, 1> shaders = {&compute_shader_};
+  return reload_shaders(manager, paths, shaders);
+}
+
 void ComputeShaderProgram::create_program() {
   GLuint compute_shader = create_shader(compute_shader_, GL_COMPUTE_SHADER);
   glAttachShader(program_id_, compute_shader);
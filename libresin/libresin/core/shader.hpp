@@ -3,6 +3,7 @@
 
 #include <glad/gl.h>
 
+#include <filesystem>
 #include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -27,6 +28,12 @@ class ShaderProgram {
 
   void recompile();
 
+  // Rebuilds the program with its shaders loaded again by the manager, if any of them was loaded from one of the
+  // paths, e.g. the ones returned by ShaderResourceManager::invalidate_modified. The external definitions are kept. The
+  // previous shaders are restored if the new ones cannot be loaded or compiled. Returns true if the program was
+  // rebuilt with the new shaders.
+  virtual bool reload(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths) = 0;
+
   template <typename T>
   inline void set_uniform(std::string_view name, const T& value) const {
     GLint location = get_uniform_location(name);
@@ -40,6 +47,8 @@ class ShaderProgram {
       glProgramUniform1f(program_id_, location, value);
     } else if constexpr (std::is_same_v<T, glm::vec2>) {
       glProgramUniform2f(program_id_, location, value.x, value.y);
+    } else if constexpr (std::is_same_v<T, glm::ivec2>) {
+      glProgramUniform2i(program_id_, location, value.x, value.y);
     } else if constexpr (std::is_same_v<T, glm::vec3>) {
       glProgramUniform3f(program_id_, location, value.x, value.y, value.z);
     } else if constexpr (std::is_same_v<T, glm::vec4>) {
@@ -76,6 +85,8 @@ class ShaderProgram {
 
   virtual void create_program() = 0;
   GLuint create_shader(const ShaderResource& resource, GLenum type);
+  bool reload_shaders(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths,
+                      std::span<ShaderResource* const> shaders);
   void link_program();
 
   static constexpr std::string_view get_shader_type_name(GLenum shaderType) {
@@ -147,6 +158,8 @@ class RenderingShaderProgram : public ShaderProgram {
   const ShaderResource& fragment_shader() const { return fragment_shader_; }
   ShaderResource& fragment_shader() { return fragment_shader_; }
 
+  bool reload(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths) override;
+
  private:
   void create_program() override;
 
@@ -162,6 +175,8 @@ class ComputeShaderProgram : public ShaderProgram {
   const ShaderResource& compute_shader() const { return compute_shader_; }
   ShaderResource& compute_shader() { return compute_shader_; }
 
+  bool reload(ShaderResourceManager& manager, std::span<const std::filesystem::path> paths) override;
+
  private:
   void create_program() override;
 
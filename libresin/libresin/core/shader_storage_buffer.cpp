@@ -24,4 +24,8 @@ void ShaderStorageBuffer::get_data(void* output, size_t size) const {
 void ShaderStorageBuffer::bind() const { glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_id_); }
 
 void ShaderStorageBuffer::unbind() const { glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0); }  // NOLINT
+
+void ShaderStorageBuffer::bind_base() const {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, static_cast<GLuint>(binding_), buffer_id_);
+}
 }  // namespace resin
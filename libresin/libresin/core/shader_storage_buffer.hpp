@@ -21,6 +21,9 @@ class ShaderStorageBuffer {
 
   void unbind() const;
 
+  // Attaches the buffer to its binding point again, e.g. after another buffer took the same binding.
+  void bind_base() const;
+
   void set_data(const void* data, size_t size) const;
 
   void get_data(void* output, size_t size) const;
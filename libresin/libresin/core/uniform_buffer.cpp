@@ -19,11 +19,14 @@ UniformBuffer::~UniformBuffer() { glDeleteBuffers(1, &buffer_id_); }
 
 void UniformBuffer::bind() const { glBindBuffer(GL_UNIFORM_BUFFER, buffer_id_); }
 void UniformBuffer::unbind() const { glBindBuffer(GL_UNIFORM_BUFFER, 0); }  // NOLINT
+void UniformBuffer::bind_base() const {
+  glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(binding_), buffer_id_);
+}
 
 // Primitive UBO
 
-PrimitiveUniformBuffer::PrimitiveUniformBuffer(size_t max_count)
-    : UniformBuffer(0, max_count, sizeof(PrimitiveNode), 0), max_count_(max_count) {}
+PrimitiveUniformBuffer::PrimitiveUniformBuffer(size_t max_count, size_t binding)
+    : UniformBuffer(binding, max_count, sizeof(PrimitiveNode), 0), max_count_(max_count) {}
 
 void PrimitiveUniformBuffer::set(SDFTree& tree) {  // NOLINT
   PrimitiveNodeVisitor visitor;
@@ -98,9 +101,16 @@ void PrimitiveUniformBuffer::PrimitiveNodeVisitor::visit_prism(TriangularPrismNo
                   sizeof(PrimitiveNode), &ubo_node);
 }
 
+void PrimitiveUniformBuffer::PrimitiveNodeVisitor::visit_prefab_reference(PrefabReferenceNode& node) {
+  PrimitiveNode ubo_node(node);
+
+  glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(node.instance_id().raw() * sizeof(PrimitiveNode)),
+                  sizeof(PrimitiveNode), &ubo_node);
+}
+
 // Node Attribute UBO
-NodeAttributesUniformBuffer::NodeAttributesUniformBuffer(size_t max_count)
-    : UniformBuffer(1, max_count, sizeof(NodeAttributes), 8), max_count_(max_count) {
+NodeAttributesUniformBuffer::NodeAttributesUniformBuffer(size_t max_count, size_t binding)
+    : UniformBuffer(binding, max_count, sizeof(NodeAttributes), 8), max_count_(max_count) {
   Logger::debug("{}", sizeof(NodeAttributes));
 }
 
@@ -123,8 +133,8 @@ void NodeAttributesUniformBuffer::NodeAttributesVisitor::visit_node(SDFTreeNode&
 
 // Material UBO
 
-MaterialUniformBuffer::MaterialUniformBuffer(size_t max_count)
-    : UniformBuffer(2, sizeof(Material), max_count, 4), max_count_(max_count) {}
+MaterialUniformBuffer::MaterialUniformBuffer(size_t max_count, size_t binding)
+    : UniformBuffer(binding, sizeof(Material), max_count, 4), max_count_(max_count) {}
 
 void MaterialUniformBuffer::set(SDFTree& tree) {  // NOLINT
   tree.visit_all_materials([](auto& mat) {
@@ -5,6 +5,7 @@
 
 #include <libresin/core/material.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node_visitor.hpp>
@@ -20,6 +21,9 @@ class UniformBuffer {
   void bind() const;
   void unbind() const;
 
+  // Attaches the buffer to its binding point again, e.g. after another buffer took the same binding.
+  void bind_base() const;
+
   size_t binding() const { return binding_; }
   size_t buffer_size() const { return buffer_size_; }
   size_t buffer_size_without_end_padding() const { return buffer_size_ - item_end_padding_; }
@@ -46,9 +50,15 @@ class PrimitiveUniformBuffer : public UniformBuffer {
         : transform(_node.transform().world_to_local_matrix()),
           size(_size),
           mat_id(static_cast<int>(_node.active_material_id_or_default().raw())) {}
+
+    explicit PrimitiveNode(const PrefabReferenceNode& _node)
+        : transform(_node.transform().world_to_local_matrix()),
+          size(_node.repetition().spacing),
+          mat_id(static_cast<int>(_node.active_material_id_or_default().raw())) {}
   };
 
-  explicit PrimitiveUniformBuffer(size_t max_count);
+  // The default binding is the one the editor shaders use.
+  explicit PrimitiveUniformBuffer(size_t max_count, size_t binding = 0);
   ~PrimitiveUniformBuffer() override = default;
 
   size_t max_count() const { return max_count_; }
@@ -72,6 +82,7 @@ class PrimitiveUniformBuffer : public UniformBuffer {
     void visit_pyramid(PyramidNode& node) override;
     void visit_cylinder(CylinderNode& node) override;
     void visit_prism(TriangularPrismNode& node) override;
+    void visit_prefab_reference(PrefabReferenceNode& node) override;
   };
 
   const size_t max_count_;
@@ -87,7 +98,8 @@ class NodeAttributesUniformBuffer : public UniformBuffer {
     explicit NodeAttributes(const SDFTreeNode& node) : scale(node.transform().local_scale()), factor(node.factor()) {}
   };
 
-  explicit NodeAttributesUniformBuffer(size_t max_count);
+  // The default binding is the one the editor shaders use.
+  explicit NodeAttributesUniformBuffer(size_t max_count, size_t binding = 1);
   ~NodeAttributesUniformBuffer() override = default;
 
   size_t max_count() const { return max_count_; }
@@ -110,7 +122,8 @@ class NodeAttributesUniformBuffer : public UniformBuffer {
 
 class MaterialUniformBuffer : public UniformBuffer {
  public:
-  explicit MaterialUniformBuffer(size_t max_count);
+  // The default binding is the one the editor shaders use.
+  explicit MaterialUniformBuffer(size_t max_count, size_t binding = 2);
   ~MaterialUniformBuffer() override = default;
 
   size_t max_count() const { return max_count_; }
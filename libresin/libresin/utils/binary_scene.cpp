@@ -0,0 +1,851 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <glm/gtc/quaternion.hpp>
+#include <libresin/core/light.hpp>
+#include <libresin/core/material.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node_visitor.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/exceptions.hpp>
+#include <libresin/utils/logger.hpp>
+#include <libresin/utils/thread_pool.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace resin {
+
+namespace binary {
+
+namespace {
+
+template <typename Record>
+void append_records(std::vector<uint8_t>& data, std::span<const Record> records) {
+  const size_t offset = data.size();
+  data.resize(offset + records.size_bytes());
+  if (!records.empty()) {
+    std::memcpy(data.data() + offset, records.data(), records.size_bytes());
+  }
+}
+
+void write_transform(const Transform& transform, std::array<float, 3>& position, std::array<float, 4>& rotation,
+                     float& scale) {
+  position = {transform.local_pos().x, transform.local_pos().y, transform.local_pos().z};
+  rotation = {transform.local_rot().w, transform.local_rot().x, transform.local_rot().y, transform.local_rot().z};
+  scale    = transform.local_scale();
+}
+
+void read_transform(Transform& transform, const std::array<float, 3>& position, const std::array<float, 4>& rotation,
+                    float scale) {
+  transform.set_local_pos(glm::vec3(position[0], position[1], position[2]));
+  transform.set_local_rot(glm::quat(rotation[0], rotation[1], rotation[2], rotation[3]));
+  transform.set_local_scale(scale);
+}
+
+constexpr uint32_t kRepetitionTypeBits  = 2;
+constexpr uint32_t kRepetitionCountBits = 10;
+constexpr uint32_t kRepetitionCountMask = (1U << kRepetitionCountBits) - 1U;
+
+static_assert(static_cast<uint32_t>(RepetitionType::_Count) <= (1U << kRepetitionTypeBits));
+static_assert(Repetition::kMaxCount <= kRepetitionCountMask);
+
+float pack_repetition(const Repetition& repetition) {
+  if (repetition.type == RepetitionType::None) {
+    return 0.0F;
+  }
+  const uint32_t bits = static_cast<uint32_t>(repetition.type) |
+                        (repetition.count.x << kRepetitionTypeBits) |
+                        (repetition.count.y << (kRepetitionTypeBits + kRepetitionCountBits)) |
+                        (repetition.count.z << (kRepetitionTypeBits + (2 * kRepetitionCountBits)));
+  return std::bit_cast<float>(bits);
+}
+
+Repetition unpack_repetition(const NodeRecord& record, size_t index) {
+  const auto bits = std::bit_cast<uint32_t>(record.parameters[3]);
+  const auto type = bits & ((1U << kRepetitionTypeBits) - 1U);
+  if (type >= static_cast<uint32_t>(RepetitionType::_Count)) {
+    log_throw(
+        BinarySceneDeserializationException(std::format("Node {} has an invalid repetition type {}.", index, type)));
+  }
+
+  Repetition repetition{.type    = static_cast<RepetitionType>(type),
+                        .spacing = glm::vec3(record.parameters[0], record.parameters[1], record.parameters[2])};
+  if (repetition.type != RepetitionType::None) {
+    repetition.count = glm::uvec3((bits >> kRepetitionTypeBits) & kRepetitionCountMask,
+                                  (bits >> (kRepetitionTypeBits + kRepetitionCountBits)) & kRepetitionCountMask,
+                                  (bits >> (kRepetitionTypeBits + (2 * kRepetitionCountBits))) & kRepetitionCountMask);
+  }
+  return repetition;
+}
+
+// Fills the type and the parameters of a node record
+class BinarySerializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
+ public:
+  explicit BinarySerializerSDFTreeNodeVisitor(NodeRecord& record) : record_(record) {}
+
+  void visit_group(GroupNode& node) override {
+    record_.type = kGroupNodeType;
+    group_       = &node;
+  }
+  void visit_sphere(SphereNode& node) override { set(SDFTreePrimitiveType::Sphere, {node.radius}); }
+  void visit_cube(CubeNode& node) override { set(SDFTreePrimitiveType::Cube, {node.size.x, node.size.y, node.size.z}); }
+  void visit_torus(TorusNode& node) override {
+    set(SDFTreePrimitiveType::Torus, {node.major_radius, node.minor_radius});
+  }
+  void visit_capsule(CapsuleNode& node) override { set(SDFTreePrimitiveType::Capsule, {node.height, node.radius}); }
+  void visit_link(LinkNode& node) override {
+    set(SDFTreePrimitiveType::Link, {node.length, node.major_radius, node.minor_radius});
+  }
+  void visit_ellipsoid(EllipsoidNode& node) override {
+    set(SDFTreePrimitiveType::Ellipsoid, {node.radii.x, node.radii.y, node.radii.z});
+  }
+  void visit_pyramid(PyramidNode& node) override { set(SDFTreePrimitiveType::Pyramid, {node.height}); }
+  void visit_cylinder(CylinderNode& node) override { set(SDFTreePrimitiveType::Cylinder, {node.height, node.radius}); }
+  void visit_prism(TriangularPrismNode& node) override {
+    set(SDFTreePrimitiveType::TriangularPrism, {node.prismHeight, node.baseHeight});
+  }
+  void visit_prefab_reference(PrefabReferenceNode& node) override {
+    const Repetition& repetition = node.repetition();
+    record_.type                 = kPrefabReferenceNodeType;
+    record_.parameters           = {repetition.spacing.x, repetition.spacing.y, repetition.spacing.z,
+                                    pack_repetition(repetition)};
+    reference_                   = &node;
+  }
+
+  // Set if the visited node is a group
+  inline GroupNode* group() const { return group_; }
+
+  // Set if the visited node is a prefab reference
+  inline PrefabReferenceNode* reference() const { return reference_; }
+
+ private:
+  void set(SDFTreePrimitiveType type, std::array<float, 4> parameters) {
+    record_.type       = static_cast<uint8_t>(type);
+    record_.parameters = parameters;
+  }
+
+  NodeRecord& record_;  // NOLINT
+  GroupNode* group_               = nullptr;
+  PrefabReferenceNode* reference_ = nullptr;
+};
+
+class BinaryDeserializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
+ public:
+  explicit BinaryDeserializerSDFTreeNodeVisitor(const NodeRecord& record) : params_(record.parameters) {}
+
+  void visit_sphere(SphereNode& node) override { node.radius = params_[0]; }
+  void visit_cube(CubeNode& node) override { node.size = glm::vec3(params_[0], params_[1], params_[2]); }
+  void visit_torus(TorusNode& node) override {
+    node.major_radius = params_[0];
+    node.minor_radius = params_[1];
+  }
+  void visit_capsule(CapsuleNode& node) override {
+    node.height = params_[0];
+    node.radius = params_[1];
+  }
+  void visit_link(LinkNode& node) override {
+    node.length       = params_[0];
+    node.major_radius = params_[1];
+    node.minor_radius = params_[2];
+  }
+  void visit_ellipsoid(EllipsoidNode& node) override { node.radii = glm::vec3(params_[0], params_[1], params_[2]); }
+  void visit_pyramid(PyramidNode& node) override { node.height = params_[0]; }
+  void visit_cylinder(CylinderNode& node) override {
+    node.height = params_[0];
+    node.radius = params_[1];
+  }
+  void visit_prism(TriangularPrismNode& node) override {
+    node.prismHeight = params_[0];
+    node.baseHeight  = params_[1];
+  }
+  void visit_prefab_reference(PrefabReferenceNode& node) override { reference_ = &node; }
+
+  // Set if the visited node is a prefab reference, its repetition is not read by the visitor
+  inline PrefabReferenceNode* reference() const { return reference_; }
+
+ private:
+  const std::array<float, 4>& params_;  // NOLINT
+  PrefabReferenceNode* reference_ = nullptr;
+};
+
+class BinarySerializerLightSceneComponentVisitor : public ILightSceneComponentVisitor {
+ public:
+  explicit BinarySerializerLightSceneComponentVisitor(LightRecord& record) : record_(record) {}
+
+  void visit_point_light(LightSceneComponent<PointLight>& point_light) override {
+    const auto& attenuation = point_light.light().attenuation;
+    record_.type            = static_cast<uint8_t>(LightType::PointLight);
+    record_.parameters      = {attenuation.constant, attenuation.linear, attenuation.quadratic};
+  }
+
+  void visit_directional_light(LightSceneComponent<DirectionalLight>& dir_light) override {
+    record_.type       = static_cast<uint8_t>(LightType::DirectionalLight);
+    record_.parameters = {dir_light.light().ambient_impact};
+  }
+
+ private:
+  LightRecord& record_;  // NOLINT
+};
+
+class BinaryDeserializerLightSceneComponentVisitor : public ILightSceneComponentVisitor {
+ public:
+  explicit BinaryDeserializerLightSceneComponentVisitor(const LightRecord& record) : params_(record.parameters) {}
+
+  void visit_point_light(LightSceneComponent<PointLight>& point_light) override {
+    point_light.light().attenuation = PointLight::Attenuation(params_[0], params_[1], params_[2]);
+  }
+
+  void visit_directional_light(LightSceneComponent<DirectionalLight>& dir_light) override {
+    dir_light.light().ambient_impact = params_[0];
+  }
+
+ private:
+  const std::array<float, 3>& params_;  // NOLINT
+};
+
+// Fills the properties shared by all of the node types, except the parent and the name
+void write_node_common(const SDFTreeNode& node, NodeRecord& record) {
+  record.material_id = node.material_id() ? static_cast<uint32_t>(node.material_id()->raw()) : kNoMaterial;
+  record.bin_op      = static_cast<uint8_t>(node.bin_op());
+  record.factor      = node.factor();
+  write_transform(node.transform(), record.position, record.rotation, record.scale);
+}
+
+std::vector<uint8_t> write_tables(std::span<const MaterialRecord> materials, std::span<const PrefabRecord> prefabs,
+                                  std::span<const NodeRecord> nodes, std::span<const LightRecord> lights,
+                                  std::string_view strings) {
+  const Header header{
+      .magic             = kBinarySceneMagic,
+      .version           = kNewestBinarySceneVersion,
+      .material_count    = static_cast<uint32_t>(materials.size()),
+      .node_count        = static_cast<uint32_t>(nodes.size()),
+      .light_count       = static_cast<uint32_t>(lights.size()),
+      .string_table_size = static_cast<uint32_t>(strings.size()),
+      .prefab_count      = static_cast<uint32_t>(prefabs.size()),
+  };
+
+  std::vector<uint8_t> data;
+  data.reserve(sizeof(Header) + materials.size_bytes() + prefabs.size_bytes() + nodes.size_bytes() +
+               lights.size_bytes() + strings.size());
+  append_records(data, std::span<const Header>(&header, 1));
+  append_records(data, materials);
+  append_records(data, prefabs);
+  append_records(data, nodes);
+  append_records(data, lights);
+  append_records(data, std::span<const char>(strings));
+  return data;
+}
+
+class BinarySceneWriter {
+ public:
+  // If expand_prefab_references is set, a prefab reference is written as a group with the content of the prefab as
+  // its only child, like the group created by PrefabReferenceNode::expand.
+  explicit BinarySceneWriter(SDFTree& tree, bool expand_prefab_references = false)
+      : tree_(tree), expand_prefab_references_(expand_prefab_references) {}
+
+  void add_material(IdView<MaterialId> mat_id) {
+    const MaterialSDFTreeComponent& mat = tree_.material(mat_id);
+    MaterialRecord record               = make_material_record(mat);
+    record.name                         = add_string(mat.name());
+    materials_.push_back(record);
+  }
+
+  // Appends the node and its subtree in pre-order
+  void add_node(SDFTreeNode& node, uint32_t parent) {
+    NodeRecord record{};
+    record.parent = parent;
+    record.name   = add_string(node.name());
+    write_node_common(node, record);
+
+    auto visitor = BinarySerializerSDFTreeNodeVisitor(record);
+    node.accept_visitor(visitor);
+
+    const auto index               = static_cast<uint32_t>(nodes_.size());
+    PrefabReferenceNode* reference = visitor.reference();
+    if (reference != nullptr && expand_prefab_references_) {
+      record.type       = kGroupNodeType;
+      record.parameters = {};
+      nodes_.push_back(record);
+      add_expanded_content(*reference, index);
+      return;
+    }
+    if (reference != nullptr) {
+      record.prefab = prefab_index(reference->prefab());
+    }
+
+    nodes_.push_back(record);
+    if (GroupNode* group = visitor.group()) {
+      for (auto child_id : *group) {
+        add_node(group->get_child(child_id), index);
+      }
+    }
+  }
+
+  // Appends the children of the group created by PrefabReferenceNode::expand
+  void add_expanded_content(PrefabReferenceNode& reference, uint32_t parent) {
+    const Repetition& repetition = reference.repetition();
+    if (repetition.type == RepetitionType::None) {
+      add_node(reference.prefab().root(), parent);
+      return;
+    }
+
+    for (size_t i = 0; i < repetition.instance_count(); ++i) {
+      Transform instance_transform;
+      instance_transform.set_local_from_matrix(repetition.instance_matrix(i));
+
+      NodeRecord record{};
+      record.parent      = parent;
+      record.material_id = kNoMaterial;
+      record.name        = add_string(PrefabReferenceNode::instance_group_name(i));
+      record.type        = kGroupNodeType;
+      record.bin_op      = static_cast<uint8_t>(SDFBinaryOperation::Union);
+      record.factor      = SDFTreeNode::kDefaultFactor;
+      write_transform(instance_transform, record.position, record.rotation, record.scale);
+
+      const auto index = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back(record);
+      add_node(reference.prefab().root(), index);
+    }
+  }
+
+  // Appends the contents of the prefabs referenced by the nodes added so far, must be called after the tree is added
+  void add_prefabs() {
+    for (Prefab* prefab : prefabs_) {
+      prefab_records_.push_back(
+          PrefabRecord{.root = static_cast<uint32_t>(nodes_.size()), .path = add_string(prefab->path())});
+      add_node(prefab->root(), kNoParent);
+    }
+  }
+
+  void add_light(BaseLightSceneComponent& light) {
+    LightRecord record = make_light_record(light);
+    record.name        = add_string(light.name());
+    lights_.push_back(record);
+  }
+
+  // Materials of the nodes added so far in the order they are first referenced, except the default one
+  std::vector<IdView<MaterialId>> used_materials() const {
+    std::vector<IdView<MaterialId>> used;
+    for (const auto& record : nodes_) {
+      if (record.material_id == kNoMaterial ||
+          record.material_id == tree_.default_material().material_id().raw()) {
+        continue;
+      }
+      const auto mat_id = std::ranges::find_if(
+          tree_.materials(), [&record](const auto& id) { return id.raw() == record.material_id; });
+      if (mat_id != tree_.materials().end() && std::ranges::find(used, *mat_id) == used.end()) {
+        used.push_back(*mat_id);
+      }
+    }
+    return used;
+  }
+
+  std::vector<uint8_t> finish() const { return write_tables(materials_, prefab_records_, nodes_, lights_, strings_); }
+
+ private:
+  StringRef add_string(std::string_view str) {
+    const StringRef ref{.offset = static_cast<uint32_t>(strings_.size()), .length = static_cast<uint32_t>(str.size())};
+    strings_.append(str);
+    return ref;
+  }
+
+  // Index of the prefab record, the prefabs are numbered in the order they are first referenced
+  uint16_t prefab_index(Prefab& prefab) {
+    auto prefab_it = std::ranges::find(prefabs_, &prefab);
+    if (prefab_it == prefabs_.end()) {
+      prefabs_.push_back(&prefab);
+      return static_cast<uint16_t>(prefabs_.size() - 1);
+    }
+    return static_cast<uint16_t>(prefab_it - prefabs_.begin());
+  }
+
+  SDFTree& tree_;  // NOLINT
+  bool expand_prefab_references_;
+  std::vector<MaterialRecord> materials_;
+  std::vector<Prefab*> prefabs_;
+  std::vector<PrefabRecord> prefab_records_;
+  std::vector<NodeRecord> nodes_;
+  std::vector<LightRecord> lights_;
+  std::string strings_;
+};
+
+// Validates the header and the table sizes up front, so the records are read without any further bounds checks.
+class BinarySceneReader {
+ public:
+  explicit BinarySceneReader(std::span<const uint8_t> data) : data_(data) {
+    if (!is_binary_scene(data_) || data_.size() < kHeaderV1Size) {
+      log_throw(BinarySceneDeserializationException("Missing the binary scene header."));
+    }
+    std::memcpy(&header_, data_.data(), kHeaderV1Size);
+    if (header_.version == 0 || header_.version > kNewestBinarySceneVersion) {
+      log_throw(BinarySceneDeserializationException(std::format("Unsupported version {}.", header_.version)));
+    }
+
+    uint64_t header_size = kHeaderV1Size;
+    if (header_.version >= 2) {
+      if (data_.size() < sizeof(Header)) {
+        log_throw(BinarySceneDeserializationException("Missing the binary scene header."));
+      }
+      header_     = read<Header>(0);
+      header_size = sizeof(Header);
+    }
+
+    materials_offset_ = header_size;
+    prefabs_offset_   = materials_offset_ + (uint64_t{header_.material_count} * sizeof(MaterialRecord));
+    nodes_offset_     = prefabs_offset_ + (uint64_t{header_.prefab_count} * sizeof(PrefabRecord));
+    lights_offset_    = nodes_offset_ + (uint64_t{header_.node_count} * sizeof(NodeRecord));
+    strings_offset_   = lights_offset_ + (uint64_t{header_.light_count} * sizeof(LightRecord));
+    if (strings_offset_ + header_.string_table_size != data_.size()) {
+      log_throw(BinarySceneDeserializationException(
+          std::format("Expected {} bytes, got {}.", strings_offset_ + header_.string_table_size, data_.size())));
+    }
+  }
+
+  inline const Header& header() const { return header_; }
+  inline MaterialRecord material(size_t i) const {
+    return read<MaterialRecord>(materials_offset_ + (i * sizeof(MaterialRecord)));
+  }
+  inline PrefabRecord prefab(size_t i) const {
+    return read<PrefabRecord>(prefabs_offset_ + (i * sizeof(PrefabRecord)));
+  }
+  inline NodeRecord node(size_t i) const { return read<NodeRecord>(nodes_offset_ + (i * sizeof(NodeRecord))); }
+  inline LightRecord light(size_t i) const { return read<LightRecord>(lights_offset_ + (i * sizeof(LightRecord))); }
+
+  std::string string(StringRef ref) const {
+    validate_string(ref);
+    return {reinterpret_cast<const char*>(data_.data() + strings_offset_ + ref.offset), ref.length};  // NOLINT
+  }
+
+  void validate_string(StringRef ref) const {
+    if (uint64_t{ref.offset} + ref.length > header_.string_table_size) {
+      log_throw(BinarySceneDeserializationException("A name is out of the string table bounds."));
+    }
+  }
+
+ private:
+  // Copies out the record, the data does not have to be aligned
+  template <typename T>
+  T read(uint64_t offset) const {
+    T value;
+    std::memcpy(&value, data_.data() + offset, sizeof(T));
+    return value;
+  }
+
+  std::span<const uint8_t> data_;
+  Header header_{};
+  uint64_t materials_offset_{}, prefabs_offset_{}, nodes_offset_{}, lights_offset_{}, strings_offset_{};
+};
+
+// Validates the nodes [begin, end), the node begin being a root group. The nodes are stored in pre-order, so the parent
+// of every other node is a group that comes before it in the same range.
+void validate_nodes(const BinarySceneReader& reader, size_t begin, size_t end,
+                    const std::unordered_set<uint32_t>& material_ids, size_t prefab_count) {
+  for (size_t i = begin; i < end; ++i) {
+    const NodeRecord record = reader.node(i);
+    if (i > begin &&
+        (record.parent < begin || record.parent >= i || reader.node(record.parent).type != kGroupNodeType)) {
+      log_throw(BinarySceneDeserializationException(std::format("Node {} has an invalid parent.", i)));
+    }
+
+    if (record.type == kPrefabReferenceNodeType) {
+      if (record.prefab >= prefab_count) {
+        log_throw(BinarySceneDeserializationException(
+            std::format("Node {} references to non existing prefab {}.", i, record.prefab)));
+      }
+      unpack_repetition(record, i);  // throws if the repetition type is invalid
+    } else if (record.type != kGroupNodeType && record.type >= static_cast<uint8_t>(SDFTreePrimitiveType::_Count)) {
+      log_throw(BinarySceneDeserializationException(std::format("Node {} has an invalid type {}.", i, record.type)));
+    }
+
+    if (record.material_id != kNoMaterial && !material_ids.contains(record.material_id)) {
+      log_throw(BinarySceneDeserializationException(
+          std::format("Node references to non existing material with id {}.", record.material_id)));
+    }
+    if (record.bin_op >= static_cast<uint8_t>(SDFBinaryOperation::_Count)) {
+      log_throw(BinarySceneDeserializationException(std::format("Invalid binary operation {}.", record.bin_op)));
+    }
+    reader.validate_string(record.name);
+  }
+}
+
+// Validates every record read by deserialize_sdf_tree and deserialize_scene, so that they do not have to modify the
+// tree or the scene before finding out that the data is corrupted.
+void validate_records(const BinarySceneReader& reader) {
+  const Header& header = reader.header();
+
+  std::unordered_set<uint32_t> material_ids;
+  for (size_t i = 0; i < header.material_count; ++i) {
+    const MaterialRecord record = reader.material(i);
+    if (!material_ids.insert(record.id).second) {
+      log_throw(BinarySceneDeserializationException(
+          std::format("More than one definition of a material with id {} found.", record.id)));
+    }
+    reader.validate_string(record.name);
+  }
+
+  if (header.node_count == 0 || reader.node(0).parent != kNoParent || reader.node(0).type != kGroupNodeType) {
+    log_throw(BinarySceneDeserializationException("The first node must be the root group."));
+  }
+
+  // The content of a prefab cannot reference other prefabs
+  for (size_t i = 0; i < header.prefab_count; ++i) {
+    const PrefabRecord record = reader.prefab(i);
+    const size_t end          = i + 1 < header.prefab_count ? reader.prefab(i + 1).root : header.node_count;
+    if (record.root == 0 || record.root >= end || end > header.node_count ||
+        reader.node(record.root).parent != kNoParent || reader.node(record.root).type != kGroupNodeType) {
+      log_throw(BinarySceneDeserializationException(std::format("Prefab {} has an invalid root.", i)));
+    }
+    validate_nodes(reader, record.root, end, material_ids, 0);
+    reader.validate_string(record.path);
+  }
+
+  // The tree ends where the content of the first prefab begins
+  const size_t tree_end = header.prefab_count == 0 ? header.node_count : reader.prefab(0).root;
+  validate_nodes(reader, 0, tree_end, material_ids, header.prefab_count);
+
+  for (size_t i = 0; i < header.light_count; ++i) {
+    const LightRecord record = reader.light(i);
+    if (record.type >= static_cast<uint8_t>(LightType::_Count)) {
+      log_throw(BinarySceneDeserializationException(std::format("Light {} has an invalid type.", i)));
+    }
+    reader.validate_string(record.name);
+  }
+}
+
+void deserialize_node_common(SDFTreeNode& node, const NodeRecord& record, const BinarySceneReader& reader,
+                             const std::unordered_map<uint32_t, IdView<MaterialId>>& material_ids_map) {
+  read_transform(node.transform(), record.position, record.rotation, record.scale);
+
+  if (record.material_id != kNoMaterial) {
+    node.set_material(material_ids_map.at(record.material_id));
+  }
+
+  node.rename(reader.string(record.name));
+  node.set_bin_op(static_cast<SDFBinaryOperation>(record.bin_op));
+  node.set_factor(record.factor);
+}
+
+// Returns the created node if it is a group, so that its children can be appended to it.
+GroupNode* deserialize_child_node(SDFSubtreeBuilder& builder, GroupNode& parent, size_t index,
+                                  const BinarySceneReader& reader,
+                                  const std::unordered_map<uint32_t, IdView<MaterialId>>& material_ids_map,
+                                  const std::vector<Prefab*>& prefabs) {
+  const NodeRecord record = reader.node(index);
+  if (record.type == kGroupNodeType) {
+    auto& group = builder.push_back_child<GroupNode>(parent, SDFBinaryOperation::Union);
+    deserialize_node_common(group, record, reader, material_ids_map);
+    return &group;
+  }
+
+  if (record.type == kPrefabReferenceNodeType) {
+    auto& reference =
+        builder.push_back_child<PrefabReferenceNode>(parent, SDFBinaryOperation::Union, *prefabs[record.prefab]);
+    deserialize_node_common(reference, record, reader, material_ids_map);
+    reference.set_repetition(unpack_repetition(record, index));
+    return nullptr;
+  }
+
+  auto& prim = builder.push_back_primitive(parent, static_cast<SDFTreePrimitiveType>(record.type),
+                                           SDFBinaryOperation::Union);
+  deserialize_node_common(prim, record, reader, material_ids_map);
+  auto visitor = BinaryDeserializerSDFTreeNodeVisitor(record);
+  prim.accept_visitor(visitor);
+  return nullptr;
+}
+
+// Builds the nodes [begin, end) into the builder, the node begin being its root. The nodes are stored in pre-order, so
+// every subtree spans a contiguous range of the nodes and the parents always come before their children.
+void build_nodes(SDFSubtreeBuilder& builder, const BinarySceneReader& reader, size_t begin, size_t end,
+                 const std::unordered_map<uint32_t, IdView<MaterialId>>& material_ids_map,
+                 const std::vector<Prefab*>& prefabs) {
+  std::vector<GroupNode*> groups(end - begin, nullptr);
+  groups[0] = &builder.root();
+  for (size_t i = begin + 1; i < end; ++i) {
+    const NodeRecord record = reader.node(i);
+    groups[i - begin]       =
+        deserialize_child_node(builder, *groups[record.parent - begin], i, reader, material_ids_map, prefabs);
+  }
+}
+
+// The records must have passed validate_records
+std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const BinarySceneReader& reader,
+                                                ThreadPool* thread_pool) {
+  const Header& header = reader.header();
+
+  std::unordered_map<uint32_t, IdView<MaterialId>> material_ids_map;
+  for (size_t i = 0; i < header.material_count; ++i) {
+    const MaterialRecord record = reader.material(i);
+    auto& mat = tree.add_material(Material(glm::vec3(record.albedo[0], record.albedo[1], record.albedo[2]),
+                                           record.ambient, record.diffuse, record.specular, record.specular_exponent));
+    mat.rename(reader.string(record.name));
+    material_ids_map.emplace(record.id, mat.material_id());
+  }
+
+  // The tree ends where the content of the first prefab begins
+  const size_t tree_end = header.prefab_count == 0 ? header.node_count : reader.prefab(0).root;
+
+  // The content of a prefab cannot reference other prefabs, so it is built without any
+  const std::vector<Prefab*> no_prefabs;
+  std::vector<Prefab*> prefabs;
+  for (size_t i = 0; i < header.prefab_count; ++i) {
+    const PrefabRecord record = reader.prefab(i);
+    const size_t end          = i + 1 < header.prefab_count ? reader.prefab(i + 1).root : header.node_count;
+    SDFSubtreeBuilder prefab_builder(tree.create_detached_node<GroupNode>());
+    deserialize_node_common(prefab_builder.root(), reader.node(record.root), reader, material_ids_map);
+    build_nodes(prefab_builder, reader, record.root, end, material_ids_map, no_prefabs);
+    prefabs.push_back(&tree.add_prefab(prefab_builder.build(), reader.string(record.path)));
+  }
+
+  SDFSubtreeBuilder builder(tree.create_detached_node<GroupNode>());
+  deserialize_node_common(builder.root(), reader.node(0), reader, material_ids_map);
+  if (thread_pool == nullptr) {
+    build_nodes(builder, reader, 0, tree_end, material_ids_map, prefabs);
+    return builder.build();
+  }
+
+  // The children of the root start the contiguous ranges of their subtrees
+  std::vector<size_t> child_begins;
+  for (size_t i = 1; i < tree_end; ++i) {
+    if (reader.node(i).parent == 0) {
+      child_begins.push_back(i);
+    }
+  }
+  auto child_end = [&](size_t k) { return k + 1 < child_begins.size() ? child_begins[k + 1] : tree_end; };
+
+  // The groups are built concurrently, each with its own builder, and the primitives are left for the attaching loop
+  std::vector<std::unique_ptr<GroupNode>> subtrees(child_begins.size());
+  thread_pool->parallel_for(child_begins.size(), [&](size_t k) {
+    const NodeRecord record = reader.node(child_begins[k]);
+    if (record.type != kGroupNodeType) {
+      return;
+    }
+    SDFSubtreeBuilder subtree_builder(tree.create_detached_node<GroupNode>());
+    deserialize_node_common(subtree_builder.root(), record, reader, material_ids_map);
+    build_nodes(subtree_builder, reader, child_begins[k], child_end(k), material_ids_map, prefabs);
+    subtrees[k] = subtree_builder.build();
+  });
+
+  for (size_t k = 0; k < child_begins.size(); ++k) {
+    if (subtrees[k] != nullptr) {
+      builder.push_back_built_subtree(builder.root(), std::move(subtrees[k]));
+      continue;
+    }
+    deserialize_child_node(builder, builder.root(), child_begins[k], reader, material_ids_map, prefabs);
+  }
+
+  return builder.build();
+}
+
+}  // namespace
+
+bool is_binary_scene(std::span<const uint8_t> data) {
+  return data.size() >= kBinarySceneMagic.size() &&
+         std::memcmp(data.data(), kBinarySceneMagic.data(), kBinarySceneMagic.size()) == 0;
+}
+
+bool is_binary_scene(std::istream& stream) {
+  const auto start = stream.tellg();
+  std::array<char, kBinarySceneMagic.size()> magic{};
+  stream.read(magic.data(), magic.size());
+  const bool is_binary = stream.gcount() == static_cast<std::streamsize>(magic.size()) && magic == kBinarySceneMagic;
+  stream.clear();
+  stream.seekg(start);
+  return is_binary;
+}
+
+NodeRecord make_node_record(SDFTreeNode& node) {
+  NodeRecord record{};
+  record.parent = kNoParent;
+  write_node_common(node, record);
+
+  auto visitor = BinarySerializerSDFTreeNodeVisitor(record);
+  node.accept_visitor(visitor);
+  return record;
+}
+
+void apply_node_record(SDFTreeNode& node, const NodeRecord& record) {
+  read_transform(node.transform(), record.position, record.rotation, record.scale);
+  if (record.bin_op >= static_cast<uint8_t>(SDFBinaryOperation::_Count)) {
+    log_throw(BinarySceneDeserializationException(std::format("Invalid binary operation {}.", record.bin_op)));
+  }
+  if (node.bin_op() != static_cast<SDFBinaryOperation>(record.bin_op)) {
+    node.set_bin_op(static_cast<SDFBinaryOperation>(record.bin_op));
+  }
+  node.set_factor(record.factor);
+
+  auto visitor = BinaryDeserializerSDFTreeNodeVisitor(record);
+  node.accept_visitor(visitor);
+  if (PrefabReferenceNode* reference = visitor.reference()) {
+    reference->set_repetition(unpack_repetition(record, 0));
+  }
+  node.mark_dirty();
+  node.mark_primitives_dirty();
+}
+
+MaterialRecord make_material_record(const MaterialSDFTreeComponent& material) {
+  const Material& mat = material.material;
+  return MaterialRecord{
+      .id                = static_cast<uint32_t>(material.material_id().raw()),
+      .name              = {},
+      .albedo            = {mat.albedo.r, mat.albedo.g, mat.albedo.b},
+      .ambient           = mat.ambientFactor,
+      .diffuse           = mat.diffuseFactor,
+      .specular          = mat.specularFactor,
+      .specular_exponent = mat.specularExponent,
+  };
+}
+
+LightRecord make_light_record(BaseLightSceneComponent& light) {
+  LightRecord record{};
+  const auto& color = light.light_base().color;
+  record.color      = {color.r, color.g, color.b};
+  write_transform(light.light_base().transform, record.position, record.rotation, record.scale);
+
+  auto visitor = BinarySerializerLightSceneComponentVisitor(record);
+  light.accept_visitor(visitor);
+  return record;
+}
+
+SceneTables decode_scene_tables(std::span<const uint8_t> data) {
+  const BinarySceneReader reader(data);
+  const Header& header = reader.header();
+
+  SceneTables tables;
+  for (size_t i = 0; i < header.material_count; ++i) {
+    tables.materials.push_back(reader.material(i));
+    tables.material_names.push_back(reader.string(tables.materials.back().name));
+  }
+  for (size_t i = 0; i < header.prefab_count; ++i) {
+    tables.prefabs.push_back(reader.prefab(i));
+    tables.prefab_paths.push_back(reader.string(tables.prefabs.back().path));
+  }
+  for (size_t i = 0; i < header.node_count; ++i) {
+    tables.nodes.push_back(reader.node(i));
+    tables.node_names.push_back(reader.string(tables.nodes.back().name));
+  }
+  for (size_t i = 0; i < header.light_count; ++i) {
+    tables.lights.push_back(reader.light(i));
+    tables.light_names.push_back(reader.string(tables.lights.back().name));
+  }
+  return tables;
+}
+
+std::vector<uint8_t> encode_scene_tables(SceneTables tables) {
+  std::string strings;
+  const auto add_string = [&strings](std::string_view str) {
+    const StringRef ref{.offset = static_cast<uint32_t>(strings.size()), .length = static_cast<uint32_t>(str.size())};
+    strings.append(str);
+    return ref;
+  };
+
+  for (size_t i = 0; i < tables.materials.size(); ++i) {
+    tables.materials[i].name = add_string(tables.material_names[i]);
+  }
+  for (size_t i = 0; i < tables.prefabs.size(); ++i) {
+    tables.prefabs[i].path = add_string(tables.prefab_paths[i]);
+  }
+  for (size_t i = 0; i < tables.nodes.size(); ++i) {
+    tables.nodes[i].name = add_string(tables.node_names[i]);
+  }
+  for (size_t i = 0; i < tables.lights.size(); ++i) {
+    tables.lights[i].name = add_string(tables.light_names[i]);
+  }
+  return write_tables(tables.materials, tables.prefabs, tables.nodes, tables.lights, strings);
+}
+
+std::vector<uint8_t> serialize_prefab(SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_id) {
+  Logger::info("Binary prefab serialization started");
+
+  BinarySceneWriter writer(tree, true);
+  writer.add_node(tree.group(subtree_root_id), kNoParent);
+  for (const auto mat_id : writer.used_materials()) {
+    writer.add_material(mat_id);
+  }
+
+  Logger::info("Binary prefab serialization succeeded");
+  return writer.finish();
+}
+
+std::vector<uint8_t> serialize_scene(Scene& scene) {
+  Logger::info("Binary resin project serialization started");
+
+  BinarySceneWriter writer(scene.tree());
+  for (const auto mat_id : scene.tree().materials()) {
+    writer.add_material(mat_id);
+  }
+  writer.add_node(scene.tree().root(), kNoParent);
+  writer.add_prefabs();
+  for (const auto& light : scene.lights()) {
+    writer.add_light(*light.second);
+  }
+
+  Logger::info("Binary resin project serialization succeeded");
+  return writer.finish();
+}
+
+std::unique_ptr<GroupNode> deserialize_prefab(SDFTree& tree, std::span<const uint8_t> prefab_data) {
+  const BinarySceneReader reader(prefab_data);
+  validate_records(reader);
+  Logger::info("Binary prefab deserialization started");
+
+  try {
+    std::unique_ptr<GroupNode> prefab_root = deserialize_sdf_tree(tree, reader, nullptr);
+    Logger::info("Binary prefab deserialization succeeded");
+    return prefab_root;
+  } catch (const ResinException& e) {
+    Logger::warn("Binary prefab deserialization failed");
+    throw e;
+  } catch (...) {
+    Logger::warn("Binary prefab deserialization failed");
+    log_throw(BinarySceneDeserializationException());
+  }
+}
+
+void deserialize_scene(Scene& scene, std::span<const uint8_t> scene_data, ThreadPool* thread_pool) {
+  // Validated before the scene is cleared, so a corrupted file leaves the current scene intact
+  const BinarySceneReader reader(scene_data);
+  validate_records(reader);
+  Logger::info("Binary resin scene deserialization started");
+
+  try {
+    scene.clear();
+    std::unique_ptr<GroupNode> root = deserialize_sdf_tree(scene.tree(), reader, thread_pool);
+    scene.tree().set_root(std::move(root));
+
+    for (size_t i = 0; i < reader.header().light_count; ++i) {
+      const LightRecord record = reader.light(i);
+      auto& light = scene.add_light(static_cast<LightType>(record.type));
+      read_transform(light.light_base().transform, record.position, record.rotation, record.scale);
+      light.light_base().color = glm::vec3(record.color[0], record.color[1], record.color[2]);
+      light.rename(reader.string(record.name));
+
+      auto visitor = BinaryDeserializerLightSceneComponentVisitor(record);
+      light.accept_visitor(visitor);
+    }
+
+    Logger::info("Binary resin scene deserialization succeeded");
+  } catch (const ResinException& e) {
+    Logger::warn("Binary resin scene deserialization failed");
+    throw e;
+  } catch (...) {
+    Logger::warn("Binary resin scene deserialization failed");
+    log_throw(BinarySceneDeserializationException());
+  }
+}
+
+}  // namespace binary
+
+}  // namespace resin
@@ -0,0 +1,165 @@
+#ifndef RESIN_BINARY_SCENE_HPP
+#define RESIN_BINARY_SCENE_HPP
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <istream>
+#include <libresin/core/id_registry.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace resin {
+
+class ThreadPool;
+
+namespace binary {
+
+// Binary counterpart of the JSON scene and prefab formats, storing exactly the same data. The file is a header
+// followed by fixed size record tables and a string table:
+//
+//   Header | MaterialRecord[material_count] | PrefabRecord[prefab_count] | NodeRecord[node_count] |
+//   LightRecord[light_count] | strings
+//
+// The nodes are stored in pre-order with the index of their parent group, so a tree is rebuilt in a single pass over
+// the table. The tree comes first, followed by the contents of the prefabs, each being a root of its own. Every record
+// is a multiple of 4 bytes, so a file mapped into memory can be read in place. All values are little-endian.
+//
+// Version 1 files have no prefab_count in the header and no prefab table.
+
+constexpr std::array<char, 4> kBinarySceneMagic = {'R', 'S', 'N', 'B'};
+constexpr uint32_t kNewestBinarySceneVersion    = 2;
+
+constexpr uint32_t kNoParent               = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kNoMaterial             = std::numeric_limits<uint32_t>::max();
+// The primitives use SDFTreePrimitiveType as their node type
+constexpr uint8_t kGroupNodeType           = std::numeric_limits<uint8_t>::max();
+constexpr uint8_t kPrefabReferenceNodeType = kGroupNodeType - 1;
+
+struct Header {
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint32_t material_count;
+  uint32_t node_count;
+  uint32_t light_count;
+  uint32_t string_table_size;
+  uint32_t prefab_count;  // since version 2
+};
+
+constexpr size_t kHeaderV1Size = 24;
+
+// Names are slices of the string table.
+struct StringRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+struct MaterialRecord {
+  uint32_t id;  // raw id the nodes reference the material by
+  StringRef name;
+  std::array<float, 3> albedo;
+  float ambient;
+  float diffuse;
+  float specular;
+  float specular_exponent;
+};
+
+struct PrefabRecord {
+  uint32_t root;  // index of the node record of the prefab content root
+  StringRef path;
+};
+
+struct NodeRecord {
+  uint32_t parent;       // index of the parent group record, kNoParent for the roots
+  uint32_t material_id;  // kNoMaterial if the node has no material of its own
+  StringRef name;
+  uint8_t type;
+  uint8_t bin_op;
+  uint16_t prefab;  // index of the prefab record of a prefab reference, zero otherwise
+  float factor;
+  std::array<float, 3> position;
+  std::array<float, 4> rotation;  // w, x, y, z
+  float scale;
+
+  // Primitive parameters in the order of the JSON properties, e.g. the cube size or the torus major and minor radius.
+  // A prefab reference stores the repetition spacing in the first three and the bits of the repetition type and counts
+  // in the last one: the type in the lowest 2 bits followed by 10 bits for each of the counts, all zero if the content
+  // is not repeated.
+  std::array<float, 4> parameters;
+};
+
+struct LightRecord {
+  uint8_t type;  // LightType
+  std::array<uint8_t, 3> padding;
+  StringRef name;
+  std::array<float, 3> color;
+  std::array<float, 3> position;
+  std::array<float, 4> rotation;  // w, x, y, z
+  float scale;
+
+  // Attenuation of a point light, ambient impact of a directional light
+  std::array<float, 3> parameters;
+};
+
+static_assert(std::endian::native == std::endian::little, "The binary scene format is little-endian");
+static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) == 28);
+static_assert(std::is_trivially_copyable_v<MaterialRecord> && sizeof(MaterialRecord) == 40);
+static_assert(std::is_trivially_copyable_v<PrefabRecord> && sizeof(PrefabRecord) == 12);
+static_assert(std::is_trivially_copyable_v<NodeRecord> && sizeof(NodeRecord) == 72);
+static_assert(std::is_trivially_copyable_v<LightRecord> && sizeof(LightRecord) == 68);
+
+// True if the data starts with the binary scene magic, used to tell the binary files from the JSON ones.
+bool is_binary_scene(std::span<const uint8_t> data);
+
+// Stream variant of the above, which only peeks at the magic and leaves the stream at the position it was at.
+bool is_binary_scene(std::istream& stream);
+
+// Records of the single objects as written by serialize_scene, except that the names and the node parents are left
+// unset. The prefab index of a prefab reference is set to zero, as it depends on the other references.
+[[nodiscard]] NodeRecord make_node_record(SDFTreeNode& node);
+[[nodiscard]] MaterialRecord make_material_record(const MaterialSDFTreeComponent& material);
+[[nodiscard]] LightRecord make_light_record(BaseLightSceneComponent& light);
+
+// Inverse of make_node_record for an existing node of the record type, the material, the name and the prefab are left
+// untouched. The binary operation is set only if it changed, as it is compiled into the shader.
+void apply_node_record(SDFTreeNode& node, const NodeRecord& record);
+
+// Binary scene split into its record tables, with the names stored next to the tables instead of the string table, so
+// that the scene can be edited at the record level, e.g. by the autosave journal. The name references of the records
+// are ignored by encode_scene_tables.
+struct SceneTables {
+  std::vector<MaterialRecord> materials;
+  std::vector<PrefabRecord> prefabs;
+  std::vector<NodeRecord> nodes;
+  std::vector<LightRecord> lights;
+
+  std::vector<std::string> material_names;
+  std::vector<std::string> prefab_paths;
+  std::vector<std::string> node_names;
+  std::vector<std::string> light_names;
+};
+
+// The records are not validated beyond the table bounds, deserialize_scene validates them once encoded back.
+[[nodiscard]] SceneTables decode_scene_tables(std::span<const uint8_t> data);
+[[nodiscard]] std::vector<uint8_t> encode_scene_tables(SceneTables tables);
+
+// The prefab file must be self-contained, so the prefab references are stored expanded.
+[[nodiscard]] std::vector<uint8_t> serialize_prefab(SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_id);
+[[nodiscard]] std::vector<uint8_t> serialize_scene(Scene& scene);
+
+[[nodiscard]] std::unique_ptr<GroupNode> deserialize_prefab(SDFTree& tree, std::span<const uint8_t> prefab_data);
+
+// If the thread pool is provided, the groups under the root are built concurrently on it. The tree must not be used by
+// other threads until the function returns.
+void deserialize_scene(Scene& scene, std::span<const uint8_t> scene_data, ThreadPool* thread_pool = nullptr);
+
+}  // namespace binary
+
+}  // namespace resin
+#endif
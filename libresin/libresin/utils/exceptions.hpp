@@ -357,6 +357,40 @@ class SDFTreeReachedDirtyPrimitivesLimit : public ResinException {
       : ResinException(std::format(R"(SDF Tree reached the dirty primitives limit)")) {}
 };
 
+class PrefabDoesNotExist : public ResinException {
+ public:
+  EXCEPTION_NAME(PrefabDoesNotExist)
+
+  explicit PrefabDoesNotExist(size_t id)
+      : ResinException(std::format(R"(Prefab with id {} does not exist)", id)), id_(id) {}
+
+  inline size_t get_id() const { return id_; }
+
+ private:
+  size_t id_;
+};
+
+class SDFTreeNodeIsNotAPrefabReference : public ResinException {
+ public:
+  EXCEPTION_NAME(SDFTreeNodeIsNotAPrefabReference)
+
+  explicit SDFTreeNodeIsNotAPrefabReference(size_t id)
+      : ResinException(std::format(R"(SDF Tree node with id {} is not a prefab reference)", id)), id_(id) {}
+
+  inline size_t get_id() const { return id_; }
+
+ private:
+  size_t id_;
+};
+
+class NestedPrefabReferenceException : public ResinException {
+ public:
+  EXCEPTION_NAME(NestedPrefabReferenceException)
+
+  explicit NestedPrefabReferenceException()
+      : ResinException(std::format(R"(Prefab content must not contain prefab references)")) {}
+};
+
 class JSONSerializationException : public ResinException {
  public:
   EXCEPTION_NAME(JSONSerializationException)
@@ -415,6 +449,15 @@ class InvalidJSONException : public ResinException {
   explicit InvalidJSONException() : ResinException("Provided JSON is not valid.") {}
 };
 
+class BinarySceneDeserializationException : public ResinException {
+ public:
+  EXCEPTION_NAME(BinarySceneDeserializationException)
+
+  explicit BinarySceneDeserializationException() : ResinException("Binary scene deserialization failed.") {}
+  explicit BinarySceneDeserializationException(const std::string& msg)
+      : ResinException(std::format("Binary scene deserialization failed: {}", msg)) {}
+};
+
 class NotImplementedException : public ResinException {
  public:
   EXCEPTION_NAME(NotImplementedException)
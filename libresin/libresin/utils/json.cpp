@@ -2,14 +2,20 @@
 #include <json_schemas/json_schemas.hpp>
 #include <libresin/core/light.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/json.hpp>
 #include <libresin/utils/logger.hpp>
+#include <libresin/utils/thread_pool.hpp>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace resin {
 
@@ -19,15 +25,28 @@ namespace {
 
 bool property_exists(const json& j, std::string_view key) { return j.find(key) != j.end(); }
 
+class PrefabReferenceVisitor : public ISDFTreeNodeVisitor {
+ public:
+  void visit_prefab_reference(PrefabReferenceNode& node) override { reference = &node; }
+
+  PrefabReferenceNode* reference = nullptr;
+};
+
 void find_used_materials(
-    std::unordered_set<IdView<MaterialId>, IdViewHash<MaterialId>, std::equal_to<>>& used_materials,
-    const SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_id) {
+    std::unordered_set<IdView<MaterialId>, IdViewHash<MaterialId>, std::equal_to<>>& used_materials, SDFTree& tree,
+    IdView<SDFTreeNodeId> subtree_root_id) {
   if (tree.is_group(subtree_root_id)) {
     for (const auto& child_id : tree.group(subtree_root_id)) {
       find_used_materials(used_materials, tree, child_id);
     }
   }
 
+  PrefabReferenceVisitor visitor;
+  tree.visit_node(subtree_root_id, visitor);
+  if (visitor.reference != nullptr) {
+    find_used_materials(used_materials, tree, visitor.reference->prefab().root().node_id());
+  }
+
   auto mat_id = tree.node(subtree_root_id).material_id();
   if (mat_id.has_value() && *mat_id != tree.default_material().material_id()) {
     used_materials.insert(*mat_id);
@@ -49,6 +68,30 @@ void serialize_transform(json& target_json, const Transform& transform) {
   target_json["scale"] = transform.local_scale();
 }
 
+void serialize_repetition(json& target_json, const Repetition& repetition) {
+  switch (repetition.type) {
+    case RepetitionType::None:
+      return;
+    case RepetitionType::Grid: {
+      auto& grid_json           = target_json[kRepetitionJSONNames[RepetitionType::Grid]];
+      grid_json["spacing"]["x"] = repetition.spacing.x;
+      grid_json["spacing"]["y"] = repetition.spacing.y;
+      grid_json["spacing"]["z"] = repetition.spacing.z;
+      grid_json["count"]["x"]   = repetition.count.x;
+      grid_json["count"]["y"]   = repetition.count.y;
+      grid_json["count"]["z"]   = repetition.count.z;
+      return;
+    }
+    case RepetitionType::Polar:
+      target_json[kRepetitionJSONNames[RepetitionType::Polar]]["count"] = repetition.count.x;
+      return;
+    case RepetitionType::_Count:
+      break;
+  }
+
+  throw NonExhaustiveEnumException();
+}
+
 void serialize_material(json& target_json, const MaterialSDFTreeComponent& material) {
   target_json["id"]               = material.material_id().raw();
   target_json["name"]             = material.name();
@@ -84,14 +127,15 @@ void serialize_node_common(json& target_json, const SDFTreeNode& node) {
   serialize_node_factor(target_json, node);
 }
 
-JSONSerializerSDFTreeNodeVisitor::JSONSerializerSDFTreeNodeVisitor(json& node_json) : json_(node_json) {}
+JSONSerializerSDFTreeNodeVisitor::JSONSerializerSDFTreeNodeVisitor(json& node_json, bool expand_prefab_references)
+    : json_(node_json), expand_prefab_references_(expand_prefab_references) {}
 
 void JSONSerializerSDFTreeNodeVisitor::visit_group(GroupNode& node) {
   auto children = json::array();
   for (auto child_id : node) {
     auto& child = node.get_child(child_id);
     json child_json;
-    JSONSerializerSDFTreeNodeVisitor visitor(child_json);
+    JSONSerializerSDFTreeNodeVisitor visitor(child_json, expand_prefab_references_);
     serialize_node_common(child_json, child);
     child.accept_visitor(visitor);
     children.push_back(child_json);
@@ -141,8 +185,45 @@ void JSONSerializerSDFTreeNodeVisitor::visit_prism(TriangularPrismNode& node) {
   json_["triangularPrism"]["baseHeight"]  = node.baseHeight;
 }
 
+void JSONSerializerSDFTreeNodeVisitor::visit_prefab_reference(PrefabReferenceNode& node) {
+  const Repetition& repetition = node.repetition();
+  if (!expand_prefab_references_) {
+    json_["prefabReference"]["prefabId"] = node.prefab().prefab_id().raw();
+    if (repetition.type != RepetitionType::None) {
+      serialize_repetition(json_["prefabReference"]["repetition"], repetition);
+    }
+    return;
+  }
+
+  // Same layout as the group created by PrefabReferenceNode::expand
+  auto& content = node.prefab().root();
+  json content_json;
+  JSONSerializerSDFTreeNodeVisitor visitor(content_json, true);
+  serialize_node_common(content_json, content);
+  content.accept_visitor(visitor);
+  if (repetition.type == RepetitionType::None) {
+    json_["group"]["children"] = json::array({content_json});
+    return;
+  }
+
+  auto children = json::array();
+  for (size_t i = 0; i < repetition.instance_count(); ++i) {
+    Transform instance_transform;
+    instance_transform.set_local_from_matrix(repetition.instance_matrix(i));
+
+    json instance_json;
+    serialize_transform(instance_json["transform"], instance_transform);
+    instance_json["name"]              = PrefabReferenceNode::instance_group_name(i);
+    instance_json["binaryOperation"]   = kSDFBinaryOperationsJSONNames[SDFBinaryOperation::Union];
+    instance_json["factor"]            = SDFTreeNode::kDefaultFactor;
+    instance_json["group"]["children"] = json::array({content_json});
+    children.push_back(std::move(instance_json));
+  }
+  json_["group"]["children"] = std::move(children);
+}
+
 void serialize_sdf_tree(json& target_json, SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_id,
-                        bool ignore_unused_materials) {
+                        bool ignore_unused_materials, bool expand_prefab_references) {
   auto materials = json::array();
   if (ignore_unused_materials) {
     Logger::info("Ignoring unused materials");
@@ -163,9 +244,28 @@ void serialize_sdf_tree(json& target_json, SDFTree& tree, IdView<SDFTreeNodeId>
   }
   target_json["tree"]["materials"] = materials;
 
+  if (!expand_prefab_references) {
+    auto prefabs = json::array();
+    for (auto prefab_id : tree.prefabs()) {
+      auto& prefab = tree.prefab(prefab_id);
+      if (prefab.reference_count() == 0) {
+        continue;
+      }
+
+      json prefab_json;
+      prefab_json["id"]   = prefab_id.raw();
+      prefab_json["path"] = prefab.path();
+      serialize_node_common(prefab_json["rootGroup"], prefab.root());
+      auto visitor = JSONSerializerSDFTreeNodeVisitor(prefab_json["rootGroup"]);
+      prefab.root().accept_visitor(visitor);
+      prefabs.push_back(prefab_json);
+    }
+    target_json["tree"]["prefabs"] = prefabs;
+  }
+
   auto& root_group = tree.group(subtree_root_id);
   serialize_node_common(target_json["tree"]["rootGroup"], root_group);
-  auto visitor = JSONSerializerSDFTreeNodeVisitor(target_json["tree"]["rootGroup"]);
+  auto visitor = JSONSerializerSDFTreeNodeVisitor(target_json["tree"]["rootGroup"], expand_prefab_references);
   root_group.accept_visitor(visitor);
 }
 
@@ -178,7 +278,8 @@ std::string serialize_prefab(SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_i
   try {
     json prefab_json;
     prefab_json["version"] = kNewestResinPrefabJSONSchemaVersion;
-    serialize_sdf_tree(prefab_json, tree, subtree_root_id, true);
+    // The prefab file must be self-contained, so the references are stored expanded
+    serialize_sdf_tree(prefab_json, tree, subtree_root_id, true, true);
 
     Logger::info("JSON prefab serialization succceeded");
     return prefab_json.dump(2);
@@ -282,6 +383,23 @@ void deserialize_transform(Transform& transform, const json& trans_json) {
   }
 }
 
+void deserialize_repetition(Repetition& repetition, const json& repetition_json) {
+  const auto grid_json_it  = repetition_json.find(kRepetitionJSONNames[RepetitionType::Grid]);
+  const auto polar_json_it = repetition_json.find(kRepetitionJSONNames[RepetitionType::Polar]);
+  if (grid_json_it != repetition_json.end()) {
+    const auto& spacing_json = grid_json_it->at("spacing");
+    const auto& count_json   = grid_json_it->at("count");
+    repetition.type          = RepetitionType::Grid;
+    repetition.spacing       = glm::vec3(spacing_json.at("x"), spacing_json.at("y"), spacing_json.at("z"));
+    repetition.count         = glm::uvec3(count_json.at("x"), count_json.at("y"), count_json.at("z"));
+  } else if (polar_json_it != repetition_json.end()) {
+    repetition.type  = RepetitionType::Polar;
+    repetition.count = glm::uvec3(polar_json_it->at("count").get<uint32_t>(), 1, 1);
+  } else {
+    log_throw(JSONNodeDeserializationException("The repetition type is not defined."));
+  }
+}
+
 void deserialize_material(MaterialSDFTreeComponent& material, const json& mat_json) {
   try {
     material.material = Material(
@@ -327,31 +445,70 @@ void deserialize_node_common(SDFTreeNode& node, const json& node_json,
 }
 
 JSONDeserializerSDFTreeNodeVisitor::JSONDeserializerSDFTreeNodeVisitor(
-    const json& node_json, const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map)
-    : node_json_(node_json), material_ids_map_(material_ids_map) {}
+    const json& node_json, SDFSubtreeBuilder& builder,
+    const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map, const PrefabsMap& prefabs_map)
+    : node_json_(node_json), builder_(builder), material_ids_map_(material_ids_map), prefabs_map_(prefabs_map) {}
 
-void JSONDeserializerSDFTreeNodeVisitor::visit_group(GroupNode& node) {
-  try {
-    for (const auto& child_json : node_json_.at("group").at("children")) {
-      for (auto [prim_type, name] : kSDFTreePrimitiveNodesJSONNames) {
-        if (property_exists(child_json, name)) {
-          auto& child_prim = node.push_back_primitive(prim_type, SDFBinaryOperation::Union);
+namespace {
 
-          deserialize_node_common(child_prim, child_json, material_ids_map_);
-          auto visitor = JSONDeserializerSDFTreeNodeVisitor(child_json, material_ids_map_);
-          child_prim.accept_visitor(visitor);
+void deserialize_child_node(SDFSubtreeBuilder& builder, GroupNode& parent, const json& child_json,
+                            const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map,
+                            const PrefabsMap& prefabs_map) {
+  for (auto [prim_type, name] : kSDFTreePrimitiveNodesJSONNames) {
+    if (property_exists(child_json, name)) {
+      auto& child_prim = builder.push_back_primitive(parent, prim_type, SDFBinaryOperation::Union);
 
-          break;
-        }
-      }
+      deserialize_node_common(child_prim, child_json, material_ids_map);
+      auto visitor = JSONDeserializerSDFTreeNodeVisitor(child_json, builder, material_ids_map, prefabs_map);
+      child_prim.accept_visitor(visitor);
 
-      if (property_exists(child_json, "group")) {
-        auto& child_group = node.push_back_child<GroupNode>(SDFBinaryOperation::Union);
+      break;
+    }
+  }
 
-        deserialize_node_common(child_group, child_json, material_ids_map_);
-        auto visitor = JSONDeserializerSDFTreeNodeVisitor(child_json, material_ids_map_);
-        child_group.accept_visitor(visitor);
-      }
+  if (property_exists(child_json, "group")) {
+    auto& child_group = builder.push_back_child<GroupNode>(parent, SDFBinaryOperation::Union);
+
+    deserialize_node_common(child_group, child_json, material_ids_map);
+    auto visitor = JSONDeserializerSDFTreeNodeVisitor(child_json, builder, material_ids_map, prefabs_map);
+    child_group.accept_visitor(visitor);
+  }
+
+  if (property_exists(child_json, "prefabReference")) {
+    size_t id      = child_json.at("prefabReference").at("prefabId");
+    auto prefab_it = prefabs_map.find(id);
+    if (prefab_it == prefabs_map.end()) {
+      log_throw(JSONDeserializationException(std::format("Node references to non existing prefab with id {}.", id)));
+    }
+
+    auto& child_reference =
+        builder.push_back_child<PrefabReferenceNode>(parent, SDFBinaryOperation::Union, prefab_it->second.get());
+    deserialize_node_common(child_reference, child_json, material_ids_map);
+    if (property_exists(child_json.at("prefabReference"), "repetition")) {
+      Repetition repetition;
+      deserialize_repetition(repetition, child_json.at("prefabReference").at("repetition"));
+      child_reference.set_repetition(repetition);
+    }
+  }
+}
+
+// Builds the group with its own builder, so that it may run concurrently with the other groups
+std::unique_ptr<GroupNode> deserialize_group(SDFTree& tree, const json& group_json,
+                                             const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map,
+                                             const PrefabsMap& prefabs_map) {
+  SDFSubtreeBuilder builder(tree.create_detached_node<GroupNode>());
+  deserialize_node_common(builder.root(), group_json, material_ids_map);
+  auto visitor = JSONDeserializerSDFTreeNodeVisitor(group_json, builder, material_ids_map, prefabs_map);
+  builder.root().accept_visitor(visitor);
+  return builder.build();
+}
+
+}  // namespace
+
+void JSONDeserializerSDFTreeNodeVisitor::visit_group(GroupNode& node) {
+  try {
+    for (const auto& child_json : node_json_.at("group").at("children")) {
+      deserialize_child_node(builder_, node, child_json, material_ids_map_, prefabs_map_);
     }
   } catch (const ResinException& e) {
     Logger::warn("JSON prefab serialization failed");
@@ -502,7 +659,7 @@ void JSONDeserializerLightSceneComponentVisitor::visit_directional_light(
   }
 }
 
-std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const json& tree_json) {
+std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const json& tree_json, ThreadPool* thread_pool) {
   std::unordered_map<size_t, IdView<MaterialId>> material_ids_map;
   for (const auto& mat_json : tree_json.at("materials")) {
     auto& mat = tree.add_material(Material());
@@ -519,12 +676,54 @@ std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const json& tree_
 
   Logger::info("Materials deserialization succeeded");
 
-  auto root = tree.create_detached_node<GroupNode>();
-  deserialize_node_common(*root, tree_json.at("rootGroup"), material_ids_map);
-  auto visitor = JSONDeserializerSDFTreeNodeVisitor(tree_json.at("rootGroup"), material_ids_map);
-  root->accept_visitor(visitor);
+  PrefabsMap prefabs_map;
+  if (property_exists(tree_json, "prefabs")) {
+    // The content of a prefab cannot reference other prefabs, so it is built without any
+    const PrefabsMap no_prefabs;
+    for (const auto& prefab_json : tree_json.at("prefabs")) {
+      size_t id = prefab_json.at("id");
+      if (prefabs_map.contains(id)) {
+        log_throw(JSONDeserializationException(
+            std::format("More than one definition of a prefab with id {} found.", id)));
+      }
+
+      std::string path = property_exists(prefab_json, "path") ? prefab_json.at("path").get<std::string>() : "";
+      auto& prefab     = tree.add_prefab(
+          deserialize_group(tree, prefab_json.at("rootGroup"), material_ids_map, no_prefabs), std::move(path));
+      prefabs_map.emplace(id, prefab);
+    }
+
+    Logger::info("Prefabs deserialization succeeded");
+  }
+
+  SDFSubtreeBuilder builder(tree.create_detached_node<GroupNode>());
+  const json& root_json = tree_json.at("rootGroup");
+  deserialize_node_common(builder.root(), root_json, material_ids_map);
+  if (thread_pool == nullptr) {
+    auto visitor = JSONDeserializerSDFTreeNodeVisitor(root_json, builder, material_ids_map, prefabs_map);
+    builder.root().accept_visitor(visitor);
+    return builder.build();
+  }
+
+  // The groups under the root are independent until they are attached, so they are built concurrently and attached in
+  // order afterwards. The primitives under the root are cheap to build on the calling thread.
+  const json& children_json = root_json.at("group").at("children");
+  std::vector<std::unique_ptr<GroupNode>> subtrees(children_json.size());
+  thread_pool->parallel_for(children_json.size(), [&](size_t i) {
+    if (property_exists(children_json[i], "group")) {
+      subtrees[i] = deserialize_group(tree, children_json[i], material_ids_map, prefabs_map);
+    }
+  });
+
+  for (size_t i = 0; i < children_json.size(); ++i) {
+    if (subtrees[i] != nullptr) {
+      builder.push_back_built_subtree(builder.root(), std::move(subtrees[i]));
+    } else {
+      deserialize_child_node(builder, builder.root(), children_json[i], material_ids_map, prefabs_map);
+    }
+  }
 
-  return root;
+  return builder.build();
 }
 
 std::unique_ptr<GroupNode> deserialize_prefab(SDFTree& tree, std::string_view prefab_json_str) {
@@ -547,7 +746,7 @@ std::unique_ptr<GroupNode> deserialize_prefab(SDFTree& tree, std::string_view pr
   }
 }
 
-void deserialize_scene(Scene& scene, std::string_view scene_json_str) {
+void deserialize_scene(Scene& scene, std::string_view scene_json_str, ThreadPool* thread_pool) {
   if (!json::accept(scene_json_str)) {
     log_throw(InvalidJSONException());
   }
@@ -557,7 +756,7 @@ void deserialize_scene(Scene& scene, std::string_view scene_json_str) {
     scene.clear();
     auto scene_json = json::parse(scene_json_str);
 
-    std::unique_ptr<GroupNode> root = deserialize_sdf_tree(scene.tree(), scene_json.at("tree"));
+    std::unique_ptr<GroupNode> root = deserialize_sdf_tree(scene.tree(), scene_json.at("tree"), thread_pool);
     scene.tree().set_root(std::move(root));
 
     if (property_exists(scene_json, "lights")) {
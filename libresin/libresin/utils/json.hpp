@@ -1,13 +1,18 @@
 #ifndef RESIN_JSON_HPP
 #define RESIN_JSON_HPP
+#include <functional>
 #include <libresin/core/id_registry.hpp>
 #include <libresin/core/light.hpp>
 #include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node_visitor.hpp>
 #include <memory>
 #include <nlohmann/json_fwd.hpp>
+#include <unordered_map>
 
 namespace resin {
 
@@ -15,6 +20,7 @@ struct Transform;
 class MaterialSDFTreeComponent;
 class SDFTreeNode;
 class GroupNode;
+class ThreadPool;
 
 namespace json {
 using json = nlohmann::json;
@@ -49,10 +55,19 @@ constexpr StringEnumMapper<LightType> kLightJSONNames({
     {LightType::PointLight, "pointLight"},              //
 });
 
-// Serializes node specific data
+constexpr StringEnumMapper<RepetitionType> kRepetitionJSONNames({
+    {RepetitionType::None, "none"},    //
+    {RepetitionType::Grid, "grid"},    //
+    {RepetitionType::Polar, "polar"},  //
+});
+
+using PrefabsMap = std::unordered_map<size_t, std::reference_wrapper<Prefab>>;
+
+// Serializes node specific data. If expand_prefab_references is set, a prefab reference is written as the group created
+// by PrefabReferenceNode::expand, so the result does not depend on the prefabs table.
 class JSONSerializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
  public:
-  explicit JSONSerializerSDFTreeNodeVisitor(json& node_json);
+  explicit JSONSerializerSDFTreeNodeVisitor(json& node_json, bool expand_prefab_references = false);
 
   void visit_group(GroupNode& node) override;
   void visit_sphere(SphereNode& node) override;
@@ -64,9 +79,11 @@ class JSONSerializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
   void visit_pyramid(PyramidNode&) override;
   void visit_cylinder(CylinderNode&) override;
   void visit_prism(TriangularPrismNode&) override;
+  void visit_prefab_reference(PrefabReferenceNode&) override;
 
  private:
   json& json_;  // NOLINT
+  bool expand_prefab_references_;
 };
 
 class JSONSerializerLightSceneComponentVisitor : public ILightSceneComponentVisitor {
@@ -81,6 +98,7 @@ class JSONSerializerLightSceneComponentVisitor : public ILightSceneComponentVisi
 };
 
 void serialize_transform(json& target_json, const Transform& transform);
+void serialize_repetition(json& target_json, const Repetition& repetition);
 void serialize_material(json& target_json, const MaterialSDFTreeComponent& material);
 
 void serialize_node_material(json& target_json, const SDFTreeNode& node);
@@ -91,8 +109,9 @@ void serialize_node_factor(json& target_json, const SDFTreeNode& node);
 // Serializes material id, name, transform and binary operation
 void serialize_node_common(json& target_json, const SDFTreeNode& node);
 
+// The referenced prefabs are written to the prefabs table, unless the references are expanded
 void serialize_sdf_tree(json& target_json, SDFTree& tree, IdView<SDFTreeNodeId> subtree_root_id,
-                        bool ignore_unused_materials = true);
+                        bool ignore_unused_materials = true, bool expand_prefab_references = false);
 void serialize_sdf_tree(json& target_json, SDFTree& tree, bool ignore_unused_materials = true);
 
 void serialize_light_common(json& target_json, const BaseLightSceneComponent& light);
@@ -104,8 +123,9 @@ void serialize_attenuation(json& target_json, const PointLight::Attenuation& att
 // Deserializes node specific data
 class JSONDeserializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
  public:
-  explicit JSONDeserializerSDFTreeNodeVisitor(const json& node_json,
-                                              const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map);
+  explicit JSONDeserializerSDFTreeNodeVisitor(const json& node_json, SDFSubtreeBuilder& builder,
+                                              const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map,
+                                              const PrefabsMap& prefabs_map);
 
   void visit_group(GroupNode& node) override;
   void visit_sphere(SphereNode& node) override;
@@ -120,7 +140,9 @@ class JSONDeserializerSDFTreeNodeVisitor : public ISDFTreeNodeVisitor {
 
  private:
   const json& node_json_;                                                   // NOLINT
+  SDFSubtreeBuilder& builder_;                                              // NOLINT
   const std::unordered_map<size_t, IdView<MaterialId>>& material_ids_map_;  // NOLINT
+  const PrefabsMap& prefabs_map_;                                           // NOLINT
 };
 
 class JSONDeserializerLightSceneComponentVisitor : public ILightSceneComponentVisitor {
@@ -135,6 +157,7 @@ class JSONDeserializerLightSceneComponentVisitor : public ILightSceneComponentVi
 };
 
 void deserialize_transform(Transform& transform, const json& trans_json);
+void deserialize_repetition(Repetition& repetition, const json& repetition_json);
 void deserialize_material(MaterialSDFTreeComponent& material, const json& mat_json);
 
 void deserialize_node_material(SDFTreeNode& node, const json& node_json,
@@ -150,10 +173,14 @@ void deserialize_node_common(SDFTreeNode& node, const json& node_json,
 void deserialize_light_common(BaseLightSceneComponent& light, const json& light_json);
 void deserialize_attenuation(PointLight::Attenuation& attenuation, const json& attenuation_json);
 
-std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const json& tree_json);
+// The prefabs of the prefabs table are added to the tree before the root is built. If the thread pool is provided, the
+// groups under the root are built concurrently on it. The tree must not be used by other threads until the function
+// returns.
+std::unique_ptr<GroupNode> deserialize_sdf_tree(SDFTree& tree, const json& tree_json,
+                                                ThreadPool* thread_pool = nullptr);
 
 [[nodiscard]] std::unique_ptr<GroupNode> deserialize_prefab(SDFTree& tree, std::string_view prefab_json_str);
-void deserialize_scene(Scene& scene, std::string_view scene_json_str);
+void deserialize_scene(Scene& scene, std::string_view scene_json_str, ThreadPool* thread_pool = nullptr);
 
 }  // namespace json
 
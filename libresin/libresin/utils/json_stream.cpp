@@ -0,0 +1,1012 @@
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <glm/gtc/quaternion.hpp>
+#include <libresin/core/light.hpp>
+#include <libresin/core/material.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_node_visitor.hpp>
+#include <libresin/core/transform.hpp>
+#include <libresin/utils/enum_mapper.hpp>
+#include <libresin/utils/exceptions.hpp>
+#include <libresin/utils/json.hpp>
+#include <libresin/utils/json_stream.hpp>
+#include <libresin/utils/logger.hpp>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace resin {
+
+namespace json {
+
+namespace {
+
+constexpr size_t kNoKey  = std::numeric_limits<size_t>::max();
+constexpr float kNoBound = std::numeric_limits<float>::max();
+
+constexpr std::array<std::string_view, 3> kDocumentKeys         = {"version", "tree", "lights"};
+constexpr std::array<std::string_view, 3> kTreeKeys             = {"materials", "prefabs", "rootGroup"};
+constexpr std::array<std::string_view, 3> kPrefabKeys           = {"id", "path", "rootGroup"};
+constexpr std::array<std::string_view, 2> kPrefabReferenceKeys  = {"prefabId", "repetition"};
+constexpr std::array<std::string_view, 2> kRepetitionKeys       = {"grid", "polar"};
+constexpr std::array<std::string_view, 2> kGridRepetitionKeys   = {"spacing", "count"};
+constexpr std::array<std::string_view, 1> kPolarRepetitionKeys  = {"count"};
+constexpr std::array<std::string_view, 1> kGroupKeys            = {"children"};
+constexpr std::array<std::string_view, 3> kTransformKeys        = {"position", "rotation", "scale"};
+constexpr std::array<std::string_view, 3> kVectorKeys           = {"x", "y", "z"};
+constexpr std::array<std::string_view, 4> kQuaternionKeys       = {"w", "x", "y", "z"};
+constexpr std::array<std::string_view, 3> kColorKeys            = {"r", "g", "b"};
+constexpr std::array<std::string_view, 3> kAttenuationKeys      = {"constant", "linear", "quadratic"};
+constexpr std::array<std::string_view, 1> kPointLightKeys       = {"attenuation"};
+constexpr std::array<std::string_view, 1> kDirectionalLightKeys = {"ambientImpact"};
+
+constexpr std::array<std::string_view, 7> kMaterialKeys = {
+    "id", "name", "albedo", "ambient", "diffuse", "specular", "specularExponent"};
+
+// The node type keys follow the common ones: the group first, then the primitives in the SDFTreePrimitiveType order
+// and the prefab reference last
+constexpr size_t kNodeTypesOffset = 5;
+constexpr size_t kPrimitivesCount = static_cast<size_t>(SDFTreePrimitiveType::_Count);
+
+consteval std::array<std::string_view, kNodeTypesOffset + 2 + kPrimitivesCount> make_node_keys() {
+  std::array<std::string_view, kNodeTypesOffset + 2 + kPrimitivesCount> keys = {
+      "binaryOperation", "factor", "name", "materialId", "transform", "group"};
+  for (size_t i = 0; i < kPrimitivesCount; ++i) {
+    keys[kNodeTypesOffset + 1 + i] = kSDFTreePrimitiveNodesJSONNames[static_cast<SDFTreePrimitiveType>(i)];
+  }
+  keys[kNodeTypesOffset + 1 + kPrimitivesCount] = "prefabReference";
+  return keys;
+}
+
+// The light type keys follow the common ones in the LightType order
+constexpr size_t kLightTypesOffset = 3;
+constexpr size_t kLightTypesCount  = static_cast<size_t>(LightType::_Count);
+
+consteval std::array<std::string_view, kLightTypesOffset + kLightTypesCount> make_light_keys() {
+  std::array<std::string_view, kLightTypesOffset + kLightTypesCount> keys = {"color", "name", "transform"};
+  for (size_t i = 0; i < kLightTypesCount; ++i) {
+    keys[kLightTypesOffset + i] = kLightJSONNames[static_cast<LightType>(i)];
+  }
+  return keys;
+}
+
+constexpr auto kNodeKeys  = make_node_keys();
+constexpr auto kLightKeys = make_light_keys();
+
+constexpr std::array<std::string_view, 1> kSphereKeys    = {"radius"};
+constexpr std::array<std::string_view, 1> kCubeKeys      = {"size"};
+constexpr std::array<std::string_view, 2> kTorusKeys     = {"majorRadius", "minorRadius"};
+constexpr std::array<std::string_view, 2> kCapsuleKeys   = {"height", "radius"};
+constexpr std::array<std::string_view, 3> kLinkKeys      = {"length", "majorRadius", "minorRadius"};
+constexpr std::array<std::string_view, 1> kEllipsoidKeys = {"radii"};
+constexpr std::array<std::string_view, 1> kPyramidKeys   = {"height"};
+constexpr std::array<std::string_view, 2> kCylinderKeys  = {"height", "radius"};
+constexpr std::array<std::string_view, 2> kPrismKeys     = {"prismHeight", "baseHeight"};
+
+struct PrimitiveJSONParameters {
+  std::span<const std::string_view> keys;
+
+  // Set if the parameters are the components of a single vector property, e.g. the cube size
+  bool is_vector = false;
+};
+
+constexpr EnumMapper<SDFTreePrimitiveType, PrimitiveJSONParameters> kPrimitiveJSONParameters({
+    {SDFTreePrimitiveType::Sphere, {.keys = kSphereKeys}},                           //
+    {SDFTreePrimitiveType::Cube, {.keys = kCubeKeys, .is_vector = true}},            //
+    {SDFTreePrimitiveType::Torus, {.keys = kTorusKeys}},                             //
+    {SDFTreePrimitiveType::Capsule, {.keys = kCapsuleKeys}},                         //
+    {SDFTreePrimitiveType::Link, {.keys = kLinkKeys}},                               //
+    {SDFTreePrimitiveType::Ellipsoid, {.keys = kEllipsoidKeys, .is_vector = true}},  //
+    {SDFTreePrimitiveType::Pyramid, {.keys = kPyramidKeys}},                         //
+    {SDFTreePrimitiveType::Cylinder, {.keys = kCylinderKeys}},                       //
+    {SDFTreePrimitiveType::TriangularPrism, {.keys = kPrismKeys}}                    //
+});
+
+// Bit mask of the keys with indices in the [begin, end) range
+constexpr uint32_t key_bits(size_t begin, size_t end) { return ((1U << (end - begin)) - 1U) << begin; }
+
+enum class Scope : uint8_t {
+  Document = 0,
+  Tree,
+  Materials,
+  Material,
+  Prefabs,
+  Prefab,
+  PrefabReference,
+  Repetition,
+  GridRepetition,
+  Node,
+  Group,
+  Children,
+  Transform,
+  Lights,
+  Light,
+  Numbers,  // object of numeric properties, e.g. a position or a color
+  Wrapper,  // object with a single Numbers property, e.g. the cube size
+};
+
+struct PendingTransform {
+  std::array<float, 3> position{};
+  std::array<float, 4> rotation{};  // w, x, y, z
+  float scale = 1.0F;
+
+  void apply(Transform& transform) const {
+    transform.set_local_pos(glm::vec3(position[0], position[1], position[2]));
+    transform.set_local_rot(glm::quat(rotation[0], rotation[1], rotation[2], rotation[3]));
+    transform.set_local_scale(scale);
+  }
+};
+
+struct PendingMaterial {
+  size_t id = 0;
+  std::string name;
+  std::array<float, 3> albedo{};
+  float ambient           = 0.0F;
+  float diffuse           = 0.0F;
+  float specular          = 0.0F;
+  float specular_exponent = 0.0F;
+};
+
+struct PendingPrefab {
+  size_t id = 0;
+  std::string path;
+};
+
+struct PendingRepetition {
+  RepetitionType type = RepetitionType::None;
+  std::array<float, 3> spacing{};
+  std::array<float, 3> count = {1.0F, 1.0F, 1.0F};
+
+  Repetition get() const {
+    return Repetition{.type    = type,
+                      .spacing = glm::vec3(spacing[0], spacing[1], spacing[2]),
+                      .count   = glm::uvec3(count[0], count[1], count[2])};
+  }
+};
+
+struct PendingNode {
+  GroupNode* parent              = nullptr;  // nullptr for the root group
+  SDFTreeNode* node              = nullptr;  // created once the node type is read, as the children need their parent
+  PrefabReferenceNode* reference = nullptr;  // set along with the node if the node is a prefab reference
+  std::string name;
+  SDFBinaryOperation bin_op = SDFBinaryOperation::Union;
+  float factor              = 0.0F;
+  std::optional<size_t> material_id;
+  PendingTransform transform;
+  std::array<float, 3> parameters{};
+  PendingRepetition repetition;  // may be read before the prefab id, so it is applied once the node is read
+};
+
+struct PendingLight {
+  std::optional<LightType> type;
+  std::string name;
+  std::array<float, 3> color{};
+  PendingTransform transform;
+  std::array<float, 3> parameters{};
+};
+
+struct NumberFields {
+  std::span<const std::string_view> keys;
+  std::span<float> values;  // one value for each key
+  float min       = -kNoBound;
+  float max       = kNoBound;
+  bool is_integer = false;
+};
+
+struct Frame {
+  Scope scope;
+  std::span<const std::string_view> keys;
+  uint32_t required = 0;  // bit mask of the keys that must be present
+  uint32_t types    = 0;  // bit mask of the mutually exclusive keys of which exactly one must be present
+  uint32_t seen     = 0;  // bit mask of the keys read so far
+  size_t key        = kNoKey;
+  size_t items      = 0;  // number of the array items read so far
+
+  NumberFields numbers;  // read by Numbers, nested in a single property by Wrapper
+  GroupNode* group            = nullptr;
+  PendingTransform* transform = nullptr;
+  PendingNode* node           = nullptr;  // read by PrefabReference and the repetition scopes
+  std::variant<std::monostate, PendingMaterial, PendingPrefab, PendingNode, PendingLight> pending;
+
+  std::string_view key_name() const { return key == kNoKey ? std::string_view() : keys[key]; }
+};
+
+bool is_object_scope(Scope scope) {
+  return scope != Scope::Materials && scope != Scope::Prefabs && scope != Scope::Children && scope != Scope::Lights;
+}
+
+// Mirrors the additionalProperties constraints of the schemas
+bool allows_unknown_keys(Scope scope) {
+  return scope == Scope::Document || scope == Scope::Tree || scope == Scope::Node || scope == Scope::Light;
+}
+
+class PrimitiveParametersVisitor : public ISDFTreeNodeVisitor {
+ public:
+  explicit PrimitiveParametersVisitor(const std::array<float, 3>& params) : params_(params) {}
+
+  void visit_sphere(SphereNode& node) override { node.radius = params_[0]; }
+  void visit_cube(CubeNode& node) override { node.size = glm::vec3(params_[0], params_[1], params_[2]); }
+  void visit_torus(TorusNode& node) override {
+    node.major_radius = params_[0];
+    node.minor_radius = params_[1];
+  }
+  void visit_capsule(CapsuleNode& node) override {
+    node.height = params_[0];
+    node.radius = params_[1];
+  }
+  void visit_link(LinkNode& node) override {
+    node.length       = params_[0];
+    node.major_radius = params_[1];
+    node.minor_radius = params_[2];
+  }
+  void visit_ellipsoid(EllipsoidNode& node) override { node.radii = glm::vec3(params_[0], params_[1], params_[2]); }
+  void visit_pyramid(PyramidNode& node) override { node.height = params_[0]; }
+  void visit_cylinder(CylinderNode& node) override {
+    node.height = params_[0];
+    node.radius = params_[1];
+  }
+  void visit_prism(TriangularPrismNode& node) override {
+    node.prismHeight = params_[0];
+    node.baseHeight  = params_[1];
+  }
+
+ private:
+  const std::array<float, 3>& params_;  // NOLINT
+};
+
+class LightParametersVisitor : public ILightSceneComponentVisitor {
+ public:
+  explicit LightParametersVisitor(const std::array<float, 3>& params) : params_(params) {}
+
+  void visit_point_light(LightSceneComponent<PointLight>& point_light) override {
+    point_light.light().attenuation = PointLight::Attenuation(params_[0], params_[1], params_[2]);
+  }
+
+  void visit_directional_light(LightSceneComponent<DirectionalLight>& dir_light) override {
+    dir_light.light().ambient_impact = params_[0];
+  }
+
+ private:
+  const std::array<float, 3>& params_;  // NOLINT
+};
+
+// Builds the tree while the JSON is being read. Every open JSON object or array has a frame on the stack, which holds
+// the data read so far that cannot be applied yet, e.g. the properties of a node whose type is not known yet.
+class StreamingSceneLoader : public nlohmann::json_sax<json> {
+ public:
+  // The lights are read only if the scene is given
+  StreamingSceneLoader(SDFTree& tree, Scene* scene) : tree_(tree), scene_(scene) {}
+
+  bool null() override { return unexpected_value("null"); }
+  bool boolean(bool /*value*/) override { return unexpected_value("boolean"); }
+  bool number_integer(number_integer_t value) override { return number(static_cast<double>(value), std::nullopt); }
+  bool number_unsigned(number_unsigned_t value) override { return number(static_cast<double>(value), value); }
+  bool number_float(number_float_t value, const string_t& /*raw*/) override { return number(value, std::nullopt); }
+  bool binary(binary_t& /*value*/) override { return unexpected_value("binary"); }
+
+  bool string(string_t& value) override {
+    if (is_skipping_scalar()) {
+      return true;
+    }
+
+    Frame& frame               = top();
+    const std::string_view key = frame.key_name();
+    if (frame.scope == Scope::Material && key == "name") {
+      std::get<PendingMaterial>(frame.pending).name = std::move(value);
+      return true;
+    }
+    if (frame.scope == Scope::Prefab && key == "path") {
+      std::get<PendingPrefab>(frame.pending).path = std::move(value);
+      return true;
+    }
+    if (frame.scope == Scope::Light && key == "name") {
+      std::get<PendingLight>(frame.pending).name = std::move(value);
+      return true;
+    }
+    if (frame.scope == Scope::Node && key == "name") {
+      std::get<PendingNode>(frame.pending).name = std::move(value);
+      return true;
+    }
+    if (frame.scope == Scope::Node && key == "binaryOperation") {
+      const auto bin_op = kSDFBinaryOperationsJSONNames.from_value(value);
+      if (!bin_op.has_value()) {
+        fail(std::format("Provided binary operation '{}' is invalid.", value));
+      }
+      std::get<PendingNode>(frame.pending).bin_op = *bin_op;
+      return true;
+    }
+
+    return unexpected_value("string");
+  }
+
+  bool start_object(std::size_t /*elements*/) override {
+    if (is_skipping_object_or_array()) {
+      return true;
+    }
+
+    if (frames_.empty()) {
+      push({.scope = Scope::Document, .keys = kDocumentKeys, .required = key_bits(0, 2)});
+      return true;
+    }
+
+    Frame& frame               = frames_.back();
+    const std::string_view key = frame.key_name();
+    switch (frame.scope) {
+      case Scope::Document:
+        if (key == "tree") {
+          push({.scope = Scope::Tree, .keys = kTreeKeys, .required = key_bits(2, 3)});
+          return true;
+        }
+        break;
+      case Scope::Tree:
+        if (key == "rootGroup") {
+          push_node(nullptr);
+          return true;
+        }
+        break;
+      case Scope::Materials:
+        ++frame.items;
+        push({.scope    = Scope::Material,
+              .keys     = kMaterialKeys,
+              .required = key_bits(0, kMaterialKeys.size()),
+              .pending  = PendingMaterial()});
+        return true;
+      case Scope::Prefabs:
+        ++frame.items;
+        is_reading_prefab_ = true;
+        push({.scope    = Scope::Prefab,
+              .keys     = kPrefabKeys,
+              .required = key_bits(0, 1) | key_bits(2, 3),
+              .pending  = PendingPrefab()});
+        return true;
+      case Scope::Prefab:
+        if (key == "rootGroup") {
+          push_node(nullptr);
+          return true;
+        }
+        break;
+      case Scope::Children:
+        ++frame.items;
+        push_node(frame.group);
+        return true;
+      case Scope::Lights:
+        ++frame.items;
+        push({.scope    = Scope::Light,
+              .keys     = kLightKeys,
+              .required = key_bits(0, kLightTypesOffset),
+              .types    = key_bits(kLightTypesOffset, kLightKeys.size()),
+              .pending  = PendingLight()});
+        return true;
+      case Scope::Material:
+        if (key == "albedo") {
+          push_numbers({.keys   = kColorKeys,
+                        .values = std::get<PendingMaterial>(frame.pending).albedo,
+                        .min    = 0.0F,
+                        .max    = 1.0F});
+          return true;
+        }
+        break;
+      case Scope::Node:
+        if (start_node_property(frame)) {
+          return true;
+        }
+        break;
+      case Scope::Light:
+        if (start_light_property(frame)) {
+          return true;
+        }
+        break;
+      case Scope::Transform:
+        if (key == "position") {
+          push_numbers({.keys = kVectorKeys, .values = frame.transform->position});
+          return true;
+        }
+        if (key == "rotation") {
+          push_numbers({.keys = kQuaternionKeys, .values = frame.transform->rotation});
+          return true;
+        }
+        break;
+      case Scope::Wrapper:
+        push_numbers(frame.numbers);
+        return true;
+      case Scope::PrefabReference:
+        if (key == "repetition") {
+          push({.scope = Scope::Repetition, .keys = kRepetitionKeys, .types = key_bits(0, 2), .node = frame.node});
+          return true;
+        }
+        break;
+      case Scope::Repetition:
+        start_repetition(frame);
+        return true;
+      case Scope::GridRepetition:
+        if (key == "spacing") {
+          push_numbers({.keys = kVectorKeys, .values = frame.node->repetition.spacing, .min = 0.0F});
+          return true;
+        }
+        if (key == "count") {
+          push_repetition_count(kVectorKeys, frame.node->repetition.count);
+          return true;
+        }
+        break;
+      case Scope::Group:
+      case Scope::Numbers:
+        break;
+    }
+
+    return unexpected_value("object");
+  }
+
+  bool key(string_t& key) override {
+    if (skipped_depth_ > 0) {
+      return true;
+    }
+
+    Frame& frame = top();
+    frame.key    = find_key(frame, key);
+    if (frame.key == kNoKey) {
+      if (!allows_unknown_keys(frame.scope)) {
+        fail(std::format("Unknown property '{}'.", key));
+      }
+      return true;
+    }
+
+    const uint32_t bit = 1U << frame.key;
+    if ((frame.seen & bit) != 0) {
+      fail("The property is defined more than once.");
+    }
+    if ((frame.types & bit) != 0 && (frame.seen & frame.types) != 0) {
+      fail("More than one type is defined.");
+    }
+    frame.seen |= bit;
+    return true;
+  }
+
+  bool end_object() override {
+    if (skipped_depth_ > 0) {
+      --skipped_depth_;
+      return true;
+    }
+
+    Frame& frame = top();
+    for (size_t i = 0; i < frame.keys.size(); ++i) {
+      if ((frame.required & ~frame.seen & (1U << i)) != 0) {
+        fail(std::format("Missing property '{}'.", frame.keys[i]));
+      }
+    }
+    if (frame.types != 0 && (frame.seen & frame.types) == 0) {
+      fail("The type is not defined.");
+    }
+
+    switch (frame.scope) {
+      case Scope::Tree:
+        resolve_materials();
+        break;
+      case Scope::Material:
+        add_material(std::get<PendingMaterial>(frame.pending));
+        break;
+      case Scope::Prefab:
+        add_prefab(std::get<PendingPrefab>(frame.pending));
+        break;
+      case Scope::Node:
+        finish_node(std::get<PendingNode>(frame.pending));
+        break;
+      case Scope::Light:
+        add_light(std::get<PendingLight>(frame.pending));
+        break;
+      default:
+        break;
+    }
+
+    frames_.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t /*elements*/) override {
+    if (is_skipping_object_or_array()) {
+      return true;
+    }
+
+    Frame& frame               = top();
+    const std::string_view key = frame.key_name();
+    if (frame.scope == Scope::Tree && key == "materials") {
+      if ((frame.seen & key_bits(1, 2)) != 0) {
+        fail("The materials must be defined before the prefabs.");
+      }
+      push({.scope = Scope::Materials});
+      return true;
+    }
+    if (frame.scope == Scope::Tree && key == "prefabs") {
+      if ((frame.seen & key_bits(2, 3)) != 0) {
+        fail("The prefabs must be defined before the root group.");
+      }
+      // The content of the prefabs is built right away, so its materials must be known
+      are_materials_read_ = true;
+      push({.scope = Scope::Prefabs});
+      return true;
+    }
+    if (frame.scope == Scope::Group && key == "children") {
+      push({.scope = Scope::Children, .group = frame.group});
+      return true;
+    }
+    if (frame.scope == Scope::Document && key == "lights") {
+      push({.scope = Scope::Lights});
+      return true;
+    }
+
+    return unexpected_value("array");
+  }
+
+  bool end_array() override {
+    if (skipped_depth_ > 0) {
+      --skipped_depth_;
+      return true;
+    }
+
+    if (top().scope == Scope::Materials) {
+      are_materials_read_ = true;
+    }
+    frames_.pop_back();
+    return true;
+  }
+
+  bool parse_error(std::size_t position, const std::string& /*last_token*/,
+                   const nlohmann::detail::exception& ex) override {
+    Logger::warn("JSON parsing failed at byte {}: {}", position, ex.what());
+    log_throw(InvalidJSONException());
+  }
+
+  std::unique_ptr<GroupNode> take_root() {
+    if (!builder_.has_value()) {
+      log_throw(JSONDeserializationException("The tree is not defined."));
+    }
+    return builder_->build();
+  }
+
+ private:
+  Frame& top() {
+    if (frames_.empty()) {
+      log_throw(JSONDeserializationException("Expected a JSON object."));
+    }
+    return frames_.back();
+  }
+
+  void push(Frame&& frame) { frames_.push_back(std::move(frame)); }
+
+  // The content of a prefab is built separately from the tree
+  std::optional<SDFSubtreeBuilder>& current_builder() { return is_reading_prefab_ ? prefab_builder_ : builder_; }
+
+  void push_numbers(const NumberFields& numbers) {
+    push({.scope    = Scope::Numbers,
+          .keys     = numbers.keys,
+          .required = key_bits(0, numbers.keys.size()),
+          .numbers  = numbers});
+  }
+
+  void push_transform(PendingTransform& transform) {
+    push({.scope     = Scope::Transform,
+          .keys      = kTransformKeys,
+          .required  = key_bits(0, kTransformKeys.size()),
+          .transform = &transform});
+  }
+
+  void push_node(GroupNode* parent) {
+    push({.scope    = Scope::Node,
+          .keys     = kNodeKeys,
+          .required = key_bits(0, kNodeTypesOffset) & ~key_bits(3, 4),  // the material is optional
+          .types    = key_bits(kNodeTypesOffset, kNodeKeys.size()),
+          .pending  = PendingNode{.parent = parent}});
+  }
+
+  size_t find_key(const Frame& frame, std::string_view key) const {
+    // The prefabs have no lights, so the property is ignored like any other unknown one
+    if (frame.scope == Scope::Document && key == "lights" && scene_ == nullptr) {
+      return kNoKey;
+    }
+
+    for (size_t i = 0; i < frame.keys.size(); ++i) {
+      if (frame.keys[i] == key) {
+        return i;
+      }
+    }
+    return kNoKey;
+  }
+
+  // The values of the unknown properties are consumed without being interpreted
+  bool is_skipping_scalar() const {
+    return skipped_depth_ > 0 ||
+           (!frames_.empty() && frames_.back().key == kNoKey && allows_unknown_keys(frames_.back().scope));
+  }
+
+  bool is_skipping_object_or_array() {
+    if (is_skipping_scalar()) {
+      ++skipped_depth_;
+      return true;
+    }
+    return false;
+  }
+
+  bool number(double value, std::optional<uint64_t> index) {
+    if (is_skipping_scalar()) {
+      return true;
+    }
+
+    Frame& frame               = top();
+    const std::string_view key = frame.key_name();
+    switch (frame.scope) {
+      case Scope::Document:
+        if (key == "version") {
+          return true;
+        }
+        break;
+      case Scope::Material: {
+        auto& material = std::get<PendingMaterial>(frame.pending);
+        if (key == "id") {
+          material.id = expect_index(index);
+          return true;
+        }
+        if (key == "ambient") {
+          material.ambient = in_range(value, 0.0F, 1.0F);
+          return true;
+        }
+        if (key == "diffuse") {
+          material.diffuse = in_range(value, 0.0F, 1.0F);
+          return true;
+        }
+        if (key == "specular") {
+          material.specular = in_range(value, 0.0F, 1.0F);
+          return true;
+        }
+        if (key == "specularExponent") {
+          material.specular_exponent = in_range(value, 0.0F, kNoBound);
+          return true;
+        }
+        break;
+      }
+      case Scope::Prefab:
+        if (key == "id") {
+          std::get<PendingPrefab>(frame.pending).id = expect_index(index);
+          return true;
+        }
+        break;
+      case Scope::PrefabReference:
+        if (key == "prefabId") {
+          add_prefab_reference(*frame.node, expect_index(index));
+          return true;
+        }
+        break;
+      case Scope::Node: {
+        auto& node = std::get<PendingNode>(frame.pending);
+        if (key == "factor") {
+          node.factor = in_range(value, 0.0F, kNoBound);
+          return true;
+        }
+        if (key == "materialId") {
+          node.material_id = expect_index(index);
+          return true;
+        }
+        break;
+      }
+      case Scope::Transform:
+        if (key == "scale") {
+          frame.transform->scale = in_range(value, -kNoBound, kNoBound);
+          return true;
+        }
+        break;
+      case Scope::Numbers:
+        if (frame.numbers.is_integer) {
+          expect_index(index);
+        }
+        frame.numbers.values[frame.key] = in_range(value, frame.numbers.min, frame.numbers.max);
+        return true;
+      default:
+        break;
+    }
+
+    return unexpected_value("number");
+  }
+
+  bool start_node_property(Frame& frame) {
+    auto& node = std::get<PendingNode>(frame.pending);
+    if (frame.key_name() == "transform") {
+      push_transform(node.transform);
+      return true;
+    }
+    if (frame.key < kNodeTypesOffset) {
+      return false;
+    }
+
+    if (frame.key_name() == "group") {
+      GroupNode* group = nullptr;
+      if (node.parent == nullptr) {
+        group = &current_builder().emplace(tree_.create_detached_node<GroupNode>()).root();
+      } else {
+        group = &current_builder()->push_back_child<GroupNode>(*node.parent, SDFBinaryOperation::Union);
+      }
+      node.node = group;
+      push({.scope = Scope::Group, .keys = kGroupKeys, .required = key_bits(0, 1), .group = group});
+      return true;
+    }
+
+    if (node.parent == nullptr) {
+      fail("The root node must be a group.");
+    }
+    if (frame.key_name() == "prefabReference") {
+      if (is_reading_prefab_) {
+        fail("Prefab content must not contain prefab references.");
+      }
+      push({.scope    = Scope::PrefabReference,
+            .keys     = kPrefabReferenceKeys,
+            .required = key_bits(0, 1),
+            .node     = &node});
+      return true;
+    }
+
+    const auto type = *kSDFTreePrimitiveNodesJSONNames.from_value(frame.key_name());
+    node.node       = &current_builder()->push_back_primitive(*node.parent, type, SDFBinaryOperation::Union);
+
+    const PrimitiveJSONParameters params = kPrimitiveJSONParameters[type];
+    if (params.is_vector) {
+      push({.scope    = Scope::Wrapper,
+            .keys     = params.keys,
+            .required = key_bits(0, 1),
+            .numbers  = {.keys = kVectorKeys, .values = node.parameters, .min = 0.0F}});
+    } else {
+      push_numbers({.keys = params.keys, .values = std::span(node.parameters).first(params.keys.size()), .min = 0.0F});
+    }
+    return true;
+  }
+
+  void start_repetition(Frame& frame) {
+    PendingRepetition& repetition = frame.node->repetition;
+    if (frame.key_name() == "grid") {
+      repetition.type = RepetitionType::Grid;
+      push({.scope    = Scope::GridRepetition,
+            .keys     = kGridRepetitionKeys,
+            .required = key_bits(0, kGridRepetitionKeys.size()),
+            .node     = frame.node});
+      return;
+    }
+
+    repetition.type = RepetitionType::Polar;
+    push_repetition_count(kPolarRepetitionKeys, std::span(repetition.count).first(1));
+  }
+
+  void push_repetition_count(std::span<const std::string_view> keys, std::span<float> values) {
+    push_numbers({.keys       = keys,
+                  .values     = values,
+                  .min        = 1.0F,
+                  .max        = static_cast<float>(Repetition::kMaxCount),
+                  .is_integer = true});
+  }
+
+  bool start_light_property(Frame& frame) {
+    auto& light                = std::get<PendingLight>(frame.pending);
+    const std::string_view key = frame.key_name();
+    if (key == "transform") {
+      push_transform(light.transform);
+      return true;
+    }
+    if (key == "color") {
+      push_numbers({.keys = kColorKeys, .values = light.color, .min = 0.0F, .max = 1.0F});
+      return true;
+    }
+    if (frame.key < kLightTypesOffset) {
+      return false;
+    }
+
+    light.type = *kLightJSONNames.from_value(key);
+    if (*light.type == LightType::PointLight) {
+      push({.scope    = Scope::Wrapper,
+            .keys     = kPointLightKeys,
+            .required = key_bits(0, 1),
+            .numbers  = {.keys = kAttenuationKeys, .values = light.parameters, .min = 0.0F}});
+    } else {
+      push_numbers({.keys   = kDirectionalLightKeys,
+                    .values = std::span(light.parameters).first(1),
+                    .min    = 0.0F,
+                    .max    = 1.0F});
+    }
+    return true;
+  }
+
+  void add_material(PendingMaterial& pending) {
+    if (material_ids_map_.contains(pending.id)) {
+      fail(std::format("More than one definition of a material with id {} found.", pending.id));
+    }
+
+    auto& mat = tree_.add_material(Material(glm::vec3(pending.albedo[0], pending.albedo[1], pending.albedo[2]),
+                                            pending.ambient, pending.diffuse, pending.specular,
+                                            pending.specular_exponent));
+    mat.rename(std::move(pending.name));
+    material_ids_map_.emplace(pending.id, mat.material_id());
+  }
+
+  void add_prefab(PendingPrefab& pending) {
+    if (prefabs_map_.contains(pending.id)) {
+      fail(std::format("More than one definition of a prefab with id {} found.", pending.id));
+    }
+
+    auto& prefab = tree_.add_prefab(prefab_builder_->build(), std::move(pending.path));
+    prefab_builder_.reset();
+    is_reading_prefab_ = false;
+    prefabs_map_.emplace(pending.id, prefab);
+  }
+
+  void add_prefab_reference(PendingNode& pending, size_t prefab_id) {
+    auto prefab_it = prefabs_map_.find(prefab_id);
+    if (prefab_it == prefabs_map_.end()) {
+      fail(std::format("Node references to non existing prefab with id {}.", prefab_id));
+    }
+    pending.reference = &builder_->push_back_child<PrefabReferenceNode>(*pending.parent, SDFBinaryOperation::Union,
+                                                                        prefab_it->second.get());
+    pending.node      = pending.reference;
+  }
+
+  void finish_node(PendingNode& pending) {
+    SDFTreeNode& node = *pending.node;
+    node.rename(std::move(pending.name));
+    node.set_bin_op(pending.bin_op);
+    node.set_factor(pending.factor);
+    pending.transform.apply(node.transform());
+
+    if (pending.material_id.has_value()) {
+      auto mat_it = material_ids_map_.find(*pending.material_id);
+      if (mat_it != material_ids_map_.end()) {
+        current_builder()->set_material(node, mat_it->second);
+      } else if (are_materials_read_) {
+        fail(std::format("Node references to non existing material with id {}.", *pending.material_id));
+      } else {
+        unresolved_materials_.emplace_back(&node, *pending.material_id);
+      }
+    }
+
+    auto visitor = PrimitiveParametersVisitor(pending.parameters);
+    node.accept_visitor(visitor);
+
+    if (pending.reference != nullptr) {
+      pending.reference->set_repetition(pending.repetition.get());
+    }
+  }
+
+  void resolve_materials() {
+    are_materials_read_ = true;
+    for (const auto& [node, material_id] : unresolved_materials_) {
+      auto mat_it = material_ids_map_.find(material_id);
+      if (mat_it == material_ids_map_.end()) {
+        fail(std::format("Node with name {} references to non existing material with id {}.", node->name(),
+                         material_id));
+      }
+      builder_->set_material(*node, mat_it->second);
+    }
+    unresolved_materials_.clear();
+  }
+
+  void add_light(PendingLight& pending) {
+    auto& light = scene_->add_light(*pending.type);
+    pending.transform.apply(light.light_base().transform);
+    light.light_base().color = glm::vec3(pending.color[0], pending.color[1], pending.color[2]);
+    light.rename(std::move(pending.name));
+
+    auto visitor = LightParametersVisitor(pending.parameters);
+    light.accept_visitor(visitor);
+  }
+
+  float in_range(double value, float min, float max) {
+    if (value < min || value > max) {
+      fail(std::format("Value {} is out of the [{}, {}] range.", value, min, max));
+    }
+    return static_cast<float>(value);
+  }
+
+  size_t expect_index(std::optional<uint64_t> index) {
+    if (!index.has_value()) {
+      fail("Expected a non-negative integer.");
+    }
+    return static_cast<size_t>(*index);
+  }
+
+  bool unexpected_value(std::string_view type) {
+    if (is_skipping_scalar()) {
+      return true;
+    }
+    fail(std::format("Unexpected {} value.", type));
+  }
+
+  [[noreturn]] void fail(std::string_view reason) {
+    log_throw(JSONDeserializationException(std::format("{} Found at '{}'.", reason, path())));
+  }
+
+  // Location of the value being read, e.g. tree.rootGroup.group.children[1].transform
+  std::string path() const {
+    std::string path;
+    for (const auto& frame : frames_) {
+      if (!is_object_scope(frame.scope)) {
+        path += std::format("[{}]", frame.items == 0 ? 0 : frame.items - 1);
+      } else if (frame.key != kNoKey) {
+        if (!path.empty()) {
+          path += '.';
+        }
+        path += frame.keys[frame.key];
+      }
+    }
+    return path;
+  }
+
+  SDFTree& tree_;  // NOLINT
+  Scene* scene_;
+  std::optional<SDFSubtreeBuilder> builder_;  // holds the tree until it is read as a whole
+  std::optional<SDFSubtreeBuilder> prefab_builder_;
+  bool is_reading_prefab_ = false;
+  PrefabsMap prefabs_map_;
+
+  std::deque<Frame> frames_;  // references to the frames stay valid while the frames above are pushed and popped
+  size_t skipped_depth_ = 0;
+
+  std::unordered_map<size_t, IdView<MaterialId>> material_ids_map_;
+  bool are_materials_read_ = false;
+
+  // Nodes read before the materials they reference
+  std::vector<std::pair<SDFTreeNode*, size_t>> unresolved_materials_;
+};
+
+}  // namespace
+
+std::unique_ptr<GroupNode> stream_deserialize_prefab(SDFTree& tree, std::istream& prefab_json) {
+  Logger::info("JSON prefab stream deserialization started");
+
+  try {
+    StreamingSceneLoader loader(tree, nullptr);
+    json::sax_parse(prefab_json, &loader);
+    std::unique_ptr<GroupNode> prefab_root = loader.take_root();
+    Logger::info("JSON prefab stream deserialization succeeded");
+    return prefab_root;
+  } catch (const ResinException&) {
+    Logger::warn("JSON prefab stream deserialization failed");
+    throw;
+  } catch (...) {
+    Logger::warn("JSON prefab stream deserialization failed");
+    log_throw(JSONDeserializationException());
+  }
+}
+
+void stream_deserialize_scene(Scene& scene, std::istream& scene_json) {
+  const auto start = scene_json.tellg();
+  if (!json::accept(scene_json)) {
+    log_throw(InvalidJSONException());
+  }
+  scene_json.clear();
+  scene_json.seekg(start);
+  Logger::info("JSON resin scene stream deserialization started");
+
+  try {
+    scene.clear();
+    StreamingSceneLoader loader(scene.tree(), &scene);
+    json::sax_parse(scene_json, &loader);
+    scene.tree().set_root(loader.take_root());
+    Logger::info("JSON resin scene stream deserialization succeeded");
+  } catch (const ResinException&) {
+    Logger::warn("JSON resin scene stream deserialization failed");
+    throw;
+  } catch (...) {
+    Logger::warn("JSON resin scene stream deserialization failed");
+    log_throw(JSONDeserializationException());
+  }
+}
+
+}  // namespace json
+
+}  // namespace resin
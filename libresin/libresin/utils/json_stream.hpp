@@ -0,0 +1,31 @@
+#ifndef RESIN_JSON_STREAM_HPP
+#define RESIN_JSON_STREAM_HPP
+#include <istream>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <memory>
+
+namespace resin {
+
+namespace json {
+
+// Streaming counterparts of deserialize_prefab and deserialize_scene. The JSON is read with the SAX interface and the
+// nodes are created while it is being read, so neither the file contents nor a DOM are ever held in memory. The
+// properties are validated against the JSON schemas on the fly and the memory used by the loader is proportional to
+// the depth of the tree.
+//
+// The materials may come after the nodes that reference them, in which case these references are resolved once the
+// whole tree is read. The prefabs table is an exception: the content of the prefabs is built as soon as it is read, so
+// the materials must come before the prefabs, and the prefabs before the root group.
+
+[[nodiscard]] std::unique_ptr<GroupNode> stream_deserialize_prefab(SDFTree& tree, std::istream& prefab_json);
+
+// The stream is read twice: the syntax is checked before the scene is cleared, so a malformed file leaves the current
+// scene intact. Therefore the stream must be seekable.
+void stream_deserialize_scene(Scene& scene, std::istream& scene_json);
+
+}  // namespace json
+
+}  // namespace resin
+#endif
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <libresin/utils/path.hpp>
 
 #ifdef _WIN32
@@ -18,6 +19,24 @@ std::filesystem::path get_executable_path() {
 
 std::filesystem::path get_executable_dir() { return get_executable_path().parent_path(); }
 
+std::filesystem::path get_user_cache_dir() {
+#ifdef _WIN32
+  if (const wchar_t* local_app_data = _wgetenv(L"LOCALAPPDATA"); local_app_data != nullptr && *local_app_data != 0) {
+    return std::filesystem::path(local_app_data) / "resin";
+  }
+#else
+  // The spec says to ignore a relative XDG_CACHE_HOME
+  if (const char* cache_home = std::getenv("XDG_CACHE_HOME");  // NOLINT
+      cache_home != nullptr && std::filesystem::path(cache_home).is_absolute()) {
+    return std::filesystem::path(cache_home) / "resin";
+  }
+  if (const char* home = std::getenv("HOME"); home != nullptr && *home != 0) {  // NOLINT
+    return std::filesystem::path(home) / ".cache" / "resin";
+  }
+#endif
+  return get_executable_dir() / "cache";
+}
+
 std::string path_to_utf8str(const std::filesystem::path& path) {
 #ifdef _WIN32
   std::wstring wide_path = path.wstring();
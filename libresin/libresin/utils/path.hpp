@@ -10,6 +10,11 @@ std::filesystem::path get_executable_path();
 
 std::filesystem::path get_executable_dir();
 
+// Per user directory for the files the editor keeps between the sessions: XDG_CACHE_HOME (falling back to ~/.cache)
+// on Linux and LOCALAPPDATA on Windows. The executable directory is often read only for the installed builds, it is
+// used only if none of these is set.
+std::filesystem::path get_user_cache_dir();
+
 std::string path_to_utf8str(const std::filesystem::path& path);
 
 std::filesystem::path utf8str_to_path(std::string_view str_path);
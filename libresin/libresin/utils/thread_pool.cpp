@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <libresin/utils/thread_pool.hpp>
+
+namespace resin {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  queues_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back([this, i]() { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::default_thread_count() {
+  const unsigned int hw_threads = std::thread::hardware_concurrency();
+  return hw_threads == 0 ? 1 : hw_threads;
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+
+  Job job;
+  job.task      = &task;
+  job.remaining = count;
+
+  // Counted before they are queued, otherwise a worker could pop a task and decrement the counter first
+  {
+    std::lock_guard lock(wake_mutex_);
+    queued_tasks_ += count;
+  }
+
+  // Deal contiguous ranges to the queues, so neighbouring tasks run on the same worker unless they get stolen
+  const size_t queue_count = queues_.size();
+  for (size_t q = 0; q < queue_count; ++q) {
+    const size_t begin = count * q / queue_count;
+    const size_t end   = count * (q + 1) / queue_count;
+    if (begin == end) {
+      continue;
+    }
+
+    std::lock_guard lock(queues_[q]->mutex);
+    for (size_t i = begin; i < end; ++i) {
+      queues_[q]->tasks.push_back(Task{.job = &job, .index = i});
+    }
+  }
+  wake_cv_.notify_all();
+
+  // Help until there is nothing left to steal, then wait for the tasks that are still running
+  Task stolen{};
+  while (job.remaining.load() > 0 && try_steal(queue_count, stolen)) {
+    run(stolen);
+  }
+  {
+    std::unique_lock lock(done_mutex_);
+    done_cv_.wait(lock, [&job]() { return job.remaining.load() == 0; });
+  }
+
+  if (job.exception) {
+    std::rethrow_exception(job.exception);
+  }
+}
+
+bool ThreadPool::try_pop(size_t queue_idx, Task& task) {
+  auto& queue = *queues_[queue_idx];
+  std::lock_guard lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.front();
+  queue.tasks.pop_front();
+  --queued_tasks_;
+  return true;
+}
+
+bool ThreadPool::try_steal(size_t thief_idx, Task& task) {
+  const size_t queue_count = queues_.size();
+  for (size_t offset = 1; offset <= queue_count; ++offset) {
+    auto& queue = *queues_[(thief_idx + offset) % queue_count];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    --queued_tasks_;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::run(const Task& task) {
+  Job& job = *task.job;
+  try {
+    (*job.task)(task.index);
+  } catch (...) {
+    std::lock_guard lock(job.exception_mutex);
+    if (!job.exception) {
+      job.exception = std::current_exception();
+    }
+  }
+
+  if (job.remaining.fetch_sub(1) == 1) {
+    { std::lock_guard lock(done_mutex_); }
+    done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::worker_loop(size_t worker_idx) {
+  Task task{};
+  while (true) {
+    if (try_pop(worker_idx, task) || try_steal(worker_idx, task)) {
+      run(task);
+      continue;
+    }
+
+    std::unique_lock lock(wake_mutex_);
+    wake_cv_.wait(lock, [this]() { return stop_ || queued_tasks_.load() > 0; });
+    if (stop_ && queued_tasks_.load() == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace resin
@@ -0,0 +1,74 @@
+#ifndef RESIN_THREAD_POOL_HPP
+#define RESIN_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <libresin/utils/macros.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace resin {
+
+// Fixed size pool of worker threads with one task queue per worker. Workers pop tasks from the front of their own
+// queue and, once it is empty, steal from the back of the other queues, so uneven tasks (e.g. mesh tiles crossed by
+// the surface vs empty ones) get balanced without a central queue.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_count = default_thread_count());
+  ~ThreadPool();
+
+  DISABLE_COPY_AND_MOVE(ThreadPool)
+
+  // Runs task(i) for every i in [0, count) and blocks until all of the calls return. The calling thread takes part in
+  // the work, so parallel_for may be nested in a task. If any of the tasks throws, the first exception is rethrown
+  // after the remaining tasks finish.
+  void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+  inline size_t thread_count() const { return workers_.size(); }
+
+  static size_t default_thread_count();
+
+ private:
+  struct Job {
+    const std::function<void(size_t)>* task;
+    std::atomic<size_t> remaining;
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+  };
+
+  struct Task {
+    Job* job;
+    size_t index;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool try_pop(size_t queue_idx, Task& task);
+  bool try_steal(size_t thief_idx, Task& task);
+  void run(const Task& task);
+  void worker_loop(size_t worker_idx);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  std::atomic<size_t> queued_tasks_ = 0;
+  bool stop_                        = false;
+
+  std::mutex done_mutex_;
+  std::condition_variable done_cv_;
+};
+
+}  // namespace resin
+
+#endif  // RESIN_THREAD_POOL_HPP
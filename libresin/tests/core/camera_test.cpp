@@ -21,4 +21,21 @@ TEST(CameraTest, UpdateDimensions) {
   EXPECT_NEAR(camera.width(), expected_width, 1e-5);
 }
 
+TEST(CameraTest, RayGoesThroughNearPlane) {
+  // given
+  const float near_plane = 0.1F;
+  resin::Camera camera(false, 90.0F, 1.0F, near_plane, 100.0F);
+  camera.transform.set_local_pos(glm::vec3(0.0F, 0.0F, 5.0F));
+
+  // when
+  const resin::Ray center = camera.ray(glm::vec2(0.0F));
+  const resin::Ray corner = camera.ray(glm::vec2(1.0F));
+
+  // then
+  EXPECT_NEAR(center.origin.z, 5.0F, 1e-5);
+  EXPECT_NEAR(center.direction.z, -1.0F, 1e-5);
+  EXPECT_NEAR(corner.direction.x, corner.direction.y, 1e-5);
+  EXPECT_NEAR(corner.direction.x * near_plane / -corner.direction.z, camera.width(), 1e-5);
+}
+
 }  // namespace resin
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/common.hpp>
+#include <libresin/core/dual_contouring.hpp>
+#include <tests/glm_helper.hpp>
+#include <vector>
+
+class DualContouringTest : public testing::Test {
+ protected:
+  // Hermite samples of an axis aligned box on a [-1, 1]^3 grid, computed analytically.
+  static std::vector<resin::HermiteSample> box_samples(unsigned int res, const glm::vec3& half_size) {
+    const glm::vec3 start(-1.0F);
+    const float voxel = 2.0F / static_cast<float>(res);
+    const auto side   = res + 1;
+
+    auto sdf = [&](const glm::vec3& p) {
+      const glm::vec3 q = glm::abs(p) - half_size;
+      return glm::length(glm::max(q, glm::vec3(0.0F))) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0F);
+    };
+
+    std::vector<resin::HermiteSample> samples;
+    for (unsigned int z = 0; z < res; ++z) {
+      for (unsigned int y = 0; y < res; ++y) {
+        for (unsigned int x = 0; x < res; ++x) {
+          const glm::vec3 p0 = start + glm::vec3(x, y, z) * voxel;
+          for (int axis = 0; axis < 3; ++axis) {
+            glm::vec3 p1 = p0;
+            p1[axis] += voxel;
+            const float v0 = sdf(p0);
+            const float v1 = sdf(p1);
+            if ((v0 < 0) == (v1 < 0)) {
+              continue;
+            }
+
+            resin::HermiteSample sample{};
+            const glm::vec3 p = glm::mix(p0, p1, -v0 / (v1 - v0));
+            glm::vec3 normal(0.0F);
+            normal[axis]         = p[axis] > 0 ? 1.0F : -1.0F;
+            sample.position      = glm::vec4(p, 1.0F);
+            sample.normal        = glm::vec4(normal, 0.0F);
+            sample.edge_id       = ((((z * side) + y) * side) + x) * 3 + static_cast<uint32_t>(axis);
+            sample.starts_inside = v0 < 0 ? 1 : 0;
+            samples.push_back(sample);
+          }
+        }
+      }
+    }
+    return samples;
+  }
+};
+
+TEST_F(DualContouringTest, QEFSolvesPlanesIntersection) {
+  // given
+  resin::QEF qef;
+  qef.add(glm::vec3(0.5F, 0.1F, 0.2F), glm::vec3(1, 0, 0));
+  qef.add(glm::vec3(0.3F, -0.25F, 0.7F), glm::vec3(0, 1, 0));
+  qef.add(glm::vec3(0.1F, 0.4F, 0.75F), glm::vec3(0, 0, 1));
+
+  // when
+  const glm::vec3 x = qef.solve();
+
+  // then
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0.5F, -0.25F, 0.75F), x, 1e-5F);
+  EXPECT_NEAR(qef.error(x), 0.0F, 1e-5F);
+}
+
+TEST_F(DualContouringTest, QEFFallsBackToMassPointOnFlatSurface) {
+  // given
+  resin::QEF qef;
+  qef.add(glm::vec3(0.0F, 0.0F, 1.0F), glm::vec3(0, 0, 1));
+  qef.add(glm::vec3(1.0F, 2.0F, 1.0F), glm::vec3(0, 0, 1));
+
+  // when
+  const glm::vec3 x = qef.solve();
+
+  // then
+  EXPECT_GLM_VEC_NEAR(glm::vec3(0.5F, 1.0F, 1.0F), x, 1e-5F);
+}
+
+TEST_F(DualContouringTest, QEFErrorIsExactFarFromOrigin) {
+  // given
+  resin::QEF qef;
+  for (int i = 0; i < 4; ++i) {
+    qef.add(glm::vec3(1000.0F + static_cast<float>(i), 1000.1F, 1000.0F - static_cast<float>(i)), glm::vec3(0, 1, 0));
+  }
+
+  // when
+  const float on_plane  = qef.error(glm::vec3(1001.5F, 1000.1F, 998.5F));
+  const float off_plane = qef.error(glm::vec3(1001.5F, 1000.1F + 0.01F, 998.5F));
+
+  // then
+  EXPECT_NEAR(on_plane, 0.0F, 1e-6F);
+  EXPECT_NEAR(off_plane, 4.0F * 0.01F * 0.01F, 1e-4F);
+}
+
+TEST_F(DualContouringTest, BoxCornersArePreserved) {
+  // given
+  const glm::vec3 half_size(0.55F);
+  const auto samples = box_samples(16, half_size);
+  const resin::DualContouringOptions options{.bb_start = glm::vec3(-1.0F), .bb_end = glm::vec3(1.0F), .resolution = 16};
+
+  // when
+  const resin::IndexedMesh mesh = resin::dual_contour(samples, options);
+
+  // then
+  ASSERT_FALSE(mesh.empty());
+  const float max_coord = std::ranges::max(mesh.vertices, {}, [](const glm::vec3& v) { return v.x; }).x;
+  EXPECT_NEAR(max_coord, half_size.x, 1e-4F);
+  const bool has_corner = std::ranges::any_of(
+      mesh.vertices, [&](const glm::vec3& v) { return glm::all(glm::epsilonEqual(v, half_size, 1e-4F)); });
+  EXPECT_TRUE(has_corner);
+}
+
+TEST_F(DualContouringTest, FlatFacesAreSimplified) {
+  // given
+  const auto samples = box_samples(16, glm::vec3(0.55F));
+  resin::DualContouringOptions options{.bb_start = glm::vec3(-1.0F), .bb_end = glm::vec3(1.0F), .resolution = 16};
+
+  // when
+  options.max_depth                   = 0;
+  const resin::IndexedMesh full       = resin::dual_contour(samples, options);
+  options.max_depth                   = 3;
+  const resin::IndexedMesh simplified = resin::dual_contour(samples, options);
+
+  // then
+  EXPECT_LT(simplified.vertices.size(), full.vertices.size());
+  EXPECT_LT(simplified.triangle_count(), full.triangle_count());
+}
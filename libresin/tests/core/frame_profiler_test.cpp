@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/frame_profiler.hpp>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <vector>
+
+class FrameProfilerTest : public testing::Test {};
+
+TEST_F(FrameProfilerTest, RollingStatsKeepOnlyTheLastSamples) {
+  // given
+  resin::RollingStats stats(3);
+
+  // when
+  for (const double sample : {10.0, 1.0, 2.0, 3.0}) {
+    stats.add(sample);
+  }
+
+  // then
+  EXPECT_EQ(stats.count(), 3);
+  EXPECT_DOUBLE_EQ(stats.last(), 3.0);
+  EXPECT_DOUBLE_EQ(stats.average(), 2.0);
+  EXPECT_DOUBLE_EQ(stats.min(), 1.0);
+  EXPECT_DOUBLE_EQ(stats.max(), 3.0);
+}
+
+TEST_F(FrameProfilerTest, EmptyRollingStatsAreZero) {
+  // given
+  const resin::RollingStats stats;
+
+  // when
+  // then
+  EXPECT_EQ(stats.count(), 0);
+  EXPECT_DOUBLE_EQ(stats.average(), 0.0);
+  EXPECT_DOUBLE_EQ(stats.min(), 0.0);
+  EXPECT_DOUBLE_EQ(stats.max(), 0.0);
+}
+
+TEST_F(FrameProfilerTest, ChromeTraceHasCompleteEventsInMicroseconds) {
+  // given
+  const std::vector<resin::ProfileEvent> events = {
+      {.name = "SDF pass", .track = resin::ProfileTrack::GPU, .start_ns = 2000, .duration_ns = 1500},
+      {.name = "Shader compile", .track = resin::ProfileTrack::CPU, .start_ns = 0, .duration_ns = 3000000},
+  };
+  std::ostringstream output;
+
+  // when
+  resin::write_chrome_trace(output, events);
+  const nlohmann::json trace = nlohmann::json::parse(output.str());
+
+  // then
+  ASSERT_TRUE(trace.contains("traceEvents"));
+  std::vector<nlohmann::json> complete_events;
+  for (const auto& event : trace["traceEvents"]) {
+    if (event["ph"] == "X") {
+      complete_events.push_back(event);
+    }
+  }
+  ASSERT_EQ(complete_events.size(), 2);
+
+  EXPECT_EQ(complete_events[0]["name"], "SDF pass");
+  EXPECT_DOUBLE_EQ(complete_events[0]["ts"].get<double>(), 2.0);
+  EXPECT_DOUBLE_EQ(complete_events[0]["dur"].get<double>(), 1.5);
+  EXPECT_EQ(complete_events[1]["name"], "Shader compile");
+  EXPECT_DOUBLE_EQ(complete_events[1]["dur"].get<double>(), 3000.0);
+  EXPECT_NE(complete_events[0]["tid"], complete_events[1]["tid"]);
+}
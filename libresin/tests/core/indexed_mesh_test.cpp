@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <libresin/core/indexed_mesh.hpp>
+#include <vector>
+
+class IndexedMeshTest : public testing::Test {};
+
+TEST_F(IndexedMeshTest, SharedEdgeVerticesAreWelded) {
+  // given
+  // two triangles of a quad sharing edges 1 and 2
+  const std::vector<glm::vec4> vertices = {
+      {0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1},  //
+      {1, 0, 0, 1}, {1, 1, 0, 1}, {0, 1, 0, 1},  //
+  };
+  const std::vector<glm::vec4> normals(vertices.size(), glm::vec4(0, 0, 1, 1));
+  const std::vector<glm::vec2> uvs(vertices.size(), glm::vec2(0));
+  const std::vector<uint32_t> keys = {0, 1, 2, 1, 3, 2};
+
+  // when
+  const resin::IndexedMesh mesh = resin::weld_triangle_soup(vertices, normals, uvs, keys);
+
+  // then
+  EXPECT_EQ(mesh.vertices.size(), 4);
+  EXPECT_EQ(mesh.normals.size(), 4);
+  EXPECT_EQ(mesh.uvs.size(), 4);
+  ASSERT_EQ(mesh.triangle_count(), 2);
+  EXPECT_EQ(mesh.vertices[mesh.indices[1]], glm::vec3(0, 0, 0));
+  EXPECT_EQ(mesh.indices[0], mesh.indices[4]);
+  EXPECT_EQ(mesh.indices[2], mesh.indices[5]);
+}
+
+TEST_F(IndexedMeshTest, WindingIsFlippedToCounterclockwise) {
+  // given
+  const std::vector<glm::vec4> vertices = {{0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1}};
+  const std::vector<glm::vec4> normals(vertices.size(), glm::vec4(0, 0, 1, 1));
+  const std::vector<glm::vec2> uvs(vertices.size(), glm::vec2(0));
+  const std::vector<uint32_t> keys = {7, 8, 9};
+
+  // when
+  const resin::IndexedMesh mesh = resin::weld_triangle_soup(vertices, normals, uvs, keys);
+
+  // then
+  ASSERT_EQ(mesh.triangle_count(), 1);
+  EXPECT_EQ(mesh.vertices[mesh.indices[0]], glm::vec3(1, 0, 0));
+  EXPECT_EQ(mesh.vertices[mesh.indices[1]], glm::vec3(0, 0, 0));
+  EXPECT_EQ(mesh.vertices[mesh.indices[2]], glm::vec3(0, 1, 0));
+}
+
+TEST_F(IndexedMeshTest, DegenerateTrianglesAreDropped) {
+  // given
+  const std::vector<glm::vec4> vertices = {{0, 0, 0, 1}, {0, 0, 0, 1}, {0, 1, 0, 1}};
+  const std::vector<glm::vec4> normals(vertices.size(), glm::vec4(0, 0, 1, 1));
+  const std::vector<glm::vec2> uvs(vertices.size(), glm::vec2(0));
+  const std::vector<uint32_t> keys = {5, 5, 6};
+
+  // when
+  const resin::IndexedMesh mesh = resin::weld_triangle_soup(vertices, normals, uvs, keys);
+
+  // then
+  EXPECT_TRUE(mesh.empty());
+}
+
+TEST_F(IndexedMeshTest, TriangleMaterialsSurviveWelding) {
+  // given
+  const std::vector<glm::vec4> vertices = {
+      {0, 0, 0, 1}, {0, 0, 0, 1}, {0, 1, 0, 1},  // degenerate
+      {0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1},  //
+      {1, 0, 0, 1}, {1, 1, 0, 1}, {0, 1, 0, 1},  //
+  };
+  const std::vector<glm::vec4> normals(vertices.size(), glm::vec4(0, 0, 1, 1));
+  const std::vector<glm::vec2> uvs(vertices.size(), glm::vec2(0));
+  const std::vector<uint32_t> keys      = {0, 0, 2, 0, 1, 2, 1, 3, 2};
+  const std::vector<uint32_t> materials = {7, 3, 5};
+
+  // when
+  const resin::IndexedMesh mesh = resin::weld_triangle_soup(vertices, normals, uvs, keys, materials);
+
+  // then
+  ASSERT_EQ(mesh.triangle_count(), 2);
+  EXPECT_EQ(mesh.materials, std::vector<uint32_t>({3, 5}));
+}
+
+TEST_F(IndexedMeshTest, MeshIsSplitByMaterial) {
+  // given
+  // a quad of two triangles with different materials and a third triangle sharing the first material
+  resin::IndexedMesh mesh;
+  mesh.vertices  = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {2, 0, 0}};
+  mesh.normals   = std::vector<glm::vec3>(mesh.vertices.size(), glm::vec3(0, 0, 1));
+  mesh.uvs       = std::vector<glm::vec2>(mesh.vertices.size(), glm::vec2(0));
+  mesh.indices   = {0, 1, 2, 0, 2, 3, 1, 4, 2};
+  mesh.materials = {4, 1, 4};
+
+  // when
+  const std::vector<resin::MaterialSubmesh> submeshes = resin::split_by_material(mesh);
+
+  // then
+  ASSERT_EQ(submeshes.size(), 2);
+  EXPECT_EQ(submeshes[0].material, 1);
+  EXPECT_EQ(submeshes[0].mesh.triangle_count(), 1);
+  EXPECT_EQ(submeshes[0].mesh.vertices.size(), 3);
+  EXPECT_EQ(submeshes[1].material, 4);
+  EXPECT_EQ(submeshes[1].mesh.triangle_count(), 2);
+  EXPECT_EQ(submeshes[1].mesh.vertices.size(), 4);
+  EXPECT_EQ(submeshes[1].mesh.vertices[submeshes[1].mesh.indices[3]], glm::vec3(1, 0, 0));
+}
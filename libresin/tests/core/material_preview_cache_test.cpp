@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <libresin/core/material.hpp>
+#include <libresin/core/material_preview_cache.hpp>
+#include <vector>
+
+class MaterialPreviewCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() / "resin_material_preview_cache_test";
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  // background with a few varying pixels in the middle, like a preview of a sphere
+  static resin::MaterialPreviewPixels preview(size_t size) {
+    resin::MaterialPreviewPixels pixels(size * size, 0xFF404040U);
+    for (size_t i = (size * size / 2) - 5; i < (size * size / 2) + 5; ++i) {
+      pixels[i] = static_cast<uint32_t>(i) * 2654435761U;
+    }
+    return pixels;
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(MaterialPreviewCacheTest, EncodingRoundTrips) {
+  // given
+  const resin::MaterialPreviewPixels pixels = preview(16);
+
+  // when
+  const std::vector<uint8_t> data = resin::encode_material_preview(pixels);
+  const auto decoded              = resin::decode_material_preview(data, pixels.size());
+
+  // then
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(*decoded, pixels);
+  EXPECT_LT(data.size(), pixels.size() * sizeof(uint32_t) / 4);
+}
+
+TEST_F(MaterialPreviewCacheTest, TruncatedDataIsRejected) {
+  // given
+  const resin::MaterialPreviewPixels pixels = preview(16);
+  std::vector<uint8_t> data                 = resin::encode_material_preview(pixels);
+  data.resize(data.size() - 3);
+
+  // when
+  const auto decoded = resin::decode_material_preview(data, pixels.size());
+
+  // then
+  EXPECT_FALSE(decoded.has_value());
+}
+
+TEST_F(MaterialPreviewCacheTest, StoredPreviewIsLoaded) {
+  // given
+  resin::MaterialPreviewCache cache(directory_, 16);
+  const resin::MaterialPreviewPixels pixels = preview(16);
+  const uint64_t key                        = cache.key(resin::Material(glm::vec3(0.2F, 0.4F, 0.6F)));
+
+  // when
+  cache.store(key, pixels);
+  const auto loaded  = cache.load(key);
+  const auto missing = cache.load(key + 1);
+
+  // then
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(*loaded, pixels);
+  EXPECT_FALSE(missing.has_value());
+}
+
+TEST_F(MaterialPreviewCacheTest, KeyDependsOnMaterialAndSize) {
+  // given
+  const resin::MaterialPreviewCache cache(directory_, 16);
+  const resin::MaterialPreviewCache larger_cache(directory_, 32);
+  const resin::Material material;
+  resin::Material edited_material = material;
+  edited_material.specularExponent += 1.0F;
+
+  // when
+  const uint64_t key = cache.key(material);
+
+  // then
+  EXPECT_EQ(key, cache.key(resin::Material()));
+  EXPECT_NE(key, cache.key(edited_material));
+  EXPECT_NE(key, larger_cache.key(material));
+}
+
+TEST_F(MaterialPreviewCacheTest, LeastRecentlyUsedPreviewIsEvicted) {
+  // given
+  resin::MaterialPreviewCache cache(directory_, 16, /* max_previews= */ 2);
+  const resin::MaterialPreviewPixels pixels = preview(16);
+  cache.store(1, pixels);
+  cache.store(2, pixels);
+  const auto an_hour_ago = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+  for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+    std::filesystem::last_write_time(entry.path(), an_hour_ago);
+  }
+
+  // when
+  const auto used = cache.load(1);
+  cache.store(3, pixels);
+  cache.evict();
+
+  // then
+  EXPECT_TRUE(used.has_value());
+  EXPECT_TRUE(cache.load(1).has_value());
+  EXPECT_FALSE(cache.load(2).has_value());
+  EXPECT_TRUE(cache.load(3).has_value());
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <libresin/core/indexed_mesh.hpp>
+#include <libresin/core/mesh_simplifier.hpp>
+#include <map>
+#include <numbers>
+#include <utility>
+
+class MeshSimplifierTest : public testing::Test {
+ protected:
+  // Unit UV sphere with a single vertex at each pole.
+  static resin::IndexedMesh uv_sphere(unsigned int rings, unsigned int segments) {
+    resin::IndexedMesh mesh;
+    auto add_vertex = [&mesh](const glm::vec3& v) {
+      mesh.vertices.push_back(v);
+      mesh.normals.push_back(v);
+      mesh.uvs.emplace_back(0.0F);
+    };
+
+    add_vertex(glm::vec3(0.0F, 1.0F, 0.0F));
+    for (unsigned int r = 1; r < rings; ++r) {
+      for (unsigned int s = 0; s < segments; ++s) {
+        const float theta = std::numbers::pi_v<float> * static_cast<float>(r) / static_cast<float>(rings);
+        const float phi   = 2.0F * std::numbers::pi_v<float> * static_cast<float>(s) / static_cast<float>(segments);
+        add_vertex(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+      }
+    }
+    add_vertex(glm::vec3(0.0F, -1.0F, 0.0F));
+
+    const auto bottom = static_cast<uint32_t>(mesh.vertices.size() - 1);
+    auto ring_vertex  = [segments](unsigned int r, unsigned int s) {
+      return 1 + ((r - 1) * segments) + (s % segments);
+    };
+    for (unsigned int s = 0; s < segments; ++s) {
+      mesh.indices.insert(mesh.indices.end(), {0, ring_vertex(1, s + 1), ring_vertex(1, s)});
+      mesh.indices.insert(mesh.indices.end(), {bottom, ring_vertex(rings - 1, s), ring_vertex(rings - 1, s + 1)});
+    }
+    for (unsigned int r = 1; r + 1 < rings; ++r) {
+      for (unsigned int s = 0; s < segments; ++s) {
+        const uint32_t a = ring_vertex(r, s);
+        const uint32_t b = ring_vertex(r, s + 1);
+        const uint32_t c = ring_vertex(r + 1, s);
+        const uint32_t d = ring_vertex(r + 1, s + 1);
+        mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+      }
+    }
+    return mesh;
+  }
+
+  // True if every directed edge appears exactly once and has its twin, i.e. the mesh is a closed oriented manifold.
+  static bool is_closed_manifold(const resin::IndexedMesh& mesh) {
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+      const size_t next = (i % 3 == 2) ? i - 2 : i + 1;
+      ++edges[{mesh.indices[i], mesh.indices[next]}];
+    }
+    for (const auto& [edge, count] : edges) {
+      if (count != 1 || !edges.contains({edge.second, edge.first})) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+TEST_F(MeshSimplifierTest, ReachesTargetAndKeepsTopology) {
+  // given
+  const resin::IndexedMesh sphere = uv_sphere(32, 64);
+
+  // when
+  const resin::IndexedMesh simplified = resin::simplify_mesh(sphere, {.target_ratio = 0.1F});
+
+  // then
+  EXPECT_LE(simplified.triangle_count(), sphere.triangle_count() / 10 + 1);
+  EXPECT_TRUE(is_closed_manifold(simplified));
+  EXPECT_EQ(simplified.vertices.size() + simplified.triangle_count() - (3 * simplified.triangle_count() / 2), 2);
+  for (const auto& vertex : simplified.vertices) {
+    EXPECT_NEAR(glm::length(vertex), 1.0F, 0.02F);
+  }
+}
+
+TEST_F(MeshSimplifierTest, StopsAtErrorBound) {
+  // given
+  const resin::IndexedMesh sphere = uv_sphere(32, 64);
+
+  // when
+  const resin::IndexedMesh coarse = resin::simplify_mesh(sphere, {.target_ratio = 0.0F, .max_error = 0.05F});
+  const resin::IndexedMesh fine   = resin::simplify_mesh(sphere, {.target_ratio = 0.0F, .max_error = 0.005F});
+
+  // then
+  EXPECT_LT(coarse.triangle_count(), fine.triangle_count());
+  EXPECT_LT(fine.triangle_count(), sphere.triangle_count());
+  for (const auto& vertex : fine.vertices) {
+    EXPECT_NEAR(glm::length(vertex), 1.0F, 0.005F);
+  }
+}
+
+TEST_F(MeshSimplifierTest, KeepsMeshBelowTarget) {
+  // given
+  const resin::IndexedMesh sphere = uv_sphere(8, 16);
+
+  // when
+  const resin::IndexedMesh result = resin::simplify_mesh(sphere, {.target_triangle_count = 10000});
+
+  // then
+  EXPECT_EQ(result.indices, sphere.indices);
+}
+
+TEST_F(MeshSimplifierTest, KeepsMaterialSeams) {
+  // given
+  // upper and lower hemispheres with different materials, the seam runs along the equator
+  resin::IndexedMesh sphere = uv_sphere(32, 64);
+  for (size_t t = 0; t < sphere.triangle_count(); ++t) {
+    const float y = sphere.vertices[sphere.indices[3 * t]].y + sphere.vertices[sphere.indices[(3 * t) + 1]].y +
+                    sphere.vertices[sphere.indices[(3 * t) + 2]].y;
+    sphere.materials.push_back(y > 0.0F ? 1 : 2);
+  }
+
+  // when
+  const resin::IndexedMesh simplified = resin::simplify_mesh(sphere, {.target_ratio = 0.2F});
+
+  // then
+  ASSERT_EQ(simplified.materials.size(), simplified.triangle_count());
+  for (size_t t = 0; t < simplified.triangle_count(); ++t) {
+    for (size_t corner = 0; corner < 3; ++corner) {
+      const float y = simplified.vertices[simplified.indices[(3 * t) + corner]].y;
+      if (simplified.materials[t] == 1) {
+        EXPECT_GT(y, -0.02F);
+      } else {
+        EXPECT_LT(y, 0.02F);
+      }
+    }
+  }
+}
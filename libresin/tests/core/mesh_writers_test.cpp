@@ -0,0 +1,205 @@
+#include <assimp/mesh.h>
+#include <assimp/scene.h>
+#include <gtest/gtest.h>
+
+#include <assimp/Exporter.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <libresin/core/cpu_mesher.hpp>
+#include <libresin/core/indexed_mesh.hpp>
+#include <libresin/core/mesh_writers.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_evaluator.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/thread_pool.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class MeshWritersTest : public testing::Test {
+ protected:
+  // two triangles of a quad with different materials
+  static resin::IndexedMesh quad() {
+    resin::IndexedMesh mesh;
+    mesh.vertices  = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    mesh.normals   = std::vector<glm::vec3>(4, glm::vec3(0, 0, 1));
+    mesh.uvs       = std::vector<glm::vec2>(4, glm::vec2(0));
+    mesh.indices   = {0, 1, 2, 0, 2, 3};
+    mesh.materials = {1, 2};
+    return mesh;
+  }
+
+  static uint32_t read_u32(const std::string& data, size_t offset) {
+    uint32_t value = 0;
+    std::memcpy(&value, data.data() + offset, sizeof(uint32_t));
+    return value;
+  }
+
+  // Assimp scene with a single mesh and material, like the one of MeshExporter::create_scene without vertex colors
+  static std::unique_ptr<aiScene> assimp_scene(const resin::IndexedMesh& mesh) {
+    // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+    auto scene                     = std::make_unique<aiScene>();
+    scene->mMaterials              = new aiMaterial*[1]{new aiMaterial()};
+    scene->mNumMaterials           = 1;
+    scene->mMeshes                 = new aiMesh*[1]{new aiMesh()};
+    scene->mNumMeshes              = 1;
+    scene->mRootNode               = new aiNode();
+    scene->mRootNode->mMeshes      = new unsigned int[1]{0};
+    scene->mRootNode->mNumMeshes   = 1;
+    aiMesh* ai_mesh                = scene->mMeshes[0];
+    ai_mesh->mPrimitiveTypes       = aiPrimitiveType_TRIANGLE;
+    ai_mesh->mNumVertices          = static_cast<unsigned int>(mesh.vertices.size());
+    ai_mesh->mVertices             = new aiVector3D[mesh.vertices.size()];
+    ai_mesh->mNormals              = new aiVector3D[mesh.vertices.size()];
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+      ai_mesh->mVertices[i] = aiVector3D(mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z);
+      ai_mesh->mNormals[i]  = aiVector3D(mesh.normals[i].x, mesh.normals[i].y, mesh.normals[i].z);
+    }
+    ai_mesh->mNumFaces = static_cast<unsigned int>(mesh.triangle_count());
+    ai_mesh->mFaces    = new aiFace[mesh.triangle_count()];
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) {
+      ai_mesh->mFaces[i].mNumIndices = 3;
+      ai_mesh->mFaces[i].mIndices =
+          new unsigned int[3]{mesh.indices[3 * i], mesh.indices[(3 * i) + 1], mesh.indices[(3 * i) + 2]};
+    }
+    // NOLINTEND(cppcoreguidelines-owning-memory)
+    return scene;
+  }
+};
+
+TEST_F(MeshWritersTest, STLHasRecordPerTriangle) {
+  // given
+  const resin::IndexedMesh mesh = quad();
+  std::ostringstream output;
+
+  // when
+  resin::write_stl(output, mesh);
+
+  // then
+  const std::string data = output.str();
+  ASSERT_EQ(data.size(), 84 + (50 * mesh.triangle_count()));
+  EXPECT_NE(data.substr(0, 5), "solid");
+  EXPECT_EQ(read_u32(data, 80), mesh.triangle_count());
+
+  float normal_z = 0.0F;
+  std::memcpy(&normal_z, data.data() + 84 + (2 * sizeof(float)), sizeof(float));
+  EXPECT_FLOAT_EQ(normal_z, 1.0F);
+}
+
+TEST_F(MeshWritersTest, PLYHeaderMatchesBody) {
+  // given
+  const resin::IndexedMesh mesh = quad();
+  std::ostringstream output;
+
+  // when
+  resin::write_ply(output, mesh);
+
+  // then
+  const std::string data  = output.str();
+  const size_t header_end = data.find("end_header\n");
+  ASSERT_NE(header_end, std::string::npos);
+  EXPECT_NE(data.find("element vertex 4\n"), std::string::npos);
+  EXPECT_NE(data.find("element face 2\n"), std::string::npos);
+
+  const size_t body_offset = header_end + std::string("end_header\n").size();
+  const size_t face_size   = 1 + (4 * sizeof(uint32_t));
+  ASSERT_EQ(data.size(), body_offset + (4 * 8 * sizeof(float)) + (2 * face_size));
+
+  const size_t second_face = body_offset + (4 * 8 * sizeof(float)) + face_size;
+  EXPECT_EQ(data[second_face], 3);
+  EXPECT_EQ(read_u32(data, second_face + 1 + (3 * sizeof(uint32_t))), 2);
+}
+
+TEST_F(MeshWritersTest, GLBHasAlignedChunks) {
+  // given
+  const resin::IndexedMesh mesh = quad();
+  const std::vector<resin::MeshExportMaterial> materials = {
+      {.id = 1, .name = "first", .material = resin::Material()},
+      {.id = 2, .name = "second", .material = resin::Material()},
+  };
+  std::ostringstream output;
+
+  // when
+  resin::write_glb(output, mesh, {}, materials);
+
+  // then
+  const std::string data = output.str();
+  ASSERT_GE(data.size(), 20);
+  EXPECT_EQ(data.substr(0, 4), "glTF");
+  EXPECT_EQ(read_u32(data, 4), 2);
+  EXPECT_EQ(read_u32(data, 8), data.size());
+
+  const uint32_t json_size = read_u32(data, 12);
+  EXPECT_EQ(json_size % 4, 0);
+  EXPECT_EQ(data.substr(16, 4), "JSON");
+
+  const std::string json = data.substr(20, json_size);
+  EXPECT_NE(json.find("\"first\""), std::string::npos);
+  EXPECT_NE(json.find("\"second\""), std::string::npos);
+
+  const size_t bin_offset = 20 + json_size;
+  ASSERT_GE(data.size(), bin_offset + 8);
+  EXPECT_EQ(data.substr(bin_offset + 4, 3), "BIN");
+  EXPECT_EQ(bin_offset + 8 + read_u32(data, bin_offset), data.size());
+}
+
+// Not a correctness test, run with --gtest_also_run_disabled_tests to compare the native writers with Assimp
+TEST_F(MeshWritersTest, DISABLED_ExportThroughputBenchmark) {
+  using clock                   = std::chrono::steady_clock;
+  static constexpr int kRepeats = 5;
+
+  // given
+  resin::SDFTree tree;
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  const resin::SDFEvaluator evaluator(tree.root());
+  const resin::CPUMesher mesher(evaluator, glm::vec3(-1.1F), glm::vec3(1.1F), 256);
+  resin::ThreadPool pool;
+  const resin::TriangleSoup soup = mesher.march(pool);
+  const resin::IndexedMesh mesh  = resin::weld_triangle_soup(soup.vertices, soup.normals, soup.uvs, soup.edge_ids);
+  const std::vector<resin::MeshExportMaterial> materials = {
+      {.id = 0, .name = "default", .material = resin::Material()},
+  };
+
+  // Triangles per second, the Assimp timings include building its scene
+  const auto measure = [&mesh](const auto& function) {
+    const auto start = clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+      function();
+    }
+    const std::chrono::duration<double> elapsed = clock::now() - start;
+    return static_cast<double>(mesh.triangle_count()) * kRepeats / elapsed.count();
+  };
+  const auto assimp_export = [&mesh](const char* format) {
+    const std::unique_ptr<aiScene> scene = assimp_scene(mesh);
+    Assimp::Exporter exporter;
+    EXPECT_NE(exporter.ExportToBlob(scene.get(), format), nullptr);
+  };
+
+  // when
+  const double native_stl = measure([&mesh]() {
+    std::ostringstream output;
+    resin::write_stl(output, mesh);
+  });
+  const double native_ply = measure([&mesh]() {
+    std::ostringstream output;
+    resin::write_ply(output, mesh);
+  });
+  const double native_glb = measure([&]() {
+    std::ostringstream output;
+    resin::write_glb(output, mesh, {}, materials);
+  });
+  const double assimp_stl = measure([&]() { assimp_export("stlb"); });
+  const double assimp_ply = measure([&]() { assimp_export("plyb"); });
+  const double assimp_glb = measure([&]() { assimp_export("glb2"); });
+
+  // then
+  std::cout << std::format("{} triangles, in triangles/s:\n", mesh.triangle_count());
+  std::cout << std::format("STL: native {:.0f}, Assimp {:.0f}\n", native_stl, assimp_stl);
+  std::cout << std::format("PLY: native {:.0f}, Assimp {:.0f}\n", native_ply, assimp_ply);
+  std::cout << std::format("GLB: native {:.0f}, Assimp {:.0f}\n", native_glb, assimp_glb);
+  EXPECT_FALSE(mesh.empty());
+}
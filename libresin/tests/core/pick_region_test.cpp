@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <libresin/core/pick_region.hpp>
+#include <vector>
+
+class PickRegionTest : public testing::Test {};
+
+TEST_F(PickRegionTest, BoundsAreFlippedAndClamped) {
+  // given
+  // viewport coordinates, the corners are in any order and the second one is outside of the 100x50 attachment
+  const std::array<glm::vec2, 2> corners = {glm::vec2(10.2F, 40.0F), glm::vec2(120.0F, 5.5F)};
+
+  // when
+  const resin::PickRegionBounds bounds = resin::pick_region_bounds(corners, 100, 50);
+
+  // then
+  EXPECT_FALSE(bounds.empty());
+  EXPECT_EQ(bounds.min.x, 10);
+  EXPECT_EQ(bounds.min.y, 10);
+  EXPECT_EQ(bounds.max.x, 100);
+  EXPECT_EQ(bounds.max.y, 45);
+}
+
+TEST_F(PickRegionTest, RegionOutsideOfAttachmentIsEmpty) {
+  // given
+  const std::array<glm::vec2, 3> lasso = {glm::vec2(-30.0F, 10.0F), glm::vec2(-10.0F, 20.0F),
+                                          glm::vec2(-20.0F, 30.0F)};
+
+  // when
+  const resin::PickRegionBounds bounds = resin::pick_region_bounds(lasso, 100, 50);
+
+  // then
+  EXPECT_TRUE(bounds.empty());
+}
+
+TEST_F(PickRegionTest, NodeMaskIsDecodedInOrder) {
+  // given
+  const std::vector<uint32_t> mask = {0b1001U, 0U, 0x80000000U};
+
+  // when
+  const std::vector<size_t> ids = resin::decode_node_mask(mask);
+
+  // then
+  const std::vector<size_t> expected = {0, 3, 95};
+  EXPECT_EQ(ids, expected);
+}
@@ -1,10 +1,16 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <libresin/core/resources/shader_resource.hpp>
 #include <libresin/utils/exceptions.hpp>
+#include <string>
+#include <string_view>
 #include <tests/files_helper.hpp>
 #include <tests/libresin/test_consts.hpp>
+#include <vector>
 
 class ShaderResourceTest : public testing::Test {
  protected:
@@ -41,6 +47,33 @@ TEST_F(ShaderResourceTest, ShaderWithDepsIsCorrectlyGenerated) {
   EXPECT_FALSE(glsl.find("#define EXTERNAL_B 50") == std::string_view::npos);
 }
 
+TEST_F(ShaderResourceTest, ChangedDefinitionReplacesItsSegmentOnly) {
+  // given
+  resin::ShaderResourceManager sh_resman;
+  resin::ShaderResource shader(*sh_resman.get_res(resources_path_ / "regular_load" / "main.frag"));
+  shader.set_ext_defi("EXTERNAL_MAIN", "int func() { return 5; }");
+  shader.set_ext_defi("EXTERNAL_A", "100");
+  shader.set_ext_defi("EXTERNAL_B", "50");
+  const auto segment_views = shader.get_glsl_segments();
+  const std::vector<std::string> segments(segment_views.begin(), segment_views.end());
+
+  // when
+  shader.set_ext_defi("EXTERNAL_A", "200");
+  const std::vector<std::string_view> changed_segments = shader.get_glsl_segments();
+
+  // then
+  ASSERT_EQ(changed_segments.size(), segments.size());
+  EXPECT_EQ(changed_segments.back().data(), shader.get_raw().data());
+
+  std::string glsl;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    EXPECT_EQ(changed_segments[i] == "200", segments[i] == "100");
+    glsl.append(changed_segments[i]);
+  }
+  EXPECT_EQ(glsl, shader.get_glsl());
+  EXPECT_NE(glsl.find("#define EXTERNAL_A 200\n"), std::string::npos);
+}
+
 TEST_F(ShaderResourceTest, ShaderDepsCycleIsDetected) {
   resin::ShaderResourceManager sh_resman;
 
@@ -48,3 +81,59 @@ TEST_F(ShaderResourceTest, ShaderDepsCycleIsDetected) {
       { auto res = sh_resman.get_res(resources_path_ / "deps_cycle" / "main.vert"); },
       resin::ShaderIncludeMacroDependencyCycleException);
 }
+
+TEST_F(ShaderResourceTest, ModifiedIncludeInvalidatesItsDependents) {
+  // given
+  const auto directory = std::filesystem::temp_directory_path() / "resin_shader_resource_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::copy(resources_path_ / "regular_load", directory);
+
+  resin::ShaderResourceManager sh_resman;
+  resin::ShaderResource shader(*sh_resman.get_res(directory / "main.frag"));
+  shader.set_ext_defi("EXTERNAL_MAIN", "int func() { return 5; }");
+  shader.set_ext_defi("EXTERNAL_A", "100");
+  shader.set_ext_defi("EXTERNAL_B", "50");
+  EXPECT_TRUE(sh_resman.invalidate_modified().empty());
+
+  // when
+  std::ofstream(directory / "shader_b.glsl") << "#external_definition EXTERNAL_B\nint my_func_b() { return 2; }\n";
+  std::filesystem::last_write_time(directory / "shader_b.glsl",
+                                   std::filesystem::last_write_time(directory / "main.frag") + std::chrono::hours(1));
+  auto modified = sh_resman.invalidate_modified();
+  shader.reload(*sh_resman.get_res(directory / "main.frag"));
+
+  // then
+  std::ranges::sort(modified);
+  EXPECT_EQ(modified, (std::vector<std::filesystem::path>{directory / "main.frag", directory / "shader_a.glsl",
+                                                          directory / "shader_b.glsl"}));
+  EXPECT_NE(shader.get_raw().find("return 2;"), std::string::npos);
+  EXPECT_TRUE(shader.is_glsl_ready());
+  EXPECT_NE(shader.get_glsl().find("#define EXTERNAL_A 100"), std::string::npos);
+  EXPECT_TRUE(sh_resman.invalidate_modified().empty());
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(ShaderResourceTest, TabIndentedMacrosAreProcessed) {
+  // given
+  const auto directory = std::filesystem::temp_directory_path() / "resin_shader_resource_tab_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "included.glsl") << "int included_func() { return 3; }\n";
+  std::ofstream(directory / "main.frag")
+      << "#version 330 core\n\t#external_definition EXTERNAL_TAB\n\t#include \"included.glsl\"\n";
+
+  // when
+  resin::ShaderResourceManager sh_resman;
+  resin::ShaderResource shader(*sh_resman.get_res(directory / "main.frag"));
+  const bool is_ready_before = shader.is_glsl_ready();
+  shader.set_ext_defi("EXTERNAL_TAB", "1");
+
+  // then
+  EXPECT_FALSE(is_ready_before);
+  EXPECT_TRUE(shader.is_glsl_ready());
+  EXPECT_NE(shader.get_raw().find("return 3;"), std::string::npos);
+  EXPECT_EQ(shader.get_raw().find("#include"), std::string::npos);
+
+  std::filesystem::remove_all(directory);
+}
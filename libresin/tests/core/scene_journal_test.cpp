@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <libresin/core/material.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/scene_journal.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/json.hpp>
+#include <nlohmann/json.hpp>
+#include <span>
+#include <tests/scene_helper.hpp>
+#include <vector>
+
+class SceneJournalTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() / "resin_scene_journal_test";
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  // Prefab of a group with a capsule referenced by the root
+  static void add_prefab_reference(resin::SDFTree& tree) {
+    resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+    builder.push_back_child<resin::CapsuleNode>(builder.root(), resin::SDFBinaryOperation::Union);
+    auto& prefab = tree.add_prefab(builder.build(), "prefab.amber");
+    tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab).rename("ref");
+  }
+
+  static resin::SDFTreeNode& child(resin::GroupNode& group, size_t index) {
+    return group.get_child(*std::next(group.begin(), static_cast<std::ptrdiff_t>(index)));
+  }
+
+  // Loading renumbers the ids, so the scene is compared as it would be loaded from its save
+  static nlohmann::json loaded_scene_json(std::span<const uint8_t> data) {
+    resin::Scene loaded;
+    resin::binary::deserialize_scene(loaded, data);
+    return normalized_scene_json(loaded);
+  }
+
+  static nlohmann::json saved_scene_json(resin::Scene& scene) {
+    return loaded_scene_json(resin::binary::serialize_scene(scene));
+  }
+
+  nlohmann::json restored_scene_json() const {
+    const auto data = resin::SceneJournal::restore(directory_);
+    EXPECT_TRUE(data.has_value());
+    return loaded_scene_json(data.value_or(std::vector<uint8_t>{}));
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(SceneJournalTest, EditsAreRestoredFromTheJournal) {
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  add_prefab_reference(scene.tree());
+  resin::SceneJournal journal(directory_);
+  journal.record(scene);
+  const size_t compacted_size = journal.journal_size();
+
+  auto& tree  = scene.tree();
+  auto& group = tree.group(*tree.root().begin());
+  dynamic_cast<resin::SphereNode&>(child(group, 0)).radius = 2.5F;
+  tree.material(tree.materials().front()).material.albedo  = glm::vec3(0.1F, 0.2F, 0.3F);
+  tree.add_material(resin::Material(glm::vec3(0.4F))).rename("third");
+  group.push_back_child<resin::CylinderNode>(resin::SDFBinaryOperation::Xor).rename("cylinder");
+  journal.record(scene);
+
+  // the cube is moved in front of the group and the torus is removed
+  auto cube = group.detach_child(child(group, 1).node_id());
+  tree.root().insert_before_child(group.node_id(), std::move(cube));
+  tree.delete_node(child(tree.root(), 2).node_id());
+  tree.delete_material(tree.materials()[1]);
+  scene.lights().begin()->second->rename("renamed");
+  journal.record(scene);
+  journal.flush();
+
+  // when
+  const nlohmann::json restored = restored_scene_json();
+
+  // then
+  EXPECT_GT(journal.journal_size(), compacted_size);
+  EXPECT_EQ(restored, saved_scene_json(scene));
+}
+
+TEST_F(SceneJournalTest, UnchangedSceneAppendsNothing) {
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  add_prefab_reference(scene.tree());
+  resin::SceneJournal journal(directory_);
+  journal.record(scene);
+  const size_t compacted_size = journal.journal_size();
+
+  // when
+  journal.record(scene);
+  journal.record(scene);
+  journal.flush();
+
+  // then
+  EXPECT_EQ(journal.journal_size(), compacted_size);
+  EXPECT_EQ(std::filesystem::file_size(directory_ / resin::SceneJournal::kJournalFileName), compacted_size);
+}
+
+TEST_F(SceneJournalTest, TornBatchIsIgnored) {
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  add_prefab_reference(scene.tree());
+  resin::SceneJournal journal(directory_);
+  journal.record(scene);
+
+  auto& tree = scene.tree();
+  dynamic_cast<resin::CapsuleNode&>(child(tree.root(), 1)).height = 3.0F;
+  journal.record(scene);
+  const nlohmann::json expected = saved_scene_json(scene);
+
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  journal.record(scene);
+  journal.flush();
+
+  // when
+  const auto journal_path = directory_ / resin::SceneJournal::kJournalFileName;
+  std::filesystem::resize_file(journal_path, std::filesystem::file_size(journal_path) - 3);
+  const nlohmann::json restored = restored_scene_json();
+
+  // then
+  EXPECT_EQ(restored, expected);
+}
+
+TEST_F(SceneJournalTest, NewPrefabCompactsTheJournal) {
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  add_prefab_reference(scene.tree());
+  resin::SceneJournal journal(directory_);
+  journal.record(scene);
+  scene.tree().root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  journal.record(scene);
+  const size_t journal_size = journal.journal_size();
+
+  // when
+  auto& tree = scene.tree();
+  tree.instance_group(*tree.root().begin());
+  journal.record(scene);
+  journal.flush();
+
+  // then
+  EXPECT_LT(journal.journal_size(), journal_size);
+  EXPECT_EQ(restored_scene_json(), saved_scene_json(scene));
+
+  resin::SceneJournal::discard(directory_);
+  EXPECT_FALSE(resin::SceneJournal::has_autosave(directory_));
+}
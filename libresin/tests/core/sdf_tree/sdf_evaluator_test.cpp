@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <glm/geometric.hpp>
+#include <libresin/core/cpu_mesher.hpp>
+#include <libresin/core/indexed_mesh.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_evaluator.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/thread_pool.hpp>
+#include <optional>
+#include <tests/glm_helper.hpp>
+
+class SDFEvaluatorTest : public testing::Test {
+ protected:
+  // Sphere traces the ray evaluating every primitive at every step
+  static std::optional<float> march_all(const resin::SDFEvaluator& evaluator, const glm::vec3& origin,
+                                        const glm::vec3& direction) {
+    float t = 0.0F;
+    for (int i = 0; i < 512 && t <= resin::SDFEvaluator::kFarPlane; ++i) {
+      const float dist = evaluator.distance(origin + (t * direction));
+      if (dist < 0.0001F) {
+        return t;
+      }
+      t += dist;
+    }
+    return std::nullopt;
+  }
+};
+
+TEST_F(SDFEvaluatorTest, EmptyTreeEvaluatesToFarPlane) {
+  // given
+  resin::SDFTree tree;
+
+  // when
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // then
+  EXPECT_TRUE(evaluator.empty());
+  EXPECT_FLOAT_EQ(evaluator.distance(glm::vec3(0.0F)), resin::SDFEvaluator::kFarPlane);
+}
+
+TEST_F(SDFEvaluatorTest, TransformedPrimitivesAreCombined) {
+  // given
+  resin::SDFTree tree;
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  auto& cube = tree.root().push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Diff);
+  cube.transform().set_local_pos(glm::vec3(1.0F, 0.0F, 0.0F));
+
+  // when
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // then
+  EXPECT_EQ(evaluator.instruction_count(), 4);
+  EXPECT_NEAR(evaluator.distance(glm::vec3(-2.0F, 0.0F, 0.0F)), 1.0F, 1e-5F);
+  EXPECT_GT(evaluator.distance(glm::vec3(0.5F, 0.0F, 0.0F)), 0.0F);
+  EXPECT_LT(evaluator.distance(glm::vec3(-0.5F, 0.0F, 0.0F)), 0.0F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-1.0F, 0.0F, 0.0F), evaluator.normal(glm::vec3(-1.0F, 0.0F, 0.0F)), 1e-3F);
+}
+
+TEST_F(SDFEvaluatorTest, ZeroScaledPrimitiveIsEmpty) {
+  // given
+  resin::SDFTree tree;
+  auto& sphere = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  sphere.transform().set_local_scale(0.0F);
+  auto& cube = tree.root().push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Union);
+  cube.transform().set_local_pos(glm::vec3(3.0F, 0.0F, 0.0F));
+
+  // when
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // then
+  EXPECT_NEAR(evaluator.distance(glm::vec3(0.0F)), 2.0F, 1e-5F);
+}
+
+TEST_F(SDFEvaluatorTest, CPUMesherProducesClosedSphere) {
+  // given
+  resin::SDFTree tree;
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  const resin::SDFEvaluator evaluator(tree.root());
+  const resin::CPUMesher mesher(evaluator, glm::vec3(-1.9F), glm::vec3(2.1F), 16);
+  resin::ThreadPool pool(4);
+
+  // when
+  const resin::TriangleSoup soup = mesher.march(pool);
+  const resin::IndexedMesh mesh  = resin::weld_triangle_soup(soup.vertices, soup.normals, soup.uvs, soup.edge_ids);
+
+  // then
+  ASSERT_FALSE(mesh.empty());
+  for (const auto& vertex : mesh.vertices) {
+    EXPECT_NEAR(glm::length(vertex), 1.0F, 0.05F);
+  }
+  // Closed genus 0 surface, the grid is offset so no corner lies exactly on the sphere
+  const auto v = static_cast<int64_t>(mesh.vertices.size());
+  const auto f = static_cast<int64_t>(mesh.triangle_count());
+  EXPECT_EQ(v - (3 * f / 2) + f, 2);
+}
+
+TEST_F(SDFEvaluatorTest, MaterialOfClosestPrimitiveIsReturned) {
+  // given
+  resin::SDFTree tree;
+  auto& left  = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  auto& right = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  left.transform().set_local_pos(glm::vec3(-2.0F, 0.0F, 0.0F));
+  right.transform().set_local_pos(glm::vec3(2.0F, 0.0F, 0.0F));
+  auto& material = tree.add_material(resin::Material(glm::vec3(1.0F, 0.0F, 0.0F)));
+  right.set_material(material.material_id());
+
+  // when
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // then
+  EXPECT_EQ(evaluator.material(glm::vec3(-2.5F, 0.0F, 0.0F)), tree.default_material().material_id().raw());
+  EXPECT_EQ(evaluator.material(glm::vec3(2.5F, 0.0F, 0.0F)), material.material_id().raw());
+}
+
+TEST_F(SDFEvaluatorTest, RayHitsClosestPrimitive) {
+  // given
+  resin::SDFTree tree;
+  auto& left  = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  auto& right = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  left.transform().set_local_pos(glm::vec3(-2.0F, 0.0F, 0.0F));
+  right.transform().set_local_pos(glm::vec3(2.0F, 0.0F, 0.0F));
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // when
+  const auto from_left  = evaluator.raycast(glm::vec3(-10.0F, 0.0F, 0.0F), glm::vec3(1.0F, 0.0F, 0.0F));
+  const auto from_right = evaluator.raycast(glm::vec3(10.0F, 0.0F, 0.0F), glm::vec3(-2.0F, 0.0F, 0.0F));
+
+  // then
+  ASSERT_TRUE(from_left.has_value());
+  EXPECT_EQ(from_left->node_id, left.node_id().raw());
+  EXPECT_NEAR(from_left->distance, 7.0F, 1e-3F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-3.0F, 0.0F, 0.0F), from_left->position, 1e-3F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(-1.0F, 0.0F, 0.0F), from_left->normal, 1e-3F);
+
+  ASSERT_TRUE(from_right.has_value());
+  EXPECT_EQ(from_right->node_id, right.node_id().raw());
+  EXPECT_NEAR(from_right->distance, 7.0F, 1e-3F);
+}
+
+TEST_F(SDFEvaluatorTest, RayMissesOutsideOfBounds) {
+  // given
+  resin::SDFTree tree;
+  auto& sphere = tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  sphere.transform().set_local_pos(glm::vec3(3.0F, 0.0F, 0.0F));
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // when
+  const auto above  = evaluator.raycast(glm::vec3(3.0F, 5.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+  const auto beside = evaluator.raycast(glm::vec3(0.0F, 5.0F, 0.0F), glm::vec3(0.0F, -1.0F, 0.0F));
+  const auto short_ray =
+      evaluator.raycast(glm::vec3(3.0F, 5.0F, 0.0F), glm::vec3(0.0F, -1.0F, 0.0F), /* max_distance= */ 3.0F);
+
+  // then
+  EXPECT_GLM_VEC_NEAR(glm::vec3(2.0F, -1.0F, -1.0F), evaluator.bounds_min(), 0.05F);
+  EXPECT_GLM_VEC_NEAR(glm::vec3(4.0F, 1.0F, 1.0F), evaluator.bounds_max(), 0.05F);
+  EXPECT_FALSE(above.has_value());
+  EXPECT_FALSE(beside.has_value());
+  EXPECT_FALSE(short_ray.has_value());
+}
+
+TEST_F(SDFEvaluatorTest, RaySkippingMissedPrimitivesMatchesFullMarch) {
+  // given
+  resin::SDFTree tree;
+  auto& group = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Union);
+  group.push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Union).size = glm::vec3(2.0F);
+  auto& hole = group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Diff);
+  hole.transform().set_local_pos(glm::vec3(0.0F, 1.0F, 0.0F));
+  auto& cut = group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Inter);
+  cut.radius = 1.5F;
+  auto& blob = tree.root().push_back_child<resin::TorusNode>(resin::SDFBinaryOperation::SmoothUnion);
+  blob.transform().set_local_pos(glm::vec3(3.0F, 0.0F, 0.0F));
+  blob.set_factor(0.5F);
+
+  resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+  builder.push_back_child<resin::CapsuleNode>(builder.root(), resin::SDFBinaryOperation::Union);
+  auto& prefab    = tree.add_prefab(builder.build());
+  auto& reference = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab);
+  reference.transform().set_local_pos(glm::vec3(-3.0F, 0.0F, 0.0F));
+  reference.set_repetition(
+      {.type = resin::RepetitionType::Grid, .spacing = glm::vec3(1.0F), .count = glm::uvec3(1, 1, 3)});
+  const resin::SDFEvaluator evaluator(tree.root());
+
+  // when
+  // then
+  // The rays are offset from the edges of the primitives, where the step counts of the two marches could differ
+  for (int x = -10; x <= 10; ++x) {
+    for (int z = -4; z <= 4; ++z) {
+      const glm::vec3 origin((0.5F * static_cast<float>(x)) + 0.2F, 10.0F, (0.5F * static_cast<float>(z)) + 0.2F);
+      const glm::vec3 direction(0.0F, -1.0F, 0.0F);
+      const auto hit      = evaluator.raycast(origin, direction);
+      const auto expected = march_all(evaluator, origin, direction);
+      ASSERT_EQ(hit.has_value(), expected.has_value()) << "x=" << x << " z=" << z;
+      if (hit.has_value()) {
+        EXPECT_NEAR(hit->distance, *expected, 1e-3F) << "x=" << x << " z=" << z;
+      }
+    }
+  }
+}
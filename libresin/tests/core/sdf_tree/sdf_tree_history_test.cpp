@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <libresin/core/material.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_history.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/json.hpp>
+#include <nlohmann/json.hpp>
+
+class SDFTreeHistoryTest : public testing::Test {
+ protected:
+  //      o
+  //  o   o   p
+  //  o o
+  //
+  void SetUp() override {
+    auto& tree = scene_.tree();
+    tree.add_material(resin::Material(glm::vec3(0.2F))).rename("first");
+    tree.add_material(resin::Material(glm::vec3(0.8F))).rename("second");
+
+    auto& group = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::SmoothUnion);
+    group.rename("group");
+    group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union).rename("sphere");
+    group.push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Diff).rename("cube");
+    group.set_material(tree.materials()[1]);
+    tree.root().push_back_child<resin::TorusNode>(resin::SDFBinaryOperation::Union).rename("torus");
+
+    resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+    builder.push_back_child<resin::CapsuleNode>(builder.root(), resin::SDFBinaryOperation::Union);
+    auto& prefab = tree.add_prefab(builder.build(), "prefab.amber");
+    tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab).rename("ref");
+  }
+
+  static resin::SDFTreeNode& child(resin::GroupNode& group, size_t index) {
+    return group.get_child(*std::next(group.begin(), static_cast<std::ptrdiff_t>(index)));
+  }
+
+  // Undo recreates the deleted objects with new ids, so the scene is compared as it would be loaded from its save
+  nlohmann::json saved_scene_json() {
+    resin::Scene loaded;
+    resin::binary::deserialize_scene(loaded, resin::binary::serialize_scene(scene_));
+    return nlohmann::json::parse(resin::json::serialize_scene(loaded));
+  }
+
+  resin::Scene scene_;
+};
+
+TEST_F(SDFTreeHistoryTest, ParameterChangeIsUndoneInPlace) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+  const nlohmann::json initial = saved_scene_json();
+
+  auto& sphere  = dynamic_cast<resin::SphereNode&>(child(tree.group(*tree.root().begin()), 0));
+  sphere.radius = 2.5F;
+  sphere.transform().set_local_pos(glm::vec3(1.0F, 2.0F, 3.0F));
+  EXPECT_TRUE(history.commit());
+  const nlohmann::json edited = saved_scene_json();
+  const auto sphere_id        = sphere.node_id();
+  tree.mark_clean();
+
+  // when
+  EXPECT_TRUE(history.undo());
+
+  // then
+  EXPECT_FALSE(tree.is_dirty());
+  EXPECT_EQ(tree.node(sphere_id).node_id(), sphere_id);
+  EXPECT_EQ(sphere.radius, 1.0F);
+  EXPECT_EQ(saved_scene_json(), initial);
+  EXPECT_TRUE(history.redo());
+  EXPECT_EQ(saved_scene_json(), edited);
+  EXPECT_FALSE(history.can_redo());
+}
+
+TEST_F(SDFTreeHistoryTest, StructuralChangesAreUndoneAndRedone) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+  const nlohmann::json initial = saved_scene_json();
+
+  // the cube is moved in front of the group, the torus is removed and a cylinder is added to the group
+  auto& group = tree.group(*tree.root().begin());
+  auto cube   = group.detach_child(child(group, 1).node_id());
+  tree.root().insert_before_child(group.node_id(), std::move(cube));
+  tree.delete_node(child(tree.root(), 2).node_id());
+  group.push_back_child<resin::CylinderNode>(resin::SDFBinaryOperation::Xor).rename("cylinder");
+  history.commit();
+  const nlohmann::json moved = saved_scene_json();
+
+  // the group is removed with its children
+  tree.delete_node(group.node_id());
+  history.commit();
+  const nlohmann::json removed = saved_scene_json();
+
+  // when
+  // then
+  EXPECT_TRUE(history.undo());
+  EXPECT_EQ(saved_scene_json(), moved);
+  EXPECT_TRUE(history.undo());
+  EXPECT_EQ(saved_scene_json(), initial);
+  EXPECT_FALSE(history.undo());
+  EXPECT_TRUE(history.redo());
+  EXPECT_EQ(saved_scene_json(), moved);
+  EXPECT_TRUE(history.redo());
+  EXPECT_EQ(saved_scene_json(), removed);
+  EXPECT_EQ(history.step_count(), 2);
+}
+
+TEST_F(SDFTreeHistoryTest, DeletedReferenceKeepsItsPrefab) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+  const nlohmann::json initial = saved_scene_json();
+
+  // when
+  tree.delete_node(child(tree.root(), 2).node_id());
+  tree.delete_unused_prefabs();
+  history.commit();
+
+  // then
+  EXPECT_EQ(tree.prefabs().size(), 1);
+  EXPECT_TRUE(history.undo());
+  EXPECT_EQ(saved_scene_json(), initial);
+}
+
+TEST_F(SDFTreeHistoryTest, DeletedMaterialIsRestoredWithItsNodes) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+  const nlohmann::json initial = saved_scene_json();
+
+  // when
+  tree.delete_material(tree.materials()[1]);
+  tree.material(tree.materials()[0]).material.albedo = glm::vec3(0.1F, 0.2F, 0.3F);
+  history.commit();
+
+  // then
+  EXPECT_TRUE(history.undo());
+  EXPECT_EQ(tree.materials().size(), 2);
+  EXPECT_EQ(saved_scene_json(), initial);
+}
+
+TEST_F(SDFTreeHistoryTest, UnchangedTreeCommitsNothing) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+
+  // when
+  const bool is_committed = history.commit();
+
+  // then
+  EXPECT_FALSE(is_committed);
+  EXPECT_FALSE(history.can_undo());
+  EXPECT_EQ(history.step_count(), 0);
+}
+
+TEST_F(SDFTreeHistoryTest, ReplacedRootClearsTheHistory) {
+  // given
+  auto& tree = scene_.tree();
+  resin::SDFTreeHistory history(tree);
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  history.commit();
+
+  // when
+  resin::binary::deserialize_scene(scene_, resin::binary::serialize_scene(scene_));
+
+  // then
+  EXPECT_FALSE(history.undo());
+  EXPECT_EQ(history.step_count(), 0);
+}
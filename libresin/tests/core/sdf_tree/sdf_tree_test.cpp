@@ -1,17 +1,46 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <libresin/core/material.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/transform.hpp>
+#include <libresin/utils/exceptions.hpp>
 #include <optional>
 #include <print>
 #include <tests/glm_helper.hpp>
 
-class SDFTreeTest : public testing::Test {};
+class SDFTreeTest : public testing::Test {
+ protected:
+  class NodeCountVisitor : public resin::ISDFTreeNodeVisitor {
+   public:
+    void visit_node(resin::SDFTreeNode& /*node*/) override { ++count; }
+
+    size_t count = 0;
+  };
+
+  static size_t node_count(resin::SDFTree& tree) {
+    NodeCountVisitor visitor;
+    tree.visit_all_nodes(visitor);
+    return visitor.count;
+  }
+
+  // Prefab of a group with a sphere and a cube
+  static resin::Prefab& add_prefab(resin::SDFTree& tree) {
+    resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+    builder.push_back_child<resin::SphereNode>(builder.root(), resin::SDFBinaryOperation::Union);
+    builder.push_back_child<resin::CubeNode>(builder.root(), resin::SDFBinaryOperation::Diff);
+    return tree.add_prefab(builder.build(), "prefab.amber");
+  }
+};
 
 TEST_F(SDFTreeTest, SDFShaderIsCorrectlyGenerated) {
   // given
@@ -454,3 +483,270 @@ TEST_F(SDFTreeTest, MaterialsAreProperlyDeletedFromTree) {
   ASSERT_EQ(tree.node(*it).material_id(), mat1);
   ASSERT_EQ(tree.node(*it).ancestor_material_id(), mat3);
 }
+
+TEST_F(SDFTreeTest, SubtreeBuiltInBulkIsCorrectlyLinked) {
+  // given
+  //       o
+  //    o     o
+  //  o   o o   o
+  //      o
+  resin::SDFTree tree;
+  auto mat1 = tree.add_material(resin::Material(glm::vec3(1.F))).material_id();
+  auto mat2 = tree.add_material(resin::Material(glm::vec3(1.F))).material_id();
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  auto& group1 = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Union);
+  group1.set_material(mat1);
+
+  resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+  auto& group2   = builder.push_back_child<resin::GroupNode>(builder.root(), resin::SDFBinaryOperation::Inter);
+  auto cube1_id  = builder.push_back_child<resin::CubeNode>(group2, resin::SDFBinaryOperation::Xor).node_id();
+  auto& group3   = builder.push_back_child<resin::GroupNode>(group2, resin::SDFBinaryOperation::Union);
+  auto& sphere1  = builder.push_back_child<resin::SphereNode>(group3, resin::SDFBinaryOperation::Diff);
+  auto& cube2    = builder.push_back_primitive(builder.root(), resin::SDFTreePrimitiveType::Cube,
+                                               resin::SDFBinaryOperation::Union);
+  auto root_id   = builder.root().node_id();
+  auto cube2_id  = cube2.node_id();
+  auto sphere_id = sphere1.node_id();
+  builder.set_material(group2, mat2);
+  builder.set_material(cube2, mat2);
+  tree.mark_primitives_clean();
+  tree.mark_node_attributes_clean();
+  tree.mark_clean();
+
+  // when
+  group1.push_back_child(builder.build());
+
+  // then
+  ASSERT_EQ(tree.group(root_id).primitives().size(), 3);
+  ASSERT_EQ(group2.primitives().size(), 2);
+  ASSERT_TRUE(group2.primitives().contains(cube1_id));
+  ASSERT_TRUE(group2.primitives().contains(sphere_id));
+  ASSERT_EQ(group3.primitives().size(), 1);
+  ASSERT_EQ(group1.primitives().size(), 3);
+  ASSERT_EQ(tree.root().primitives().size(), 4);
+
+  ASSERT_EQ(tree.node(root_id).parent(), group1);
+  ASSERT_EQ(sphere1.parent(), group3);
+  ASSERT_EQ(group3.parent(), group2);
+
+  ASSERT_EQ(tree.node(root_id).active_material_id(), mat1);
+  ASSERT_EQ(group2.active_material_id(), mat2);
+  ASSERT_EQ(tree.node(cube1_id).ancestor_material_id(), mat2);
+  ASSERT_EQ(sphere1.ancestor_material_id(), mat2);
+  ASSERT_EQ(cube2.material_id(), mat2);
+  ASSERT_EQ(cube2.ancestor_material_id(), mat1);
+
+  ASSERT_TRUE(tree.is_dirty());
+  ASSERT_EQ(tree.dirty_primitives().size(), 3);
+  ASSERT_TRUE(tree.dirty_primitives().contains(cube2_id));
+  ASSERT_TRUE(tree.dirty_node_attributes().contains(sphere_id));
+}
+
+TEST_F(SDFTreeTest, PrefabReferencesShareTheContent) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab = add_prefab(tree);
+  tree.root().push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  const size_t count_before = node_count(tree);
+
+  // when
+  for (int i = 0; i < 3; ++i) {
+    tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab);
+  }
+
+  // then
+  ASSERT_EQ(node_count(tree), count_before + 3);
+  ASSERT_EQ(prefab.reference_count(), 3);
+  ASSERT_EQ(tree.root().primitives().size(), 4);
+  ASSERT_EQ(tree.find_prefab("prefab.amber")->get().prefab_id(), prefab.prefab_id());
+
+  const std::string code      = tree.gen_shader_code();
+  const std::string functions = tree.gen_shader_functions();
+  ASSERT_EQ(functions.find("sdf_result sdPrefab0("), 0);
+  size_t calls = 0;
+  for (size_t pos = code.find("sdPrefab0("); pos != std::string::npos; pos = code.find("sdPrefab0(", pos + 1)) {
+    ++calls;
+  }
+  ASSERT_EQ(calls, 3);
+  ASSERT_EQ(functions.find("sdf_result", 1), std::string::npos);
+}
+
+TEST_F(SDFTreeTest, UnreferencedPrefabsAreDeleted) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab      = add_prefab(tree);
+  auto reference_id = tree.root()
+                          .push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab)
+                          .node_id();
+  tree.delete_unused_prefabs();
+  ASSERT_EQ(tree.prefabs().size(), 1);
+
+  // when
+  tree.delete_node(reference_id);
+  tree.delete_unused_prefabs();
+
+  // then
+  ASSERT_TRUE(tree.prefabs().empty());
+  ASSERT_TRUE(tree.gen_shader_functions().empty());
+  ASSERT_FALSE(tree.find_prefab("prefab.amber").has_value());
+}
+
+TEST_F(SDFTreeTest, ExpandedPrefabReferenceHoldsACopyOfTheContent) {
+  // given
+  resin::SDFTree tree;
+  auto mat          = tree.add_material(resin::Material(glm::vec3(1.F))).material_id();
+  auto& prefab      = add_prefab(tree);
+  auto& reference   = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Inter, prefab);
+  auto reference_id = reference.node_id();
+  reference.rename("instance");
+  reference.set_material(mat);
+  reference.transform().set_local_scale(2.0F);
+
+  // when
+  auto& group = tree.expand_prefab_reference(reference_id);
+
+  // then
+  ASSERT_TRUE(reference_id.expired());
+  ASSERT_EQ(prefab.reference_count(), 0);
+  ASSERT_EQ(tree.root().get_children_count(), 1);
+  ASSERT_EQ(group.name(), "instance");
+  ASSERT_EQ(group.bin_op(), resin::SDFBinaryOperation::Inter);
+  ASSERT_EQ(group.material_id(), mat);
+  ASSERT_FLOAT_EQ(group.transform().local_scale(), 2.0F);
+  ASSERT_EQ(group.get_children_count(), 1);
+  ASSERT_EQ(group.primitives().size(), 2);
+  ASSERT_EQ(tree.root().primitives().size(), 2);
+  for (auto prim : group.primitives()) {
+    ASSERT_FALSE(prefab.root().primitives().contains(prim));
+    ASSERT_EQ(tree.node(prim).ancestor_material_id(), mat);
+  }
+}
+
+TEST_F(SDFTreeTest, NestedPrefabReferencesAreRejected) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab = add_prefab(tree);
+  resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+  builder.push_back_child<resin::PrefabReferenceNode>(builder.root(), resin::SDFBinaryOperation::Union, prefab);
+  auto content = builder.build();
+
+  // when
+  // then
+  ASSERT_THROW(tree.add_prefab(std::move(content)), resin::NestedPrefabReferenceException);
+  ASSERT_EQ(tree.prefabs().size(), 1);
+}
+
+TEST_F(SDFTreeTest, RepetitionFoldsTheCopiesOntoTheContent) {
+  // given
+  const resin::Repetition grid{
+      .type = resin::RepetitionType::Grid, .spacing = glm::vec3(2.0F, 1.0F, 3.0F), .count = glm::uvec3(3, 1, 2)};
+  const resin::Repetition polar{.type = resin::RepetitionType::Polar, .count = glm::uvec3(6, 1, 1)};
+  const glm::vec3 content_pos(0.1F, 0.2F, -0.3F);
+  ASSERT_EQ(grid.instance_count(), 6);
+  ASSERT_EQ(polar.instance_count(), 6);
+
+  // when
+  // then
+  for (size_t i = 0; i < 6; ++i) {
+    const glm::vec3 grid_pos = glm::vec3(grid.instance_matrix(i) * glm::vec4(content_pos, 1.0F));
+    ASSERT_GLM_VEC_NEAR(grid.fold(grid_pos), content_pos, 1e-5F);
+
+    const glm::vec3 polar_content_pos = content_pos + glm::vec3(1.0F, 0.0F, 0.0F);
+    const glm::vec3 polar_pos         = glm::vec3(polar.instance_matrix(i) * glm::vec4(polar_content_pos, 1.0F));
+    ASSERT_GLM_VEC_NEAR(polar.fold(polar_pos), polar_content_pos, 1e-5F);
+  }
+
+  // The points outside of the grid belong to the nearest copy on its border
+  ASSERT_GLM_VEC_NEAR(grid.fold(glm::vec3(100.0F, 0.0F, 1.5F)), glm::vec3(98.0F, 0.0F, 0.0F), 1e-5F);
+}
+
+TEST_F(SDFTreeTest, RepeatedPrefabReferenceEvaluatesTheContentOnce) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab    = add_prefab(tree);
+  auto& reference = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab);
+  const size_t count_before = node_count(tree);
+
+  // when
+  reference.set_repetition({.type = resin::RepetitionType::Grid, .count = glm::uvec3(100, 10, 10)});
+
+  // then
+  ASSERT_EQ(node_count(tree), count_before);
+  ASSERT_EQ(reference.repetition().instance_count(), 10000);
+
+  const std::string code = tree.gen_shader_code();
+  ASSERT_NE(code.find("opRepeatGrid("), std::string::npos);
+  ASSERT_EQ(code.find("sdPrefab0("), code.rfind("sdPrefab0("));
+}
+
+TEST_F(SDFTreeTest, ExpandedRepeatedPrefabReferenceHoldsACopyPerInstance) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab    = add_prefab(tree);
+  auto& reference = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab);
+  reference.set_repetition({.type = resin::RepetitionType::Polar, .count = glm::uvec3(4, 1, 1)});
+
+  // when
+  auto& group = tree.expand_prefab_reference(reference.node_id());
+
+  // then
+  ASSERT_EQ(group.get_children_count(), 4);
+  ASSERT_EQ(group.primitives().size(), 8);
+  auto& instance = group.get_child(*std::next(group.begin()));
+  ASSERT_EQ(instance.name(), resin::PrefabReferenceNode::instance_group_name(1));
+  ASSERT_GLM_VEC_NEAR(instance.transform().local_pos(), glm::vec3(0.0F), 1e-5F);
+}
+
+TEST_F(SDFTreeTest, ExpandingTooManyCopiesLeavesTheReference) {
+  // given
+  resin::SDFTree tree;
+  auto& prefab      = add_prefab(tree);
+  auto& reference   = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Union, prefab);
+  auto reference_id = reference.node_id();
+  reference.set_repetition({.type = resin::RepetitionType::Grid, .count = glm::uvec3(5, 5, 2)});
+  const size_t count_before = node_count(tree);
+
+  // when
+  // then
+  ASSERT_GT(reference.repetition().instance_count() * 4, tree.max_node_count());
+  ASSERT_THROW(tree.expand_prefab_reference(reference_id), resin::ObjectsOverflowException);
+  ASSERT_FALSE(reference_id.expired());
+  ASSERT_EQ(node_count(tree), count_before);
+  ASSERT_EQ(tree.root().get_children_count(), 1);
+  ASSERT_EQ(prefab.reference_count(), 1);
+
+  reference.set_repetition({.type = resin::RepetitionType::Grid, .count = glm::uvec3(2, 2, 1)});
+  ASSERT_EQ(tree.expand_prefab_reference(reference_id).get_children_count(), 4);
+}
+
+TEST_F(SDFTreeTest, GroupIsReplacedWithAnInstance) {
+  // given
+  resin::SDFTree tree;
+  auto mat    = tree.add_material(resin::Material(glm::vec3(1.F))).material_id();
+  auto& group = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Diff);
+  group.rename("bolt");
+  group.set_material(mat);
+  group.transform().set_local_scale(2.0F);
+  group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+  group.push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Union);
+  tree.root().push_back_child<resin::TorusNode>(resin::SDFBinaryOperation::Union);
+  auto group_id = group.node_id();
+
+  // when
+  auto& reference = tree.instance_group(group_id);
+
+  // then
+  ASSERT_EQ(tree.root().get_children_count(), 2);
+  ASSERT_EQ(*tree.root().begin(), reference.node_id());
+  ASSERT_EQ(reference.name(), "bolt");
+  ASSERT_EQ(reference.bin_op(), resin::SDFBinaryOperation::Diff);
+  ASSERT_FLOAT_EQ(reference.transform().local_scale(), 2.0F);
+  ASSERT_EQ(tree.prefabs().size(), 1);
+  ASSERT_EQ(reference.prefab().reference_count(), 1);
+  ASSERT_EQ(reference.prefab().root().primitives().size(), 2);
+  ASSERT_EQ(reference.prefab().root().bin_op(), resin::SDFBinaryOperation::Union);
+  ASSERT_FLOAT_EQ(reference.prefab().root().transform().local_scale(), 1.0F);
+  ASSERT_EQ(reference.prefab().root().material_id(), mat);
+  ASSERT_NE(tree.gen_shader_code().find("sdPrefab0("), std::string::npos);
+  ASSERT_THROW(tree.instance_group(tree.root().node_id()), resin::SDFTreeRootDeletionError);
+}
@@ -1,3 +1,5 @@
+#ifndef RESIN_TESTS_RANDOM_HELPER
+#define RESIN_TESTS_RANDOM_HELPER
 #include <glm/fwd.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -38,3 +40,5 @@ inline void randomize_material(resin::Material& material) {
   material.specularFactor   = random_float(0.0F, 1.0F);
   material.specularExponent = random_float(0.0F, 1.0F);
 }
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef RESIN_TESTS_SCENE_HELPER
+#define RESIN_TESTS_SCENE_HELPER
+#include <algorithm>
+#include <libresin/core/light.hpp>
+#include <libresin/core/material.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/utils/json.hpp>
+#include <nlohmann/json.hpp>
+#include <tests/random_helper.hpp>
+#include <vector>
+
+//        o
+//    o   o   o
+//  o o o   o o o
+//             o o o
+//
+inline void build_scene(resin::Scene& scene) {
+  scene.clear();
+  scene.add_light<resin::DirectionalLight>(random_vec3(0.0F, 1.0F), random_float(0.0F, 1.0F)).rename("dir");
+  scene
+      .add_light<resin::PointLight>(random_vec3(0.0F, 1.0F), random_vec3(),
+                                    resin::PointLight::Attenuation(random_float(0.0F, 1.0F), random_float(0.0F, 1.0F),
+                                                                   random_float(0.0F, 1.0F)))
+      .rename("point");
+
+  auto& tree = scene.tree();
+  auto& mat1 = tree.add_material(resin::Material(glm::vec3(1.F)));
+  auto& mat2 = tree.add_material(resin::Material(glm::vec3(1.F)));
+  randomize_material(mat1.material);
+  randomize_material(mat2.material);
+  mat2.rename("second");
+
+  auto& group1 = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::SmoothUnion);
+  group1.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union).radius = random_float(0.1F, 2.0F);
+  group1.push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Diff).size      = random_vec3(0.1F, 2.0F);
+  group1.push_back_child<resin::TorusNode>(resin::SDFBinaryOperation::Xor).set_material(mat2.material_id());
+  tree.root().push_back_child<resin::CapsuleNode>(resin::SDFBinaryOperation::Inter).set_factor(0.7F);
+
+  auto& group2 = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::SmoothDiff);
+  group2.set_material(mat1.material_id());
+  randomize_transform(group2.transform());
+  randomize_transform(group2.push_back_child<resin::LinkNode>(resin::SDFBinaryOperation::Union).transform());
+  group2.push_back_child<resin::EllipsoidNode>(resin::SDFBinaryOperation::Union).radii = random_vec3(0.1F, 2.0F);
+  auto& group3 = group2.push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::SmoothInter);
+  group3.rename("nested");
+  randomize_transform(group3.push_back_child<resin::PyramidNode>(resin::SDFBinaryOperation::Union).transform());
+  group3.push_back_child<resin::CylinderNode>(resin::SDFBinaryOperation::SmoothXor).radius        = 0.3F;
+  group3.push_back_child<resin::TriangularPrismNode>(resin::SDFBinaryOperation::Union).baseHeight = 0.2F;
+}
+
+// The lights are kept in a hash map, so their order in the files is not defined
+inline nlohmann::json normalized_scene_json(resin::Scene& scene) {
+  auto scene_json = nlohmann::json::parse(resin::json::serialize_scene(scene));
+  auto lights     = scene_json["lights"].get<std::vector<nlohmann::json>>();
+  std::ranges::sort(lights, [](const auto& a, const auto& b) { return a["name"] < b["name"]; });
+  scene_json["lights"] = lights;
+  return scene_json;
+}
+
+#endif
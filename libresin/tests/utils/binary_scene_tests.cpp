@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <libresin/core/material.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/binary_scene.hpp>
+#include <libresin/utils/exceptions.hpp>
+#include <libresin/utils/json.hpp>
+#include <libresin/utils/thread_pool.hpp>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <tests/random_helper.hpp>
+#include <tests/scene_helper.hpp>
+#include <utility>
+#include <vector>
+
+class BinarySceneTest : public testing::Test {
+ protected:
+  // Prefab of a group with a sphere and a cube referenced twice by the root, repeated on a grid by the first reference
+  // and around the Y axis by the second one
+  static void add_prefab_references(resin::SDFTree& tree) {
+    resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+    auto& root = builder.root();
+    root.rename("prefab");
+    builder.push_back_child<resin::SphereNode>(root, resin::SDFBinaryOperation::Union).radius = 0.5F;
+    builder.push_back_child<resin::CubeNode>(root, resin::SDFBinaryOperation::Diff).size      = random_vec3(0.1F, 2.0F);
+    auto& prefab = tree.add_prefab(builder.build(), "prefab.amber");
+    for (int i = 0; i < 2; ++i) {
+      auto& reference = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Xor, prefab);
+      randomize_transform(reference.transform());
+      reference.set_repetition(
+          i == 0 ? resin::Repetition{.type    = resin::RepetitionType::Grid,
+                                     .spacing = random_vec3(0.5F, 2.0F),
+                                     .count   = glm::uvec3(3, 1, 2)}
+                 : resin::Repetition{.type = resin::RepetitionType::Polar, .count = glm::uvec3(6, 1, 1)});
+    }
+  }
+};
+
+TEST_F(BinarySceneTest, SceneRoundTripsLosslessly) {
+  // given
+  resin::Scene scene1;
+  build_scene(scene1);
+
+  // when
+  const std::vector<uint8_t> data = resin::binary::serialize_scene(scene1);
+  resin::Scene scene2;
+  resin::binary::deserialize_scene(scene2, data);
+
+  // then
+  ASSERT_TRUE(resin::binary::is_binary_scene(data));
+  EXPECT_EQ(normalized_scene_json(scene2), normalized_scene_json(scene1));
+  EXPECT_EQ(resin::binary::serialize_scene(scene2).size(), data.size());
+}
+
+TEST_F(BinarySceneTest, JSONSceneConvertsToBinaryAndBack) {
+  // given
+  resin::Scene original;
+  build_scene(original);
+  const std::string json_str = resin::json::serialize_scene(original);
+
+  // when
+  resin::Scene from_json;
+  resin::json::deserialize_scene(from_json, json_str);
+  const std::vector<uint8_t> data = resin::binary::serialize_scene(from_json);
+  resin::Scene from_binary;
+  resin::binary::deserialize_scene(from_binary, data);
+
+  // then
+  EXPECT_FALSE(resin::binary::is_binary_scene(
+      std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(json_str.data()), json_str.size())));  // NOLINT
+  EXPECT_EQ(normalized_scene_json(from_binary), normalized_scene_json(from_json));
+}
+
+TEST_F(BinarySceneTest, ConcurrentLoadsMatchTheSerialOnes) {
+  // given
+  resin::Scene original;
+  build_scene(original);
+  const std::string json_str      = resin::json::serialize_scene(original);
+  const std::vector<uint8_t> data = resin::binary::serialize_scene(original);
+  resin::ThreadPool pool(4);
+
+  // when
+  resin::Scene from_json;
+  resin::json::deserialize_scene(from_json, json_str, &pool);
+  resin::Scene from_binary;
+  resin::binary::deserialize_scene(from_binary, data, &pool);
+
+  // then
+  const nlohmann::json expected = normalized_scene_json(original);
+  EXPECT_EQ(normalized_scene_json(from_json), expected);
+  EXPECT_EQ(normalized_scene_json(from_binary), expected);
+  EXPECT_EQ(from_binary.tree().root().get_children_count(), original.tree().root().get_children_count());
+}
+
+TEST_F(BinarySceneTest, PrefabReferencesRoundTrip) {
+  // given
+  resin::Scene original;
+  build_scene(original);
+  add_prefab_references(original.tree());
+  const std::vector<uint8_t> data = resin::binary::serialize_scene(original);
+  resin::ThreadPool pool(4);
+
+  // when
+  resin::Scene serial;
+  resin::binary::deserialize_scene(serial, data);
+  resin::Scene concurrent;
+  resin::binary::deserialize_scene(concurrent, data, &pool);
+
+  // then
+  const nlohmann::json expected = normalized_scene_json(original);
+  EXPECT_EQ(normalized_scene_json(serial), expected);
+  EXPECT_EQ(normalized_scene_json(concurrent), expected);
+  ASSERT_EQ(serial.tree().prefabs().size(), 1);
+  EXPECT_EQ(serial.tree().prefab(serial.tree().prefabs().front()).reference_count(), 2);
+}
+
+TEST_F(BinarySceneTest, PrefabKeepsOnlyUsedMaterials) {
+  // given
+  resin::SDFTree tree;
+  auto& used   = tree.add_material(resin::Material(glm::vec3(0.1F, 0.2F, 0.3F)));
+  auto& unused = tree.add_material(resin::Material(glm::vec3(1.F)));
+  unused.rename("unused");
+  auto& group = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Union);
+  group.rename("prefab");
+  group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union).set_material(used.material_id());
+  group.push_back_child<resin::CubeNode>(resin::SDFBinaryOperation::Xor);
+
+  // when
+  const std::vector<uint8_t> data = resin::binary::serialize_prefab(tree, group.node_id());
+  resin::SDFTree loaded_tree;
+  auto prefab = resin::binary::deserialize_prefab(loaded_tree, data);
+
+  // then
+  ASSERT_EQ(loaded_tree.materials().size(), 1);
+  EXPECT_EQ(loaded_tree.material(loaded_tree.materials().front()).material.albedo, used.material.albedo);
+  EXPECT_EQ(prefab->name(), "prefab");
+  ASSERT_EQ(prefab->get_children_count(), 2);
+
+  auto& sphere = prefab->get_child(*prefab->begin());
+  EXPECT_EQ(sphere.material_id(), loaded_tree.materials().front());
+  EXPECT_EQ(prefab->get_child(*std::next(prefab->begin())).bin_op(), resin::SDFBinaryOperation::Xor);
+}
+
+TEST_F(BinarySceneTest, CorruptedSceneIsRejectedAndKeepsTheCurrentScene) {
+  // given
+  resin::Scene scene1;
+  build_scene(scene1);
+  std::vector<uint8_t> truncated = resin::binary::serialize_scene(scene1);
+  truncated.resize(truncated.size() - 1);
+  std::vector<uint8_t> bad_version = resin::binary::serialize_scene(scene1);
+  bad_version[4]                   = 0xFF;
+
+  // The last records are corrupted, so that everything before them would be read
+  const auto corrupt = [&scene1](const auto& edit) {
+    resin::binary::SceneTables tables = resin::binary::decode_scene_tables(resin::binary::serialize_scene(scene1));
+    edit(tables);
+    return resin::binary::encode_scene_tables(std::move(tables));
+  };
+  std::vector<std::vector<uint8_t>> corrupted_records = {
+      corrupt([](auto& tables) { tables.nodes.back().parent = static_cast<uint32_t>(tables.nodes.size()); }),
+      corrupt([](auto& tables) { tables.nodes.back().parent = 2; }),  // the sphere of the first group
+      corrupt([](auto& tables) { tables.nodes.back().type = 200; }),
+      corrupt([](auto& tables) { tables.nodes.back().bin_op = 200; }),
+      corrupt([](auto& tables) { tables.nodes.back().material_id = 12345; }),
+      corrupt([](auto& tables) { tables.lights.back().type = 200; }),
+  };
+
+  // The name of the last light starts at the end of the string table
+  std::vector<uint8_t>& bad_name = corrupted_records.emplace_back(resin::binary::serialize_scene(scene1));
+  resin::binary::Header header{};
+  std::memcpy(&header, bad_name.data(), sizeof(header));
+  const size_t last_light = bad_name.size() - header.string_table_size - sizeof(resin::binary::LightRecord);
+  std::memcpy(bad_name.data() + last_light + offsetof(resin::binary::LightRecord, name), &header.string_table_size,
+              sizeof(header.string_table_size));
+
+  resin::Scene scene2;
+  build_scene(scene2);
+  const nlohmann::json expected = normalized_scene_json(scene2);
+
+  // when
+  // then
+  EXPECT_THROW(resin::binary::deserialize_scene(scene2, truncated), resin::BinarySceneDeserializationException);
+  EXPECT_THROW(resin::binary::deserialize_scene(scene2, bad_version), resin::BinarySceneDeserializationException);
+  for (const auto& data : corrupted_records) {
+    EXPECT_THROW(resin::binary::deserialize_scene(scene2, data), resin::BinarySceneDeserializationException);
+  }
+  EXPECT_EQ(normalized_scene_json(scene2), expected);
+}
+
+// Not a correctness test, run with --gtest_also_run_disabled_tests to compare the formats
+TEST_F(BinarySceneTest, DISABLED_SaveLoadBenchmark) {
+  using clock                   = std::chrono::steady_clock;
+  static constexpr int kRepeats = 200;
+
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  for (int i = 0; i < 6; ++i) {
+    auto& group = scene.tree().root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Union);
+    for (int j = 0; j < 10; ++j) {
+      randomize_transform(group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union).transform());
+    }
+  }
+
+  const auto measure = [](const auto& function) {
+    const auto start = clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+      function();
+    }
+    return std::chrono::duration<double, std::micro>(clock::now() - start).count() / kRepeats;
+  };
+
+  // when
+  const std::string json_str      = resin::json::serialize_scene(scene);
+  const std::vector<uint8_t> data = resin::binary::serialize_scene(scene);
+  resin::Scene loaded;
+
+  const double json_save   = measure([&scene]() { (void)resin::json::serialize_scene(scene); });
+  const double binary_save = measure([&scene]() { (void)resin::binary::serialize_scene(scene); });
+  const double json_load   = measure([&]() { resin::json::deserialize_scene(loaded, json_str); });
+  const double binary_load = measure([&]() { resin::binary::deserialize_scene(loaded, data); });
+
+  // then
+  std::cout << std::format("JSON:   {} bytes, save {:.1f} us, load {:.1f} us\n", json_str.size(), json_save, json_load);
+  std::cout << std::format("Binary: {} bytes, save {:.1f} us, load {:.1f} us\n", data.size(), binary_save, binary_load);
+  EXPECT_LT(data.size(), json_str.size());
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <format>
+#include <libresin/core/material.hpp>
+#include <libresin/core/scene.hpp>
+#include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
+#include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
+#include <libresin/core/sdf_tree/sdf_subtree_builder.hpp>
+#include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/utils/exceptions.hpp>
+#include <libresin/utils/json.hpp>
+#include <libresin/utils/json_stream.hpp>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <tests/random_helper.hpp>
+#include <tests/scene_helper.hpp>
+#include <vector>
+
+class JSONStreamTest : public testing::Test {
+ protected:
+  // Prefab of a group with a sphere and a cube referenced twice by the root, repeated on a grid by the first reference
+  // and around the Y axis by the second one
+  static void add_prefab_references(resin::SDFTree& tree) {
+    resin::SDFSubtreeBuilder builder(tree.create_detached_node<resin::GroupNode>());
+    auto& root = builder.root();
+    root.rename("prefab");
+    builder.push_back_child<resin::SphereNode>(root, resin::SDFBinaryOperation::Union).radius = 0.5F;
+    builder.push_back_child<resin::CubeNode>(root, resin::SDFBinaryOperation::Diff).size      = random_vec3(0.1F, 2.0F);
+    auto& prefab = tree.add_prefab(builder.build(), "prefab.amber");
+    for (int i = 0; i < 2; ++i) {
+      auto& reference = tree.root().push_back_child<resin::PrefabReferenceNode>(resin::SDFBinaryOperation::Xor, prefab);
+      randomize_transform(reference.transform());
+      reference.set_repetition(
+          i == 0 ? resin::Repetition{.type    = resin::RepetitionType::Grid,
+                                     .spacing = random_vec3(0.5F, 2.0F),
+                                     .count   = glm::uvec3(3, 1, 2)}
+                 : resin::Repetition{.type = resin::RepetitionType::Polar, .count = glm::uvec3(6, 1, 1)});
+    }
+  }
+
+  // Prefab of a group with a single sphere, modified with the JSON patch operations
+  static nlohmann::json sphere_prefab_json(const nlohmann::json& patch = nlohmann::json::array()) {
+    resin::SDFTree tree;
+    auto& group = tree.root().push_back_child<resin::GroupNode>(resin::SDFBinaryOperation::Union);
+    group.push_back_child<resin::SphereNode>(resin::SDFBinaryOperation::Union);
+    return nlohmann::json::parse(resin::json::serialize_prefab(tree, group.node_id())).patch(patch);
+  }
+
+  static std::unique_ptr<resin::GroupNode> stream_prefab(resin::SDFTree& tree, const nlohmann::json& prefab_json) {
+    std::istringstream stream(prefab_json.dump());
+    return resin::json::stream_deserialize_prefab(tree, stream);
+  }
+};
+
+TEST_F(JSONStreamTest, StreamedSceneMatchesTheSavedOne) {
+  // given
+  resin::Scene scene1;
+  build_scene(scene1);
+  std::istringstream stream(resin::json::serialize_scene(scene1));
+
+  // when
+  resin::Scene scene2;
+  resin::json::stream_deserialize_scene(scene2, stream);
+
+  // then
+  EXPECT_EQ(normalized_scene_json(scene2), normalized_scene_json(scene1));
+}
+
+TEST_F(JSONStreamTest, StreamedPrefabReferencesMatchTheSavedOnes) {
+  // given
+  resin::Scene scene1;
+  build_scene(scene1);
+  add_prefab_references(scene1.tree());
+  std::istringstream stream(resin::json::serialize_scene(scene1));
+
+  // when
+  resin::Scene scene2;
+  resin::json::stream_deserialize_scene(scene2, stream);
+
+  // then
+  EXPECT_EQ(normalized_scene_json(scene2), normalized_scene_json(scene1));
+  ASSERT_EQ(scene2.tree().prefabs().size(), 1);
+  EXPECT_EQ(scene2.tree().prefab(scene2.tree().prefabs().front()).reference_count(), 2);
+}
+
+TEST_F(JSONStreamTest, NestedPrefabReferencesAreRejected) {
+  // given
+  resin::Scene scene;
+  build_scene(scene);
+  const size_t reference_index = scene.tree().root().get_children_count();
+  add_prefab_references(scene.tree());
+  const auto patch = nlohmann::json::parse(std::format(
+      R"([{{"op": "copy", "from": "/tree/rootGroup/group/children/{}",
+            "path": "/tree/prefabs/0/rootGroup/group/children/-"}}])",
+      reference_index));
+  std::istringstream stream(nlohmann::json::parse(resin::json::serialize_scene(scene)).patch(patch).dump());
+
+  // when
+  // then
+  resin::Scene loaded;
+  EXPECT_THROW(resin::json::stream_deserialize_scene(loaded, stream), resin::JSONDeserializationException);
+}
+
+TEST_F(JSONStreamTest, MaterialsDefinedAfterTheNodesAreResolved) {
+  // given
+  const std::string prefab_json_str = R"({
+    "version": 1,
+    "tree": {
+      "rootGroup": {
+        "name": "prefab", "binaryOperation": "union", "factor": 0.0, "materialId": 7,
+        "transform": {"position": {"x": 0, "y": 0, "z": 0}, "rotation": {"w": 1, "x": 0, "y": 0, "z": 0}, "scale": 1},
+        "group": {"children": [{
+          "name": "ball", "binaryOperation": "xor", "factor": 0.5,
+          "transform": {"position": {"x": 1, "y": 2, "z": 3}, "rotation": {"w": 1, "x": 0, "y": 0, "z": 0}, "scale": 2},
+          "sphere": {"radius": 4}
+        }]}
+      },
+      "materials": [{
+        "id": 7, "name": "late", "albedo": {"r": 0.5, "g": 0.25, "b": 1.0},
+        "ambient": 0.1, "diffuse": 0.2, "specular": 0.3, "specularExponent": 8
+      }]
+    }
+  })";
+  std::istringstream stream(prefab_json_str);
+  resin::SDFTree tree;
+
+  // when
+  auto prefab = resin::json::stream_deserialize_prefab(tree, stream);
+
+  // then
+  ASSERT_TRUE(prefab->material_id().has_value());
+  EXPECT_EQ(tree.material(*prefab->material_id()).name(), "late");
+  EXPECT_EQ(prefab->name(), "prefab");
+  ASSERT_EQ(prefab->get_children_count(), 1);
+
+  auto& sphere = static_cast<resin::SphereNode&>(prefab->get_child(*prefab->begin()));  // NOLINT
+  EXPECT_EQ(sphere.name(), "ball");
+  EXPECT_EQ(sphere.bin_op(), resin::SDFBinaryOperation::Xor);
+  EXPECT_FLOAT_EQ(sphere.factor(), 0.5F);
+  EXPECT_FLOAT_EQ(sphere.radius, 4.0F);
+  EXPECT_FLOAT_EQ(sphere.transform().local_scale(), 2.0F);
+  EXPECT_EQ(sphere.active_material_id(), prefab->material_id());
+}
+
+TEST_F(JSONStreamTest, UnknownNodePropertiesAreIgnored) {
+  // given
+  const auto prefab_json = sphere_prefab_json(nlohmann::json::parse(R"([
+    {"op": "add", "path": "/tree/rootGroup/editor", "value": {"expanded": true, "tags": [1, "a", null]}},
+    {"op": "add", "path": "/tree/rootGroup/group/children/0/tag", "value": "ignored"}
+  ])"));
+  resin::SDFTree tree;
+
+  // when
+  // then
+  EXPECT_NO_THROW({ auto prefab = stream_prefab(tree, prefab_json); });
+}
+
+TEST_F(JSONStreamTest, SchemaViolationsAreRejected) {
+  // given
+  const std::vector<std::string> patches = {
+      // negative radius
+      R"([{"op": "replace", "path": "/tree/rootGroup/group/children/0/sphere/radius", "value": -1.0}])",
+      // unknown transform property
+      R"([{"op": "add", "path": "/tree/rootGroup/transform/skew", "value": 0.0}])",
+      // missing name
+      R"([{"op": "remove", "path": "/tree/rootGroup/group/children/0/name"}])",
+      // more than one node type
+      R"([{"op": "add", "path": "/tree/rootGroup/group/children/0/pyramid", "value": {"height": 1.0}}])",
+      // invalid binary operation
+      R"([{"op": "replace", "path": "/tree/rootGroup/binaryOperation", "value": "blend"}])",
+      // reference to a missing material
+      R"([{"op": "add", "path": "/tree/rootGroup/materialId", "value": 3}])",
+      // primitive root
+      R"([{"op": "move", "from": "/tree/rootGroup/group/children/0", "path": "/tree/rootGroup"}])",
+  };
+  resin::SDFTree tree;
+
+  // when
+  // then
+  for (const auto& patch : patches) {
+    EXPECT_THROW(stream_prefab(tree, sphere_prefab_json(nlohmann::json::parse(patch))),
+                 resin::JSONDeserializationException);
+  }
+}
+
+TEST_F(JSONStreamTest, MalformedSceneIsRejectedAndKeepsTheCurrentScene) {
+  // given
+  resin::Scene scene1;
+  build_scene(scene1);
+  std::string scene_json_str = resin::json::serialize_scene(scene1);
+  scene_json_str.resize(scene_json_str.size() / 2);
+  std::istringstream stream(scene_json_str);
+
+  resin::Scene scene2;
+  build_scene(scene2);
+  const nlohmann::json expected = normalized_scene_json(scene2);
+
+  // when
+  // then
+  EXPECT_THROW(resin::json::stream_deserialize_scene(scene2, stream), resin::InvalidJSONException);
+  EXPECT_EQ(normalized_scene_json(scene2), expected);
+}
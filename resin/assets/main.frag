@@ -15,6 +15,7 @@ uniform float u_farPlane;
 #include "blinn_phong.glsl"
 #include "sdf.glsl"
 #external_definition SDF_CODE
+#external_definition SDF_FUNCTIONS
 
 // rendering
 const vec3 u_Ambient = vec3(0.25,0.25,0.25);
@@ -22,6 +23,8 @@ const vec3 u_Ambient = vec3(0.25,0.25,0.25);
 uniform directional_light u_dirLight;
 uniform point_light u_pointLight;
 
+SDF_FUNCTIONS
+
 sdf_result map( vec3 pos )
 {
     return SDF_CODE;
@@ -1,13 +1,19 @@
-#version 330 core
+#version 430 core
 #include "blinn_phong.glsl"
+#external_definition MAX_UBO_MATERIAL_COUNT
 
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out int id;
 
 // fragment
 in vec2 v_Pos;
+flat in uint v_MaterialId;
 
-uniform material u_material;
+const int kMaxMaterialCount = MAX_UBO_MATERIAL_COUNT;
+layout (std140, binding = 2) uniform MaterialData 
+{
+    material u_sdf_materials[kMaxMaterialCount];
+};
 
 // https://raytracing.github.io/books/RayTracingInOneWeekend.html#surfacenormalsandmultipleobjects/simplifyingtheray-sphereintersectioncode
 float hit_sphere(vec3 center, float radius, vec3 ray) {
@@ -33,14 +39,15 @@ void main() {
     dir_light.dir = normalize(sphere_pos - vec3(1.0, 2.0, 0.5));
     dir_light.ambient_impact = 0.15;
 
+    material mat = u_sdf_materials[v_MaterialId];
     vec3 ray = normalize(vec3(v_Pos, -focal_length));
 
     float t = hit_sphere(sphere_pos, sphere_rad, ray);
     if (t > 0) {
         vec3 hit_point = ray * t;
         vec3 n = normalize(hit_point - sphere_pos);
-        vec3 col = calc_dir_light(dir_light, u_material, n, -ray) * u_material.albedo + 
-                    dir_light.ambient_impact * u_material.ka;
+        vec3 col = calc_dir_light(dir_light, mat, n, -ray) * mat.albedo + 
+                    dir_light.ambient_impact * mat.ka;
         fragColor = vec4(col, 1.0);
     }
     else {
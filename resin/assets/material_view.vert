@@ -0,0 +1,21 @@
+#version 430 core
+#external_definition MATERIAL_BATCH_SIZE
+
+layout(location = 0) in vec3 a_Position;
+
+// Raw ids of the materials drawn by the instances, the material with the raw id i is drawn into the tile i of the atlas
+uniform uint u_materialIds[MATERIAL_BATCH_SIZE];
+uniform uint u_columns;
+uniform vec2 u_tileSize; // in NDC
+
+out vec2 v_Pos;
+flat out uint v_MaterialId;
+
+void main() {
+    uint mat_id = u_materialIds[gl_InstanceID];
+    vec2 tile = vec2(mat_id % u_columns, mat_id / u_columns);
+
+    v_Pos = a_Position.xy;
+    v_MaterialId = mat_id;
+    gl_Position = vec4((tile + a_Position.xy * 0.5 + 0.5) * u_tileSize - 1.0, 0.0, 1.0);
+}
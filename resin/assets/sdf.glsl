@@ -16,6 +16,7 @@ struct sdf_result {
     material mat;
     float dist;
     int id;
+    int mat_id; // material of the primitive closest to the surface, blended materials only affect mat
 };
 
 const int kMaxNodeCount = MAX_UBO_NODE_COUNT;
@@ -45,6 +46,33 @@ void prepare(inout sdf_result res, inout vec3 pos, int node_id, int primitive_id
     pos = (u_sdf_primitives[primitive_id].transform * vec4(pos,1)).xyz;
     res.mat = u_sdf_materials[u_sdf_primitives[primitive_id].mat_id];
     res.id = node_id;
+    res.mat_id = u_sdf_primitives[primitive_id].mat_id;
+}
+
+vec3 instancePos(vec3 pos, int primitive_id) {
+    return (u_sdf_primitives[primitive_id].transform * vec4(pos,1)).xyz;
+}
+
+sdf_result opInstance(sdf_result res, int node_id) {
+    res.id = node_id;
+    return opScale(res, node_id);
+}
+
+// Folds the position into the nearest copy of the grid, the spacing is stored in the size of the instance
+vec3 opRepeatGrid(vec3 pos, int primitive_id, vec3 count) {
+    vec3 spacing = u_sdf_primitives[primitive_id].size;
+    vec3 offset = 0.5*(count - 1.0);
+    vec3 cell = clamp(round(pos/max(spacing, 1e-6) + offset), vec3(0.0), count - 1.0) - offset;
+    return pos - spacing*cell;
+}
+
+// Folds the position into the nearest copy rotated around the Y axis
+vec3 opRepeatPolar(vec3 pos, float count) {
+    float sector = 6.28318530718/count;
+    float angle = sector*round(atan(pos.z, pos.x)/sector);
+    float c = cos(angle);
+    float s = sin(angle);
+    return vec3(c*pos.x + s*pos.z, pos.y, c*pos.z - s*pos.x);
 }
 
 sdf_result sdEmpty()
@@ -187,7 +215,7 @@ sdf_result opUnion(sdf_result d1, sdf_result d2) // FIXME(SDF-117)
 sdf_result opDiff(sdf_result d1, sdf_result d2) // FIXME(SDF-117)
 {
     d2.dist -= 0.001; // prevent rendering ultra-thin regions
-	return (d1.dist>-d2.dist) ? d1 : sdf_result(d2.mat, -d2.dist, d2.id);
+	return (d1.dist>-d2.dist) ? d1 : sdf_result(d2.mat, -d2.dist, d2.id, d2.mat_id);
 } 
 
 sdf_result opInter(sdf_result d1, sdf_result d2) // FIXME(SDF-117)
@@ -222,6 +250,7 @@ sdf_result opSmoothUnion(sdf_result d1, sdf_result d2, int node_id)
     result.mat = material_mix(d1.mat, d2.mat, clamp(0.5+0.75*(d1.dist-d2.dist)/k, 0.0, 1.0)); // TODO(SDF-157): optimize math?
     result.dist = smooth_min(d1.dist,d2.dist,k); 
     result.id = d1.dist < d2.dist ? d1.id : d2.id;
+    result.mat_id = d1.dist < d2.dist ? d1.mat_id : d2.mat_id;
     return result;
 }
 
@@ -232,6 +261,7 @@ sdf_result opSmoothDiff(sdf_result d1, sdf_result d2, int node_id)
     result.mat = material_mix(d1.mat, d2.mat, clamp(0.5-0.75*(d1.dist+d2.dist)/k, 0.0, 1.0)); // TODO(SDF-157): optimize math?
     result.dist = smooth_max(d1.dist,-d2.dist,k); 
     result.id = d1.dist > -d2.dist ? d1.id : d2.id;
+    result.mat_id = d1.dist > -d2.dist ? d1.mat_id : d2.mat_id;
     return result;
 }
 
@@ -242,6 +272,7 @@ sdf_result opSmoothInter(sdf_result d1, sdf_result d2, int node_id)
     result.mat = material_mix(d1.mat, d2.mat, clamp(0.5-0.75*(d1.dist-d2.dist)/k, 0.0, 1.0)); // TODO(SDF-157): optimize math?
     result.dist = smooth_max(d1.dist,d2.dist,k); 
     result.id = d1.dist > d2.dist ? d1.id : d2.id;
+    result.mat_id = d1.dist > d2.dist ? d1.mat_id : d2.mat_id;
     return result;
 }
 
@@ -3,7 +3,10 @@
 #include <libresin/core/sdf_tree/group_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/utils/binary_scene.hpp>
 #include <libresin/utils/json.hpp>
+#include <libresin/utils/json_stream.hpp>
+#include <libresin/utils/thread_pool.hpp>
 #include <resin/dialog/file_dialog.hpp>
 #include <resin/imgui/main_menu_bar.hpp>
 #include <resin/imgui/modals.hpp>
@@ -14,10 +17,13 @@ namespace resin {
 static const std::array<::resin::FileDialog::FilterItem, 1> kPrefabFiltersArray = {
     ::resin::FileDialog::FilterItem("Resin prefab", "amber")};
 
-static const std::array<::resin::FileDialog::FilterItem, 1> kResinFiltersArray = {
-    ::resin::FileDialog::FilterItem("Resin project", "resin")};
+static const std::array<::resin::FileDialog::FilterItem, 2> kResinFiltersArray = {
+    ::resin::FileDialog::FilterItem("Resin project", "resin"),
+    ::resin::FileDialog::FilterItem("Resin binary project", "resinb")};
 
-void MainMenuBar(LazyMaterialImageFramebuffers& material_img_fbs, ::resin::Scene& scene) {
+static constexpr std::string_view kBinarySceneExtension = ".resinb";
+
+void MainMenuBar(MaterialPreviewAtlas& material_atlas, ::resin::Scene& scene, ::resin::ThreadPool& thread_pool) {
   bool open_new_modal   = false;
   bool open_scene_modal = false;
   if (ImGui::BeginMainMenuBar()) {
@@ -30,14 +36,21 @@ void MainMenuBar(LazyMaterialImageFramebuffers& material_img_fbs, ::resin::Scene
     if (ImGui::MenuItem("Save As...")) {
       ::resin::FileDialog::instance().save_file(
           [&scene](const std::filesystem::path& path) {
-            std::ofstream file(path);
+            const bool is_binary = path.extension() == kBinarySceneExtension;
+            std::ofstream file(path, is_binary ? std::ios::binary : std::ios::out);
             if (!file.is_open()) {
               ::resin::Logger::warn("Could not save to path {}", path.string());
               return;
             }
             scene.tree().root().rename(std::format("{}", path.stem().string()));
             try {
-              file << ::resin::json::serialize_scene(scene);
+              if (is_binary) {
+                const std::vector<uint8_t> data = ::resin::binary::serialize_scene(scene);
+                file.write(reinterpret_cast<const char*>(data.data()),  // NOLINT
+                           static_cast<std::streamsize>(data.size()));
+              } else {
+                file << ::resin::json::serialize_scene(scene);
+              }
               ::resin::Logger::info("Saved scene to {}", path.string());
             } catch (...) {
               ::resin::Logger::err("Could not save scene to {}", path.string());
@@ -75,7 +88,7 @@ void MainMenuBar(LazyMaterialImageFramebuffers& material_img_fbs, ::resin::Scene
                            "Are you sure you want to create a new scene? Any unsaved progress will be lost.", "Create",
                            "Cancel")) {
     scene.set_default();
-    material_img_fbs.reset();
+    material_atlas.reset();
 
     ::resin::Logger::info("New scene created");
   }
@@ -87,26 +100,29 @@ void MainMenuBar(LazyMaterialImageFramebuffers& material_img_fbs, ::resin::Scene
   if (MessageOkCancelModal("Open Scene", "Are you sure you want to open a scene? Any unsaved progress will be lost.",
                            "Open", "Cancel")) {
     ::resin::FileDialog::instance().open_file(
-        [&scene, &material_img_fbs](const std::filesystem::path& path) {
-          std::string json_content;
-          std::ifstream file(path);
+        [&scene, &material_atlas, &thread_pool](const std::filesystem::path& path) {
+          std::ifstream file(path, std::ios::binary);
           if (!file.is_open()) {
             ::resin::Logger::err("Could not open a file with path {}", path.string());
             return;
           }
 
-          std::ostringstream ss;
-          ss << file.rdbuf();
-          json_content = ss.str();
-
           try {
-            ::resin::json::deserialize_scene(scene, json_content);
+            // The binary files are recognized by their magic, whatever their extension is. The JSON ones are streamed,
+            // so that their contents are never held in memory as a whole. The subtrees of the binary ones are built
+            // concurrently.
+            if (::resin::binary::is_binary_scene(file)) {
+              const std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+              ::resin::binary::deserialize_scene(scene, data, &thread_pool);
+            } else {
+              ::resin::json::stream_deserialize_scene(scene, file);
+            }
             ::resin::Logger::info("Loaded scene from {}", path.string());
           } catch (...) {
             ::resin::Logger::err("Could not load scene from {}", path.string());
           }
 
-          material_img_fbs.reset();
+          material_atlas.reset();
         },
         std::span<const ::resin::FileDialog::FilterItem>(kResinFiltersArray));
   }
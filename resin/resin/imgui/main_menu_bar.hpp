@@ -5,12 +5,14 @@
 
 namespace resin {
 class Scene;
+class ThreadPool;
 }
 
 namespace ImGui {
 namespace resin {
 
-void MainMenuBar(LazyMaterialImageFramebuffers& material_img_fbs, ::resin::Scene& scene);
+// The subtrees of the binary scenes are built on `thread_pool`.
+void MainMenuBar(MaterialPreviewAtlas& material_atlas, ::resin::Scene& scene, ::resin::ThreadPool& thread_pool);
 
 }  // namespace resin
 
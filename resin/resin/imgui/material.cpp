@@ -1,24 +1,86 @@
 #include <GLFW/glfw3.h>
+#include <glad/gl.h>
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 
 #include <libresin/core/framebuffer.hpp>
 #include <libresin/core/id_registry.hpp>
 #include <libresin/core/material.hpp>
-#include <libresin/core/raycaster.hpp>
 #include <libresin/utils/logger.hpp>
-#include <memory>
 #include <resin/imgui/dnd_payloads.hpp>
 #include <resin/imgui/material.hpp>
 #include <resin/imgui/modals.hpp>
-#include <resin/imgui/types.hpp>
 
 namespace ImGui {
 
 namespace resin {
 
+MaterialPreviewAtlas::MaterialPreviewAtlas(size_t tile_size, size_t columns)
+    : fb_(tile_size * columns, tile_size),
+      tile_size_(tile_size),
+      columns_(columns),
+      rows_(1),
+      is_reset_(true) {
+  // The tiles are usually shown smaller than they are rendered
+  glBindTexture(GL_TEXTURE_2D, fb_.color_texture());
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+}
+
+void MaterialPreviewAtlas::reserve(size_t tile_count) {
+  if (fits(tile_count)) {
+    return;
+  }
+
+  while (columns_ * rows_ < tile_count) {
+    rows_ *= 2;
+  }
+  fb_.resize(tile_size_ * columns_, tile_size_ * rows_);
+
+  ::resin::Logger::info("Resized material preview atlas to {} tiles", columns_ * rows_);
+}
+
+void MaterialPreviewAtlas::clear() {
+  fb_.bind();
+  fb_.clear();
+  fb_.unbind();
+  is_reset_ = false;
+}
+
+void MaterialPreviewAtlas::upload_tile(size_t raw_id, std::span<const uint32_t> pixels) {
+  const auto x    = static_cast<GLint>((raw_id % columns_) * tile_size_);
+  const auto y    = static_cast<GLint>((raw_id / columns_) * tile_size_);
+  const auto size = static_cast<GLsizei>(tile_size_);
+
+  glBindTexture(GL_TEXTURE_2D, fb_.color_texture());
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+std::vector<uint32_t> MaterialPreviewAtlas::download_tile(size_t raw_id) {
+  const auto x    = static_cast<GLint>((raw_id % columns_) * tile_size_);
+  const auto y    = static_cast<GLint>((raw_id / columns_) * tile_size_);
+  const auto size = static_cast<GLsizei>(tile_size_);
+
+  std::vector<uint32_t> pixels(tile_size_ * tile_size_);
+  fb_.bind();
+  glReadPixels(x, y, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  fb_.unbind();
+  return pixels;
+}
+
+ImVec2 MaterialPreviewAtlas::uv_min(::resin::IdView<::resin::MaterialId> id) const {
+  const auto col = static_cast<float>(id.raw() % columns_);
+  const auto row = static_cast<float>(id.raw() / columns_);
+  return {col / static_cast<float>(columns_), (row + 1.0F) / static_cast<float>(rows_)};
+}
+
+ImVec2 MaterialPreviewAtlas::uv_max(::resin::IdView<::resin::MaterialId> id) const {
+  const auto col = static_cast<float>(id.raw() % columns_);
+  const auto row = static_cast<float>(id.raw() / columns_);
+  return {(col + 1.0F) / static_cast<float>(columns_), row / static_cast<float>(rows_)};
+}
+
 bool MaterialsList(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                   LazyMaterialImageFramebuffers& material_img_fbs, const ::resin::SDFTree& sdf_tree) {
+                   const MaterialPreviewAtlas& material_atlas, const ::resin::SDFTree& sdf_tree) {
   static const float kPadding = 6.0F;
 
   if (sdf_tree.materials().empty()) {
@@ -27,7 +89,7 @@ bool MaterialsList(std::optional<::resin::IdView<::resin::MaterialId>>& selected
 
   auto selected_new       = selected;
   bool is_any_mat_clicked = false;
-  const auto img_size     = static_cast<float>(material_img_fbs.material_preview_img_size);
+  const auto img_size     = static_cast<float>(kMaterialListPreviewSize);
   auto cols               = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / (2 * kPadding + img_size)));
 
   ImGui::BeginChild("ResizeableMaterialsList");
@@ -36,32 +98,17 @@ bool MaterialsList(std::optional<::resin::IdView<::resin::MaterialId>>& selected
     for (const auto& mat_id : sdf_tree.materials()) {
       ImGui::PushID(static_cast<int>(mat_id.raw()));
 
-      // Add missing material framebuffers to the preview map
-      auto it = material_img_fbs.material_preview_fbs_map.find(mat_id);
-      if (it == material_img_fbs.material_preview_fbs_map.end()) {
-        it = material_img_fbs               //
-                 .material_preview_fbs_map  //
-                 .emplace(mat_id,
-                          std::make_unique<LazyImageFramebuffer>(::resin::ImageFramebuffer(
-                              material_img_fbs.material_preview_img_size, material_img_fbs.material_preview_img_size)))
-                 .first;
-
-        it->second->mark_dirty();
-
-        ::resin::Logger::info("Added material image framebuffer for material with id {}", it->first.raw());
-      }
-
       bool is_selected = selected_new && *selected_new == mat_id;
       const auto& mat  = sdf_tree.material(mat_id);
 
       if (!is_selected) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImGui::GetColorU32(ImGuiCol_MenuBarBg));
       };
-      ImGui::ImageButton("##MaterialButton",                                     //
-                         (ImTextureID)(intptr_t)it->second->fb.color_texture(),  // NOLINT
-                         ImVec2(img_size, img_size),                             //
-                         ImVec2(0, 1),                                           //
-                         ImVec2(1, 0)                                            //
+      ImGui::ImageButton("##MaterialButton",             //
+                         material_atlas.texture(),       //
+                         ImVec2(img_size, img_size),     //
+                         material_atlas.uv_min(mat_id),  //
+                         material_atlas.uv_max(mat_id)   //
       );
 
       if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
@@ -96,21 +143,13 @@ bool MaterialsList(std::optional<::resin::IdView<::resin::MaterialId>>& selected
   }
   ImGui::EndChild();
 
-  // Remove outdated material framebuffers if the number of stored framebuffers exceeds twice the number of materials.
-  // This heuristic minimizes the number of framebuffer deletions and enables reusage of the already created
-  // framebuffers.
-  if (material_img_fbs.material_preview_fbs_map.size() >= 2 * sdf_tree.materials().size()) {
-    std::erase_if(material_img_fbs.material_preview_fbs_map, [](const auto& pair) { return pair.first.expired(); });
-    ::resin::Logger::info("Deleted obselete material framebuffers");
-  }
-
   bool edited = selected != selected_new;
   selected    = selected_new;
   return edited;
 }
 
 bool MaterialsListEdit(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                       LazyMaterialImageFramebuffers& material_img_fbs, ::resin::SDFTree& sdf_tree) {
+                       const MaterialPreviewAtlas& material_atlas, ::resin::SDFTree& sdf_tree) {
   auto selected_new = selected;
   bool edited       = false;
 
@@ -130,11 +169,7 @@ bool MaterialsListEdit(std::optional<::resin::IdView<::resin::MaterialId>>& sele
     edited = true;
   }
 
-  edited = MaterialsList(selected_new, material_img_fbs, sdf_tree) || edited;
-
-  if (selected_new && selected != selected_new) {
-    material_img_fbs.material_preview_fbs_map[*selected_new]->mark_dirty();
-  }
+  edited = MaterialsList(selected_new, material_atlas, sdf_tree) || edited;
 
   selected = selected_new;
 
@@ -142,22 +177,17 @@ bool MaterialsListEdit(std::optional<::resin::IdView<::resin::MaterialId>>& sele
 }
 
 bool MaterialEdit(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                  LazyMaterialImageFramebuffers& material_img_fbs, ::resin::SDFTree& sdf_tree) {
+                  const MaterialPreviewAtlas& material_atlas, ::resin::SDFTree& sdf_tree) {
   if (!selected || selected->expired()) {
     return false;
   }
 
-  if (selected != material_img_fbs.main_material_id) {
-    material_img_fbs.main_material_fb.mark_dirty();
-    material_img_fbs.main_material_id = *selected;
-  }
-
-  const auto img_size = static_cast<float>(material_img_fbs.main_material_fb.fb.width());
+  const auto img_size = static_cast<float>(kMaterialMainPreviewSize);
 
-  ImGui::Image((ImTextureID)(intptr_t)material_img_fbs.main_material_fb.fb.color_texture(),  // NOLINT
-               ImVec2(img_size, img_size),                                                   //
-               ImVec2(0, 1),                                                                 //
-               ImVec2(1, 0)                                                                  //
+  ImGui::Image(material_atlas.texture(),          //
+               ImVec2(img_size, img_size),        //
+               material_atlas.uv_min(*selected),  //
+               material_atlas.uv_max(*selected)   //
   );
 
   auto& mat = sdf_tree.material(*selected);
@@ -188,17 +218,7 @@ bool MaterialEdit(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
   edited      = ImGui::DragFloat("Exponent", &mat.material.specularExponent, 0.1F, 0.0F, 100.0F, "%.2f") || edited;
 
   if (edited) {
-    auto it = material_img_fbs.material_preview_fbs_map.find(*selected);
-    if (it != material_img_fbs.material_preview_fbs_map.end()) {
-      it->second->mark_dirty();
-    }
-
-    material_img_fbs.main_material_fb.mark_dirty();
-
-    if (material_img_fbs.node_material_preview_id == selected) {
-      material_img_fbs.node_material_preview_fb.mark_dirty();
-    }
-
+    // Updates the material uniform buffer and the preview in the atlas
     mat.mark_dirty();
   }
 
@@ -3,50 +3,76 @@
 
 #include <imgui/imgui.h>
 
+#include <cstdint>
 #include <libresin/core/framebuffer.hpp>
 #include <libresin/core/material.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/shader.hpp>
-#include <resin/imgui/types.hpp>
+#include <span>
+#include <unordered_set>
+#include <vector>
 
 namespace ImGui {
 
 namespace resin {
 
-using MaterialPreviewImageFramebuffersMap =
-    std::unordered_map<::resin::IdView<::resin::MaterialId>, std::unique_ptr<LazyImageFramebuffer>,
-                       ::resin::IdViewHash<::resin::MaterialId>, std::equal_to<>>;
-
-struct LazyMaterialImageFramebuffers {
-  explicit LazyMaterialImageFramebuffers(size_t node_material_preview_img_size, size_t main_material_img_size,
-                                         size_t _material_preview_img_size)
-      : node_material_preview_fb(LazyImageFramebuffer(
-            ::resin::ImageFramebuffer(node_material_preview_img_size, node_material_preview_img_size))),
-        main_material_fb(::resin::ImageFramebuffer(main_material_img_size, main_material_img_size)),
-        material_preview_img_size(_material_preview_img_size) {}
-
-  void reset() {
-    main_material_fb.mark_dirty();
-    material_preview_fbs_map.clear();
-    node_material_preview_fb.mark_dirty();
-  }
-
-  LazyImageFramebuffer node_material_preview_fb;
-  std::optional<::resin::IdView<::resin::MaterialId>> node_material_preview_id;
-  LazyImageFramebuffer main_material_fb;
-  std::optional<::resin::IdView<::resin::MaterialId>> main_material_id;
-  MaterialPreviewImageFramebuffersMap material_preview_fbs_map;
-  size_t material_preview_img_size;
+constexpr size_t kMaterialNodePreviewSize = 32;
+constexpr size_t kMaterialListPreviewSize = 64;
+constexpr size_t kMaterialMainPreviewSize = 160;
+
+// Previews of all materials rendered into the tiles of a single framebuffer. The material with the raw id `i` owns the
+// tile `i` (row major, starting at the bottom left corner of the texture), so the preview of a material is the same
+// wherever it is shown. The atlas grows by doubling its rows as the raw ids grow.
+class MaterialPreviewAtlas {
+ public:
+  MaterialPreviewAtlas(size_t tile_size, size_t columns);
+
+  inline bool fits(size_t tile_count) const { return tile_count <= columns_ * rows_; }
+
+  // Makes room for the tiles of the raw ids below `tile_count`. Growing discards the content of the atlas.
+  void reserve(size_t tile_count);
+
+  // Clears the atlas to the clear color and handles a pending reset, the tiles have to be drawn again.
+  void clear();
+
+  inline void mark_dirty(size_t raw_id) { dirty_tiles_.insert(static_cast<uint32_t>(raw_id)); }
+  inline void reset() { is_reset_ = true; }
+  inline void mark_clean() { dirty_tiles_.clear(); }
+
+  // The atlas has to be cleared and every material has to be drawn again, e.g. after the scene was replaced.
+  inline bool is_reset() const { return is_reset_; }
+  inline const std::unordered_set<uint32_t>& dirty_tiles() const { return dirty_tiles_; }
+
+  // Copies tile pixels between the atlas and the memory, RGBA8 rows from the bottom up.
+  void upload_tile(size_t raw_id, std::span<const uint32_t> pixels);
+  std::vector<uint32_t> download_tile(size_t raw_id);
+
+  // Texture coordinates of the tile corners, flipped for ImGui (`uv_min` is the top left corner).
+  ImVec2 uv_min(::resin::IdView<::resin::MaterialId> id) const;
+  ImVec2 uv_max(::resin::IdView<::resin::MaterialId> id) const;
+
+  inline size_t tile_size() const { return tile_size_; }
+  inline size_t columns() const { return columns_; }
+  inline size_t rows() const { return rows_; }
+
+  inline ::resin::ImageFramebuffer& fb() { return fb_; }
+  inline ImTextureID texture() const { return (ImTextureID)(intptr_t)fb_.color_texture(); }  // NOLINT
+
+ private:
+  ::resin::ImageFramebuffer fb_;
+  size_t tile_size_, columns_, rows_;
+  std::unordered_set<uint32_t> dirty_tiles_;
+  bool is_reset_;
 };
 
 bool MaterialsList(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                   LazyMaterialImageFramebuffers& material_img_fbs, const ::resin::SDFTree& sdf_tree);
+                   const MaterialPreviewAtlas& material_atlas, const ::resin::SDFTree& sdf_tree);
 
 bool MaterialsListEdit(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                       LazyMaterialImageFramebuffers& material_img_fbs, ::resin::SDFTree& sdf_tree);
+                       const MaterialPreviewAtlas& material_atlas, ::resin::SDFTree& sdf_tree);
 
 bool MaterialEdit(std::optional<::resin::IdView<::resin::MaterialId>>& selected,
-                  LazyMaterialImageFramebuffers& material_img_fbs, ::resin::SDFTree& sdf_tree);
+                  const MaterialPreviewAtlas& material_atlas, ::resin::SDFTree& sdf_tree);
 
 }  // namespace resin
 
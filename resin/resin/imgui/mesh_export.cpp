@@ -0,0 +1,36 @@
+#include <imgui/imgui.h>
+
+#include <format>
+#include <libresin/core/mesh_export_job.hpp>
+#include <libresin/utils/path.hpp>
+#include <resin/imgui/mesh_export.hpp>
+#include <string>
+
+namespace ImGui {  // NOLINT
+
+namespace resin {
+
+void MeshExportJobsView(::resin::MeshExportQueue& queue) {
+  if (queue.empty()) {
+    ImGui::TextDisabled("No exports in progress");
+    return;
+  }
+
+  for (const auto& job : queue.jobs()) {
+    ImGui::PushID(job.get());
+    ImGui::Text("%s", ::resin::path_to_utf8str(job->output_path().filename()).c_str());
+
+    const std::string overlay =
+        std::format("{} {:.0f}%", ::resin::kMeshExportStageNames[job->stage()], job->progress() * 100.0F);
+    ImGui::ProgressBar(job->progress(), ImVec2(-ImGui::CalcTextSize("Cancel").x * 2.0F, 0.0F), overlay.c_str());
+    ImGui::SameLine();
+    if (ImGui::Button("Cancel")) {
+      job->cancel();
+    }
+    ImGui::PopID();
+  }
+}
+
+}  // namespace resin
+
+}  // namespace ImGui
@@ -0,0 +1,16 @@
+#ifndef IMGUI_RESIN_MESH_EXPORT_HPP
+#define IMGUI_RESIN_MESH_EXPORT_HPP
+#include <libresin/core/mesh_export_job.hpp>
+
+namespace ImGui {  // NOLINT
+
+namespace resin {
+
+// Progress bars of the running export jobs, each with a cancel button.
+void MeshExportJobsView(::resin::MeshExportQueue& queue);
+
+}  // namespace resin
+
+}  // namespace ImGui
+
+#endif  // IMGUI_RESIN_MESH_EXPORT_HPP
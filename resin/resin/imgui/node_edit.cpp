@@ -1,13 +1,18 @@
 #include <imgui/imgui.h>
 
+#include <algorithm>
+#include <glm/common.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <libresin/core/framebuffer.hpp>
 #include <libresin/core/material.hpp>
 #include <libresin/core/raycaster.hpp>
 #include <libresin/core/sdf_shader_consts.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
 #include <libresin/core/sdf_tree/primitive_base_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
+#include <libresin/core/sdf_tree/repetition.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/shader.hpp>
 #include <ranges>
@@ -67,7 +72,47 @@ void resin::SDFNodeEditVisitor::visit_prism(::resin::TriangularPrismNode& node)
   }
 }
 
-bool NodeEdit(::resin::SDFTreeNode& node, LazyMaterialImageFramebuffers& material_img_fbs,
+void resin::SDFNodeEditVisitor::visit_prefab_reference(::resin::PrefabReferenceNode& node) {
+  ImGui::Text("Prefab: %s", node.prefab().name().data());
+  if (!node.prefab().path().empty()) {
+    ImGui::TextDisabled("%s", node.prefab().path().data());
+  }
+  ImGui::TextDisabled("References: %zu", node.prefab().reference_count());
+
+  ::resin::Repetition repetition = node.repetition();
+  bool changed                   = false;
+  if (ImGui::BeginCombo("Repetition", ::resin::kRepetitionTypeNames[repetition.type].data())) {
+    for (const auto [type, name] : ::resin::kRepetitionTypeNames) {
+      if (ImGui::Selectable(name.data(), type == repetition.type)) {
+        repetition.type = type;
+        changed         = true;
+      }
+    }
+    ImGui::EndCombo();
+  }
+
+  const auto max_count = static_cast<int>(::resin::Repetition::kMaxCount);
+  if (repetition.type == ::resin::RepetitionType::Grid) {
+    glm::ivec3 count(repetition.count);
+    changed |= ImGui::DragFloat3("Spacing", glm::value_ptr(repetition.spacing), 0.01F, 0.0F, 10.0F, "%.2f");
+    if (ImGui::DragInt3("Count", glm::value_ptr(count), 0.1F, 1, max_count)) {
+      repetition.count = glm::uvec3(glm::max(count, 1));
+      changed          = true;
+    }
+  } else if (repetition.type == ::resin::RepetitionType::Polar) {
+    int count = static_cast<int>(repetition.count.x);
+    if (ImGui::DragInt("Count", &count, 0.1F, 1, max_count)) {
+      repetition.count.x = static_cast<unsigned int>(std::max(count, 1));
+      changed            = true;
+    }
+  }
+
+  if (changed) {
+    node.set_repetition(repetition);
+  }
+}
+
+bool NodeEdit(::resin::SDFTreeNode& node, const MaterialPreviewAtlas& material_atlas,
               std::optional<::resin::IdView<::resin::MaterialId>>& selected_material,
               const ::resin::SDFTree& sdf_tree) {
   static std::optional<::resin::IdView<::resin::MaterialId>> modal_selected_material;
@@ -104,19 +149,13 @@ bool NodeEdit(::resin::SDFTreeNode& node, LazyMaterialImageFramebuffers& materia
 
       node.accept_visitor(vs);
 
-      const auto img_size = static_cast<float>(material_img_fbs.node_material_preview_fb.fb.width());
+      const auto img_size = static_cast<float>(kMaterialNodePreviewSize);
       if (node.material_id() && !node.material_id()->expired()) {
-        if (node.material_id() != material_img_fbs.node_material_preview_id) {
-          material_img_fbs.node_material_preview_id = node.material_id();
-          material_img_fbs.node_material_preview_fb.mark_dirty();
-        }
-
-        ImGui::ImageButton(
-            "##MaterialButton",                                                                   //
-            (ImTextureID)(intptr_t)material_img_fbs.node_material_preview_fb.fb.color_texture(),  // NOLINT
-            ImVec2(img_size, img_size),                                                           //
-            ImVec2(0, 1),                                                                         //
-            ImVec2(1, 0)                                                                          //
+        ImGui::ImageButton("##MaterialButton",                          //
+                           material_atlas.texture(),                    //
+                           ImVec2(img_size, img_size),                  //
+                           material_atlas.uv_min(*node.material_id()),  //
+                           material_atlas.uv_max(*node.material_id())   //
         );
 
       } else {
@@ -144,8 +183,6 @@ bool NodeEdit(::resin::SDFTreeNode& node, LazyMaterialImageFramebuffers& materia
 
           if (!source_id.expired()) {
             node.set_material(source_id);
-            material_img_fbs.node_material_preview_id = source_id;
-            material_img_fbs.node_material_preview_fb.mark_dirty();
           }
         }
       }
@@ -183,7 +220,7 @@ bool NodeEdit(::resin::SDFTreeNode& node, LazyMaterialImageFramebuffers& materia
         }
 
         ImGui::SetNextWindowSizeConstraints(ImVec2(240.F, 200.F), ImVec2(FLT_MAX, FLT_MAX));
-        MaterialsList(modal_selected_material, material_img_fbs, sdf_tree);
+        MaterialsList(modal_selected_material, material_atlas, sdf_tree);
 
         ImGui::EndPopup();
       }
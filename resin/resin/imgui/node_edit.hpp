@@ -22,6 +22,7 @@ class SDFNodeEditVisitor : public ::resin::ISDFTreeNodeVisitor {
   void visit_pyramid(::resin::PyramidNode&) override;
   void visit_cylinder(::resin::CylinderNode&) override;
   void visit_prism(::resin::TriangularPrismNode&) override;
+  void visit_prefab_reference(::resin::PrefabReferenceNode&) override;
 
   static constexpr ::resin::StringEnumMapper<::resin::SDFBinaryOperation> kOperationSymbol =
       ::resin::StringEnumMapper<::resin::SDFBinaryOperation>({
@@ -36,7 +37,7 @@ class SDFNodeEditVisitor : public ::resin::ISDFTreeNodeVisitor {
       });
 };
 
-bool NodeEdit(::resin::SDFTreeNode& node, LazyMaterialImageFramebuffers& material_img_fbs,
+bool NodeEdit(::resin::SDFTreeNode& node, const MaterialPreviewAtlas& material_atlas,
               std::optional<::resin::IdView<::resin::MaterialId>>& selected_material, const ::resin::SDFTree& sdf_tree);
 
 }  // namespace resin
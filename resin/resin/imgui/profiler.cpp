@@ -0,0 +1,74 @@
+#include <imgui/imgui.h>
+
+#include <array>
+#include <filesystem>
+#include <libresin/core/frame_profiler.hpp>
+#include <resin/dialog/file_dialog.hpp>
+#include <resin/imgui/profiler.hpp>
+#include <span>
+
+namespace ImGui {  // NOLINT
+
+namespace resin {
+
+static const std::array<::resin::FileDialog::FilterItem, 1> kTraceFiltersArray = {
+    ::resin::FileDialog::FilterItem("Chrome trace", "json")};
+
+void ProfilerView(::resin::FrameProfiler& profiler) {
+  ImGui::Checkbox("Record", &profiler.is_enabled);
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) {
+    profiler.clear();
+  }
+  ImGui::SameLine();
+  ImGui::BeginDisabled(profiler.events().empty() || ::resin::FileDialog::instance().is_active());
+  if (ImGui::Button("Export trace")) {
+    ::resin::FileDialog::instance().save_file(
+        [&profiler](const std::filesystem::path& path) { profiler.export_chrome_trace(path); },
+        std::span<const ::resin::FileDialog::FilterItem>(kTraceFiltersArray), "resin_trace.json");
+  }
+  ImGui::EndDisabled();
+
+  if (profiler.dropped_frames() > 0) {
+    ImGui::TextDisabled("GPU frames dropped: %zu", profiler.dropped_frames());
+  }
+
+  if (profiler.sections().empty()) {
+    ImGui::TextDisabled("Nothing recorded yet");
+    return;
+  }
+
+  static constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+  if (ImGui::BeginTable("##Profiler", 6, kTableFlags)) {
+    ImGui::TableSetupColumn("Section");
+    ImGui::TableSetupColumn("Track", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Last ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Avg ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Min ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Max ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+
+    for (const auto& section : profiler.sections()) {
+      const auto& stats = section.milliseconds;
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", section.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", ::resin::kProfileTrackNames[section.track].data());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.last());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.average());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.min());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.max());
+    }
+    ImGui::EndTable();
+  }
+}
+
+}  // namespace resin
+
+}  // namespace ImGui
@@ -0,0 +1,16 @@
+#ifndef IMGUI_RESIN_PROFILER_HPP
+#define IMGUI_RESIN_PROFILER_HPP
+#include <libresin/core/frame_profiler.hpp>
+
+namespace ImGui {  // NOLINT
+
+namespace resin {
+
+// Rolling statistics of the profiled sections with the controls for recording and exporting the trace.
+void ProfilerView(::resin::FrameProfiler& profiler);
+
+}  // namespace resin
+
+}  // namespace ImGui
+
+#endif  // IMGUI_RESIN_PROFILER_HPP
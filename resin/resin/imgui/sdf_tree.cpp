@@ -7,14 +7,19 @@
 #include <glm/fwd.hpp>
 #include <glm/geometric.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <iterator>
+#include <libresin/core/mesh_export_job.hpp>
 #include <libresin/core/mesh_exporter.hpp>
 #include <libresin/core/resources/shader_resource.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
+#include <libresin/core/sdf_tree/prefab_reference_node.hpp>
 #include <libresin/core/sdf_tree/primitive_base_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
+#include <libresin/utils/binary_scene.hpp>
 #include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/json.hpp>
+#include <libresin/utils/json_stream.hpp>
 #include <libresin/utils/logger.hpp>
 #include <libresin/utils/path.hpp>
 #include <memory>
@@ -25,6 +30,7 @@
 #include <resin/imgui/sdf_tree.hpp>
 #include <resin/resources/resource_managers.hpp>
 #include <utility>
+#include <vector>
 
 namespace ImGui {  // NOLINT
 
@@ -33,8 +39,24 @@ namespace resin {
 static const std::array<::resin::FileDialog::FilterItem, 1> kPrefabFiltersArray = {
     ::resin::FileDialog::FilterItem("Resin prefab", "amber")};
 
-static const std::array<::resin::FileDialog::FilterItem, 2> kMeshFiltersArray = {
-    ::resin::FileDialog::FilterItem("Wavefront obj", "obj"), ::resin::FileDialog::FilterItem("GLTF2", "gltf")};
+static const std::array<::resin::FileDialog::FilterItem, 5> kMeshFiltersArray = {
+    ::resin::FileDialog::FilterItem("Wavefront obj", "obj"), ::resin::FileDialog::FilterItem("GLTF2", "gltf"),
+    ::resin::FileDialog::FilterItem("GLTF2 binary", "glb"), ::resin::FileDialog::FilterItem("Binary STL", "stl"),
+    ::resin::FileDialog::FilterItem("Binary PLY", "ply")};
+
+struct MeshExportFormatItem {
+  const char* label;
+  const char* format;     // Assimp or native writer id, see MeshExporter::export_mesh
+  const char* extension;  // default file extension
+};
+
+static constexpr std::array<MeshExportFormatItem, 5> kMeshExportFormats = {{
+    {.label = "OBJ", .format = "obj", .extension = ".obj"},
+    {.label = "GLTF", .format = "gltf2", .extension = ".gltf"},
+    {.label = "GLB", .format = "glb2", .extension = ".glb"},
+    {.label = "STL", .format = "stlb", .extension = ".stl"},
+    {.label = "PLY", .format = "plyb", .extension = ".ply"},
+}};
 
 std::optional<::resin::IdView<::resin::SDFTreeNodeId>> SDFTreeComponentVisitor::get_curr_payload() {
   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> source_id;
@@ -149,6 +171,9 @@ void SDFTreeComponentVisitor::visit_group(::resin::GroupNode& node) {
     if (ImGui::Selectable("Duplicate")) {
       duplicate_target_ = node.node_id();
     }
+    if (node.has_parent() && ImGui::Selectable("Make instance")) {
+      instance_target_ = node.node_id();
+    }
 
     ImGui::Separator();
 
@@ -182,36 +207,49 @@ void SDFTreeComponentVisitor::visit_group(::resin::GroupNode& node) {
         auto curr_id                     = node.node_id();
         auto name                        = node.name();
         auto& sdf_tree                   = sdf_tree_;
+        auto& export_queue               = export_queue_;
         ImGui::Text("Select resolution:");
         if (ImGui::Combo("##Resolution", &resolution_index, resolution_labels, IM_ARRAYSIZE(resolution_labels))) {
         }
         unsigned int resolution = resolutions[resolution_index];
-        if (ImGui::MenuItem("OBJ")) {
-          ::resin::FileDialog::instance().save_file(
-              [curr_id, &sdf_tree, resolution](const std::filesystem::path& path) {
-                auto& resource_manager = ::resin::ResourceManagers::shader_manager();
-                ::resin::ShaderResource shader_resource =
-                    *resource_manager.get_res(::resin::get_executable_dir() / "assets/marching_cubes.comp");
-                ::resin::MeshExporter exporter(shader_resource, resolution);
-                glm::vec3 pos = sdf_tree.group(curr_id).transform().pos();  // TODO(SDF-130) calculate bounding box
-                exporter.setup_scene(pos - glm::vec3(5.0F), pos + glm::vec3(5.0F), sdf_tree, curr_id);
-                exporter.export_mesh(path, "obj");
-              },
-              std::span<const ::resin::FileDialog::FilterItem>(kMeshFiltersArray), std::string(name) + ".obj");
-        }
 
-        if (ImGui::MenuItem("GLTF")) {
+        static int meshing_mode_index     = 0;
+        const char* meshing_mode_labels[] = {"Marching cubes", "Dual contouring"};
+        ImGui::Text("Select meshing mode:");
+        ImGui::Combo("##MeshingMode", &meshing_mode_index, meshing_mode_labels, IM_ARRAYSIZE(meshing_mode_labels));
+        auto meshing_mode = static_cast<::resin::MeshingMode>(meshing_mode_index);
+
+        static int backend_index     = 0;
+        const char* backend_labels[] = {"GPU", "CPU"};
+        ImGui::Text("Select backend:");
+        ImGui::Combo("##MeshExportBackend", &backend_index, backend_labels, IM_ARRAYSIZE(backend_labels));
+        auto backend = static_cast<::resin::MeshExportBackend>(backend_index);
+
+        // Every level halves the triangle count of the previous one
+        static int lod_count = 0;
+        ImGui::Text("Select LOD levels:");
+        ImGui::SliderInt("##LODCount", &lod_count, 0, 4);
+        std::vector<::resin::SimplificationOptions> lods(static_cast<size_t>(lod_count));
+        for (const auto& format : kMeshExportFormats) {
+          if (!ImGui::MenuItem(format.label)) {
+            continue;
+          }
           ::resin::FileDialog::instance().save_file(
-              [curr_id, &sdf_tree, resolution](const std::filesystem::path& path) {
+              [curr_id, &sdf_tree, &export_queue, resolution, meshing_mode, backend, lods,
+               format = format.format](const std::filesystem::path& path) {
                 auto& resource_manager = ::resin::ResourceManagers::shader_manager();
                 ::resin::ShaderResource shader_resource =
                     *resource_manager.get_res(::resin::get_executable_dir() / "assets/marching_cubes.comp");
-                ::resin::MeshExporter exporter(shader_resource, resolution);
+                auto exporter =
+                    std::make_unique<::resin::MeshExporter>(shader_resource, resolution, meshing_mode, backend);
+                exporter->set_lods(lods);
                 glm::vec3 pos = sdf_tree.group(curr_id).transform().pos();  // TODO(SDF-130) calculate bounding box
-                exporter.setup_scene(pos - glm::vec3(5.0F), pos + glm::vec3(5.0F), sdf_tree, curr_id);
-                exporter.export_mesh(path, "gltf2");
+                export_queue.start(std::make_unique<::resin::MeshExportJob>(std::move(exporter), pos - glm::vec3(5.0F),
+                                                                            pos + glm::vec3(5.0F), sdf_tree, curr_id,
+                                                                            path, format));
               },
-              std::span<const ::resin::FileDialog::FilterItem>(kMeshFiltersArray), std::string(name) + ".gltf");
+              std::span<const ::resin::FileDialog::FilterItem>(kMeshFiltersArray),
+              std::string(name) + format.extension);
         }
         ImGui::EndMenu();
       }
@@ -260,7 +298,11 @@ void SDFTreeComponentVisitor::visit_group(::resin::GroupNode& node) {
   ImGui::PopID();
 }
 
-void SDFTreeComponentVisitor::visit_primitive(::resin::BasePrimitiveNode& node) {
+void SDFTreeComponentVisitor::visit_primitive(::resin::BasePrimitiveNode& node) { render_leaf(node, false); }
+
+void SDFTreeComponentVisitor::visit_prefab_reference(::resin::PrefabReferenceNode& node) { render_leaf(node, true); }
+
+void SDFTreeComponentVisitor::render_leaf(::resin::SDFTreeNode& node, bool is_prefab_reference) {
   static std::string node_name;
   auto source_id = get_curr_payload();
 
@@ -302,6 +344,9 @@ void SDFTreeComponentVisitor::visit_primitive(::resin::BasePrimitiveNode& node)
     if (ImGui::Selectable("Duplicate")) {
       duplicate_target_ = node.node_id();
     }
+    if (is_prefab_reference && ImGui::Selectable("Expand")) {
+      expand_target_ = node.node_id();
+    }
 
     ImGui::Separator();
 
@@ -447,9 +492,44 @@ void SDFTreeComponentVisitor::apply_delete_operation() {
     return;
   }
   sdf_tree_.delete_node(*delete_target_);
+  sdf_tree_.delete_unused_prefabs();
 }
 
-void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::SDFTreeNodeId>>& old_selected) {
+void SDFTreeComponentVisitor::apply_expand_operation() {
+  if (!expand_target_ || expand_target_->expired()) {
+    return;
+  }
+
+  try {
+    const bool was_selected = selected_ == *expand_target_;
+    auto& group             = sdf_tree_.expand_prefab_reference(*expand_target_);
+    if (was_selected) {
+      selected_ = group.node_id();
+    }
+    sdf_tree_.delete_unused_prefabs();
+  } catch (const ::resin::ObjectsOverflowException&) {
+    ::resin::Logger::err("Could not expand the prefab reference, as the tree cannot hold all of its copies");
+  }
+}
+
+void SDFTreeComponentVisitor::apply_instance_operation() {
+  if (!instance_target_ || instance_target_->expired()) {
+    return;
+  }
+
+  try {
+    const bool was_selected = selected_ == *instance_target_;
+    auto& reference         = sdf_tree_.instance_group(*instance_target_);
+    if (was_selected) {
+      selected_ = reference.node_id();
+    }
+  } catch (const ::resin::NestedPrefabReferenceException&) {
+    ::resin::Logger::err("Could not make an instance of a group containing prefab references");
+  }
+}
+
+void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::SDFTreeNodeId>>& old_selected,
+                 ::resin::MeshExportQueue& export_queue) {
   static std::string_view delete_label    = "Delete";
   static std::string_view add_prim_label  = "Add Primitive";
   static std::string_view add_group_label = "Add Group";
@@ -465,7 +545,7 @@ void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::
 
   ImGui::PushID(static_cast<int>(tree.tree_id()));
 
-  auto comp_vs = resin::SDFTreeComponentVisitor(tree, old_selected);
+  auto comp_vs = resin::SDFTreeComponentVisitor(tree, old_selected, export_queue);
 
   ImGui::BeginChild("ResizableInnerChild", ImVec2(-FLT_MIN, ImGui::GetWindowHeight() - buttons_section_height));
 
@@ -477,6 +557,8 @@ void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::
   comp_vs.apply_move_operation();
   comp_vs.apply_duplicate_operation();
   comp_vs.apply_delete_operation();
+  comp_vs.apply_expand_operation();
+  comp_vs.apply_instance_operation();
 
   ImGui::IsItemClicked();
   ImGui::GetMouseDragDelta();
@@ -488,6 +570,7 @@ void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::
 
   if (ImGui::Button(delete_label.data())) {
     tree.delete_node(selected.value());
+    tree.delete_unused_prefabs();
     selected = std::nullopt;
   }
 
@@ -518,19 +601,20 @@ void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::
 
       ::resin::FileDialog::instance().open_file(
           [&sdf_tree, selected](const std::filesystem::path& path) {
-            std::string json_content;
-            std::ifstream file(path);
+            std::ifstream file(path, std::ios::binary);
             if (!file.is_open()) {
               ::resin::Logger::err("Could not open a file with path {}", path.string());
               return;
             }
 
-            std::ostringstream ss;
-            ss << file.rdbuf();
-            json_content = ss.str();
-
             try {
-              auto group = ::resin::json::deserialize_prefab(sdf_tree, json_content);
+              std::unique_ptr<::resin::GroupNode> group;
+              if (::resin::binary::is_binary_scene(file)) {
+                const std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+                group = ::resin::binary::deserialize_prefab(sdf_tree, data);
+              } else {
+                group = ::resin::json::stream_deserialize_prefab(sdf_tree, file);
+              }
               if (selected.has_value()) {
                 if (sdf_tree.is_group(*selected)) {
                   sdf_tree.group(*selected).push_back_child(std::move(group));
@@ -547,6 +631,47 @@ void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::
           },
           std::span<const ::resin::FileDialog::FilterItem>(kPrefabFiltersArray));
     }
+
+    if (ImGui::Selectable("Reference prefab")) {
+      auto& sdf_tree = tree;
+
+      ::resin::FileDialog::instance().open_file(
+          [&sdf_tree, selected](const std::filesystem::path& path) {
+            try {
+              // The prefab content is loaded once and shared by all of its references
+              auto prefab = sdf_tree.find_prefab(path.string());
+              if (!prefab.has_value()) {
+                std::ifstream file(path, std::ios::binary);
+                if (!file.is_open()) {
+                  ::resin::Logger::err("Could not open a file with path {}", path.string());
+                  return;
+                }
+
+                std::unique_ptr<::resin::GroupNode> group;
+                if (::resin::binary::is_binary_scene(file)) {
+                  const std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+                  group = ::resin::binary::deserialize_prefab(sdf_tree, data);
+                } else {
+                  group = ::resin::json::stream_deserialize_prefab(sdf_tree, file);
+                }
+                prefab = sdf_tree.add_prefab(std::move(group), path.string());
+              }
+
+              ::resin::GroupNode* parent = &sdf_tree.root();
+              if (selected.has_value() && sdf_tree.is_group(*selected)) {
+                parent = &sdf_tree.group(*selected);
+              } else if (selected.has_value()) {
+                parent = &sdf_tree.node(*selected).parent();
+              }
+              parent->push_back_child<::resin::PrefabReferenceNode>(::resin::SDFBinaryOperation::SmoothUnion,
+                                                                    prefab->get());
+              ::resin::Logger::info("Referenced prefab from {}", path.string());
+            } catch (...) {
+              ::resin::Logger::err("Could not reference prefab from {}", path.string());
+            }
+          },
+          std::span<const ::resin::FileDialog::FilterItem>(kPrefabFiltersArray));
+    }
     ImGui::EndPopup();
   }
 
@@ -5,6 +5,7 @@
 #include <imgui/imgui_internal.h>
 
 #include <libresin/core/id_registry.hpp>
+#include <libresin/core/mesh_export_job.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
@@ -19,20 +20,28 @@ namespace resin {
 class SDFTreeComponentVisitor : public ::resin::ISDFTreeNodeVisitor {
  public:
   explicit SDFTreeComponentVisitor(::resin::SDFTree& tree,
-                                   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> selected)
-      : selected_(selected), payload_type_(std::format("SDF_TREE_DND_PAYLOAD_{}", tree.tree_id())), sdf_tree_(tree) {}
+                                   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> selected,
+                                   ::resin::MeshExportQueue& export_queue)
+      : selected_(selected),
+        payload_type_(std::format("SDF_TREE_DND_PAYLOAD_{}", tree.tree_id())),
+        sdf_tree_(tree),
+        export_queue_(export_queue) {}
   void visit_group(::resin::GroupNode& node) override;
   void visit_primitive(::resin::BasePrimitiveNode& node) override;
+  void visit_prefab_reference(::resin::PrefabReferenceNode& node) override;
 
   void render_tree();
   void render_rename_popup_modal(const char* name);
   void apply_move_operation();
   void apply_duplicate_operation();
   void apply_delete_operation();
+  void apply_expand_operation();
+  void apply_instance_operation();
 
   inline std::optional<::resin::IdView<::resin::SDFTreeNodeId>> selected() const { return selected_; }
 
  private:
+  void render_leaf(::resin::SDFTreeNode& node, bool is_prefab_reference);
   void render_op(::resin::SDFTreeNode& node) const;
   void drag_and_drop(::resin::SDFTreeNode& node, bool ignore_middle);
   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> get_curr_payload();
@@ -53,6 +62,8 @@ class SDFTreeComponentVisitor : public ::resin::ISDFTreeNodeVisitor {
 
   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> duplicate_target_ = std::nullopt;
   std::optional<::resin::IdView<::resin::SDFTreeNodeId>> delete_target_    = std::nullopt;
+  std::optional<::resin::IdView<::resin::SDFTreeNodeId>> expand_target_    = std::nullopt;
+  std::optional<::resin::IdView<::resin::SDFTreeNodeId>> instance_target_  = std::nullopt;
 
   std::string payload_type_;
   static constexpr ::resin::StringEnumMapper<::resin::SDFBinaryOperation> kOperationSymbol =
@@ -67,10 +78,12 @@ class SDFTreeComponentVisitor : public ::resin::ISDFTreeNodeVisitor {
           {::resin::SDFBinaryOperation::SmoothXor, "^'"}     //
       });
 
-  ::resin::SDFTree& sdf_tree_;  // NOLINT
+  ::resin::SDFTree& sdf_tree_;              // NOLINT
+  ::resin::MeshExportQueue& export_queue_;  // NOLINT
 };
 
-void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::SDFTreeNodeId>>& old_selected);
+void SDFTreeView(::resin::SDFTree& tree, std::optional<::resin::IdView<::resin::SDFTreeNodeId>>& old_selected,
+                 ::resin::MeshExportQueue& export_queue);
 
 }  // namespace resin
 
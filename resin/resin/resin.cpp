@@ -5,11 +5,14 @@
 #include <imgui/imgui_impl_opengl3.h>
 #include <imgui/imgui_internal.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
+#include <format>
 #include <glm/ext.hpp>
 #include <glm/ext/matrix_relational.hpp>
 #include <glm/ext/quaternion_trigonometric.hpp>
@@ -20,20 +23,27 @@
 #include <glm/matrix.hpp>
 #include <glm/trigonometric.hpp>
 #include <libresin/core/camera.hpp>
+#include <libresin/core/frame_profiler.hpp>
 #include <libresin/core/framebuffer.hpp>
 #include <libresin/core/light.hpp>
 #include <libresin/core/material.hpp>
+#include <libresin/core/material_preview_cache.hpp>
 #include <libresin/core/raycaster.hpp>
 #include <libresin/core/resources/shader_resource.hpp>
+#include <libresin/core/scene_journal.hpp>
+#include <libresin/core/scene_view.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
 #include <libresin/core/sdf_tree/primitive_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/shader.hpp>
 #include <libresin/core/transform.hpp>
 #include <libresin/core/uniform_buffer.hpp>
+#include <libresin/utils/binary_scene.hpp>
 #include <libresin/utils/enum_mapper.hpp>
+#include <libresin/utils/exceptions.hpp>
 #include <libresin/utils/logger.hpp>
 #include <libresin/utils/path.hpp>
+#include <libresin/utils/thread_pool.hpp>
 #include <memory>
 #include <nfd/nfd.hpp>
 #include <optional>
@@ -49,17 +59,25 @@
 #include <resin/imgui/gizmo.hpp>
 #include <resin/imgui/main_menu_bar.hpp>
 #include <resin/imgui/material.hpp>
+#include <resin/imgui/mesh_export.hpp>
+#include <resin/imgui/modals.hpp>
 #include <resin/imgui/node_edit.hpp>
+#include <resin/imgui/profiler.hpp>
 #include <resin/imgui/sdf_tree.hpp>
 #include <resin/imgui/transform_edit.hpp>
 #include <resin/imgui/viewport.hpp>
 #include <resin/resin.hpp>
+#include <span>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace resin {
 
 Resin::Resin()
     : current_viewport_state_(ViewportState::InactiveIdle),
+      region_selection_mode_(RegionSelectionMode::None),
       viewport_pos_(),
       camera_distance_(0),
       gizmo_operation_(ImGui::resin::gizmo::Operation::Translation) {
@@ -81,16 +99,32 @@ Resin::Resin()
   }
 
   // Setup framebuffer and raycaster
-  framebuffer_     = std::make_unique<ViewportFramebuffer>(window_->dimensions().x, window_->dimensions().y);
-  raycaster_       = std::make_unique<Raycaster>();
-  material_images_ = std::make_unique<ImGui::resin::LazyMaterialImageFramebuffers>(
-      kMaterialNodeImageSize, kMaterialMainImageSize, kMaterialImageSize);
+  framebuffer_    = std::make_unique<ViewportFramebuffer>(window_->dimensions().x, window_->dimensions().y);
+  raycaster_      = std::make_unique<Raycaster>();
+  profiler_       = std::make_unique<FrameProfiler>();
+  thread_pool_    = std::make_unique<ThreadPool>();
+  material_atlas_ = std::make_unique<ImGui::resin::MaterialPreviewAtlas>(ImGui::resin::kMaterialMainPreviewSize,
+                                                                        kMaterialAtlasColumns);
 
   // Main resource path
   const std::filesystem::path assets_path = resin::get_executable_dir() / "assets";
 
+  material_preview_cache_ = std::make_unique<MaterialPreviewCache>(
+      resin::get_user_cache_dir() / "material_previews", material_atlas_->tile_size());
+
+  // The autosave is left behind only if the last session did not close cleanly. It is read before the journal starts
+  // writing over it and recovered once the user agrees to.
+  const std::filesystem::path autosave_path = resin::get_user_cache_dir() / "autosave";
+  try {
+    recovered_scene_ = SceneJournal::restore(autosave_path);
+  } catch (const ResinException&) {
+    Logger::warn("Could not read the autosave of the last session");
+  }
+  scene_journal_ = std::make_unique<SceneJournal>(autosave_path);
+
   // Setup scene
   scene_.set_default();
+  tree_history_ = std::make_unique<SDFTreeHistory>(scene_.tree());
 
   // Setup shaders
   primitive_ubo_ = std::make_unique<PrimitiveUniformBuffer>(scene_.tree().max_node_count());
@@ -111,24 +145,43 @@ Resin::Resin()
   ShaderResource grid_frag_shader = *shader_resource_manager_.get_res(assets_path / "grid.frag");
   ShaderResource main_frag_shader = *shader_resource_manager_.get_res(assets_path / "main.frag");
   main_frag_shader.set_ext_defi("SDF_CODE", scene_.tree().gen_shader_code());
+  main_frag_shader.set_ext_defi("SDF_FUNCTIONS", scene_.tree().gen_shader_functions());
   main_frag_shader.set_ext_defi("MAX_UBO_NODE_COUNT", std::to_string(scene_.tree().max_node_count()));
   main_frag_shader.set_ext_defi("MAX_UBO_MATERIAL_COUNT", std::to_string(scene_.tree().max_material_count()));
+  ShaderResource material_vert_shader = *shader_resource_manager_.get_res(assets_path / "material_view.vert");
+  ShaderResource material_frag_shader = *shader_resource_manager_.get_res(assets_path / "material_view.frag");
+  material_vert_shader.set_ext_defi("MATERIAL_BATCH_SIZE", std::to_string(kMaterialBatchSize));
+  material_frag_shader.set_ext_defi("MAX_UBO_MATERIAL_COUNT", std::to_string(scene_.tree().max_material_count()));
 
   grid_shader_ = std::make_unique<RenderingShaderProgram>(
       "grid", *shader_resource_manager_.get_res(assets_path / "main.vert"), std::move(grid_frag_shader));
-  material_img_shader_ = std::make_unique<RenderingShaderProgram>(
-      "material_view", *shader_resource_manager_.get_res(assets_path / "main.vert"),
-      *shader_resource_manager_.get_res(assets_path / "material_view.frag"));
+  material_img_shader_ = std::make_unique<RenderingShaderProgram>("material_view", std::move(material_vert_shader),
+                                                                  std::move(material_frag_shader));
+  material_img_shader_->bind_uniform_buffer("MaterialData", *material_ubo_);
   shader_ = std::make_unique<RenderingShaderProgram>(
       "main", *shader_resource_manager_.get_res(assets_path / "main.vert"), std::move(main_frag_shader));
   shader_->bind_uniform_buffer("PrimitiveNodeData", *primitive_ubo_);
   shader_->bind_uniform_buffer("NodeAttributesData", *node_attributes_ubo_);
   shader_->bind_uniform_buffer("MaterialData", *material_ubo_);
+  pick_region_reducer_ =
+      std::make_unique<PickRegionReducer>(*shader_resource_manager_.get_res(assets_path / "pick_region.comp"));
 
   // Setup camera
   camera_ = std::make_unique<Camera>(false, 70.F, 16.F / 9.F, 0.75F, 100.F);
   camera_->transform.set_local_pos(glm::vec3(0.0F, 0.0F, 5.0F));
 
+  // Setup additional views, orthographic along the axes
+  const auto add_scene_view = [this](std::string name, const glm::vec3& pos, const glm::vec3& up) {
+    auto camera = std::make_unique<Camera>(true, 70.F, 1.F, 0.75F, 100.F);
+    camera->transform.set_local_pos(pos);
+    camera->transform.set_local_rot(glm::quatLookAt(-glm::normalize(pos), up));
+    camera->recalculate_projection();
+    scene_views_.push_back(std::make_unique<SceneView>(std::move(name), std::move(camera), kSceneViewResolutionScale));
+  };
+  add_scene_view("Front View", glm::vec3(0.0F, 0.0F, 5.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+  add_scene_view("Top View", glm::vec3(0.0F, 5.0F, 0.0F), glm::vec3(0.0F, 0.0F, -1.0F));
+  add_scene_view("Right View", glm::vec3(5.0F, 0.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+
   // Setup lights
   point_light_       = std::make_unique<PointLight>(glm::vec3(0.57F, 0.38F, 0.04F), glm::vec3(-1.0F, 1.0F, 0.0F),
                                                     PointLight::Attenuation(1.0F, 0.7F, 1.8F));
@@ -139,23 +192,9 @@ Resin::Resin()
 }
 
 void Resin::setup_shader_uniforms() {
-  shader_->set_uniform("u_iV", camera_->inverse_view_matrix());
-  shader_->set_uniform("u_resolution", glm::vec2(framebuffer_->width(), framebuffer_->height()));
-  shader_->set_uniform("u_nearPlane", camera_->near_plane());
-  shader_->set_uniform("u_farPlane", camera_->far_plane());
-  shader_->set_uniform("u_ortho", camera_->is_orthographic());
-  shader_->set_uniform("u_camSize", camera_->height());
-
-  grid_shader_->set_uniform("u_iV", camera_->inverse_view_matrix());
-  grid_shader_->set_uniform("u_resolution", glm::vec2(framebuffer_->width(), framebuffer_->height()));
-  grid_shader_->set_uniform("u_nearPlane", camera_->near_plane());
-  grid_shader_->set_uniform("u_farPlane", camera_->far_plane());
-  grid_shader_->set_uniform("u_ortho", camera_->is_orthographic());
-  grid_shader_->set_uniform("u_camSize", camera_->height());
+  set_camera_uniforms(*shader_, *camera_, *framebuffer_);
+  set_camera_uniforms(*grid_shader_, *camera_, *framebuffer_);
   grid_shader_->set_uniform("u_spacing", grid_spacing_);
-
-  material_img_shader_->set_uniform("u_camSize", 1.0F);
-  material_img_shader_->set_uniform("u_resolution", glm::vec2(kMaterialImageSize, kMaterialImageSize));
 }
 
 void Resin::run() {
@@ -171,6 +210,8 @@ void Resin::run() {
   init_gl();
 
   while (running_) {
+    profiler_->begin_frame();
+
     auto current_time = clock::now();
     auto delta        = current_time - previous_time;
     previous_time     = current_time;
@@ -212,6 +253,14 @@ void Resin::run() {
       second = 0ns;
     }
   }
+
+  store_material_previews();
+
+  // The session closed cleanly, so there is nothing to recover. An autosave that was not recovered yet is kept.
+  scene_journal_->flush();
+  if (!recovered_scene_) {
+    SceneJournal::discard(scene_journal_->directory());
+  }
 }
 
 void Resin::init_gl() {  // NOLINT
@@ -229,29 +278,92 @@ void Resin::update(duration_t delta) {
 
   // FileDialog update must go before ubo updates
   FileDialog::instance().update();
+  mesh_export_queue_.update();
 
-  directional_light_->transform.rotate(glm::angleAxis(std::chrono::duration<float>(delta).count(), glm::vec3(0, 1, 0)));
+  if (auto id = framebuffer_->poll_mouse_pick()) {
+    selected_node_ = *id == -1 ? std::nullopt : scene_.tree().get_view_from_raw_id(static_cast<size_t>(*id));
+  }
+  if (auto ids = pick_region_reducer_->poll()) {
+    region_selected_nodes_.clear();
+    for (const size_t id : *ids) {
+      if (auto node_id = scene_.tree().get_view_from_raw_id(id)) {
+        region_selected_nodes_.push_back(*node_id);
+      }
+    }
+    selected_node_ = region_selected_nodes_.empty() ? std::nullopt : std::optional(region_selected_nodes_.front());
+  }
+
+  // The views share the lights, so the moving light invalidates them every tick while it is animated
+  if (is_light_animated_) {
+    directional_light_->transform.rotate(
+        glm::angleAxis(std::chrono::duration<float>(delta).count(), glm::vec3(0, 1, 0)));
+    invalidate_scene_views();
+  }
+
+  if (scene_.tree().is_dirty() || !scene_.tree().dirty_primitives().empty() ||
+      !scene_.tree().dirty_node_attributes().empty()) {
+    invalidate_scene_views();
+    has_uncommitted_edits_ = true;
+  }
+  if (!scene_.tree().dirty_materials().empty()) {
+    has_uncommitted_edits_ = true;
+  }
+
+  // An edit is committed once it ends, so that a drag of a slider or of the gizmo is undone as a whole. Every edit
+  // marks the tree dirty, so the idle frames skip capturing the tree.
+  if (has_uncommitted_edits_ && !ImGui::IsAnyItemActive() &&
+      current_viewport_state_ != ViewportState::GizmoTransform) {
+    CPUProfileScope scope(*profiler_, "History");
+    tree_history_->commit();
+    has_uncommitted_edits_ = false;
+  }
+
+  shader_reload_lag_ += delta;
+  if (shader_reload_lag_ >= kShaderReloadInterval) {
+    shader_reload_lag_ = 0ns;
+    reload_modified_shaders();
+  }
+
+  // Recording before the autosave is recovered would replace it with the current scene
+  autosave_lag_ += delta;
+  if (autosave_lag_ >= kAutosaveInterval && !recovered_scene_) {
+    autosave_lag_ = 0ns;
+    CPUProfileScope scope(*profiler_, "Autosave");
+    scene_journal_->record(scene_);
+  }
 
   if (scene_.tree().is_dirty()) {
     shader_->fragment_shader().set_ext_defi("SDF_CODE", scene_.tree().gen_shader_code());
+    shader_->fragment_shader().set_ext_defi("SDF_FUNCTIONS", scene_.tree().gen_shader_functions());
     Logger::debug("{}", scene_.tree().gen_shader_code());
-    shader_->recompile();
+    {
+      CPUProfileScope scope(*profiler_, "Shader compile");
+      shader_->recompile();
+    }
     setup_shader_uniforms();
     Logger::info("Refreshed the SDF Tree");
     scene_.tree().mark_clean();
   }
 
-  primitive_ubo_->bind();
-  primitive_ubo_->update_dirty(scene_.tree());
-  primitive_ubo_->unbind();
+  {
+    GPUProfileScope scope(*profiler_, "UBO uploads");
 
-  node_attributes_ubo_->bind();
-  node_attributes_ubo_->update_dirty(scene_.tree());
-  node_attributes_ubo_->unbind();
+    primitive_ubo_->bind();
+    primitive_ubo_->update_dirty(scene_.tree());
+    primitive_ubo_->unbind();
 
-  material_ubo_->bind();
-  material_ubo_->update_dirty(scene_.tree());
-  material_ubo_->unbind();
+    node_attributes_ubo_->bind();
+    node_attributes_ubo_->update_dirty(scene_.tree());
+    node_attributes_ubo_->unbind();
+
+    material_ubo_->bind();
+    material_ubo_->update_dirty(scene_.tree());
+    material_ubo_->unbind();
+  }
+  scene_.tree().visit_dirty_materials([this](auto& mat) {
+    material_atlas_->mark_dirty(mat.material_id().raw());
+    invalidate_scene_views();
+  });
 
   shader_->set_uniform("u_dirLight", *directional_light_);
   shader_->set_uniform("u_pointLight", *point_light_);
@@ -265,70 +377,239 @@ void Resin::update(duration_t delta) {
   scene_.tree().mark_node_attributes_clean();
 }
 
-void Resin::render_viewport() {
-  framebuffer_->bind();
-  framebuffer_->clear();
+void Resin::render_viewport(ViewportFramebuffer& framebuffer, std::string_view name) {
+  framebuffer.bind();
+  framebuffer.clear();
 
   raycaster_->bind();
 
-  framebuffer_->begin_pick_render();
-  shader_->bind();
-  raycaster_->draw_call();
-  shader_->unbind();
-  framebuffer_->end_pick_render();
+  {
+    GPUProfileScope scope(*profiler_, std::format("{} SDF pass", name));
+    framebuffer.begin_pick_render();
+    shader_->bind();
+    raycaster_->draw_call();
+    shader_->unbind();
+    framebuffer.end_pick_render();
+  }
 
   if (is_grid_) {
+    GPUProfileScope scope(*profiler_, std::format("{} grid pass", name));
     grid_shader_->bind();
     raycaster_->draw_call();
     grid_shader_->unbind();
   }
 
-  framebuffer_->unbind();
+  framebuffer.unbind();
 
   glViewport(0, 0, static_cast<GLint>(window_->dimensions().x), static_cast<GLint>(window_->dimensions().y));
 }
 
-void Resin::render_material_image(ImageFramebuffer& fb) {
-  fb.bind();
-  fb.clear();
+void Resin::draw_scene_views() {
+  static constexpr std::array<float, 4> kResolutionScales = {1.0F, 0.75F, 0.5F, 0.25F};
 
-  raycaster_->bind();
+  bool is_any_rendered = false;
+  for (auto& view : scene_views_) {
+    if (!view->is_open) {
+      continue;
+    }
 
-  material_img_shader_->bind();
-  raycaster_->draw_call();
-  material_img_shader_->unbind();
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+    const bool is_visible = ImGui::Begin(view->name().data(), &view->is_open, ImGuiWindowFlags_MenuBar);
+    ImGui::PopStyleVar();
+    if (!is_visible) {
+      ImGui::End();
+      continue;
+    }
+
+    if (ImGui::BeginMenuBar()) {
+      ImGui::Text("Resolution:");
+      ImGui::SetNextItemWidth(ImGui::CalcTextSize("100%").x + 12.0F);
+      const std::string current = std::format("{:.0f}%", view->resolution_scale() * 100.0F);
+      if (ImGui::BeginCombo("##ResolutionCombo", current.c_str(), ImGuiComboFlags_NoArrowButton)) {
+        for (const float scale : kResolutionScales) {
+          const bool is_selected = std::abs(scale - view->resolution_scale()) < 1e-3F;
+          if (ImGui::Selectable(std::format("{:.0f}%", scale * 100.0F).c_str(), is_selected)) {
+            view->set_resolution_scale(scale);
+          }
+        }
+        ImGui::EndCombo();
+      }
+      ImGui::EndMenuBar();
+    }
 
-  fb.unbind();
+    const ImVec2 size = ImGui::GetContentRegionAvail();
+    view->resize(static_cast<size_t>(size.x), static_cast<size_t>(size.y));
+
+    if (view->is_dirty()) {
+      set_camera_uniforms(*shader_, view->camera(), view->framebuffer());
+      set_camera_uniforms(*grid_shader_, view->camera(), view->framebuffer());
+      render_viewport(view->framebuffer(), view->name());
+      view->mark_clean();
+      is_any_rendered = true;
+    }
+
+    ImGui::Image((ImTextureID)(intptr_t)view->framebuffer().color_texture(), size, ImVec2(0, 1),  // NOLINT
+                 ImVec2(1, 0));
+
+    // Zooming changes the size of the orthographic camera
+    if (ImGui::IsItemHovered() && std::abs(ImGui::GetIO().MouseWheel) > 0.0F) {
+      Camera& camera       = view->camera();
+      const float distance = glm::length(camera.transform.local_pos()) * std::pow(0.9F, ImGui::GetIO().MouseWheel);
+      camera.transform.set_local_pos(glm::normalize(camera.transform.local_pos()) * std::max(distance, 0.1F));
+      camera.recalculate_projection();
+      view->mark_dirty();
+    }
+
+    ImGui::End();
+  }
+
+  // The main viewport uses the same programs
+  if (is_any_rendered) {
+    setup_shader_uniforms();
+  }
+}
+
+void Resin::invalidate_scene_views() {
+  for (auto& view : scene_views_) {
+    view->mark_dirty();
+  }
 }
 
 void Resin::render_material_images() {
-  for (auto& mat : material_images_->material_preview_fbs_map) {
-    if (mat.second->is_dirty && !mat.first.expired()) {
-      material_img_shader_->set_uniform("u_material", scene_.tree().material(mat.first).material);
-      render_material_image(mat.second->fb);
-    }
-    mat.second->mark_clean();
+  auto& tree = scene_.tree();
+
+  if (auto loaded = material_preview_cache_->poll_loaded()) {
+    loaded_material_previews_ = std::move(*loaded);
   }
 
-  if (material_images_->main_material_fb.is_dirty) {
-    if (material_images_->main_material_id && !material_images_->main_material_id->expired()) {
-      material_img_shader_->set_uniform("u_material",
-                                        scene_.tree().material(*material_images_->main_material_id).material);
-      render_material_image(material_images_->main_material_fb.fb);
+  std::vector<IdView<MaterialId>> mat_ids = tree.materials();
+  mat_ids.push_back(tree.default_material().material_id());
+
+  size_t tile_count = 0;
+  for (const auto& mat_id : mat_ids) {
+    tile_count = std::max(tile_count, mat_id.raw() + 1);
+  }
+
+  if (material_atlas_->is_reset() || !material_atlas_->fits(tile_count)) {
+    // The previews that are not on the disk yet would be lost with the content of the atlas
+    store_material_previews();
+    material_atlas_->reserve(tile_count);
+    material_atlas_->clear();
+    loaded_material_previews_.clear();
+
+    std::vector<uint64_t> keys;
+    keys.reserve(mat_ids.size());
+    for (const auto& mat_id : mat_ids) {
+      material_atlas_->mark_dirty(mat_id.raw());
+      keys.push_back(material_preview_cache_->key(tree.material(mat_id).material));
     }
-    material_images_->main_material_fb.mark_clean();
+    material_preview_cache_->load_async(std::move(keys));
+  }
+
+  // The dirty tiles wait for the cached previews, a missing one is rendered once the load is done
+  if (material_atlas_->dirty_tiles().empty() || material_preview_cache_->is_loading()) {
+    return;
   }
 
-  if (material_images_->node_material_preview_fb.is_dirty) {
-    if (material_images_->node_material_preview_id && !material_images_->node_material_preview_id->expired()) {
-      material_img_shader_->set_uniform("u_material",
-                                        scene_.tree().material(*material_images_->node_material_preview_id).material);
-      render_material_image(material_images_->node_material_preview_fb.fb);
+  std::vector<uint32_t> rendered_ids;
+  for (const auto& mat_id : mat_ids) {
+    const auto raw_id = static_cast<uint32_t>(mat_id.raw());
+    if (!material_atlas_->dirty_tiles().contains(raw_id)) {
+      continue;
+    }
+
+    const uint64_t key = material_preview_cache_->key(tree.material(mat_id).material);
+    if (auto it = loaded_material_previews_.find(key); it != loaded_material_previews_.end()) {
+      material_atlas_->upload_tile(raw_id, it->second);
+      unstored_material_previews_.erase(raw_id);
+    } else {
+      rendered_ids.push_back(raw_id);
+      unstored_material_previews_[raw_id] = key;
     }
-    material_images_->node_material_preview_fb.mark_clean();
   }
+  material_atlas_->mark_clean();
+
+  if (rendered_ids.empty()) {
+    return;
+  }
+
+  // Only the sphere pixels are opaque, so the background of the redrawn tiles stays the clear color
+  material_atlas_->fb().bind();
+
+  const auto columns = static_cast<float>(material_atlas_->columns());
+  const auto rows    = static_cast<float>(material_atlas_->rows());
+  material_img_shader_->set_uniform("u_columns", static_cast<uint32_t>(material_atlas_->columns()));
+  material_img_shader_->set_uniform("u_tileSize", glm::vec2(2.0F / columns, 2.0F / rows));
+
+  GPUProfileScope scope(*profiler_, "Material previews");
+  raycaster_->bind();
+  material_img_shader_->bind();
+  for (size_t first = 0; first < rendered_ids.size(); first += kMaterialBatchSize) {
+    const size_t count = std::min(kMaterialBatchSize, rendered_ids.size() - first);
+    material_img_shader_->set_uniform_array("u_materialIds", std::span<uint32_t>(rendered_ids.data() + first, count));
+    raycaster_->draw_call_instanced(static_cast<GLsizei>(count));
+  }
+  material_img_shader_->unbind();
+
+  material_atlas_->fb().unbind();
+
+  glViewport(0, 0, static_cast<GLint>(window_->dimensions().x), static_cast<GLint>(window_->dimensions().y));
+}
+
+void Resin::store_material_previews() {
+  std::vector<std::pair<uint64_t, MaterialPreviewPixels>> previews;
+  previews.reserve(unstored_material_previews_.size());
+  for (const auto& [raw_id, key] : unstored_material_previews_) {
+    previews.emplace_back(key, material_atlas_->download_tile(raw_id));
+  }
+  unstored_material_previews_.clear();
 
   glViewport(0, 0, static_cast<GLint>(window_->dimensions().x), static_cast<GLint>(window_->dimensions().y));
+  material_preview_cache_->store_async(std::move(previews));
+}
+
+void Resin::reload_modified_shaders() {
+  const std::vector<std::filesystem::path> modified = shader_resource_manager_.invalidate_modified();
+  if (modified.empty()) {
+    return;
+  }
+
+  // Only the programs built from the modified files are rebuilt, the others are not affected
+  bool is_reloaded = shader_->reload(shader_resource_manager_, modified);
+  is_reloaded      = grid_shader_->reload(shader_resource_manager_, modified) || is_reloaded;
+  is_reloaded      = material_img_shader_->reload(shader_resource_manager_, modified) || is_reloaded;
+  pick_region_reducer_->program().reload(shader_resource_manager_, modified);
+  if (is_reloaded) {
+    invalidate_scene_views();
+  }
+}
+
+void Resin::recover_scene_modal() {
+  if (!recovered_scene_) {
+    return;
+  }
+
+  if (!is_recovery_prompted_) {
+    ImGui::resin::OpenModal("Recover Scene");
+    is_recovery_prompted_ = true;
+  }
+
+  if (ImGui::resin::MessageOkCancelModal("Recover Scene",
+                                         "The last session did not close cleanly. Do you want to recover its scene "
+                                         "from the autosave?",
+                                         "Recover", "Discard")) {
+    try {
+      binary::deserialize_scene(scene_, *recovered_scene_, thread_pool_.get());
+      Logger::info("Recovered the scene of the last session");
+    } catch (...) {
+      Logger::err("Could not recover the scene of the last session");
+    }
+    material_atlas_->reset();
+  }
+
+  if (!ImGui::IsPopupOpen("Recover Scene")) {
+    recovered_scene_.reset();
+  }
 }
 
 void Resin::gui(duration_t delta) {
@@ -337,7 +618,8 @@ void Resin::gui(duration_t delta) {
 
   bool resized = false;
 
-  ImGui::resin::MainMenuBar(*material_images_, scene_);
+  ImGui::resin::MainMenuBar(*material_atlas_, scene_, *thread_pool_);
+  recover_scene_modal();
 
   if (ImGui::resin::Viewport(*framebuffer_, resized)) {
     // These click checks allow for instant camera manipulation when viewport is not focused
@@ -395,13 +677,14 @@ void Resin::gui(duration_t delta) {
       grid_shader_->set_uniform("u_camSize", camera_->height());
     }
 
-    render_viewport();
+    render_viewport(*framebuffer_, "Viewport");
     ImGui::Image((ImTextureID)(intptr_t)framebuffer_->color_texture(), ImVec2(width, height), ImVec2(0, 1),  // NOLINT
                  ImVec2(1, 0));
 
     if (ImGui::IsItemHovered()) {
       ImGui::SetNextFrameWantCaptureMouse(false);
     }
+    update_region_selection();
 
     ImGui::resin::gizmo::BeginFrame();
     draw_transform_gizmo();
@@ -410,9 +693,31 @@ void Resin::gui(duration_t delta) {
 
   ImGui::End();
 
+  draw_scene_views();
+
   ImGui::SetNextWindowSizeConstraints(ImVec2(280.F, 200.F), ImVec2(FLT_MAX, FLT_MAX));
   if (ImGui::Begin("SDF Tree")) {
-    ImGui::resin::SDFTreeView(scene_.tree(), selected_node_);
+    ImGui::resin::SDFTreeView(scene_.tree(), selected_node_, mesh_export_queue_);
+  }
+  ImGui::End();
+
+  if (ImGui::Begin("Selection")) {
+    std::erase_if(region_selected_nodes_, [](const IdView<SDFTreeNodeId>& node_id) { return node_id.expired(); });
+    if (region_selected_nodes_.empty()) {
+      ImGui::TextDisabled("Shift + drag: box, Alt + drag: lasso");
+    }
+    for (const auto& node_id : region_selected_nodes_) {
+      ImGui::PushID(static_cast<int>(node_id.raw()));
+      if (ImGui::Selectable(scene_.tree().node(node_id).name().data(), selected_node_ == node_id)) {
+        selected_node_ = node_id;
+      }
+      ImGui::PopID();
+    }
+  }
+  ImGui::End();
+
+  if (ImGui::Begin("Exports")) {
+    ImGui::resin::MeshExportJobsView(mesh_export_queue_);
   }
   ImGui::End();
 
@@ -423,9 +728,16 @@ void Resin::gui(duration_t delta) {
       shader_->set_uniform("u_camSize", camera_->height());
       grid_shader_->set_uniform("u_camSize", camera_->height());
     }
-    ImGui::Checkbox("Grid", &is_grid_);
+    if (ImGui::Checkbox("Grid", &is_grid_)) {
+      invalidate_scene_views();
+    }
     if (ImGui::DragFloat("Spacing", &grid_spacing_, 0.05F, 0.0F, 100.0F)) {
       grid_shader_->set_uniform("u_spacing", grid_spacing_);
+      invalidate_scene_views();
+    }
+    ImGui::Text("Views:");
+    for (auto& view : scene_views_) {
+      ImGui::Checkbox(view->name().data(), &view->is_open);
     }
     ImGui::Text("First Person Camera:");
     bool use_local_up = first_person_camera_operator_.is_using_local_axises();
@@ -435,13 +747,13 @@ void Resin::gui(duration_t delta) {
   ImGui::End();
 
   if (ImGui::Begin("Materials")) {
-    ImGui::resin::MaterialsListEdit(selected_material_, *material_images_, scene_.tree());
+    ImGui::resin::MaterialsListEdit(selected_material_, *material_atlas_, scene_.tree());
   }
   ImGui::End();
 
   if (ImGui::Begin("Edit Material")) {
     if (selected_material_ && !selected_material_->expired()) {
-      ImGui::resin::MaterialEdit(selected_material_, *material_images_, scene_.tree());
+      ImGui::resin::MaterialEdit(selected_material_, *material_atlas_, scene_.tree());
     }
   }
   ImGui::End();
@@ -450,32 +762,45 @@ void Resin::gui(duration_t delta) {
   ImGui::Begin("Lights");
   if (ImGui::BeginTabBar("LightsTabBar", ImGuiTabBarFlags_None)) {
     // TODO(SDF-88): i don't want to design GUI please save me guys 🤲🙏
+    bool is_light_edited = false;
     if (ImGui::BeginTabItem("DirLight")) {
-      ImGui::ColorEdit3("Light color", glm::value_ptr(directional_light_->color));
-      ImGui::resin::TransformEdit(&directional_light_->transform);
-      ImGui::DragFloat("Ambient impact", &directional_light_->ambient_impact, 0.01F, 0.0F, 2.0F, "%.2f");
+      ImGui::Checkbox("Animate", &is_light_animated_);
+      is_light_edited |= ImGui::ColorEdit3("Light color", glm::value_ptr(directional_light_->color));
+      is_light_edited |= ImGui::resin::TransformEdit(&directional_light_->transform);
+      is_light_edited |=
+          ImGui::DragFloat("Ambient impact", &directional_light_->ambient_impact, 0.01F, 0.0F, 2.0F, "%.2f");
 
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("PointLight")) {
-      ImGui::ColorEdit3("Light color", glm::value_ptr(point_light_->color));
-      ImGui::resin::TransformEdit(&point_light_->transform);
+      is_light_edited |= ImGui::ColorEdit3("Light color", glm::value_ptr(point_light_->color));
+      is_light_edited |= ImGui::resin::TransformEdit(&point_light_->transform);
       if (ImGui::TreeNode("Attenuation")) {
-        ImGui::DragFloat("Constant", &point_light_->attenuation.constant, 0.01F, 0.0F, 2.0F, "%.2f");
-        ImGui::DragFloat("Linear", &point_light_->attenuation.linear, 0.01F, 0.0F, 2.0F, "%.2f");
-        ImGui::DragFloat("Quadratic", &point_light_->attenuation.quadratic, 0.01F, 0.0F, 2.0F, "%.2f");
+        is_light_edited |= ImGui::DragFloat("Constant", &point_light_->attenuation.constant, 0.01F, 0.0F, 2.0F, "%.2f");
+        is_light_edited |= ImGui::DragFloat("Linear", &point_light_->attenuation.linear, 0.01F, 0.0F, 2.0F, "%.2f");
+        is_light_edited |=
+            ImGui::DragFloat("Quadratic", &point_light_->attenuation.quadratic, 0.01F, 0.0F, 2.0F, "%.2f");
         ImGui::TreePop();
       }
       ImGui::EndTabItem();
     }
     ImGui::EndTabBar();
+
+    if (is_light_edited) {
+      invalidate_scene_views();
+    }
   }
   ImGui::End();
 
   ImGui::SetNextWindowSizeConstraints(ImVec2(350.F, 200.F), ImVec2(FLT_MAX, FLT_MAX));
   ImGui::Begin("Selection");
   if (selected_node_.has_value() && !selected_node_->expired()) {
-    ImGui::resin::NodeEdit(scene_.tree().node(*selected_node_), *material_images_, selected_material_, scene_.tree());
+    ImGui::resin::NodeEdit(scene_.tree().node(*selected_node_), *material_atlas_, selected_material_, scene_.tree());
+  }
+  ImGui::End();
+
+  if (ImGui::Begin("Profiler")) {
+    ImGui::resin::ProfilerView(*profiler_);
   }
   ImGui::End();
 
@@ -536,7 +861,8 @@ bool Resin::on_mouse_btn_pressed(MouseButtonPressedEvent& e) {
     return false;
   }
 
-  if (e.button() == mouse::Code::MouseButtonLeft) {
+  // With a modifier the press starts a region selection instead
+  if (e.button() == mouse::Code::MouseButtonLeft && !io.KeyShift && !io.KeyAlt) {
     return select_node(relative_pos);
   }
 
@@ -560,6 +886,13 @@ bool Resin::on_key_pressed(KeyPressedEvent& e) {
     return switch_ortho();
   }
 
+  // The text fields undo their own edits
+  const ImGuiIO& io = ImGui::GetIO();
+  if (io.KeyCtrl && !io.WantTextInput && (e.key_code() == key::Code::Z || e.key_code() == key::Code::Y)) {
+    const bool is_redo = e.key_code() == key::Code::Y || io.KeyShift;
+    return is_redo ? tree_history_->redo() : tree_history_->undo();
+  }
+
   return start_moving_first_person_camera(e.key_code());
 }
 
@@ -786,17 +1119,71 @@ bool Resin::zoom_camera(glm::vec2 offset) {
 
 bool Resin::select_node(glm::vec2 relative_pos) {
   if (current_viewport_state_ == ViewportState::ActiveIdle || current_viewport_state_ == ViewportState::InactiveIdle) {
+    // Resolved by update() once the GPU is done, so the click does not stall the pipeline
     framebuffer_->bind();
-    int id = framebuffer_->sample_mouse_pick(static_cast<size_t>(relative_pos.x), static_cast<size_t>(relative_pos.y));
+    framebuffer_->request_mouse_pick(static_cast<size_t>(relative_pos.x), static_cast<size_t>(relative_pos.y));
     framebuffer_->unbind();
-
-    selected_node_ = id == -1 ? std::nullopt : scene_.tree().get_view_from_raw_id(static_cast<size_t>(id));
     return true;
   }
 
   return false;
 }
 
+bool Resin::update_region_selection() {
+  const ImGuiIO& io     = ImGui::GetIO();
+  const glm::vec2 mouse = glm::vec2(io.MousePos.x, io.MousePos.y) - viewport_pos_;
+
+  if (region_selection_mode_ == RegionSelectionMode::None) {
+    if ((current_viewport_state_ != ViewportState::ActiveIdle &&
+         current_viewport_state_ != ViewportState::InactiveIdle) ||
+        !ImGui::IsItemHovered() || !ImGui::IsMouseClicked(ImGuiMouseButton_Left) || (!io.KeyShift && !io.KeyAlt)) {
+      return false;
+    }
+    region_selection_mode_   = io.KeyShift ? RegionSelectionMode::Box : RegionSelectionMode::Lasso;
+    region_selection_points_ = {mouse};
+    return true;
+  }
+
+  if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+    static constexpr float kLassoPointSpacing = 3.0F;  // in pixels
+    if (region_selection_mode_ == RegionSelectionMode::Box) {
+      region_selection_points_.resize(2);
+      region_selection_points_.back() = mouse;
+    } else if (glm::distance(region_selection_points_.back(), mouse) > kLassoPointSpacing) {
+      region_selection_points_.push_back(mouse);
+    }
+
+    static constexpr ImU32 kOverlayColor = IM_COL32(255, 255, 255, 200);
+    ImDrawList* draw_list                = ImGui::GetWindowDrawList();
+    if (region_selection_mode_ == RegionSelectionMode::Box) {
+      const glm::vec2 from = viewport_pos_ + region_selection_points_.front();
+      const glm::vec2 to   = viewport_pos_ + region_selection_points_.back();
+      draw_list->AddRect(ImVec2(from.x, from.y), ImVec2(to.x, to.y), kOverlayColor);
+    } else {
+      std::vector<ImVec2> polyline;
+      polyline.reserve(region_selection_points_.size());
+      for (const auto& point : region_selection_points_) {
+        polyline.emplace_back(viewport_pos_.x + point.x, viewport_pos_.y + point.y);
+      }
+      draw_list->AddPolyline(polyline.data(), static_cast<int>(polyline.size()), kOverlayColor, ImDrawFlags_Closed,
+                             1.0F);
+    }
+    return true;
+  }
+
+  // Released, the selection is applied by update() once the reduction is read back
+  if (region_selection_mode_ == RegionSelectionMode::Box && region_selection_points_.size() == 2) {
+    pick_region_reducer_->request_box(*framebuffer_, region_selection_points_.front(), region_selection_points_.back(),
+                                      scene_.tree().max_node_count());
+  } else if (region_selection_mode_ == RegionSelectionMode::Lasso && region_selection_points_.size() >= 3) {
+    pick_region_reducer_->request_lasso(*framebuffer_, region_selection_points_, scene_.tree().max_node_count());
+  }
+
+  region_selection_mode_ = RegionSelectionMode::None;
+  region_selection_points_.clear();
+  return true;
+}
+
 bool Resin::start_interpolation() {
   if (current_viewport_state_ == ViewportState::ActiveIdle || current_viewport_state_ == ViewportState::InactiveIdle) {
     current_viewport_state_ = ViewportState::CameraInterpolation;
@@ -5,17 +5,26 @@
 #include <cstdint>
 #include <glm/ext/vector_float2.hpp>
 #include <libresin/core/camera.hpp>
+#include <libresin/core/frame_profiler.hpp>
 #include <libresin/core/framebuffer.hpp>
 #include <libresin/core/material.hpp>
+#include <libresin/core/material_preview_cache.hpp>
+#include <libresin/core/mesh_export_job.hpp>
+#include <libresin/core/pick_region.hpp>
 #include <libresin/core/raycaster.hpp>
 #include <libresin/core/resources/shader_resource.hpp>
 #include <libresin/core/scene.hpp>
+#include <libresin/core/scene_journal.hpp>
+#include <libresin/core/scene_view.hpp>
 #include <libresin/core/sdf_tree/group_node.hpp>
 #include <libresin/core/sdf_tree/sdf_tree.hpp>
+#include <libresin/core/sdf_tree/sdf_tree_history.hpp>
 #include <libresin/core/sdf_tree/sdf_tree_node.hpp>
 #include <libresin/core/shader.hpp>
 #include <libresin/core/uniform_buffer.hpp>
+#include <libresin/utils/thread_pool.hpp>
 #include <memory>
+#include <optional>
 #include <resin/camera/first_person_camera_operator.hpp>
 #include <resin/camera/orbiting_camera_operator.hpp>
 #include <resin/core/key_codes.hpp>
@@ -26,8 +35,10 @@
 #include <resin/event/window_events.hpp>
 #include <resin/imgui/gizmo.hpp>
 #include <resin/imgui/material.hpp>
-#include <resin/imgui/types.hpp>
 #include <resin/resources/resource_managers.hpp>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 int main();
 
@@ -60,9 +71,13 @@ class Resin {
   void init_gl();
   void update(duration_t delta);
   void gui(duration_t delta);
-  void render_viewport();
-  void render_material_image(ImageFramebuffer& fb);
+  void render_viewport(ViewportFramebuffer& framebuffer, std::string_view name);
+  void draw_scene_views();
+  void invalidate_scene_views();
   void render_material_images();
+  void store_material_previews();
+  void recover_scene_modal();
+  void reload_modified_shaders();
 
   // events
   bool on_window_close(WindowCloseEvent& e);
@@ -88,6 +103,7 @@ class Resin {
   bool update_camera_operators(float dt);
   bool zoom_camera(glm::vec2 offset);
   bool select_node(glm::vec2 relative_pos);
+  bool update_region_selection();
   bool start_interpolation();
   bool interpolate(float dt);
 
@@ -95,9 +111,11 @@ class Resin {
   static constexpr duration_t kTickTime = 16666us;  // 60 TPS = 16.6(6) ms/t
 
  private:
-  static constexpr size_t kMaterialNodeImageSize = 32;
-  static constexpr size_t kMaterialImageSize     = 64;
-  static constexpr size_t kMaterialMainImageSize = 160;
+  static constexpr size_t kMaterialAtlasColumns     = 8;
+  static constexpr size_t kMaterialBatchSize        = 64;  // previews drawn by a single instanced draw call
+  static constexpr float kSceneViewResolutionScale  = 0.5F;
+  static constexpr duration_t kAutosaveInterval     = 1s;
+  static constexpr duration_t kShaderReloadInterval = 500ms;
 
   EventDispatcher dispatcher_;
   ShaderResourceManager& shader_resource_manager_ = ResourceManagers::shader_manager();
@@ -114,7 +132,17 @@ class Resin {
   };
   ViewportState current_viewport_state_;
 
+  enum class RegionSelectionMode : uint8_t {
+    None,
+    Box,    // shift + drag
+    Lasso,  // alt + drag
+    _Count  // NOLINT
+  };
+  RegionSelectionMode region_selection_mode_;
+  std::vector<glm::vec2> region_selection_points_;  // viewport coordinates
+
   std::optional<IdView<SDFTreeNodeId>> selected_node_;
+  std::vector<IdView<SDFTreeNodeId>> region_selected_nodes_;
   std::optional<IdView<MaterialId>> selected_material_;
 
   std::unique_ptr<Window> window_;
@@ -126,7 +154,22 @@ class Resin {
   std::unique_ptr<NodeAttributesUniformBuffer> node_attributes_ubo_;
   std::unique_ptr<MaterialUniformBuffer> material_ubo_;
   std::unique_ptr<ViewportFramebuffer> framebuffer_;
-  std::unique_ptr<ImGui::resin::LazyMaterialImageFramebuffers> material_images_;
+  std::vector<std::unique_ptr<SceneView>> scene_views_;
+  std::unique_ptr<PickRegionReducer> pick_region_reducer_;
+  std::unique_ptr<FrameProfiler> profiler_;
+  std::unique_ptr<ImGui::resin::MaterialPreviewAtlas> material_atlas_;
+  std::unique_ptr<MaterialPreviewCache> material_preview_cache_;
+  std::unordered_map<uint64_t, MaterialPreviewPixels> loaded_material_previews_;
+  std::unordered_map<uint32_t, uint64_t> unstored_material_previews_;  // atlas tile -> key of its preview
+
+  // Shared by the scene loads, so that every load does not start and join its own worker threads
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  std::unique_ptr<SceneJournal> scene_journal_;
+  std::optional<std::vector<uint8_t>> recovered_scene_;  // binary scene of the last session, until the user answers
+  bool is_recovery_prompted_    = false;
+  duration_t autosave_lag_      = 0ns;
+  duration_t shader_reload_lag_ = 0ns;
 
   glm::vec2 viewport_pos_;
 
@@ -138,6 +181,7 @@ class Resin {
 
   bool use_local_gizmos_{false};
   bool is_grid_{true};
+  bool is_light_animated_{true};
   float grid_spacing_ = 1.0;
 
   float camera_distance_;
@@ -148,6 +192,11 @@ class Resin {
   FirstPersonCameraOperator first_person_camera_operator_;
 
   Scene scene_;
+  std::unique_ptr<SDFTreeHistory> tree_history_;  // declared after the scene, as it releases the retained prefabs
+  bool has_uncommitted_edits_ = false;            // the tree was marked dirty since the last commit of the history
+
+  // Declared after the GL objects, so pending exports release their buffers while the context is alive
+  MeshExportQueue mesh_export_queue_;
 
   bool running_   = true;
   bool minimized_ = false;